@@ -0,0 +1,234 @@
+/**
+ * @file avatarbench.cpp
+ * @brief Avatar appearance benchmark: region-less avatars loading, wearables,
+ *        visual params and motions updates
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+
+#include "llanimationstates.h"
+#include "llpolymesh.h"
+
+#include "benchavatar.h"
+#include "viewerbench.h"
+
+// Prints the duration and allocations of a benchmark stage, per 'divisor'
+// (avatar or frame).
+static void print_stage(const char* name, F64 start,
+						const LLBenchAllocs& allocs, U32 divisor,
+						const char* unit)
+{
+	F64 elapsed = bench_elapsed(start);
+	std::cout << llformat("%-22s %10.3fms (%.3fms per %s)", name,
+						  elapsed * 1000.0, elapsed * 1000.0 / divisor, unit)
+			  << "\n    per " << unit << ": " << allocs.delta(divisor)
+			  << std::endl;
+}
+
+// Frames: 'changes' avatars change their appearance at each frame, and all
+// get their motions and joints updated.
+static void run_frames(std::vector<LLBenchAvatar*>& avatars, U32 frames,
+					   U32 changes, U32 unique)
+{
+	U32 composites = LLBenchTexLayerSet::sUpdateRequests;
+	U32 dirty_meshes = LLBenchAvatar::sDirtyMeshes;
+#if LL_FAST_TIMERS_ENABLED
+	LLFastTimer::reset();
+#endif
+	F64 start = LLTimer::getTotalSeconds();
+	LLBenchAllocs allocs;
+	U32 count = avatars.size();
+	U32 next_change = 0;
+	for (U32 f = 0; f < frames; ++f)
+	{
+		LL_TRACY_TIMER(TRC_BENCH_AVATAR_FRAME);
+		bench_step_frame();
+		for (U32 i = 0; i < changes; ++i)
+		{
+			LLBenchAvatar* avatarp = avatars[next_change];
+			avatarp->randomizeWearables((f + next_change) % unique);
+			avatarp->updateVisualParams();
+			next_change = (next_change + 1) % count;
+		}
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLBenchAvatar* avatarp = avatars[i];
+			avatarp->updateMotions(LLCharacter::FORCE_UPDATE);
+			avatarp->getRootJoint()->updateWorldMatrixChildren();
+		}
+	}
+	print_stage("Animated frames:", start, allocs, frames, "frame");
+#if LL_FAST_TIMERS_ENABLED
+	static const LLBenchTimer timers[] =
+	{
+		{ LLFastTimer::FTM_UPDATE_ANIMATION,				"Animation" },
+		{ LLFastTimer::FTM_UPDATE_MOTIONS,					"Motions" },
+		{ LLFastTimer::FTM_MOTION_ON_UPDATE,				"On Update" },
+		{ LLFastTimer::FTM_APPLY_MORPH_TARGET,				"Apply Morph" },
+		{ LLFastTimer::FTM_POLYSKELETAL_DISTORTION_APPLY,	"Skel Distortion" },
+	};
+	bench_print_timers(timers, LL_ARRAY_SIZE(timers), frames);
+#endif
+	std::cout << llformat("Null renderer: %.2f composite updates and %.2f mesh rebuilds requested per frame.",
+						  (F64)(LLBenchTexLayerSet::sUpdateRequests -
+								composites) / frames,
+						  (F64)(LLBenchAvatar::sDirtyMeshes - dirty_meshes) /
+						  frames)
+			  << std::endl;
+}
+
+int avatar_benchmark(const std::vector<std::string>& args)
+{
+	// Options: -n <avatars> -f <frames> -u <appearances> -a <changes>
+	// -s <self> -c <cache MB>
+	U32 values[] = { 10, 100, 8, 1, 1, 32 };
+	if (!parse_bench_options(args, "nfuasc", values))
+	{
+		std::cerr << "Options for the avatar benchmark:\n"
+				  << "  -n <count>    Number of avatars (default: 10).\n"
+				  << "  -f <count>    Number of animated frames (default: 100).\n"
+				  << "  -u <count>    Number of distinct random appearances\n"
+				  << "                (default: 8).\n"
+				  << "  -a <count>    Avatars changing appearance at each frame\n"
+				  << "                (default: 1).\n"
+				  << "  -s <0|1>      Make the first avatar the agent's own avatar,\n"
+				  << "                with texture layer sets (default: 1).\n"
+				  << "  -c <MB>       Morphed meshes cache size, 0 to disable it\n"
+				  << "                (default: 32).\n"
+				  << "This benchmark must run from the directory holding the viewer\n"
+				  << "\"character\" sub-directory. Nothing is rendered: the texture\n"
+				  << "layers compositing and mesh rebuilds are only counted.\n"
+				  << std::endl;
+		return 1;
+	}
+	U32 count = llmax(1U, values[0]);
+	U32 frames = values[1];
+	U32 unique = llmax(1U, values[2]);
+	U32 changes = llmin(values[3], count);
+	bool self = values[4] != 0;
+	LLPolyMesh::setMorphsCacheSize(values[5]);
+
+	F64 start = LLTimer::getTotalSeconds();
+	LLBenchAllocs allocs;
+	if (!LLBenchAvatar::initClass())
+	{
+		return 1;
+	}
+	print_stage("Character files:", start, allocs, 1, "load");
+
+	// The first avatar loads the meshes and motions, the others share them.
+	std::vector<LLBenchAvatar*> avatars;
+	avatars.reserve(count);
+	{
+		LL_TRACY_TIMER(TRC_BENCH_AVATAR_CREATE);
+		start = LLTimer::getTotalSeconds();
+		allocs.snapshot();
+		LLBenchAvatar* avatarp = new LLBenchAvatar(self);
+		avatarp->initInstance();
+		avatars.push_back(avatarp);
+		print_stage("First avatar:", start, allocs, 1, "avatar");
+
+		if (count > 1)
+		{
+			start = LLTimer::getTotalSeconds();
+			allocs.snapshot();
+			for (U32 i = 1; i < count; ++i)
+			{
+				avatarp = new LLBenchAvatar(false);
+				avatarp->initInstance();
+				avatars.push_back(avatarp);
+			}
+			print_stage("Other avatars:", start, allocs, count - 1,
+						"avatar");
+		}
+	}
+
+	// Wearables and visual params: 'unique' distinct appearances, so that
+	// the morphed meshes cache gets hits when count > unique.
+	{
+		LL_TRACY_TIMER(TRC_BENCH_AVATAR_WEARABLES);
+		start = LLTimer::getTotalSeconds();
+		allocs.snapshot();
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLBenchAvatar* avatarp = avatars[i];
+			avatarp->createWearables();
+			avatarp->randomizeWearables(i % unique);
+			avatarp->updateVisualParams();
+		}
+		print_stage("Wearables and params:", start, allocs, count, "avatar");
+	}
+
+	// Motions: half the avatars walk, the others stand, and all get the
+	// default procedural motions implemented in llcharacter.
+	{
+		LL_TRACY_TIMER(TRC_BENCH_AVATAR_MOTIONS_START);
+		start = LLTimer::getTotalSeconds();
+		allocs.snapshot();
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLBenchAvatar* avatarp = avatars[i];
+			if (i % 2)
+			{
+				avatarp->setVelocity(LLVector3(3.f, 0.f, 0.f));
+				avatarp->startMotion(ANIM_AGENT_WALK);
+				avatarp->startMotion(ANIM_AGENT_WALK_ADJUST);
+			}
+			else
+			{
+				avatarp->startMotion(ANIM_AGENT_STAND);
+			}
+			avatarp->startMotion(ANIM_AGENT_HEAD_ROT);
+			avatarp->startMotion(ANIM_AGENT_EYE);
+			avatarp->startMotion(ANIM_AGENT_HAND_MOTION);
+			avatarp->updateMotions(LLCharacter::FORCE_UPDATE);
+		}
+		print_stage("Motions start:", start, allocs, count, "avatar");
+	}
+
+	if (frames)
+	{
+		run_frames(avatars, frames, changes, unique);
+	}
+
+	start = LLTimer::getTotalSeconds();
+	for (U32 i = 0; i < count; ++i)
+	{
+		delete avatars[i];
+	}
+	avatars.clear();
+	LLBenchAvatar::cleanupClass();
+	std::cout << llformat("Cleanup: %.3fms", bench_elapsed(start) * 1000.0)
+			  << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,299 @@
+/**
+ * @file benchavatar.cpp
+ * @brief Region-less avatar fixture for the viewer libraries benchmarks
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+
+#include "benchavatar.h"
+
+#include "llanimationstates.h"
+#include "lldir.h"
+#include "lleditingmotion.h"
+#include "llemote.h"
+#include "llglslshader.h"
+#include "llhandmotion.h"
+#include "llheadrotmotion.h"
+#include "llkeyframefallmotion.h"
+#include "llkeyframestandmotion.h"
+#include "llkeyframewalkmotion.h"
+#include "llpolymesh.h"
+#include "lltargetingmotion.h"
+
+using namespace LLAvatarAppearanceDefines;
+
+// Defined by the viewer shaders manager, and referenced by the texture layers
+// code; never bound here, since nothing gets composited.
+LLGLSLShader gAlphaMaskProgram;
+
+U32 LLBenchTexLayerSet::sUpdateRequests = 0;
+U32 LLBenchAvatar::sDirtyMeshes = 0;
+
+// Small xorshift generator, so that a given seed always gives the same
+// appearance, whatever the benchmark options.
+static F32 bench_frand(U32& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (F32)(state & 0xFFFFFF) / (F32)0x1000000;
+}
+
+// There is no UI to translate the wearable type names for.
+class LLBenchTranslationBridge final : public LLTranslationBridge
+{
+public:
+	LL_INLINE std::string getString(const std::string& xml_desc) override
+	{
+		return xml_desc;
+	}
+};
+
+//-----------------------------------------------------------------------------
+// LLBenchWearable class
+//-----------------------------------------------------------------------------
+
+LLBenchWearable::LLBenchWearable(LLWearableType::EType type,
+								 LLAvatarAppearance* avatarp)
+{
+	setType(type, avatarp);
+	setName(LLWearableType::getTypeName(type));
+}
+
+void LLBenchWearable::randomizeParams(U32 seed)
+{
+	U32 state = (seed + 1) * 2654435761U | 1;
+	for (visual_param_index_map_t::iterator
+			it = mVisualParamIndexMap.begin(),
+			end = mVisualParamIndexMap.end();
+		 it != end; ++it)
+	{
+		LLVisualParam* paramp = it->second;
+		if (paramp && paramp->isTweakable())
+		{
+			F32 min_weight = paramp->getMinWeight();
+			F32 range = paramp->getMaxWeight() - min_weight;
+			setVisualParamWeight(it->first,
+								 min_weight + range * bench_frand(state),
+								 false);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// LLBenchAvatar class
+//-----------------------------------------------------------------------------
+
+//static
+bool LLBenchAvatar::initClass()
+{
+	std::string lad_file =
+		gDirUtilp->getExpandedFilename(LL_PATH_CHARACTER, "avatar_lad.xml");
+	if (!LLFile::exists(lad_file))
+	{
+		std::cerr << "Cannot find " << lad_file
+				  << ": run viewerbench from the directory holding the "
+				  << "viewer \"character\" sub-directory (with its meshes "
+				  << "and anims)." << std::endl;
+		return false;
+	}
+
+	LLWearableType::initClass(std::make_shared<LLBenchTranslationBridge>());
+	gAvatarAppDictp = new LLAvatarAppearanceDictionary();
+	LLAvatarAppearance::initClass("avatar_lad.xml", "avatar_skeleton.xml");
+	return true;
+}
+
+//static
+void LLBenchAvatar::cleanupClass()
+{
+	LLKeyframeMotion::flushKeyframeCache();
+	LLPolyMesh::freeAllMeshes();
+	LLAvatarAppearance::cleanupClass();
+	LLWearableType::cleanupClass();
+	if (gAvatarAppDictp)
+	{
+		delete gAvatarAppDictp;	// Also NULLs gAvatarAppDictp
+	}
+}
+
+LLBenchAvatar::LLBenchAvatar(bool is_self)
+:	LLAvatarAppearance(new LLBenchWearableData),
+	mLastSkeletonSerialNum(0),
+	mIsSelf(is_self)
+{
+	mID.generate();
+	getWearableData()->setAvatarAppearance(this);
+}
+
+//virtual
+LLBenchAvatar::~LLBenchAvatar()
+{
+	for (U32 i = 0, count = mWearables.size(); i < count; ++i)
+	{
+		delete mWearables[i];
+	}
+	mWearables.clear();
+	delete getWearableData();
+}
+
+//virtual
+void LLBenchAvatar::initInstance()
+{
+	// Register the motions implemented in llcharacter, like LLVOAvatar does
+	// for the first avatar (the registry is shared by all characters).
+	if (LLCharacter::sInstances.size() == 1)
+	{
+		registerMotion(ANIM_AGENT_CROUCH,		LLKeyframeStandMotion::create);
+		registerMotion(ANIM_AGENT_CROUCHWALK,	LLKeyframeWalkMotion::create);
+		registerMotion(ANIM_AGENT_EXPRESS_LAUGH,	LLEmote::create);
+		registerMotion(ANIM_AGENT_EXPRESS_SMILE,	LLEmote::create);
+		registerMotion(ANIM_AGENT_FEMALE_WALK,	LLKeyframeWalkMotion::create);
+		registerMotion(ANIM_AGENT_RUN,			LLKeyframeWalkMotion::create);
+		registerMotion(ANIM_AGENT_STAND,		LLKeyframeStandMotion::create);
+		registerMotion(ANIM_AGENT_STAND_1,		LLKeyframeStandMotion::create);
+		registerMotion(ANIM_AGENT_STAND_2,		LLKeyframeStandMotion::create);
+		registerMotion(ANIM_AGENT_STAND_3,		LLKeyframeStandMotion::create);
+		registerMotion(ANIM_AGENT_STAND_4,		LLKeyframeStandMotion::create);
+		registerMotion(ANIM_AGENT_STANDUP,		LLKeyframeFallMotion::create);
+		registerMotion(ANIM_AGENT_TURNLEFT,		LLKeyframeWalkMotion::create);
+		registerMotion(ANIM_AGENT_TURNRIGHT,	LLKeyframeWalkMotion::create);
+		registerMotion(ANIM_AGENT_WALK,			LLKeyframeWalkMotion::create);
+
+		// Motions without a start/stop bit
+		registerMotion(ANIM_AGENT_EDITING,		LLEditingMotion::create);
+		registerMotion(ANIM_AGENT_EYE,			LLEyeMotion::create);
+		registerMotion(ANIM_AGENT_FLY_ADJUST,	LLFlyAdjustMotion::create);
+		registerMotion(ANIM_AGENT_HAND_MOTION,	LLHandMotion::create);
+		registerMotion(ANIM_AGENT_HEAD_ROT,		LLHeadRotMotion::create);
+		registerMotion(ANIM_AGENT_TARGET,		LLTargetingMotion::create);
+		registerMotion(ANIM_AGENT_WALK_ADJUST,	LLWalkAdjustMotion::create);
+	}
+
+	LLAvatarAppearance::initInstance();
+}
+
+void LLBenchAvatar::createWearables()
+{
+	static const LLWearableType::EType types[] =
+	{
+		LLWearableType::WT_SHAPE, LLWearableType::WT_SKIN,
+		LLWearableType::WT_HAIR, LLWearableType::WT_EYES,
+		LLWearableType::WT_SHIRT, LLWearableType::WT_PANTS,
+		LLWearableType::WT_SHOES, LLWearableType::WT_JACKET,
+		LLWearableType::WT_GLOVES, LLWearableType::WT_SKIRT
+	};
+
+	LLBenchWearableData* datap = (LLBenchWearableData*)getWearableData();
+	for (U32 i = 0; i < LL_ARRAY_SIZE(types); ++i)
+	{
+		LLBenchWearable* wearablep = new LLBenchWearable(types[i], this);
+		mWearables.push_back(wearablep);
+		datap->addWearable(wearablep);
+	}
+}
+
+void LLBenchAvatar::randomizeWearables(U32 seed)
+{
+	for (U32 i = 0, count = mWearables.size(); i < count; ++i)
+	{
+		LLBenchWearable* wearablep = mWearables[i];
+		wearablep->randomizeParams(seed * 31 + i);
+		wearablep->writeToAvatar(this);
+	}
+}
+
+//virtual
+void LLBenchAvatar::updateVisualParams()
+{
+	setSex(getVisualParamWeight("male") > 0.5f ? SEX_MALE : SEX_FEMALE);
+
+	LLPolyMesh::beginMorphsBatch();
+	LLCharacter::updateVisualParams();
+	LLPolyMesh::endMorphsBatch();
+
+	if (mLastSkeletonSerialNum != mSkeletonSerialNum)
+	{
+		computeBodySize();
+		mLastSkeletonSerialNum = mSkeletonSerialNum;
+		mRoot->updateWorldMatrixChildren();
+	}
+
+	dirtyMesh();
+}
+
+//virtual
+void LLBenchAvatar::getGround(const LLVector3& in_pos, LLVector3& out_pos,
+							  LLVector3& out_norm)
+{
+	// Flat ground at z = 0
+	out_pos = in_pos;
+	out_pos.mV[VZ] = 0.f;
+	out_norm.set(0.f, 0.f, 1.f);
+}
+
+//virtual
+void LLBenchAvatar::invalidateComposite(LLTexLayerSet* layersetp, bool)
+{
+	if (layersetp)
+	{
+		layersetp->requestUpdate();
+		layersetp->invalidateMorphMasks();
+	}
+}
+
+//virtual
+void LLBenchAvatar::onGlobalColorChanged(const LLTexGlobalColor* global_color,
+										 bool upload_bake)
+{
+	if (global_color == mTexSkinColor)
+	{
+		invalidateComposite(mBakedTextureDatas[BAKED_HEAD].mTexLayerSet,
+							upload_bake);
+		invalidateComposite(mBakedTextureDatas[BAKED_UPPER].mTexLayerSet,
+							upload_bake);
+		invalidateComposite(mBakedTextureDatas[BAKED_LOWER].mTexLayerSet,
+							upload_bake);
+	}
+	else if (global_color == mTexHairColor)
+	{
+		invalidateComposite(mBakedTextureDatas[BAKED_HEAD].mTexLayerSet,
+							upload_bake);
+		invalidateComposite(mBakedTextureDatas[BAKED_HAIR].mTexLayerSet,
+							upload_bake);
+	}
+	else if (global_color == mTexEyeColor)
+	{
+		invalidateComposite(mBakedTextureDatas[BAKED_EYES].mTexLayerSet,
+							upload_bake);
+	}
+}
@@ -0,0 +1,227 @@
+/**
+ * @file benchavatar.h
+ * @brief Region-less avatar fixture for the viewer libraries benchmarks
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_BENCHAVATAR_H
+#define LL_BENCHAVATAR_H
+
+#include "llavatarappearance.h"
+#include "llavatarjointmesh.h"
+#include "lltexlayer.h"
+#include "llwearable.h"
+#include "llwearabledata.h"
+
+// These classes implement the viewer-side interfaces of the avatar libraries
+// (llappearance and llcharacter) with a null renderer: the avatars get their
+// skeleton, meshes, visual params, wearables and motions, but nothing ever
+// gets drawn, textured or composited. They only need the character files
+// (avatar_lad.xml, the skeleton, the .llm meshes and the anims/ static
+// animations), and no window, login or region.
+
+class LLBenchJoint : public virtual LLAvatarJoint
+{
+public:
+	LL_INLINE U32 render(F32, bool, bool) override		{ return 0; }
+};
+
+class LLBenchJointMesh final : public LLAvatarJointMesh, public LLBenchJoint
+{
+};
+
+// Layer sets only exist for the agent's own avatar. Compositing them needs a
+// GL context, so we only count the composite updates they get requested.
+class LLBenchTexLayerSet final : public LLTexLayerSet
+{
+public:
+	LL_INLINE LLBenchTexLayerSet(LLAvatarAppearance* const appearance)
+	:	LLTexLayerSet(appearance)
+	{
+	}
+
+	LL_INLINE void createComposite() override			{}
+	LL_INLINE void requestUpdate() override				{ ++sUpdateRequests; }
+
+public:
+	static U32	sUpdateRequests;
+};
+
+class LLBenchWearable final : public LLWearable
+{
+public:
+	LLBenchWearable(LLWearableType::EType type, LLAvatarAppearance* avatarp);
+
+	// Sets all the tweakable params of this wearable to random weights,
+	// reproducible for a given 'seed'.
+	void randomizeParams(U32 seed);
+
+	LL_INLINE LLUUID getDefaultTextureImageID(LLAvatarAppearanceDefines::ETextureIndex) override
+	{
+		return LLUUID::null;
+	}
+
+	LL_INLINE void setUpdated() const override			{}
+	LL_INLINE void addToBakedTextureHash(LLMD5&) const override	{}
+};
+
+class LLBenchWearableData final : public LLWearableData
+{
+public:
+	LL_INLINE bool addWearable(LLWearable* wearablep)
+	{
+		return pushWearable(wearablep->getType(), wearablep);
+	}
+};
+
+class LLBenchAvatar final : public LLAvatarAppearance
+{
+protected:
+	LOG_CLASS(LLBenchAvatar);
+
+public:
+	// Loads the character definition files; returns false when they cannot
+	// be found in the current directory.
+	static bool initClass();
+	static void cleanupClass();
+
+	// When 'is_self' is true, the avatar gets the texture layer sets of the
+	// agent's own avatar.
+	LLBenchAvatar(bool is_self);
+	~LLBenchAvatar() override;
+
+	void initInstance() override;
+
+	// Creates the body parts and a few clothing wearables and wears them.
+	void createWearables();
+
+	// Gives random (seeded) weights to the params of all worn wearables and
+	// writes them to the avatar params. Call updateVisualParams() to apply.
+	void randomizeWearables(U32 seed);
+
+	// Same as LLVOAvatar::updateVisualParams(), minus the drawable updates.
+	void updateVisualParams() override;
+
+	LL_INLINE void setVelocity(const LLVector3& vel)	{ mVelocity = vel; }
+
+	// LLCharacter interface
+	LL_INLINE LLVector3 getCharacterPosition() override	{ return LLVector3::zero; }
+
+	LL_INLINE LLQuaternion getCharacterRotation() override
+	{
+		return LLQuaternion::DEFAULT;
+	}
+
+	LL_INLINE LLVector3 getCharacterVelocity() override	{ return mVelocity; }
+
+	LL_INLINE LLVector3 getCharacterAngularVelocity() override
+	{
+		return LLVector3::zero;
+	}
+
+	void getGround(const LLVector3& in_pos, LLVector3& out_pos,
+				   LLVector3& out_norm) override;
+
+	LL_INLINE F32 getTimeDilation() override			{ return 1.f; }
+
+	// Large enough for all the meshes LODs to be considered visible.
+	LL_INLINE F32 getPixelArea() const override			{ return 100000.f; }
+
+	LL_INLINE LLVector3d getPosGlobalFromAgent(const LLVector3& pos) override
+	{
+		return LLVector3d(pos);
+	}
+
+	LL_INLINE LLVector3 getPosAgentFromGlobal(const LLVector3d& pos) override
+	{
+		return LLVector3(pos);
+	}
+
+	LL_INLINE void addDebugText(const std::string&) override	{}
+	LL_INLINE const LLUUID& getID() override			{ return mID; }
+
+	// LLAvatarAppearance interface
+	LL_INLINE bool isSelf() const override				{ return mIsSelf; }
+	LL_INLINE bool isValid() const override				{ return true; }
+	LL_INLINE bool isUsingServerBakes() const override	{ return !mIsSelf; }
+	LL_INLINE bool isUsingLocalAppearance() const override	{ return mIsSelf; }
+	LL_INLINE bool isEditingAppearance() const override	{ return false; }
+
+	LL_INLINE void applyMorphMask(U8*, S32, S32, S32,
+								  LLAvatarAppearanceDefines::EBakedTextureIndex) override
+	{
+	}
+
+	void invalidateComposite(LLTexLayerSet* layersetp,
+							 bool upload_result) override;
+
+	LL_INLINE void updateMeshTextures() override		{}
+	LL_INLINE void dirtyMesh() override					{ ++sDirtyMeshes; }
+
+	void onGlobalColorChanged(const LLTexGlobalColor* global_color,
+							  bool upload_bake) override;
+
+	LL_INLINE bool isTextureDefined(LLAvatarAppearanceDefines::ETextureIndex,
+									U32) const override
+	{
+		return true;
+	}
+
+protected:
+	LL_INLINE LLAvatarJoint* createAvatarJoint() override
+	{
+		return new LLBenchJoint();
+	}
+
+	LL_INLINE LLAvatarJointMesh* createAvatarJointMesh() override
+	{
+		return new LLBenchJointMesh();
+	}
+
+	LL_INLINE void bodySizeChanged() override			{}
+	LL_INLINE void dirtyMesh(S32) override				{ ++sDirtyMeshes; }
+
+	LL_INLINE LLTexLayerSet* createTexLayerSet() override
+	{
+		return new LLBenchTexLayerSet(this);
+	}
+
+public:
+	// Number of mesh rebuilds the avatars requested from the (null) renderer.
+	static U32				sDirtyMeshes;
+
+private:
+	LLUUID					mID;
+	LLVector3				mVelocity;
+	std::vector<LLBenchWearable*> mWearables;
+	U32						mLastSkeletonSerialNum;
+	bool					mIsSelf;
+};
+
+#endif	// LL_BENCHAVATAR_H
@@ -0,0 +1,172 @@
+/**
+ * @file keyframebench.cpp
+ * @brief Keyframe motions playback benchmark
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+
+#include "llanimationstates.h"
+
+#include "benchavatar.h"
+#include "viewerbench.h"
+
+// The standard keyframe animations shipped with the viewer (in character/
+// anims), that the avatars play in turn.
+static const LLUUID* sAnimations[] =
+{
+	&ANIM_AGENT_STAND, &ANIM_AGENT_WALK, &ANIM_AGENT_RUN,
+	&ANIM_AGENT_FEMALE_WALK, &ANIM_AGENT_STAND_1, &ANIM_AGENT_STAND_2,
+	&ANIM_AGENT_STAND_3, &ANIM_AGENT_STAND_4, &ANIM_AGENT_TURNLEFT,
+	&ANIM_AGENT_TURNRIGHT, &ANIM_AGENT_CROUCH, &ANIM_AGENT_CROUCHWALK,
+	&ANIM_AGENT_EXPRESS_SMILE, &ANIM_AGENT_EXPRESS_LAUGH
+};
+
+int keyframe_benchmark(const std::vector<std::string>& args)
+{
+	// Options: -n <avatars> -f <frames> -m <motions per avatar>
+	U32 values[] = { 100, 300, 2 };
+	if (!parse_bench_options(args, "nfm", values))
+	{
+		std::cerr << "Options for the keyframe benchmark:\n"
+				  << "  -n <count>    Number of avatars (default: 100).\n"
+				  << "  -f <count>    Number of animated frames (default: 300).\n"
+				  << "  -m <count>    Keyframe motions played by each avatar\n"
+				  << "                (default: 2).\n"
+				  << "This benchmark must run from the directory holding the viewer\n"
+				  << "\"character\" sub-directory.\n"
+				  << std::endl;
+		return 1;
+	}
+	U32 count = llmax(1U, values[0]);
+	U32 frames = llmax(1U, values[1]);
+	U32 motions = llclamp(values[2], 1U, (U32)LL_ARRAY_SIZE(sAnimations));
+
+	if (!LLBenchAvatar::initClass())
+	{
+		return 1;
+	}
+
+	F64 start = LLTimer::getTotalSeconds();
+	std::vector<LLBenchAvatar*> avatars;
+	avatars.reserve(count);
+	for (U32 i = 0; i < count; ++i)
+	{
+		LLBenchAvatar* avatarp = new LLBenchAvatar(false);
+		avatarp->initInstance();
+		avatars.push_back(avatarp);
+	}
+	std::cout << "Created " << count << " avatars in "
+			  << llformat("%.3fms", bench_elapsed(start) * 1000.0)
+			  << std::endl;
+
+	// Each avatar plays 'motions' consecutive animations of the list, with
+	// start offsets spreading their phases, like in a crowd. The first
+	// avatars also load the animations files.
+	start = LLTimer::getTotalSeconds();
+	LLBenchAllocs allocs;
+	U32 playing = 0;
+	for (U32 i = 0; i < count; ++i)
+	{
+		LLBenchAvatar* avatarp = avatars[i];
+		for (U32 j = 0; j < motions; ++j)
+		{
+			const LLUUID& id =
+				*sAnimations[(i + j) % LL_ARRAY_SIZE(sAnimations)];
+			if (avatarp->startMotion(id, 0.1f * (F32)(i % 10)))
+			{
+				++playing;
+			}
+		}
+		avatarp->updateMotions(LLCharacter::FORCE_UPDATE);
+	}
+	std::cout << "Started " << playing << " motions in "
+			  << llformat("%.3fms", bench_elapsed(start) * 1000.0)
+			  << "\n    " << allocs.delta() << std::endl;
+	if (!playing)
+	{
+		std::cerr << "No motion could be started: check that the "
+				  << "character/anims sub-directory holds the .lla files."
+				  << std::endl;
+	}
+
+	// Playback: the motions that ended (non-looping ones) get restarted, so
+	// that the number of playing motions stays constant.
+#if LL_FAST_TIMERS_ENABLED
+	LLFastTimer::reset();
+#endif
+	U32 restarts = 0;
+	start = LLTimer::getTotalSeconds();
+	allocs.snapshot();
+	for (U32 f = 0; f < frames; ++f)
+	{
+		LL_TRACY_TIMER(TRC_BENCH_KEYFRAME_FRAME);
+		bench_step_frame();
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLBenchAvatar* avatarp = avatars[i];
+			for (U32 j = 0; j < motions; ++j)
+			{
+				const LLUUID& id =
+					*sAnimations[(i + j) % LL_ARRAY_SIZE(sAnimations)];
+				if (!avatarp->isMotionActive(id) && avatarp->startMotion(id))
+				{
+					++restarts;
+				}
+			}
+			avatarp->updateMotions(LLCharacter::FORCE_UPDATE);
+		}
+	}
+	F64 elapsed = bench_elapsed(start);
+	std::cout << llformat("Played %u frames in %.3fms: %.3fms per frame, %.3fus per avatar and frame, %u restarts.",
+						  frames, elapsed * 1000.0, elapsed * 1000.0 / frames,
+						  elapsed * 1000000.0 / (F64)(frames * count),
+						  restarts)
+			  << "\n    per frame: " << allocs.delta(frames) << std::endl;
+#if LL_FAST_TIMERS_ENABLED
+	static const LLBenchTimer timers[] =
+	{
+		{ LLFastTimer::FTM_UPDATE_ANIMATION,	"Animation" },
+		{ LLFastTimer::FTM_UPDATE_MOTIONS,		"Motions" },
+		{ LLFastTimer::FTM_MOTION_ON_UPDATE,	"On Update" },
+	};
+	bench_print_timers(timers, LL_ARRAY_SIZE(timers), frames);
+#endif
+
+	for (U32 i = 0; i < count; ++i)
+	{
+		delete avatars[i];
+	}
+	avatars.clear();
+	LLBenchAvatar::cleanupClass();
+
+	return 0;
+}
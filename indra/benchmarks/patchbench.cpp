@@ -0,0 +1,157 @@
+/**
+ * @file patchbench.cpp
+ * @brief Terrain patch decompressor check and benchmark
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+
+#include "llpatch_dct.h"
+
+#include "viewerbench.h"
+
+// Small xorshift generator, so that the patches are the same on each run.
+static U32 bench_rand(U32& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// Fills 'cpatch' and 'ph' with plausible quantized DCT coefficients and
+// header for a 'size' x 'size' patch: coefficients, stored in zig-zag order,
+// shrink with their frequency and the highest frequencies are zero.
+static void make_patch(U32& state, S32 size, S32* cpatch, LLPatchHeader* ph)
+{
+	S32 surface = size * size;
+	S32 used = surface / 4 + bench_rand(state) % (surface / 2);
+	for (S32 i = 0; i < surface; ++i)
+	{
+		if (i >= used)
+		{
+			cpatch[i] = 0;
+			continue;
+		}
+		S32 max_value = 2048 / (i + 1) + 1;
+		cpatch[i] = (S32)(bench_rand(state) % (2 * max_value + 1)) -
+					max_value;
+	}
+	ph->dc_offset = (F32)(bench_rand(state) % 4096) * 0.05f - 20.f;
+	ph->range = 1 + bench_rand(state) % 512;
+	// Upper 4 bits: quantization - 2, lower 4 bits: word bits - 2.
+	ph->quant_wbits = ((bench_rand(state) % 4) << 4) | 0x0D;
+	ph->patchids = 0;
+}
+
+// Checks that LLPatchDecompressor::decompress() gives bit-exact results
+// against the former scalar decoder, then times both.
+static bool check_patch_size(S32 size, U32 patches)
+{
+	LLPatchDecompressor decompressor(size);
+	S32 surface = size * size;
+	std::vector<S32> cpatches(patches * surface);
+	std::vector<LLPatchHeader> headers(patches);
+	U32 state = 0x2545F491 + size;
+	for (U32 i = 0; i < patches; ++i)
+	{
+		make_patch(state, size, cpatches.data() + i * surface, &headers[i]);
+	}
+
+	std::vector<F32> results(patches * surface);
+	std::vector<F32> references(patches * surface);
+
+	F64 start = LLTimer::getTotalSeconds();
+	for (U32 i = 0; i < patches; ++i)
+	{
+		decompressor.decompress(results.data() + i * surface, size,
+								cpatches.data() + i * surface, &headers[i]);
+	}
+	F64 elapsed = bench_elapsed(start);
+
+	start = LLTimer::getTotalSeconds();
+	for (U32 i = 0; i < patches; ++i)
+	{
+		decompressor.decompressReference(references.data() + i * surface,
+										 size, cpatches.data() + i * surface,
+										 &headers[i]);
+	}
+	F64 ref_elapsed = bench_elapsed(start);
+
+	U32 mismatches = 0;
+	F32 max_diff = 0.f;
+	for (U32 i = 0, count = results.size(); i < count; ++i)
+	{
+		// Compare the bits, not the values, so that we also catch signed
+		// zeroes and NaNs differences.
+		if (memcmp(&results[i], &references[i], sizeof(F32)))
+		{
+			++mismatches;
+			max_diff = llmax(max_diff, fabsf(results[i] - references[i]));
+		}
+	}
+
+	std::cout << llformat("%dx%d patches: %u decoded in %.3fms (%.2fus per patch), reference decoder: %.3fms (%.2fus per patch), x%.2f",
+						  size, size, patches, elapsed * 1000.0,
+						  elapsed * 1000000.0 / patches, ref_elapsed * 1000.0,
+						  ref_elapsed * 1000000.0 / patches,
+						  elapsed > 0.0 ? ref_elapsed / elapsed : 0.0)
+			  << std::endl;
+	if (mismatches)
+	{
+		std::cerr << llformat("%dx%d patches: %u heights differ from the reference decoder (max difference: %g) !",
+							  size, size, mismatches, max_diff)
+				  << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int patch_benchmark(const std::vector<std::string>& args)
+{
+	// Options: -n <patches>
+	U32 values[] = { 10000 };
+	if (!parse_bench_options(args, "n", values))
+	{
+		std::cerr << "Options for the patch benchmark:\n"
+				  << "  -n <count>    Number of random patches decoded for each patch\n"
+				  << "                size (default: 10000).\n"
+				  << "Exits with an error when the decoded heights are not bit-exact\n"
+				  << "against the reference (former scalar) decoder.\n"
+				  << std::endl;
+		return 1;
+	}
+	U32 patches = llmax(1U, values[0]);
+
+	bool success = check_patch_size(NORMAL_PATCH_SIZE, patches);
+	success &= check_patch_size(LARGE_PATCH_SIZE, patches);
+	return success ? 0 : 1;
+}
@@ -0,0 +1,593 @@
+/**
+ * @file stringtablebench.cpp
+ * @brief LLStringTable benchmark
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "lldiriterator.h"
+#include "llfile.h"
+#include "llmessage.h"
+#include "llstringtable.h"
+
+#include "viewerbench.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Copies of the string tables as they were before they got made thread-safe,
+// so that the new implementations get benchmarked against the code they
+// replaced.
+///////////////////////////////////////////////////////////////////////////////
+
+class LLOldStringTableEntry
+{
+public:
+	LLOldStringTableEntry(const char* str)
+	:	mCount(1)
+	{
+		U32 length = llmin((U32)strlen(str) + 1, MAX_STRINGS_LENGTH);
+		mString = new char[length];
+		strncpy(mString, str, length);
+		mString[length - 1] = 0;
+	}
+
+	~LLOldStringTableEntry()
+	{
+		delete[] mString;
+	}
+
+public:
+	char*	mString;
+	S32		mCount;
+};
+
+class LLOldStringTable
+{
+public:
+	LLOldStringTable(U32 tablesize)
+	:	mMaxEntries(tablesize),	// Must be a power of 2
+		mUniqueEntries(0)
+	{
+		mStringList = new string_list_ptr_t[mMaxEntries];
+		for (U32 i = 0; i < mMaxEntries; ++i)
+		{
+			mStringList[i] = NULL;
+		}
+	}
+
+	~LLOldStringTable()
+	{
+		for (U32 i = 0; i < mMaxEntries; ++i)
+		{
+			if (mStringList[i])
+			{
+				for (string_list_t::iterator iter = mStringList[i]->begin(),
+											 end = mStringList[i]->end();
+					 iter != end; ++iter)
+				{
+					delete *iter;
+				}
+				delete mStringList[i];
+			}
+		}
+		delete[] mStringList;
+	}
+
+	LLOldStringTableEntry* checkStringEntry(const char* str)
+	{
+		string_list_t* strlist = mStringList[make_hash(str)];
+		if (strlist)
+		{
+			for (string_list_t::iterator iter = strlist->begin(),
+										 end = strlist->end();
+				 iter != end; ++iter)
+			{
+				LLOldStringTableEntry* entry = *iter;
+				if (!strncmp(entry->mString, str, MAX_STRINGS_LENGTH))
+				{
+					return entry;
+				}
+			}
+		}
+		return NULL;
+	}
+
+	LLOldStringTableEntry* addStringEntry(const char* str)
+	{
+		U32 hash_value = make_hash(str);
+		string_list_t* strlist = mStringList[hash_value];
+		if (strlist)
+		{
+			for (string_list_t::iterator iter = strlist->begin(),
+										 end = strlist->end();
+				 iter != end; ++iter)
+			{
+				LLOldStringTableEntry* entry = *iter;
+				if (!strncmp(entry->mString, str, MAX_STRINGS_LENGTH))
+				{
+					++entry->mCount;
+					return entry;
+				}
+			}
+		}
+		else
+		{
+			strlist = new string_list_t;
+			mStringList[hash_value] = strlist;
+		}
+		++mUniqueEntries;
+		LLOldStringTableEntry* newentry = new LLOldStringTableEntry(str);
+		strlist->push_front(newentry);
+		return newentry;
+	}
+
+private:
+	LL_INLINE U32 make_hash(const char* str)
+	{
+		U32 retval = *str ? digest64to32(HBXXH64::digest(str)) : 0;
+		return retval & (mMaxEntries - 1);
+	}
+
+private:
+	U32					mMaxEntries;
+	U32					mUniqueEntries;
+
+	typedef std::list<LLOldStringTableEntry*> string_list_t;
+	typedef string_list_t* string_list_ptr_t;
+	string_list_ptr_t*	mStringList;
+};
+
+class LLOldMessageStringTable
+{
+public:
+	LLOldMessageStringTable()
+	:	mUsed(0)
+	{
+		for (U32 i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; ++i)
+		{
+			mEmpty[i] = true;
+			mString[i][0] = 0;
+		}
+	}
+
+	char* getString(const char* str)
+	{
+		U32 hash_value = make_hash(str);
+		while (!mEmpty[hash_value])
+		{
+			if (!strncmp(str, mString[hash_value], MESSAGE_MAX_STRINGS_LENGTH))
+			{
+				return mString[hash_value];
+			}
+			++hash_value;
+			hash_value %= MESSAGE_NUMBER_OF_HASH_BUCKETS;
+		}
+		strncpy(mString[hash_value], str, MESSAGE_MAX_STRINGS_LENGTH);
+		mString[hash_value][MESSAGE_MAX_STRINGS_LENGTH - 1] = 0;
+		mEmpty[hash_value] = false;
+		++mUsed;
+		return mString[hash_value];
+	}
+
+private:
+	LL_INLINE static U32 make_hash(const char* str)
+	{
+		U32 retval = 0;
+		while (*str++)
+		{
+			retval += *str;
+			retval <<= 1;
+		}
+		return retval % MESSAGE_NUMBER_OF_HASH_BUCKETS;
+	}
+
+private:
+	U32	 mUsed;
+	bool mEmpty[MESSAGE_NUMBER_OF_HASH_BUCKETS];
+	char mString[MESSAGE_NUMBER_OF_HASH_BUCKETS][MESSAGE_MAX_STRINGS_LENGTH];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Workloads
+///////////////////////////////////////////////////////////////////////////////
+
+// Fallback names, when the workload files cannot be found.
+static std::vector<std::string> make_names(U32 count, const char* prefix)
+{
+	std::vector<std::string> names;
+	names.reserve(count);
+	for (U32 i = 0; i < count; ++i)
+	{
+		names.emplace_back(llformat("%s_%u_name", prefix, i));
+	}
+	return names;
+}
+
+// Message template workload: the names of the messages, blocks and variables
+// of the message template, in file order, like the message system interns
+// them while building and decoding messages.
+static bool load_message_names(std::vector<std::string>& names)
+{
+	llifstream file("app_settings/message_template.msg");
+	if (!file.is_open())
+	{
+		return false;
+	}
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t pos = line.find("//");
+		if (pos != std::string::npos)
+		{
+			line.erase(pos);
+		}
+		for (size_t i = 0, len = line.size(); i < len; )
+		{
+			size_t j = i;
+			while (j < len && (isalnum((U8)line[j]) || line[j] == '_'))
+			{
+				++j;
+			}
+			if (j == i)
+			{
+				++i;
+				continue;
+			}
+			// Skip the numbers (message numbers, sizes, versions)
+			if (!isdigit((U8)line[i]))
+			{
+				names.emplace_back(line, i, j - i);
+			}
+			i = j;
+		}
+	}
+	return !names.empty();
+}
+
+LL_INLINE static bool is_xml_name_char(char c)
+{
+	return isalnum((U8)c) || c == '_' || c == '-' || c == '.' || c == ':';
+}
+
+// XUI workload: the element and attribute names of the XUI files, in file
+// order, like LLXMLNode interns them while parsing floaters and panels.
+static bool load_xui_names(std::vector<std::string>& names)
+{
+	const std::string dir = "skins/default/xui/en-us/";
+	LLDirIterator iter(dir, "*.xml");
+	std::string filename, line;
+	while (iter.next(filename))
+	{
+		llifstream file(dir + filename);
+		while (file.is_open() && std::getline(file, line))
+		{
+			for (size_t i = 0, len = line.size(); i < len; ++i)
+			{
+				char c = line[i];
+				if (c == '<' && i + 1 < len && isalpha((U8)line[i + 1]))
+				{
+					// Element name
+					size_t j = i + 1;
+					while (j < len && is_xml_name_char(line[j]))
+					{
+						++j;
+					}
+					names.emplace_back(line, i + 1, j - i - 1);
+					i = j - 1;
+				}
+				else if (c == '=' && i && is_xml_name_char(line[i - 1]))
+				{
+					// Attribute name
+					size_t j = i;
+					while (j && is_xml_name_char(line[j - 1]))
+					{
+						--j;
+					}
+					names.emplace_back(line, j, i - j);
+				}
+			}
+		}
+	}
+	return !names.empty();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Workload operations on each kind of table: LLXMLNode adds a reference to
+// each name and looks names up, the message system just interns them. The
+// old tables are not thread-safe, so they need a mutex when used from several
+// threads.
+///////////////////////////////////////////////////////////////////////////////
+
+struct NewStringTableOps
+{
+	static constexpr U32 OPS_PER_NAME = 2;
+
+	LL_INLINE void operator()(const std::string& name)
+	{
+		mTablep->addStringEntry(name);
+		mTablep->checkStringEntry(name);
+	}
+
+	LLStringTable*	mTablep;
+};
+
+struct OldStringTableOps
+{
+	static constexpr U32 OPS_PER_NAME = 2;
+
+	LL_INLINE void operator()(const std::string& name)
+	{
+		if (mMutexp)
+		{
+			std::lock_guard<std::mutex> lock(*mMutexp);
+			mTablep->addStringEntry(name.c_str());
+			mTablep->checkStringEntry(name.c_str());
+		}
+		else
+		{
+			mTablep->addStringEntry(name.c_str());
+			mTablep->checkStringEntry(name.c_str());
+		}
+	}
+
+	LLOldStringTable*	mTablep;
+	std::mutex*			mMutexp;
+};
+
+struct NewMessageTableOps
+{
+	static constexpr U32 OPS_PER_NAME = 1;
+
+	LL_INLINE void operator()(const std::string& name)
+	{
+		mTablep->getString(name.c_str());
+	}
+
+	LLMessageStringTable*	mTablep;
+};
+
+struct OldMessageTableOps
+{
+	static constexpr U32 OPS_PER_NAME = 1;
+
+	LL_INLINE void operator()(const std::string& name)
+	{
+		if (mMutexp)
+		{
+			std::lock_guard<std::mutex> lock(*mMutexp);
+			mTablep->getString(name.c_str());
+		}
+		else
+		{
+			mTablep->getString(name.c_str());
+		}
+	}
+
+	LLOldMessageStringTable*	mTablep;
+	std::mutex*					mMutexp;
+};
+
+// Each thread runs the operations on all the names 'passes' times, starting
+// at a different offset in the names list. Returns the operations per second.
+template<class T>
+static F64 run_threads(T ops, const std::vector<std::string>& names,
+					   U32 threads, U32 passes)
+{
+	F64 start = LLTimer::getTotalSeconds();
+	std::vector<std::thread> workers;
+	for (U32 t = 0; t < threads; ++t)
+	{
+		workers.emplace_back([ops, &names, passes, t]() mutable
+							 {
+								U32 count = names.size();
+								U32 offset = (t * 997) % count;
+								for (U32 p = 0; p < passes; ++p)
+								{
+									for (U32 i = 0; i < count; ++i)
+									{
+										ops(names[(i + offset) % count]);
+									}
+								}
+							 });
+	}
+	for (U32 t = 0; t < threads; ++t)
+	{
+		workers[t].join();
+	}
+	F64 elapsed = bench_elapsed(start);
+	F64 ops_count = (F64)threads * passes * names.size() * T::OPS_PER_NAME;
+	return elapsed > 0.0 ? ops_count / elapsed : 0.0;
+}
+
+static void print_result(U32 threads, const char* name, F64 new_ops,
+						 F64 old_ops, bool locked)
+{
+	std::cout << llformat("  %2u thread(s), %-20s new %8.2f Mops/s, old%s %8.2f Mops/s (x%.2f)",
+						  threads, name, new_ops * 1e-6,
+						  locked ? " (mutex-locked)" : "", old_ops * 1e-6,
+						  old_ops > 0.0 ? new_ops / old_ops : 0.0)
+			  << std::endl;
+}
+
+int stringtable_benchmark(const std::vector<std::string>& args)
+{
+	// Options: -n <names> -p <passes> -t <max threads> -o <saturation names>
+	U32 values[] = { 4096, 50, llmax(1U, std::thread::hardware_concurrency()),
+					 20000 };
+	if (!parse_bench_options(args, "npto", values))
+	{
+		std::cerr << "Options for the stringtable benchmark:\n"
+				  << "  -n <count>    Number of synthetic XUI names, used when the\n"
+				  << "                XUI files cannot be found (default: 4096).\n"
+				  << "  -p <count>    Passes over all the names (default: 50).\n"
+				  << "  -t <count>    Maximum number of threads (default: number of\n"
+				  << "                CPU cores).\n"
+				  << "  -o <count>    Names concurrently added by all the threads to a\n"
+				  << "                256 entries table (default: 20000).\n"
+				  << "The message template and XUI workloads are read from the\n"
+				  << "app_settings/message_template.msg and skins/default/xui/en-us/\n"
+				  << "files of the current directory (e.g. indra/newview/), when found.\n"
+				  << std::endl;
+		return 1;
+	}
+	U32 count = llmax(1U, values[0]);
+	U32 passes = llmax(1U, values[1]);
+	U32 max_threads = llmax(1U, values[2]);
+	U32 saturation = values[3];
+
+	std::vector<std::string> msg_names;
+	if (!load_message_names(msg_names))
+	{
+		std::cout << "Message template not found: using synthetic names."
+				  << std::endl;
+		// Must stay well below MESSAGE_NUMBER_OF_HASH_BUCKETS
+		msg_names = make_names(2048, "Message");
+	}
+	std::vector<std::string> xui_names;
+	if (!load_xui_names(xui_names))
+	{
+		std::cout << "XUI files not found: using synthetic names."
+				  << std::endl;
+		xui_names = make_names(count, "node");
+	}
+	std::cout << "Message template workload: " << msg_names.size()
+			  << " names - XUI workload: " << xui_names.size() << " names."
+			  << std::endl;
+
+	// The tables persist across runs, like the viewer global tables: only
+	// the first run adds the names, the next ones find them.
+	LLStringTable new_table(32768);
+	LLOldStringTable old_table(32768);
+	std::unique_ptr<LLMessageStringTable> new_msg_table(new LLMessageStringTable);
+	std::unique_ptr<LLOldMessageStringTable> old_msg_table(new LLOldMessageStringTable);
+	std::mutex old_mutex;
+
+	// Single-threaded: the new tables against the old ones, as they were.
+	F64 new_ops = run_threads(NewMessageTableOps{ new_msg_table.get() },
+							  msg_names, 1, passes);
+	F64 old_ops = run_threads(OldMessageTableOps{ old_msg_table.get(), NULL },
+							  msg_names, 1, passes);
+	print_result(1, "message template:", new_ops, old_ops, false);
+	new_ops = run_threads(NewStringTableOps{ &new_table }, xui_names, 1,
+						  passes);
+	old_ops = run_threads(OldStringTableOps{ &old_table, NULL }, xui_names, 1,
+						  passes);
+	print_result(1, "XUI:", new_ops, old_ops, false);
+
+	// Concurrent use, with an increasing number of threads: the old tables
+	// must then be protected with a mutex.
+	U32 threads = 1;
+	while (true)
+	{
+		new_ops = run_threads(NewMessageTableOps{ new_msg_table.get() },
+							  msg_names, threads, passes);
+		old_ops = run_threads(OldMessageTableOps{ old_msg_table.get(),
+												  &old_mutex },
+							  msg_names, threads, passes);
+		print_result(threads, "message template:", new_ops, old_ops, true);
+		new_ops = run_threads(NewStringTableOps{ &new_table }, xui_names,
+							  threads, passes);
+		old_ops = run_threads(OldStringTableOps{ &old_table, &old_mutex },
+							  xui_names, threads, passes);
+		print_result(threads, "XUI:", new_ops, old_ops, true);
+		if (threads >= max_threads)
+		{
+			break;
+		}
+		// Double the number of threads, making sure we also run with the
+		// maximum number of threads.
+		threads = llmin(threads * 2, max_threads);
+	}
+
+	// Saturation: several threads concurrently add the same names to a 256
+	// entries table, so that most of them end up in the overflow map. Each
+	// name must still get a single entry, whichever thread added it and
+	// wherever it got stored.
+	if (saturation)
+	{
+		std::vector<std::string> sat_names = make_names(saturation, "sat");
+		LLStringTable small_table(256);
+		std::vector<std::vector<LLStringTableEntry*> > added(max_threads);
+		F64 start = LLTimer::getTotalSeconds();
+		std::vector<std::thread> workers;
+		for (U32 t = 0; t < max_threads; ++t)
+		{
+			added[t].resize(saturation);
+			workers.emplace_back([&small_table, &sat_names, &added, t]()
+								 {
+									std::vector<LLStringTableEntry*>& entries =
+										added[t];
+									for (U32 i = 0, count = sat_names.size();
+										 i < count; ++i)
+									{
+										entries[i] =
+											small_table.addStringEntry(sat_names[i]);
+									}
+								 });
+		}
+		for (U32 t = 0; t < max_threads; ++t)
+		{
+			workers[t].join();
+		}
+		F64 elapsed = bench_elapsed(start);
+		U32 mismatches = 0;
+		for (U32 i = 0; i < saturation; ++i)
+		{
+			LLStringTableEntry* entry =
+				small_table.checkStringEntry(sat_names[i]);
+			for (U32 t = 0; t < max_threads; ++t)
+			{
+				if (added[t][i] != entry)
+				{
+					++mismatches;
+				}
+			}
+		}
+		std::cout << max_threads << " thread(s) added the same " << saturation
+				  << " names to a 256 entries table in "
+				  << llformat("%.3fms", elapsed * 1000.0) << ": "
+				  << small_table.getOverflowEntries()
+				  << " overflow entries, " << mismatches
+				  << " duplicated entries." << std::endl;
+		if (mismatches)
+		{
+			std::cerr << "Interned strings got several entries !"
+					  << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file viewerbench.cpp
+ * @brief Headless benchmarks for the viewer libraries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+// This tool runs reproducible benchmarks of the viewer libraries, outside of
+// the viewer (no window, no login, no region). Each benchmark is a named
+// command, with its own options; run "viewerbench" without argument for the
+// list of benchmarks.
+
+#include "linden_common.h"
+
+#include <iostream>
+
+#include "llapp.h"
+#include "llerrorcontrol.h"
+#include "llmemory.h"
+#include "lltimer.h"
+
+#include "viewerbench.h"
+
+// Minimal application class: the libraries frame timers (LLFrameTimer) can
+// only be stepped by LLApp. We do not run any error thread.
+class LLViewerBenchApp final : public LLApp
+{
+public:
+	LL_INLINE LLViewerBenchApp()
+	:	LLApp(NULL)
+	{
+	}
+
+	LL_INLINE InitState init() override				{ return INIT_OK; }
+	LL_INLINE bool cleanup() override				{ return true; }
+	LL_INLINE bool mainLoop() override				{ return true; }
+
+	LL_INLINE void step()							{ stepFrame(); }
+};
+
+static LLViewerBenchApp* sBenchAppp = NULL;
+
+struct BenchmarkCommand
+{
+	const char*		mName;
+	const char*		mDescription;
+	bench_func_t	mFunction;
+};
+
+static const BenchmarkCommand sCommands[] =
+{
+	{ "avatar",
+	  "Region-less avatars loading, wearables, visual params and motions",
+	  avatar_benchmark },
+	{ "keyframe",
+	  "Keyframe motions playback on a crowd of region-less avatars",
+	  keyframe_benchmark },
+	{ "patch",
+	  "Terrain patch decompressor, checked against the reference decoder",
+	  patch_benchmark },
+	{ "stringtable",
+	  "Old vs new string tables, on message template and XUI workloads",
+	  stringtable_benchmark },
+};
+
+bool parse_bench_options(const std::vector<std::string>& args,
+						 const char* options, U32* values)
+{
+	for (size_t i = 0, count = args.size(); i < count; ++i)
+	{
+		const std::string& arg = args[i];
+		if (arg.size() != 2 || arg[0] != '-' || i + 1 >= count)
+		{
+			return false;
+		}
+		const char* option = strchr(options, arg[1]);
+		if (!option)
+		{
+			return false;
+		}
+		values[option - options] = (U32)atoi(args[++i].c_str());
+	}
+	return true;
+}
+
+void bench_step_frame()
+{
+	if (sBenchAppp)
+	{
+		sBenchAppp->step();
+	}
+}
+
+void LLBenchAllocs::snapshot()
+{
+	mCustomAllocs = mCustomBytes = 0;
+	for (U32 i = 0; i < LL_ALLOC_NUM_TAGS; ++i)
+	{
+		U64 frame_count, frame_bytes, total_count, total_bytes;
+		LLMemory::getAllocStats(i, frame_count, frame_bytes, total_count,
+								total_bytes);
+		mCustomAllocs += total_count;
+		mCustomBytes += total_bytes;
+	}
+	mRSS = LLMemory::getCurrentRSS();
+}
+
+std::string LLBenchAllocs::delta(U32 divisor) const
+{
+	LLBenchAllocs now;
+	if (!divisor)
+	{
+		divisor = 1;
+	}
+	F64 kb = 1024.0 * (F64)divisor;
+	return llformat("%llu custom allocs (%.1f KB), RSS %+.1f MB",
+					(now.mCustomAllocs - mCustomAllocs) / divisor,
+					(F64)(now.mCustomBytes - mCustomBytes) / kb,
+					((F64)now.mRSS - (F64)mRSS) / 1048576.0);
+}
+
+#if LL_FAST_TIMERS_ENABLED
+void bench_print_timers(const LLBenchTimer* timers, U32 count, U32 frames)
+{
+	if (!frames)
+	{
+		frames = 1;
+	}
+	F64 ms_per_count = 1000.0 / (F64)LLFastTimer::countsPerSecond() /
+					   (F64)frames;
+	std::cout << "Per frame timers (exclusive times):\n";
+	for (U32 i = 0; i < count; ++i)
+	{
+		LLFastTimer::EFastTimerType type = timers[i].mType;
+		std::cout << llformat("  %-24s %9.3f ms %8llu calls %8llu custom allocs (%.1f KB)\n",
+							  timers[i].mName,
+							  (F64)LLFastTimer::sCounter[type] * ms_per_count,
+							  LLFastTimer::sCalls[type] / frames,
+							  LLFastTimer::sAllocs[type] / frames,
+							  (F64)LLFastTimer::sAllocBytes[type] / 1024.0 /
+							  (F64)frames);
+	}
+	std::cout.flush();
+}
+#endif
+
+static void usage()
+{
+	std::cerr << "Usage: viewerbench [-v] <benchmark> [options]\n"
+			  << "  -v  Verbose: print the libraries info messages.\n"
+			  << "Benchmarks:\n";
+	for (U32 i = 0; i < LL_ARRAY_SIZE(sCommands); ++i)
+	{
+		std::cerr << llformat("  %-14s", sCommands[i].mName)
+				  << sCommands[i].mDescription << "\n";
+	}
+	std::cerr << "Run \"viewerbench <benchmark> -h\" for the options of a "
+			  << "benchmark." << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	// Initializes APR and the timers, and cleans them up on exit.
+	LLViewerBenchApp app;
+	sBenchAppp = &app;
+
+	// Count the custom allocators allocations for the benchmarks reports.
+	LLMemory::setAllocProfiling(true);
+
+	// Set up llerror logging: warnings and errors only go to stderr, unless
+	// in verbose mode.
+	LLError::initForApplication(".");
+	LLError::setDefaultLevel(LLError::LEVEL_WARN);
+
+	S32 i = 1;
+	if (i < argc && !strcmp(argv[i], "-v"))
+	{
+		LLError::setDefaultLevel(LLError::LEVEL_INFO);
+		++i;
+	}
+	if (i >= argc)
+	{
+		usage();
+		return 1;
+	}
+
+	const BenchmarkCommand* commandp = NULL;
+	for (U32 j = 0; j < LL_ARRAY_SIZE(sCommands); ++j)
+	{
+		if (!strcmp(argv[i], sCommands[j].mName))
+		{
+			commandp = &sCommands[j];
+			break;
+		}
+	}
+	if (!commandp)
+	{
+		usage();
+		return 1;
+	}
+
+	std::vector<std::string> args;
+	for (++i; i < argc; ++i)
+	{
+		args.emplace_back(argv[i]);
+	}
+	int result = commandp->mFunction(args);
+
+	sBenchAppp = NULL;
+
+	return result;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file viewerbench.h
+ * @brief Headless benchmarks for the viewer libraries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_VIEWERBENCH_H
+#define LL_VIEWERBENCH_H
+
+#include <string>
+#include <vector>
+
+#include "llfasttimer.h"
+#include "lltimer.h"
+
+// Each benchmark gets the command line arguments following its name, and
+// returns the process exit code.
+typedef int (*bench_func_t)(const std::vector<std::string>& args);
+
+int avatar_benchmark(const std::vector<std::string>& args);
+int keyframe_benchmark(const std::vector<std::string>& args);
+int patch_benchmark(const std::vector<std::string>& args);
+int stringtable_benchmark(const std::vector<std::string>& args);
+
+// Helper to parse "-x <value>" options; returns false on unknown options or
+// missing values. 'options' lists the accepted option letters, and 'values'
+// receives the corresponding values (which keep their defaults when the
+// option is not given).
+bool parse_bench_options(const std::vector<std::string>& args,
+						 const char* options, U32* values);
+
+// Returns the elapsed time in seconds since 'start' (as returned by
+// LLTimer::getTotalSeconds()).
+LL_INLINE F64 bench_elapsed(F64 start)
+{
+	return LLTimer::getTotalSeconds() - start;
+}
+
+// Advances the frame time seen by the libraries (LLFrameTimer), like the
+// viewer does at the start of each frame.
+void bench_step_frame();
+
+// Snapshot of the allocation counters: the viewer custom allocators ones
+// (LLMemory allocations profiler: aligned, image and volume memory) and the
+// process resident set size (which accounts for all the other allocations).
+class LLBenchAllocs
+{
+public:
+	LL_INLINE LLBenchAllocs()						{ snapshot(); }
+
+	void snapshot();
+
+	// Returns a printable summary of the allocations done since the last
+	// snapshot, with the counts and sizes divided by 'divisor' (e.g. the
+	// number of frames or of avatars).
+	std::string delta(U32 divisor = 1) const;
+
+private:
+	U64	mCustomAllocs;
+	U64	mCustomBytes;
+	U64	mRSS;
+};
+
+#if LL_FAST_TIMERS_ENABLED
+struct LLBenchTimer
+{
+	LLFastTimer::EFastTimerType	mType;
+	const char*					mName;
+};
+
+// Prints the time (exclusive of the children timers), calls and custom
+// allocations accounted against each of the 'count' timers since the last
+// LLFastTimer::reset(), divided by 'frames'.
+void bench_print_timers(const LLBenchTimer* timers, U32 count, U32 frames);
+#endif
+
+#endif	// LL_VIEWERBENCH_H
@@ -67,10 +67,29 @@ set(TRACY_MEMORY ON)
 # resulting binary is then slightly slower, of course.
 set(TRACY_WITH_FAST_TIMERS OFF)
 
+# Set to ON to record the fast timers and Tracy zones of all threads into
+# per-thread ring buffers, which can be dumped on demand (or on frame time
+# spikes) into a Chrome trace JSON file, without needing a Tracy server. This
+# results in a slightly slower viewer, even when the capture is not enabled
+# at run time.
+set(USE_TRACE_CAPTURE OFF)
+
 # Set to ON to enable Animesh visual params support (Muscadine project).
 # Experimental and only supported in the Animesh* sims on the SL Aditi grid.
 set(ENABLE_ANIMESH_VISUAL_PARAMS OFF)
 
+# Set to ON to also build the "meshconverter" command line tool, which loads
+# COLLADA and glTF models, generates their LODs and writes the corresponding
+# mesh assets, for batch pre-validation and costing of models, without the
+# viewer. It is also usable as a benchmark for the model loaders and the
+# meshoptimizer based LOD generator.
+set(BUILD_MESH_CONVERTER OFF)
+
+# Set to ON to also build the "viewerbench" command line tool, which runs
+# reproducible benchmarks of the viewer libraries (string tables, keyframe
+# motions, avatar appearance...) without any window, login or region.
+set(BUILD_BENCHMARKS OFF)
+
 # Set to OFF to do away with the netapi32 DLL (Netbios) dependency in Windows
 # builds; sadly, this causes the MAC address to change, invalidating all saved
 # login passwords...
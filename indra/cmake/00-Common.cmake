@@ -416,6 +416,10 @@ if (USE_TRACY)
   endif (TRACY_WITH_FAST_TIMERS)
 endif (USE_TRACY)
 
+if (USE_TRACE_CAPTURE)
+  add_definitions(-DLL_TRACE_CAPTURE=1)
+endif (USE_TRACE_CAPTURE)
+
 if (WINDOWS AND USE_NETBIOS)
   add_definitions(-DLL_NETBIOS=1)
 endif (WINDOWS AND USE_NETBIOS)
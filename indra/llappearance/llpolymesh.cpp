@@ -36,6 +36,7 @@
 #include "lldir.h"
 #include "llendianswizzle.h"
 #include "llfasttimer.h"
+#include "hbxxh.h"
 #include "llvolume.h"
 #include "llwearable.h"
 #include "llxmltree.h"
@@ -56,6 +57,12 @@ LLPolyMorphData* clone_morph_param_cleavage(const LLPolyMorphData* src_data,
 // Global table of loaded LLPolyMeshes
 //-----------------------------------------------------------------------------
 LLPolyMesh::LLPolyMeshSharedDataTable LLPolyMesh::sGlobalSharedMeshList;
+std::vector<LLPolyMesh*> LLPolyMesh::sBatchedMeshes;
+S32 LLPolyMesh::sMorphsBatchDepth = 0;
+LLPolyMesh::morphs_cache_t LLPolyMesh::sMorphsCache;
+LLPolyMesh::morphs_cache_lru_t LLPolyMesh::sMorphsCacheLRU;
+size_t LLPolyMesh::sMorphsCacheBytes = 0;
+size_t LLPolyMesh::sMorphsCacheMaxBytes = 32 * 1024 * 1024;
 
 //-----------------------------------------------------------------------------
 // LLPolyMeshSharedData class
@@ -876,6 +883,9 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData* shared_data,
 	mReferenceMesh = reference_mesh;
 	mAvatarp = NULL;
 	mVertexData = NULL;
+	mVertexDataSize = 0;
+	mMorphTargetsListed = false;
+	mInMorphsBatch = false;
 
 	mCurVertexCount = 0;
 	mFaceIndexCount = 0;
@@ -909,7 +919,8 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData* shared_data,
 								4); //scaled binormals
 
 		// use 16 byte aligned vertex data to make LLPolyMesh SSE friendly
-		mVertexData = (F32*)allocate_volume_mem(nfloats * 4);
+		mVertexDataSize = nfloats * 4;
+		mVertexData = (F32*)allocate_volume_mem(mVertexDataSize);
 		if (!mVertexData)
 		{
 			llwarns << "Failure to allocate vertex data buffer !" << llendl;
@@ -934,6 +945,11 @@ LLPolyMesh::~LLPolyMesh()
 {
 	delete_and_clear(mJointRenderData);
 
+	if (mInMorphsBatch)
+	{
+		vector_replace_with_last(sBatchedMeshes, this);
+	}
+
 	if (mVertexData)
 	{
 		free_volume_mem(mVertexData);
@@ -941,6 +957,240 @@ LLPolyMesh::~LLPolyMesh()
 	}
 }
 
+//static
+void LLPolyMesh::beginMorphsBatch()
+{
+	++sMorphsBatchDepth;
+}
+
+//static
+void LLPolyMesh::endMorphsBatch()
+{
+	if (sMorphsBatchDepth <= 0)
+	{
+		llwarns << "Unbalanced morphs batch end; ignoring." << llendl;
+		llassert(false);
+		return;
+	}
+	if (--sMorphsBatchDepth)
+	{
+		return;	// Not the outermost batch
+	}
+	for (U32 i = 0, count = sBatchedMeshes.size(); i < count; ++i)
+	{
+		sBatchedMeshes[i]->applyPendingMorphs();
+	}
+	sBatchedMeshes.clear();
+}
+
+void LLPolyMesh::addPendingMorph(LLPolyMorphTarget* morph, F32 delta_weight)
+{
+	if (!mInMorphsBatch)
+	{
+		mInMorphsBatch = true;
+		sBatchedMeshes.push_back(this);
+	}
+	mPendingMorphs.emplace_back(morph, delta_weight);
+}
+
+void LLPolyMesh::applyPendingMorphs()
+{
+	mInMorphsBatch = false;
+
+	std::vector<U32> key;
+	U64 hash = getMorphsCacheKey(key);
+	if (hash && restoreFromMorphsCache(hash, key))
+	{
+		mPendingMorphs.clear();
+		return;
+	}
+
+	mDirtyNormalsMask.resize(getNumVertices(), 0);
+	for (U32 i = 0, count = mPendingMorphs.size(); i < count; ++i)
+	{
+		const pending_morph_t& pending = mPendingMorphs[i];
+		pending.first->applyDelta(pending.second, true);
+	}
+	mPendingMorphs.clear();
+	updateDirtyNormals();
+
+	if (hash)
+	{
+		storeInMorphsCache(hash, key);
+	}
+}
+
+void LLPolyMesh::updateDirtyNormals()
+{
+	for (U32 i = 0, count = mDirtyNormals.size(); i < count; ++i)
+	{
+		U32 index = mDirtyNormals[i];
+		mDirtyNormalsMask[index] = 0;
+
+		LLVector4a norm = mScaledNormals[index];
+		norm.normalize3fast();
+		mNormals[index] = norm;
+
+		LLVector4a tangent;
+		tangent.setCross3(mScaledBinormals[index], norm);
+		LLVector4a& binormal = mBinormals[index];
+		binormal.setCross3(norm, tangent);
+		binormal.normalize3fast();
+	}
+	mDirtyNormals.clear();
+}
+
+U64 LLPolyMesh::getMorphsCacheKey(std::vector<U32>& key)
+{
+	if (!sMorphsCacheMaxBytes || !mVertexData || !mAvatarp)
+	{
+		return 0;
+	}
+
+	if (!mMorphTargetsListed)
+	{
+		mMorphTargetsListed = true;
+		for (LLVisualParam* param = mAvatarp->getFirstVisualParam(); param;
+			 param = mAvatarp->getNextVisualParam())
+		{
+			LLPolyMorphTarget* morph = param->asPolyMorphTarget();
+			if (morph && morph->getMesh() == this)
+			{
+				mMorphTargets.push_back(morph);
+			}
+		}
+	}
+
+	// The vertex data is the base mesh data plus the sum of the weighted
+	// deltas of the morphs with a non-zero applied weight, with the clothing
+	// weights also depending on which clothing morphs got applied. Masked
+	// morphs depend on the textures of the avatar and on the order in which
+	// the masks got applied, so their meshes are never cached.
+	for (U32 i = 0, count = mMorphTargets.size(); i < count; ++i)
+	{
+		LLPolyMorphTarget* morph = mMorphTargets[i];
+		if (morph->hasVertexMask())
+		{
+			key.clear();
+			return 0;
+		}
+		F32 weight = morph->getLastWeight();
+		if (weight != 0.f || morph->clothingApplied())
+		{
+			U32 weight_bits;
+			memcpy((void*)&weight_bits, (void*)&weight, sizeof(U32));
+			key.push_back((U32)morph->getID());
+			key.push_back(weight_bits);
+		}
+	}
+
+	HBXXH64 hasher;
+	hasher.update((const void*)&mSharedData, sizeof(LLPolyMeshSharedData*));
+	if (!key.empty())
+	{
+		hasher.update((const void*)key.data(), key.size() * sizeof(U32));
+	}
+	U64 hash = hasher.digest();
+	// 0 means "not cacheable"
+	return hash ? hash : 1;
+}
+
+bool LLPolyMesh::restoreFromMorphsCache(U64 hash, const std::vector<U32>& key)
+{
+	morphs_cache_t::iterator it = sMorphsCache.find(hash);
+	if (it == sMorphsCache.end())
+	{
+		return false;
+	}
+	MorphsCacheEntry& entry = it->second;
+	if (entry.mSharedData != mSharedData || entry.mSize != mVertexDataSize ||
+		entry.mKey != key)
+	{
+		return false;	// Hash collision
+	}
+
+	LLVector4a::memcpyNonAliased16(mVertexData, entry.mData, mVertexDataSize);
+	// Flag as most recently used
+	sMorphsCacheLRU.splice(sMorphsCacheLRU.end(), sMorphsCacheLRU,
+						   entry.mLRUIter);
+	return true;
+}
+
+void LLPolyMesh::storeInMorphsCache(U64 hash, std::vector<U32>& key)
+{
+	if (mVertexDataSize > sMorphsCacheMaxBytes)
+	{
+		return;
+	}
+
+	// Replace any colliding entry and evict the least recently used ones
+	// until the new entry fits.
+	morphs_cache_t::iterator it = sMorphsCache.find(hash);
+	if (it != sMorphsCache.end())
+	{
+		sMorphsCacheBytes -= it->second.mSize;
+		free_volume_mem(it->second.mData);
+		sMorphsCacheLRU.erase(it->second.mLRUIter);
+		sMorphsCache.erase(it);
+	}
+	while (!sMorphsCacheLRU.empty() &&
+		   sMorphsCacheBytes + mVertexDataSize > sMorphsCacheMaxBytes)
+	{
+		it = sMorphsCache.find(sMorphsCacheLRU.front());
+		sMorphsCacheLRU.pop_front();
+		if (it != sMorphsCache.end())
+		{
+			sMorphsCacheBytes -= it->second.mSize;
+			free_volume_mem(it->second.mData);
+			sMorphsCache.erase(it);
+		}
+	}
+
+	F32* data = (F32*)allocate_volume_mem(mVertexDataSize);
+	if (!data)
+	{
+		return;
+	}
+	LLVector4a::memcpyNonAliased16(data, mVertexData, mVertexDataSize);
+
+	MorphsCacheEntry& entry = sMorphsCache[hash];
+	entry.mSharedData = mSharedData;
+	entry.mKey.swap(key);
+	entry.mData = data;
+	entry.mSize = mVertexDataSize;
+	entry.mLRUIter = sMorphsCacheLRU.insert(sMorphsCacheLRU.end(), hash);
+	sMorphsCacheBytes += mVertexDataSize;
+}
+
+//static
+void LLPolyMesh::setMorphsCacheSize(U32 max_mb)
+{
+	size_t max_bytes = (size_t)max_mb * 1024 * 1024;
+	if (max_bytes == sMorphsCacheMaxBytes)
+	{
+		return;
+	}
+	sMorphsCacheMaxBytes = max_bytes;
+	if (sMorphsCacheBytes > max_bytes)
+	{
+		clearMorphsCache();
+	}
+}
+
+//static
+void LLPolyMesh::clearMorphsCache()
+{
+	for (morphs_cache_t::iterator it = sMorphsCache.begin(),
+								  end = sMorphsCache.end();
+		 it != end; ++it)
+	{
+		free_volume_mem(it->second.mData);
+	}
+	sMorphsCache.clear();
+	sMorphsCacheLRU.clear();
+	sMorphsCacheBytes = 0;
+}
+
 LLPolyMesh* LLPolyMesh::getMesh(const std::string& name,
 								LLPolyMesh* reference_mesh)
 {
@@ -989,6 +1239,8 @@ void LLPolyMesh::freeAllMeshes()
 	for_each(sGlobalSharedMeshList.begin(), sGlobalSharedMeshList.end(),
 			 DeletePairedPointer());
 	sGlobalSharedMeshList.clear();
+
+	clearMorphsCache();
 }
 
 void LLPolyMesh::dumpDiagInfo()
@@ -35,6 +35,9 @@
 
 #include "linden_common.h"
 
+#include <list>
+
+#include "hbfastmap.h"
 #include "lljoint.h"
 #include "llpolymorph.h"
 #include "llquaternion.h"
@@ -190,6 +193,38 @@ public:
 	// references to these objects.  Generally, upon exit of the application.
 	static void freeAllMeshes();
 
+	// Morph targets batching: between these calls, the morph targets applied
+	// to any mesh are only queued on it. When the outermost batch ends, each
+	// mesh either restores its resulting vertex data from the morphs cache
+	// (when another mesh of the same type, e.g. of another avatar, already
+	// got deformed with the same morph weights), or applies all its queued
+	// morphs in one pass, recomputing the normals and binormals of the
+	// touched vertices only once, and caches the result.
+	static void beginMorphsBatch();
+	static void endMorphsBatch();
+
+	LL_INLINE static bool inMorphsBatch()				{ return sMorphsBatchDepth > 0; }
+
+	// Queues the application of 'delta_weight' for 'morph' (which must be a
+	// morph target of this mesh) till the end of the current morphs batch.
+	void addPendingMorph(LLPolyMorphTarget* morph, F32 delta_weight);
+
+	// Flags the normal and binormal of vertex 'index' for recomputation once
+	// the pending morphs have been applied.
+	LL_INLINE void flagDirtyNormal(U32 index)
+	{
+		if (!mDirtyNormalsMask[index])
+		{
+			mDirtyNormalsMask[index] = 1;
+			mDirtyNormals.push_back(index);
+		}
+	}
+
+	// Sets the maximum amount of memory used by the morphs cache, in MB; 0
+	// disables the cache.
+	static void setMorphsCacheSize(U32 max_mb);
+	static void clearMorphsCache();
+
 	//--------------------------------------------------------------------
 	// Transform Data Access
 	//--------------------------------------------------------------------
@@ -377,6 +412,20 @@ public:
 private:
 	void initializeForMorph();
 
+	// Applies the morphs queued during the current batch, or restores the
+	// corresponding vertex data from the morphs cache.
+	void applyPendingMorphs();
+
+	// Recomputes the normals and binormals of the flagged vertices.
+	void updateDirtyNormals();
+
+	// Fills 'key' with the (morph Id, weight) pairs fully determining the
+	// current vertex data of this mesh, and returns its hash, or returns 0
+	// when this vertex data cannot be cached (e.g. because of masked morphs).
+	U64 getMorphsCacheKey(std::vector<U32>& key);
+	bool restoreFromMorphsCache(U64 hash, const std::vector<U32>& key);
+	void storeInMorphsCache(U64 hash, std::vector<U32>& key);
+
 	// Dumps diagnostic information about the global mesh table
 	static void dumpDiagInfo();
 
@@ -402,6 +451,46 @@ protected:
 
 	LLPolyMesh*				mReferenceMesh;
 
+	// Size in bytes of mVertexData
+	U32						mVertexDataSize;
+
+	// Morphs (and their delta weight) queued during the current batch.
+	typedef std::pair<LLPolyMorphTarget*, F32> pending_morph_t;
+	std::vector<pending_morph_t> mPendingMorphs;
+
+	// Vertices which normals need to be recomputed once the pending morphs
+	// have been applied, and corresponding flags indexed by vertex number.
+	std::vector<U32>		mDirtyNormals;
+	std::vector<U8>			mDirtyNormalsMask;
+
+	// Morph targets of the avatar affecting this mesh, listed on first need.
+	std::vector<LLPolyMorphTarget*> mMorphTargets;
+	bool					mMorphTargetsListed;
+
+	bool					mInMorphsBatch;
+
+	// Meshes with pending morphs in the current batch.
+	static std::vector<LLPolyMesh*> sBatchedMeshes;
+	static S32				sMorphsBatchDepth;
+
+	// Cache of morphed vertex data, keyed by the hash of the mesh shared data
+	// and of its morphs weights, with the least recently used entries first
+	// in sMorphsCacheLRU.
+	typedef std::list<U64> morphs_cache_lru_t;
+	struct MorphsCacheEntry
+	{
+		LLPolyMeshSharedData*			mSharedData;
+		std::vector<U32>				mKey;
+		F32*							mData;
+		U32								mSize;
+		morphs_cache_lru_t::iterator	mLRUIter;
+	};
+	typedef fast_hmap<U64, MorphsCacheEntry> morphs_cache_t;
+	static morphs_cache_t	sMorphsCache;
+	static morphs_cache_lru_t sMorphsCacheLRU;
+	static size_t			sMorphsCacheBytes;
+	static size_t			sMorphsCacheMaxBytes;
+
 	// global mesh list
 	typedef std::map<std::string, LLPolyMeshSharedData*> LLPolyMeshSharedDataTable;
 	static LLPolyMeshSharedDataTable sGlobalSharedMeshList;
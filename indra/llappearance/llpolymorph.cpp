@@ -385,6 +385,7 @@ LLPolyMorphTarget::LLPolyMorphTarget(LLPolyMesh* poly_mesh)
 	mVertMask(NULL),
 	mLastSex(SEX_FEMALE),
 	mNumMorphMasksPending(0),
+	mClothingApplied(false),
 	mVolumeMorphs()
 {
 }
@@ -396,6 +397,7 @@ LLPolyMorphTarget::LLPolyMorphTarget(const LLPolyMorphTarget& other)
 	mVertMask(other.mVertMask ? new LLPolyVertexMask(*other.mVertMask) : NULL),
 	mLastSex(other.mLastSex),
 	mNumMorphMasksPending(other.mNumMorphMasksPending),
+	mClothingApplied(other.mClothingApplied),
 	mVolumeMorphs(other.mVolumeMorphs)
 {
 }
@@ -590,84 +592,114 @@ void LLPolyMorphTarget::apply(ESex avatar_sex)
 	if (delta_weight != 0.f)
 	{
 		llassert(!mMesh->isLOD());
-		LLVector4a* coords = mMesh->getWritableCoords();
 
-		LLVector4a* scaled_normals = mMesh->getScaledNormals();
-		LLVector4a* normals = mMesh->getWritableNormals();
+		if (getInfo()->mIsClothingMorph &&
+			mMesh->getWritableClothingWeights())
+		{
+			mClothingApplied = true;
+		}
 
-		LLVector4a* scaled_binormals = mMesh->getScaledBinormals();
-		LLVector4a* binormals = mMesh->getWritableBinormals();
+		// When batching morphs, the mesh applies all the morphs queued for it
+		// at once (or fetches the result from its cache) at the end of the
+		// batch.
+		if (LLPolyMesh::inMorphsBatch())
+		{
+			mMesh->addPendingMorph(this, delta_weight);
+		}
+		else
+		{
+			applyDelta(delta_weight, false);
+		}
 
-		LLVector4a* clothing_weights = mMesh->getWritableClothingWeights();
-		LLVector2* tex_coords = mMesh->getWritableTexCoords();
+		// Now apply volume changes
+		applyVolumeChanges(delta_weight);
+	}
 
-		F32* maskWeightArray = mVertMask ? mVertMask->getMorphMaskWeights()
-										 : NULL;
+	if (mNext)
+	{
+		mNext->apply(avatar_sex);
+	}
+}
 
-		for (U32 vert_index_morph = 0, count = mMorphData->mNumIndices;
-			 vert_index_morph < count; ++vert_index_morph)
-		{
-			S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
+void LLPolyMorphTarget::applyDelta(F32 delta_weight, bool deferred_normals)
+{
+	LLVector4a* coords = mMesh->getWritableCoords();
 
-			F32 maskWeight = 1.f;
-			if (maskWeightArray)
-			{
-				maskWeight = maskWeightArray[vert_index_morph];
-			}
+	LLVector4a* scaled_normals = mMesh->getScaledNormals();
+	LLVector4a* normals = mMesh->getWritableNormals();
 
-			LLVector4a pos = mMorphData->mCoords[vert_index_morph];
-			pos.mul(delta_weight * maskWeight);
-			coords[vert_index_mesh].add(pos);
+	LLVector4a* scaled_binormals = mMesh->getScaledBinormals();
+	LLVector4a* binormals = mMesh->getWritableBinormals();
 
-			if (getInfo()->mIsClothingMorph && clothing_weights)
-			{
-				LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
-				clothing_offset.mul(delta_weight * maskWeight);
-				LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
-				clothing_weight->add(clothing_offset);
-				clothing_weight->getF32ptr()[VW] = maskWeight;
-			}
+	LLVector4a* clothing_weights = mMesh->getWritableClothingWeights();
+	LLVector2* tex_coords = mMesh->getWritableTexCoords();
 
-			// Calculate new normals based on half angles
-			LLVector4a norm = mMorphData->mNormals[vert_index_morph];
-			norm.mul(delta_weight * maskWeight * NORMAL_SOFTEN_FACTOR);
-			scaled_normals[vert_index_mesh].add(norm);
-			norm = scaled_normals[vert_index_mesh];
+	F32* maskWeightArray = mVertMask ? mVertMask->getMorphMaskWeights()
+									 : NULL;
 
-			// Guard against degenerate input data before we create NaNs below !
-			norm.normalize3fast();
-			normals[vert_index_mesh] = norm;
+	bool is_clothing_morph = getInfo()->mIsClothingMorph && clothing_weights;
 
-			// Calculate new binormals
-			LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
+	for (U32 vert_index_morph = 0, count = mMorphData->mNumIndices;
+		 vert_index_morph < count; ++vert_index_morph)
+	{
+		S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
 
-			// Guard against degenerate input data before we create NaNs below !
-			if (!binorm.isFinite3() ||
-				binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO)
-			{
-				binorm.set(1.f, 0.f, 0.f, 1.f);
-			}
+		F32 maskWeight = 1.f;
+		if (maskWeightArray)
+		{
+			maskWeight = maskWeightArray[vert_index_morph];
+		}
+		F32 weight = delta_weight * maskWeight;
 
-			binorm.mul(delta_weight * maskWeight * NORMAL_SOFTEN_FACTOR);
-			scaled_binormals[vert_index_mesh].add(binorm);
-			LLVector4a tangent;
-			tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
-			LLVector4a& normalized_binormal = binormals[vert_index_mesh];
+		LLVector4a pos = mMorphData->mCoords[vert_index_morph];
+		pos.mul(weight);
+		coords[vert_index_mesh].add(pos);
 
-			normalized_binormal.setCross3(norm, tangent);
-			normalized_binormal.normalize3fast();
+		if (is_clothing_morph)
+		{
+			LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
+			clothing_weight->add(pos);
+			clothing_weight->getF32ptr()[VW] = maskWeight;
+		}
 
-			tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] *
-										   delta_weight * maskWeight;
+		// Calculate new normals based on half angles
+		LLVector4a norm = mMorphData->mNormals[vert_index_morph];
+		norm.mul(weight * NORMAL_SOFTEN_FACTOR);
+		scaled_normals[vert_index_mesh].add(norm);
+
+		// Calculate new binormals
+		LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
+
+		// Guard against degenerate input data before we create NaNs below !
+		if (!binorm.isFinite3() ||
+			binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO)
+		{
+			binorm.set(1.f, 0.f, 0.f, 1.f);
 		}
 
-		// Now apply volume changes
-		applyVolumeChanges(delta_weight);
-	}
+		binorm.mul(weight * NORMAL_SOFTEN_FACTOR);
+		scaled_binormals[vert_index_mesh].add(binorm);
 
-	if (mNext)
-	{
-		mNext->apply(avatar_sex);
+		tex_coords[vert_index_mesh] +=
+			mMorphData->mTexCoords[vert_index_morph] * weight;
+
+		if (deferred_normals)
+		{
+			mMesh->flagDirtyNormal(vert_index_mesh);
+			continue;
+		}
+
+		norm = scaled_normals[vert_index_mesh];
+		// Guard against degenerate input data before we create NaNs below !
+		norm.normalize3fast();
+		normals[vert_index_mesh] = norm;
+
+		LLVector4a tangent;
+		tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
+		LLVector4a& normalized_binormal = binormals[vert_index_mesh];
+
+		normalized_binormal.setCross3(norm, tangent);
+		normalized_binormal.normalize3fast();
 	}
 }
 
@@ -206,6 +206,17 @@ public:
 	// LLVisualParam Virtual function
 	void apply(ESex sex) override;
 
+	// Adds the weighted deltas of this morph target to its mesh. When
+	// 'deferred_normals' is true, the touched normals and binormals are only
+	// flagged for later recomputation by the mesh.
+	void applyDelta(F32 delta_weight, bool deferred_normals);
+
+	LL_INLINE LLPolyMesh* getMesh() const				{ return mMesh; }
+	LL_INLINE bool hasVertexMask() const				{ return mVertMask != NULL; }
+	// True when this clothing morph got applied at least once to its mesh
+	// (and thus set the clothing weights of its vertices).
+	LL_INLINE bool clothingApplied() const				{ return mClothingApplied; }
+
 #if 0	// Unused methods
 	// LLViewerVisualParam Virtual functions
 	F32 getTotalDistortion() override;
@@ -234,6 +245,8 @@ protected:
 	// this morph is applied
 	S32								mNumMorphMasksPending;
 
+	bool							mClothingApplied;
+
 	typedef std::vector<LLPolyVolumeMorph> volume_list_t;
 	volume_list_t 					mVolumeMorphs;
 
@@ -33,6 +33,8 @@
 
 #include <iterator> // for VS2010
 #include <deque>
+#include <list>
+#include <memory>
 
 #include "llaudiodecodemgr.h"
 
@@ -56,8 +58,42 @@ extern LLAudioEngine* gAudiop;
 LLAudioDecodeMgr* gAudioDecodeMgrp = NULL;
 
 U32 LLAudioDecodeMgr::sMaxDecodes = 0;
+size_t LLAudioDecodeMgr::sMaxCacheBytes = 64 * 1048576;
 
 constexpr S32 WAV_HEADER_SIZE = 44;
+// Number of loads of a memory-cached sound after which it gets written to the
+// disk cache, so that it survives its eviction and viewer restarts.
+constexpr U32 LOADS_BEFORE_DISK_WRITE = 2;
+
+static std::string get_decoded_filename(const LLUUID& id)
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, id.asString()) +
+		   ".dsf";
+}
+
+// May be called from any thread. Writes to a temporary file first so that a
+// partially written .dsf file may never be seen by LLAudioData::load().
+// Returns true on success.
+static bool write_decoded_file(const LLUUID& id, const std::vector<U8>& data)
+{
+	std::string filename = get_decoded_filename(id);
+	std::string temp = filename + ".tmp";
+	S64 file_size = data.size();
+	bool success;
+	{
+		LLFile outfile(temp, "wb");
+		success = outfile.write(data.data(), file_size) == file_size;
+	}
+	if (success && LLFile::rename(temp, filename))
+	{
+		LL_DEBUGS("Audio") << "Decoded file written for " << id << LL_ENDL;
+		return true;
+	}
+
+	llwarns << "Unable to write decoded file for " << id << llendl;
+	LLFile::remove(temp);
+	return false;
+}
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -71,7 +107,7 @@ protected:
 public:
 	typedef LLPointer<LLVorbisDecodeState> ptr_t;
 
-	LLVorbisDecodeState(const LLUUID& id, const std::string& out_filename);
+	LLVorbisDecodeState(const LLUUID& id);
 
 	bool initDecode();
 	bool decodeSection(); // Return true if done.
@@ -79,8 +115,10 @@ public:
 
 	LL_INLINE bool isValid() const				{ return mValid; }
 	LL_INLINE bool isDone() const				{ return mDone; }
-	LL_INLINE bool isWritten() const			{ return mWritten; }
+	LL_INLINE bool isFinished() const			{ return mFinished; }
+	LL_INLINE void setFinished()				{ mFinished = true; }
 	LL_INLINE const LLUUID& getUUID() const		{ return mUUID; }
+	LL_INLINE std::vector<U8>& getWAVBuffer()	{ return mWAVBuffer; }
 
 private:
 	void flushBadFile();
@@ -88,8 +126,6 @@ private:
 protected:
 	LLFileSystem*			mInFilep;
 
-	std::string				mOutFilename;
-
 	std::vector<U8>			mWAVBuffer;
 
 	LLUUID					mUUID;
@@ -100,7 +136,7 @@ protected:
 
 	bool					mValid;
 	bool					mDone;
-	bool					mWritten;
+	bool					mFinished;
 };
 
 static size_t cache_read(void* ptr, size_t size, size_t nmemb, void* userdata)
@@ -153,15 +189,13 @@ static long cache_tell(void* userdata)
 	return ((LLFileSystem*)userdata)->tell();
 }
 
-LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID& id,
-										 const std::string& out_filename)
+LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID& id)
 :	mUUID(id),
-	mOutFilename(out_filename),
 	mInFilep(NULL),
 	mCurrentSection(0),
 	mDone(false),
 	mValid(false),
-	mWritten(false)
+	mFinished(false)
 {
 	// No default value for mVF, is it an OGG structure ?
 }
@@ -472,24 +506,10 @@ void LLVorbisDecodeState::finishDecode()
 					 << llendl;
 		mValid = false;
 		flushBadFile();
-		return; // We have finished
 	}
-
-	LL_DEBUGS("Audio") << "Starting file write for " << mUUID << LL_ENDL;
-	LLFile oufile(mOutFilename, "wb");
-	S64 file_size = mWAVBuffer.size();
-	if (oufile.write(mWAVBuffer.data(), file_size) == file_size)
-	{
-		mDone = true;
-		LL_DEBUGS("Audio") << "Decoded file written for " << mUUID
-						   << LL_ENDL;
-	}
-	else
-	{
-		llwarns << "Unable to write file for " << mUUID << llendl;
-		mValid = false;
-	}
-	mWritten = true;
+	// Note: the decoded data is not written to disk here any more; this is
+	// now decided by the main thread (see LLAudioDecodeMgr::Impl::cacheData).
+	mFinished = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -527,11 +547,49 @@ private:
 	// Returns true if finished.
 	bool tryFinishAudio(const LLUUID& id, LLVorbisDecodeState::ptr_t state);
 
+	typedef std::shared_ptr<std::vector<U8> > wav_data_ptr_t;
+
+	// Stores the decoded data in the memory cache, taking ownership of the
+	// buffer contents, and trims the cache as needed.
+	void cacheData(const LLUUID& id, std::vector<U8>& buffer);
+	// Returns the cached data, or NULL. Moves 'id' to the front of the LRU
+	// list and counts one more load for it. Sounds being written to disk are
+	// also returned.
+	const std::vector<U8>* getCachedData(const LLUUID& id);
+	// Evicts the least recently used sounds until the cache fits its budget.
+	void trimCache();
+	// Writes the decoded data to the disk cache, via the "General" queue when
+	// possible. The data stays available from memory till the file is written.
+	void writeToDisk(const LLUUID& id, const wav_data_ptr_t& datap);
+	// Called on the main thread once the disk write for 'id' is over.
+	void writeFinished(const LLUUID& id, bool success);
+	// Flags the audio data for 'id' as needing a new decode, when its decoded
+	// data is neither in memory nor on disk any more.
+	void flagNotDecoded(const LLUUID& id);
+
 protected:
 	std::deque<LLUUID>	mDecodeQueue;
 	typedef fast_hmap<LLUUID, LLVorbisDecodeState::ptr_t> decodes_map_t;
 	decodes_map_t		mDecodes;
+	// Only ever accessed from the main thread.
 	uuid_list_t			mBadAssetList;
+
+	struct CachedSound
+	{
+		wav_data_ptr_t				mData;
+		std::list<LLUUID>::iterator	mLRUIter;
+		U32							mLoads;
+		bool						mOnDisk;
+	};
+	typedef fast_hmap<LLUUID, CachedSound> cache_map_t;
+	cache_map_t			mCache;
+	// Decoded data of the sounds being written to disk, so that they can be
+	// loaded from memory till their .dsf file exists.
+	typedef fast_hmap<LLUUID, wav_data_ptr_t> pending_map_t;
+	pending_map_t		mPendingWrites;
+	// Most recently used sounds first.
+	std::list<LLUUID>	mLRUList;
+	size_t				mCacheBytes = 0;
 };
 
 // Called from the main thread only.
@@ -617,14 +675,14 @@ void LLAudioDecodeMgr::Impl::startMoreDecodes()
 LLVorbisDecodeState::ptr_t LLAudioDecodeMgr::Impl::beginDecode(const LLUUID& id)
 {
 	LL_DEBUGS("Audio") << "Decoding " << id << " from audio queue." << LL_ENDL;
-	std::string d_path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,
-														id.asString()) +
-						 ".dsf";
-	LLVorbisDecodeState::ptr_t state = new LLVorbisDecodeState(id, d_path);
+	LLVorbisDecodeState::ptr_t state = new LLVorbisDecodeState(id);
+	// Note: bad assets are returned as finished but invalid states, so that
+	// the main thread may flag them in mBadAssetList (which is not thread-safe
+	// and therefore may not be touched from here).
 	if (!state->initDecode())
 	{
-		mBadAssetList.emplace(state->getUUID());
-		return NULL;
+		state->setFinished();
+		return state;
 	}
 
 	// Decode in a loop until we are done
@@ -634,11 +692,11 @@ LLVorbisDecodeState::ptr_t LLAudioDecodeMgr::Impl::beginDecode(const LLUUID& id)
 	{
 		// Decode stopped early, or something bad happened to the file during
 		// decoding.
-		mBadAssetList.emplace(state->getUUID());
-		return NULL;
+		state->setFinished();
+		return state;
 	}
 
-	// Write of the decoded audio to the disk cache.
+	// Finalize the WAV header and smooth the loop point.
 	state->finishDecode();
 
 	return state;
@@ -669,11 +727,21 @@ void LLAudioDecodeMgr::Impl::enqueueFinishAudio(const LLUUID& id,
 bool LLAudioDecodeMgr::Impl::tryFinishAudio(const LLUUID& id,
 											LLVorbisDecodeState::ptr_t state)
 {
-	if (!gAudiop || !(state && state->isWritten()))
+	if (!gAudiop || !(state && state->isFinished()))
 	{
 		return false;
 	}
 
+	bool valid = state->isValid();
+	if (valid)
+	{
+		cacheData(id, state->getWAVBuffer());
+	}
+	else
+	{
+		mBadAssetList.emplace(id);
+	}
+
 	LLAudioData* adp = gAudiop->getAudioData(id);
 	if (!adp)
 	{
@@ -681,14 +749,15 @@ bool LLAudioDecodeMgr::Impl::tryFinishAudio(const LLUUID& id,
 		return true;
 	}
 
-	bool valid = state && state->isValid();
 	// Mark current decode finished regardless of success or failure
 	adp->setHasCompletedDecode(true);
 	// Flip flags for decoded data
 	adp->setHasDecodeFailed(!valid);
 	adp->setHasDecodedData(valid);
-	// When finished decoding, there will also be a decoded wav file cached on
-	// disk with the .dsf extension
+	// When finished decoding, the decoded wav data is held in the memory cache
+	// and/or cached on disk as a file with the .dsf extension. Sounds being
+	// written to disk stay in memory till their file exists, so the data is
+	// loadable right now in all cases.
 	if (valid)
 	{
 		LL_DEBUGS("Audio") << "Valid decoded data for " << id << LL_ENDL;
@@ -719,6 +788,167 @@ void LLAudioDecodeMgr::Impl::checkDecodesFinished()
 	}
 }
 
+// Called from the main thread only.
+void LLAudioDecodeMgr::Impl::cacheData(const LLUUID& id,
+									   std::vector<U8>& buffer)
+{
+	wav_data_ptr_t datap = std::make_shared<std::vector<U8> >();
+	datap->swap(buffer);
+	size_t size = datap->size();
+
+	if (size > sMaxCacheBytes / 4)
+	{
+		// Memory cache disabled or sound too large to be worth keeping in
+		// memory: write it to disk right away, like we always used to do.
+		writeToDisk(id, datap);
+		return;
+	}
+
+	cache_map_t::iterator it = mCache.find(id);
+	if (it != mCache.end())
+	{
+		// Should not happen, but let's be safe and replace the old data.
+		mCacheBytes -= it->second.mData->size();
+		mLRUList.erase(it->second.mLRUIter);
+		mCache.erase(it);
+	}
+
+	mLRUList.push_front(id);
+	CachedSound& entry = mCache[id];
+	entry.mData = datap;
+	entry.mLRUIter = mLRUList.begin();
+	entry.mLoads = 0;
+	entry.mOnDisk = false;
+	mCacheBytes += size;
+
+	trimCache();
+}
+
+// Called from the main thread only.
+const std::vector<U8>* LLAudioDecodeMgr::Impl::getCachedData(const LLUUID& id)
+{
+	cache_map_t::iterator it = mCache.find(id);
+	if (it == mCache.end())
+	{
+		pending_map_t::iterator pit = mPendingWrites.find(id);
+		return pit != mPendingWrites.end() ? pit->second.get() : NULL;
+	}
+
+	CachedSound& entry = it->second;
+	if (entry.mLRUIter != mLRUList.begin())
+	{
+		mLRUList.splice(mLRUList.begin(), mLRUList, entry.mLRUIter);
+	}
+
+	// Sounds which get reloaded often (i.e. after their audio buffer got
+	// recycled) are worth keeping across sessions: write them to disk.
+	if (!entry.mOnDisk && ++entry.mLoads >= LOADS_BEFORE_DISK_WRITE)
+	{
+		entry.mOnDisk = true;
+		writeToDisk(id, entry.mData);
+	}
+
+	return entry.mData.get();
+}
+
+// Called from the main thread only.
+void LLAudioDecodeMgr::Impl::trimCache()
+{
+	while (mCacheBytes > sMaxCacheBytes && !mLRUList.empty())
+	{
+		const LLUUID& id = mLRUList.back();
+		cache_map_t::iterator it = mCache.find(id);
+		if (it != mCache.end())
+		{
+			LL_DEBUGS("Audio") << "Evicting decoded sound " << id
+							   << " from the memory cache." << LL_ENDL;
+			bool on_disk = it->second.mOnDisk;
+			mCacheBytes -= it->second.mData->size();
+			mCache.erase(it);
+			if (!on_disk)
+			{
+				// The sound will need to be decoded again from its asset.
+				flagNotDecoded(id);
+			}
+		}
+		mLRUList.pop_back();
+	}
+}
+
+// Called from the main thread only.
+void LLAudioDecodeMgr::Impl::flagNotDecoded(const LLUUID& id)
+{
+	LLAudioData* adp = gAudiop ? gAudiop->getAudioData(id) : NULL;
+	if (adp)
+	{
+		adp->setHasDecodedData(false);
+		adp->setHasCompletedDecode(false);
+	}
+}
+
+// Called from the main thread only.
+void LLAudioDecodeMgr::Impl::writeToDisk(const LLUUID& id,
+										 const wav_data_ptr_t& datap)
+{
+	static LLWorkQueue::weak_t main_queue =
+		LLWorkQueue::getNamedInstance("mainloop");
+	static LLWorkQueue::weak_t general_queue =
+		LLWorkQueue::getNamedInstance("General");
+
+	// Keep the data loadable from memory till the file is written. Note: the
+	// shared pointer also keeps the data alive for the worker, should the
+	// sound get evicted from the memory cache in the mean time.
+	mPendingWrites[id] = datap;
+
+	if (sMaxDecodes && !LLApp::isExiting())
+	{
+		auto mainq = main_queue.lock();
+		if (mainq && !mainq->isClosed() &&
+			mainq->postTo(general_queue,
+						  // Work done on general queue
+						  [id, datap]()
+						  {
+								return write_decoded_file(id, *datap);
+						  },
+						  // Callback to main thread
+						  [id, this](bool success)
+						  {
+								// Let's ensure 'this' is still valid...
+								if (gAudioDecodeMgrp)
+								{
+									writeFinished(id, success);
+								}
+						  }))
+		{
+			return;
+		}
+	}
+
+	// No worker available: write it synchronously.
+	writeFinished(id, write_decoded_file(id, *datap));
+}
+
+// Called from the main thread only.
+void LLAudioDecodeMgr::Impl::writeFinished(const LLUUID& id, bool success)
+{
+	mPendingWrites.erase(id);
+	if (success)
+	{
+		return;
+	}
+	cache_map_t::iterator it = mCache.find(id);
+	if (it != mCache.end())
+	{
+		// Still in memory: retry the write on a next load.
+		it->second.mOnDisk = false;
+		it->second.mLoads = 0;
+	}
+	else
+	{
+		flagNotDecoded(id);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 LLAudioDecodeMgr::LLAudioDecodeMgr()
@@ -736,6 +966,17 @@ void LLAudioDecodeMgr::processQueue()
 	mImpl->processQueue();
 }
 
+bool LLAudioDecodeMgr::hasDecodedData(const LLUUID& id) const
+{
+	return mImpl->mCache.count(id) != 0 ||
+		   mImpl->mPendingWrites.count(id) != 0;
+}
+
+const std::vector<U8>* LLAudioDecodeMgr::getDecodedData(const LLUUID& id)
+{
+	return mImpl->getCachedData(id);
+}
+
 bool LLAudioDecodeMgr::addDecodeRequest(const LLUUID& id)
 {
 	if (mImpl->mBadAssetList.count(id))
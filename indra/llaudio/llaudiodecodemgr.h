@@ -32,6 +32,8 @@
 #ifndef LL_LLAUDIODECODEMGR_H
 #define LL_LLAUDIODECODEMGR_H
 
+#include <vector>
+
 #include "lluuid.h"
 
 class LLVorbisDecodeState;
@@ -49,16 +51,35 @@ public:
 	bool addDecodeRequest(const LLUUID& id);
 	void addAudioRequest(const LLUUID& id);
 
+	// Decoded sounds are kept in a memory LRU cache, and only written to the
+	// disk cache (as .dsf files) once they have been (re)loaded often enough.
+	// Returns true when the decoded WAV data for 'id' is held in memory (this
+	// includes sounds being written to disk).
+	bool hasDecodedData(const LLUUID& id) const;
+	// Returns the in-memory decoded WAV data (header included) for 'id', or
+	// NULL when not cached. Counts as a new use of that sound. The returned
+	// pointer must be used immediately, since the data may get evicted as
+	// soon as another decode finishes.
+	const std::vector<U8>* getDecodedData(const LLUUID& id);
+
 	LL_INLINE static void setGeneralPoolSize(U32 pool_size)
 	{
 		sMaxDecodes = pool_size * 2;
 	}
 
+	// Sets the memory cache size in megabytes; 0 disables the memory cache
+	// and causes all decoded sounds to be written to disk immediately.
+	LL_INLINE static void setMemoryCacheSize(U32 size_mb)
+	{
+		sMaxCacheBytes = (size_t)size_mb * 1048576;
+	}
+
 protected:
 	class Impl;
-	Impl*		mImpl;
+	Impl*			mImpl;
 
-	static U32	sMaxDecodes;
+	static U32		sMaxDecodes;
+	static size_t	sMaxCacheBytes;
 };
 
 extern LLAudioDecodeMgr* gAudioDecodeMgrp;
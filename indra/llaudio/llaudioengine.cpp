@@ -1070,6 +1070,12 @@ bool LLAudioEngine::hasDecodedFile(const LLUUID& id)
 		return true;
 	}
 
+	// Search among memory-cached decoded sounds
+	if (gAudioDecodeMgrp && gAudioDecodeMgrp->hasDecodedData(id))
+	{
+		return true;
+	}
+
 	// Search among cached sound files
 	sound_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,
 												id.asString()) + ".dsf";
@@ -1897,7 +1903,17 @@ bool LLAudioData::load()
 	if (!gAudiop->isUISound(mID) ||
 		!LLAudioEngine::getUISoundFile(mID, sound_file))
 	{
-		// Not a pre-decoded UI sound file, then it will go to the cache.
+		// Not a pre-decoded UI sound file: try the memory cache first.
+		const std::vector<U8>* datap =
+			gAudioDecodeMgrp ? gAudioDecodeMgrp->getDecodedData(mID) : NULL;
+		if (datap && mBufferp->loadWAVFromMemory(datap->data(),
+												 datap->size()))
+		{
+			mHasWAVLoadFailed = false;
+			mBufferp->mAudioDatap = this;
+			return true;
+		}
+		// Else, it will go to the disk cache.
 		sound_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,
 													mID.asString()) + ".dsf";
 	}
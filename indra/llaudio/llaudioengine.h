@@ -558,6 +558,8 @@ protected:
 public:
 	virtual ~LLAudioBuffer() = default;
 	virtual bool loadWAV(const std::string& filename) = 0;
+	// Loads a complete in-memory WAV file image (header included).
+	virtual bool loadWAVFromMemory(const U8* datap, U32 size) = 0;
 	virtual U32 getLength() = 0;
 
 protected:
@@ -845,6 +845,42 @@ bool LLAudioBufferFMOD::loadWAV(const std::string& filename)
 	return true;
 }
 
+bool LLAudioBufferFMOD::loadWAVFromMemory(const U8* datap, U32 size)
+{
+	if (!datap || !size)
+	{
+		return false;
+	}
+
+	if (mSoundp)
+	{
+		// If there is already something loaded in this buffer, clean it up.
+		mSoundp->release();
+		mSoundp = NULL;
+	}
+
+	FMOD_CREATESOUNDEXINFO exinfo;
+	memset(&exinfo, 0, sizeof(FMOD_CREATESOUNDEXINFO));
+	exinfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
+	exinfo.length = size;
+	exinfo.suggestedsoundtype = FMOD_SOUND_TYPE_WAV;
+
+	// Note: without FMOD_OPENMEMORY_POINT, FMOD copies the data into its own
+	// sample, so the memory buffer may be freed after this call.
+	FMOD_RESULT result =
+		getSystem()->createSound((const char*)datap,
+								 FMOD_LOOP_NORMAL | FMOD_OPENMEMORY,
+								 &exinfo, &mSoundp);
+	if (result != FMOD_OK)
+	{
+		llwarns << "Could not load WAV data from memory: "
+				<< FMOD_ErrorString(result) << llendl;
+		return false;
+	}
+
+	return true;
+}
+
 U32 LLAudioBufferFMOD::getLength()
 {
 	unsigned int length = 0;
@@ -143,6 +143,7 @@ public:
 	~LLAudioBufferFMOD() override;
 
 	bool loadWAV(const std::string& filename) override;
+	bool loadWAVFromMemory(const U8* datap, U32 size) override;
 	U32 getLength() override;
 
 protected:
@@ -360,6 +360,26 @@ bool LLAudioBufferOpenAL::loadWAV(const std::string& filename)
 	return true;
 }
 
+bool LLAudioBufferOpenAL::loadWAVFromMemory(const U8* datap, U32 size)
+{
+	if (!datap || !size)
+	{
+		return false;
+	}
+
+	cleanup();
+	mALBuffer = alutCreateBufferFromFileImage((const ALvoid*)datap,
+											  (ALsizei)size);
+	if (mALBuffer == AL_NONE)
+	{
+		llwarns << "Error loading WAV data from memory: "
+				<< alutGetErrorString(alutGetError()) << llendl;
+		return false;
+	}
+
+	return true;
+}
+
 U32 LLAudioBufferOpenAL::getLength()
 {
 	if (mALBuffer == AL_NONE)
@@ -112,6 +112,7 @@ public:
 	~LLAudioBufferOpenAL() override;
 
 	bool loadWAV(const std::string& filename) override;
+	bool loadWAVFromMemory(const U8* datap, U32 size) override;
 	U32 getLength() override;
 
 protected:
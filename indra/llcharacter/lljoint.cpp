@@ -165,6 +165,8 @@ void LLJoint::init()
 	mXform.setScale(LLVector3(1.0f, 1.0f, 1.0f));
 	mDirtyFlags = MATRIX_DIRTY | ROTATION_DIRTY | POSITION_DIRTY;
 	mUpdateXform = true;
+	mHierarchySerial = 1;
+	mFlattenedSerial = 0;
 	mSupport = SUPPORT_BASE;
 	mEnd = LLVector3(0.f, 0.f, 0.f);
 }
@@ -308,6 +310,7 @@ void LLJoint::addChild(LLJoint* joint)
 	joint->mXform.setParent(&mXform);
 	joint->mParent = this;
 	joint->touch();
+	hierarchyChanged();
 }
 
 void LLJoint::removeChild(LLJoint* joint)
@@ -331,6 +334,7 @@ void LLJoint::removeChild(LLJoint* joint)
 			joint->mXform.setParent(NULL);
 			joint->mParent = NULL;
 			joint->touch();
+			hierarchyChanged();
 			return;
 		}
 	}
@@ -349,6 +353,17 @@ void LLJoint::removeAllChildren()
 		}
 	}
 	mChildren.clear();
+	hierarchyChanged();
+}
+
+// Only the sub-trees containing this joint (i.e. this joint and its ancestors)
+// need their flattened joints list rebuilt.
+void LLJoint::hierarchyChanged()
+{
+	for (LLJoint* joint = this; joint; joint = joint->mParent)
+	{
+		++joint->mHierarchySerial;
+	}
 }
 
 void LLJoint::setPosition(const LLVector3& requested_pos, bool do_override)
@@ -786,21 +801,57 @@ void LLJoint::updateWorldPRSParent()
 	}
 }
 
+void LLJoint::flattenJoints(LLJoint* joint)
+{
+	U32 index = mFlattenedJoints.size();
+	mFlattenedJoints.push_back(joint);
+	mFlattenedSubtreeEnds.push_back(0);
+	for (S32 i = 0, count = joint->mChildren.size(); i < count; ++i)
+	{
+		LLJoint* child = joint->mChildren[i];
+		if (child)	// Paranoia
+		{
+			flattenJoints(child);
+		}
+	}
+	mFlattenedSubtreeEnds[index] = mFlattenedJoints.size();
+}
+
+void LLJoint::buildFlattenedJoints()
+{
+	mFlattenedJoints.clear();
+	mFlattenedSubtreeEnds.clear();
+	flattenJoints(this);
+	mFlattenedSerial = mHierarchySerial;
+}
+
 void LLJoint::updateWorldMatrixChildren()
 {
 	if (!mUpdateXform) return;
 
-	if (mDirtyFlags & MATRIX_DIRTY)
+	if (mFlattenedSerial != mHierarchySerial)
 	{
-		updateWorldMatrix();
+		buildFlattenedJoints();
 	}
-	for (S32 i = 0, count = mChildren.size(); i < count; ++i)
+
+	// Parents always come before their children in the flattened list, so
+	// their world matrix is up to date when the children get updated.
+	U32 i = 0;
+	U32 count = mFlattenedJoints.size();
+	while (i < count)
 	{
-		LLJoint* joint = mChildren[i];
-		if (joint)	// Paranoia
+		LLJoint* joint = mFlattenedJoints[i];
+		if (!joint->mUpdateXform)
+		{
+			// Skip this joint and its whole sub-tree.
+			i = mFlattenedSubtreeEnds[i];
+			continue;
+		}
+		if (joint->mDirtyFlags & MATRIX_DIRTY)
 		{
-			joint->updateWorldMatrixChildren();
+			joint->updateWorldMatrix();
 		}
+		++i;
 	}
 }
 
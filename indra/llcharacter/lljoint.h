@@ -265,6 +265,15 @@ public:
 
 	const LLMatrix4& getWorldMatrix();
 
+	// Updates the world matrices of this joint and of all its descendents.
+	// The hierarchy is walked via a cached, flattened (pre-ordered) array of
+	// joints, which is rebuilt whenever a joint gets (un)parented in this
+	// sub-tree.
+	// Note: a level by level, 4 joints wide SSE2 pass over gathered SoA copies
+	// of the transforms was tried and measured 20 to 30% slower than this
+	// scalar sweep on a 133 joints avatar skeleton (4.5-5.0 against 3.7-4.0
+	// microseconds), because most levels only hold a few joints and the
+	// gathering/scattering from/to LLXformMatrix outweighs the SIMD gains.
 	void updateWorldMatrixChildren();
 	void updateWorldMatrixParent();
 
@@ -324,6 +333,12 @@ public:
 private:
 	void init();
 
+	void buildFlattenedJoints();
+	void flattenJoints(LLJoint* joint);
+
+	// Invalidates the flattened lists of this joint and of its ancestors.
+	void hierarchyChanged();
+
 protected:
 	// Explicit transformation members
 	LLXformMatrix			mXform;
@@ -365,6 +380,19 @@ public:
 	bool					mUpdateXform;
 	bool					mIsBone;
 
+private:
+	// Flattened, pre-ordered list of this joint and all its descendents, with
+	// for each joint the index of the first joint past its sub-tree in the
+	// list (used to skip the sub-trees of joints with mUpdateXform false).
+	// Only built for the joints updateWorldMatrixChildren() is called on.
+	std::vector<LLJoint*>	mFlattenedJoints;
+	std::vector<U32>		mFlattenedSubtreeEnds;
+	U32						mFlattenedSerial;
+	// Incremented each time a joint gets (un)parented in this sub-tree, so
+	// that the flattened list is rebuilt when needed.
+	U32						mHierarchySerial;
+
+public:
 	// Debug statics
 	static S32				sNumTouches;
 	static S32				sNumUpdates;
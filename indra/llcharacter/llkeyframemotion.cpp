@@ -132,81 +132,102 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
 	return total_size;
 }
 
+//-----------------------------------------------------------------------------
+// Keys arrays helpers
+//-----------------------------------------------------------------------------
+
+// Returns the index of the first key which time is not lower than 'time', or
+// the number of keys if there is none (i.e. what std::lower_bound() would
+// return). 'cursor' holds the result of the previous search for the same
+// curve and motion instance: it is checked first, followed with the next key
+// interval, so that monotonic playback does not need any binary search.
+static U32 find_right_key(const std::vector<F32>& times, F32 time,
+						  U32& cursor)
+{
+	U32 count = times.size();
+	for (U32 i = cursor, last = llmin(cursor + 1, count); i <= last; ++i)
+	{
+		if ((i == count || times[i] >= time) && (!i || times[i - 1] < time))
+		{
+			cursor = i;
+			return i;
+		}
+	}
+	cursor = std::lower_bound(times.begin(), times.end(), time) -
+			 times.begin();
+	return cursor;
+}
+
+// Inserts 'value' at 'time' in the sorted arrays, replacing any existing key
+// at the same time. Keys are normally stored in order in animation assets, so
+// this is most often a simple append.
+template<class T>
+static void insert_key(std::vector<F32>& times, std::vector<T>& values,
+					   F32 time, const T& value)
+{
+	if (times.empty() || times.back() < time)
+	{
+		times.push_back(time);
+		values.push_back(value);
+		return;
+	}
+	std::vector<F32>::iterator it = std::lower_bound(times.begin(),
+													 times.end(), time);
+	size_t index = it - times.begin();
+	if (*it == time)
+	{
+		values[index] = value;
+	}
+	else
+	{
+		times.insert(it, time);
+		values.insert(values.begin() + index, value);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // LLKeyframeMotion::ScaleCurve sub-class
 //-----------------------------------------------------------------------------
 
 LLKeyframeMotion::ScaleCurve::ScaleCurve()
+:	mInterpolationType(LLKeyframeMotion::IT_LINEAR),
+	mNumKeys(0)
 {
-	mInterpolationType = LLKeyframeMotion::IT_LINEAR;
-	mNumKeys = 0;
 }
 
-LLKeyframeMotion::ScaleCurve::~ScaleCurve()
+void LLKeyframeMotion::ScaleCurve::addKey(const ScaleKey& key)
 {
-	mKeys.clear();
-	mNumKeys = 0;
+	insert_key(mTimes, mScales, key.mTime, key.mScale);
 }
 
-LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration,
+												 U32& cursor) const
 {
-	LLVector3 value;
-
-	if (mKeys.empty())
+	U32 count = mTimes.size();
+	if (!count)
 	{
-		return value;
+		return LLVector3::zero;
 	}
 
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	U32 right = find_right_key(mTimes, time, cursor);
+	if (right == count)
 	{
 		// Past last key
-		value = (--right)->second.mScale;
+		return mScales[count - 1];
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	if (!right || mTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mScale;
+		return mScales[right];
 	}
-	else
-	{
-		// Between two keys
-		key_map_t::iterator left = right;
-		F32 index_before = (--left)->first;
-		F32 index_after = right->first;
-		if (index_after > index_before)
-		{
-			ScaleKey& scale_before = left->second;
-			ScaleKey& scale_after = right->second;
-			if (right == mKeys.end())
-			{
-				scale_after = mLoopInKey;
-				index_after = duration;
-			}
-
-			F32 u = (time - index_before) / (index_after - index_before);
-			value = interp(u, scale_before, scale_after);
-		}
-		else
-		{
-			llwarns << "Out of order indexes." << llendl;
-			value = right->second.mScale;
-		}
-	}
-	return value;
-}
-
-LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before,
-											   ScaleKey& after)
-{
+	// Between two keys
+	U32 left = right - 1;
 	if (mInterpolationType == IT_STEP)
 	{
-		return before.mScale;
-	}
-	else
-	{
-		return lerp(before.mScale, after.mScale, u);
+		return mScales[left];
 	}
+	F32 u = (time - mTimes[left]) / (mTimes[right] - mTimes[left]);
+	return lerp(mScales[left], mScales[right], u);
 }
 
 //-----------------------------------------------------------------------------
@@ -214,77 +235,44 @@ LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before,
 //-----------------------------------------------------------------------------
 
 LLKeyframeMotion::RotationCurve::RotationCurve()
+:	mInterpolationType(LLKeyframeMotion::IT_LINEAR),
+	mNumKeys(0)
 {
-	mInterpolationType = LLKeyframeMotion::IT_LINEAR;
-	mNumKeys = 0;
 }
 
-LLKeyframeMotion::RotationCurve::~RotationCurve()
+void LLKeyframeMotion::RotationCurve::addKey(const RotationKey& key)
 {
-	mKeys.clear();
-	mNumKeys = 0;
+	insert_key(mTimes, mRotations, key.mTime, key.mRotation);
 }
 
-LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
+LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration,
+													   U32& cursor) const
 {
-	if (mKeys.empty())
+	U32 count = mTimes.size();
+	if (!count)
 	{
 		return LLQuaternion::DEFAULT;
 	}
 
-	LLQuaternion value;
-
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	U32 right = find_right_key(mTimes, time, cursor);
+	if (right == count)
 	{
 		// Past last key
-		value = (--right)->second.mRotation;
+		return mRotations[count - 1];
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	if (!right || mTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mRotation;
+		return mRotations[right];
 	}
-	else
-	{
-		// Between two keys
-		key_map_t::iterator left = right;
-		F32 index_before = (--left)->first;
-		F32 index_after = right->first;
-		if (index_after > index_before)
-		{
-			RotationKey& rot_before = left->second;
-			RotationKey& rot_after = right->second;
-			if (right == mKeys.end())
-			{
-				rot_after = mLoopInKey;
-				index_after = duration;
-			}
-
-			F32 u = (time - index_before) / (index_after - index_before);
-			value = interp(u, rot_before, rot_after);
-		}
-		else
-		{
-			llwarns << "Out of order indexes." << llendl;
-			value = right->second.mRotation;
-		}
-	}
-	return value;
-}
-
-LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u,
-													 RotationKey& before,
-													 RotationKey& after)
-{
+	// Between two keys
+	U32 left = right - 1;
 	if (mInterpolationType == IT_STEP)
 	{
-		return before.mRotation;
-	}
-	else
-	{
-		return nlerp(u, before.mRotation, after.mRotation);
+		return mRotations[left];
 	}
+	F32 u = (time - mTimes[left]) / (mTimes[right] - mTimes[left]);
+	return nlerp(u, mRotations[left], mRotations[right]);
 }
 
 //-----------------------------------------------------------------------------
@@ -292,60 +280,49 @@ LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u,
 //-----------------------------------------------------------------------------
 
 LLKeyframeMotion::PositionCurve::PositionCurve()
+:	mInterpolationType(LLKeyframeMotion::IT_LINEAR),
+	mNumKeys(0)
 {
-	mInterpolationType = LLKeyframeMotion::IT_LINEAR;
-	mNumKeys = 0;
 }
 
-LLKeyframeMotion::PositionCurve::~PositionCurve()
+void LLKeyframeMotion::PositionCurve::addKey(const PositionKey& key)
 {
-	mKeys.clear();
-	mNumKeys = 0;
+	insert_key(mTimes, mPositions, key.mTime, key.mPosition);
 }
 
-LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration,
+													U32& cursor) const
 {
-	LLVector3 value;
-
-	if (mKeys.empty())
+	U32 count = mTimes.size();
+	if (!count)
 	{
-		return value;
+		return LLVector3::zero;
 	}
 
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	LLVector3 value;
+	U32 right = find_right_key(mTimes, time, cursor);
+	if (right == count)
 	{
 		// Past last key
-		value = (--right)->second.mPosition;
+		value = mPositions[count - 1];
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	else if (!right || mTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mPosition;
+		value = mPositions[right];
 	}
 	else
 	{
 		// Between two keys
-		key_map_t::iterator left = right;
-		F32 index_before = (--left)->first;
-		F32 index_after = right->first;
-		PositionKey& pos_before = left->second;
-		PositionKey& pos_after = right->second;
-		if (index_after > index_before)
-		{
-			if (right == mKeys.end())
-			{
-				pos_after = mLoopInKey;
-				index_after = duration;
-			}
-
-			F32 u = (time - index_before) / (index_after - index_before);
-			value = interp(u, pos_before, pos_after);
+		U32 left = right - 1;
+		if (mInterpolationType == IT_STEP)
+		{
+			value = mPositions[left];
 		}
 		else
 		{
-			llwarns << "Out of order indexes." << llendl;
-			value = right->second.mPosition;
+			F32 u = (time - mTimes[left]) / (mTimes[right] - mTimes[left]);
+			value = lerp(mPositions[left], mPositions[right], u);
 		}
 	}
 
@@ -354,22 +331,12 @@ LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 	return value;
 }
 
-LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before,
-												  PositionKey& after)
-{
-	if (mInterpolationType == IT_STEP)
-	{
-		return before.mPosition;
-	}
-	return lerp(before.mPosition, after.mPosition, u);
-}
-
 //-----------------------------------------------------------------------------
 // LLKeyframeMotion::JointMotion sub-class
 //-----------------------------------------------------------------------------
 
 void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
-										   F32 duration)
+										   F32 duration, KeyCursors& cursors)
 {
 	// This value being 0 is the cause of:
 	// https://jira.lindenlab.com/browse/SL-22678
@@ -385,19 +352,22 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	// Update scale component of joint state
 	if ((usage & LLJointState::SCALE) && mScaleCurve.mNumKeys)
 	{
-		joint_state->setScale(mScaleCurve.getValue(time, duration));
+		joint_state->setScale(mScaleCurve.getValue(time, duration,
+												   cursors.mScale));
 	}
 
 	// Update rotation component of joint state
 	if ((usage & LLJointState::ROT) && mRotationCurve.mNumKeys)
 	{
-		joint_state->setRotation(mRotationCurve.getValue(time, duration));
+		joint_state->setRotation(mRotationCurve.getValue(time, duration,
+														 cursors.mRotation));
 	}
 
 	// Update position component of joint state
 	if ((usage & LLJointState::POS) && mPositionCurve.mNumKeys)
 	{
-		joint_state->setPosition(mPositionCurve.getValue(time, duration));
+		joint_state->setPosition(mPositionCurve.getValue(time, duration,
+														 cursors.mPosition));
 	}
 }
 
@@ -784,16 +754,22 @@ void LLKeyframeMotion::applyKeyframes(F32 time)
 					 << mJointStates.size() << "). Aborting update." << llendl;
 		return;
 	}
+	if (mKeyCursors.size() != count)
+	{
+		mKeyCursors.clear();
+		mKeyCursors.resize(count);
+	}
+	F32 duration = mJointMotionList->mDuration;
 	for (U32 i = 0; i < count; ++i)
 	{
-		JointMotion* joint_motion = mJointMotionList->getJointMotion(i);
+		JointMotion* joint_motion = mJointMotionList->mJointMotionArray[i];
 		if (!joint_motion)
 		{
 			llwarns << "NULL joint motion found !" << llendl;
 			continue;
 		}
-		joint_motion->update(mJointStates[i], time,
-							 mJointMotionList->mDuration);
+		joint_motion->update(mJointStates[i], time, duration,
+							 mKeyCursors[i]);
 	}
 
 	static const std::string hand_pose = "Hand Pose";
@@ -1717,7 +1693,7 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id,
 				return false;
 			}
 
-			rCurve->mKeys[time] = rot_key;
+			rCurve->addKey(rot_key);
 		}
 
 		// Scan position curve header
@@ -1817,7 +1793,7 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id,
 				return false;
 			}
 
-			curvep->mKeys[pos_key.mTime] = pos_key;
+			curvep->addKey(pos_key);
 
 			if (is_pelvis)
 			{
@@ -2193,17 +2169,15 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
 
 		LL_DEBUGS("KeyFrameMotion") << "Joint: " << joint_motionp->mJointName
 									<< LL_ENDL;
-		for (RotationCurve::key_map_t::iterator
-				iter = joint_motionp->mRotationCurve.mKeys.begin(),
-				end = joint_motionp->mRotationCurve.mKeys.end();
-			 iter != end; ++iter)
+		RotationCurve& rot_curve = joint_motionp->mRotationCurve;
+		for (U32 k = 0, count = rot_curve.size(); k < count; ++k)
 		{
-			RotationKey& rot_key = iter->second;
-			U16 time_short = F32_to_U16(rot_key.mTime, 0.f,
+			F32 time = rot_curve.mTimes[k];
+			U16 time_short = F32_to_U16(time, 0.f,
 										mJointMotionList->mDuration);
 			success &= dp.packU16(time_short, "time");
 
-			LLVector3 rot_angles = rot_key.mRotation.packToVector3();
+			LLVector3 rot_angles = rot_curve.mRotations[k].packToVector3();
 			rot_angles.quantize16(-1.f, 1.f, -1.f, 1.f);
 
 			U16 x = F32_to_U16(rot_angles.mV[VX], -1.f, 1.f);
@@ -2213,7 +2187,7 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
 			success &= dp.packU16(y, "rot_angle_y");
 			success &= dp.packU16(z, "rot_angle_z");
 
-			LL_DEBUGS("KeyFrameMotion") << " Rot: t=" << rot_key.mTime
+			LL_DEBUGS("KeyFrameMotion") << " Rot: t=" << time
 										<< " - rotation=" << rot_angles.mV[VX]
 										<< "," << rot_angles.mV[VY] << ","
 										<< rot_angles.mV[VZ] << LL_ENDL;
@@ -2221,36 +2195,33 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
 
 		success &= dp.packS32(joint_motionp->mPositionCurve.mNumKeys,
 							  "num_pos_keys");
-		for (PositionCurve::key_map_t::iterator
-				iter = joint_motionp->mPositionCurve.mKeys.begin(),
-				end = joint_motionp->mPositionCurve.mKeys.end();
-			 iter != end; ++iter)
+		PositionCurve& pos_curve = joint_motionp->mPositionCurve;
+		for (U32 k = 0, count = pos_curve.size(); k < count; ++k)
 		{
-			PositionKey& pos_key = iter->second;
-			U16 time_short = F32_to_U16(pos_key.mTime, 0.f,
+			F32 time = pos_curve.mTimes[k];
+			LLVector3& position = pos_curve.mPositions[k];
+			U16 time_short = F32_to_U16(time, 0.f,
 										mJointMotionList->mDuration);
 			success &= dp.packU16(time_short, "time");
 
-			pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET,
-										 LL_MAX_PELVIS_OFFSET,
-										 -LL_MAX_PELVIS_OFFSET,
-										 LL_MAX_PELVIS_OFFSET);
+			position.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET,
+								-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
 
-			U16 x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET,
+			U16 x = F32_to_U16(position.mV[VX], -LL_MAX_PELVIS_OFFSET,
 							   LL_MAX_PELVIS_OFFSET);
-			U16 y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET,
+			U16 y = F32_to_U16(position.mV[VY], -LL_MAX_PELVIS_OFFSET,
 							   LL_MAX_PELVIS_OFFSET);
-			U16 z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET,
+			U16 z = F32_to_U16(position.mV[VZ], -LL_MAX_PELVIS_OFFSET,
 							   LL_MAX_PELVIS_OFFSET);
 			success &= dp.packU16(x, "pos_x");
 			success &= dp.packU16(y, "pos_y");
 			success &= dp.packU16(z, "pos_z");
 
-			LL_DEBUGS("KeyFrameMotion") << " Pos: t=" << pos_key.mTime
+			LL_DEBUGS("KeyFrameMotion") << " Pos: t=" << time
 										<< " - position="
-										<< pos_key.mPosition.mV[VX] << ","
-										<< pos_key.mPosition.mV[VY] << ","
-										<< pos_key.mPosition.mV[VZ] << LL_ENDL;
+										<< position.mV[VX] << ","
+										<< position.mV[VY] << ","
+										<< position.mV[VZ] << LL_ENDL;
 		}
 	}
 
@@ -33,6 +33,8 @@
 #ifndef LL_LLKEYFRAMEMOTION_H
 #define LL_LLKEYFRAMEMOTION_H
 
+#include <vector>
+
 #include "llassetstorage.h"
 #include "llbboxlocal.h"
 #include "llbvhconsts.h"
@@ -327,6 +329,13 @@ public:
 		LLVector3	mPosition;
 	};
 
+	// The curves below store their keys in time-sorted, contiguous arrays
+	// (times in one array, values in another), which are shared by all the
+	// motion instances via the JointMotionList cache. Each motion instance
+	// passes its own 'cursor' (index of the last key found) to getValue(), so
+	// that the normal, monotonic playback finds its keys in O(1) instead of
+	// doing a binary search on each frame.
+
 	class ScaleCurve
 	{
 	protected:
@@ -334,17 +343,27 @@ public:
 
 	public:
 		ScaleCurve();
-		~ScaleCurve();
-		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
+
+		// Adds a key, replacing any existing key at the same time.
+		void addKey(const ScaleKey& key);
+
+		LLVector3 getValue(F32 time, F32 duration, U32& cursor) const;
+
+		LL_INLINE LLVector3 getValue(F32 time, F32 duration) const
+		{
+			U32 cursor = 0;
+			return getValue(time, duration, cursor);
+		}
+
+		LL_INLINE U32 size() const						{ return mTimes.size(); }
 
 	public:
-		InterpolationType	mInterpolationType;
-		S32					mNumKeys;
-		typedef std::map<F32, ScaleKey> key_map_t;
-		key_map_t 			mKeys;
-		ScaleKey			mLoopInKey;
-		ScaleKey			mLoopOutKey;
+		InterpolationType		mInterpolationType;
+		S32						mNumKeys;
+		std::vector<F32>		mTimes;
+		std::vector<LLVector3>	mScales;
+		ScaleKey				mLoopInKey;
+		ScaleKey				mLoopOutKey;
 	};
 
 	class RotationCurve
@@ -354,17 +373,27 @@ public:
 
 	public:
 		RotationCurve();
-		~RotationCurve();
-		LLQuaternion getValue(F32 time, F32 duration);
-		LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
+
+		// Adds a key, replacing any existing key at the same time.
+		void addKey(const RotationKey& key);
+
+		LLQuaternion getValue(F32 time, F32 duration, U32& cursor) const;
+
+		LL_INLINE LLQuaternion getValue(F32 time, F32 duration) const
+		{
+			U32 cursor = 0;
+			return getValue(time, duration, cursor);
+		}
+
+		LL_INLINE U32 size() const						{ return mTimes.size(); }
 
 	public:
-		InterpolationType	mInterpolationType;
-		S32					mNumKeys;
-		typedef std::map<F32, RotationKey> key_map_t;
-		key_map_t			mKeys;
-		RotationKey			mLoopInKey;
-		RotationKey			mLoopOutKey;
+		InterpolationType			mInterpolationType;
+		S32							mNumKeys;
+		std::vector<F32>			mTimes;
+		std::vector<LLQuaternion>	mRotations;
+		RotationKey					mLoopInKey;
+		RotationKey					mLoopOutKey;
 	};
 
 	class PositionCurve
@@ -374,23 +403,49 @@ public:
 
 	public:
 		PositionCurve();
-		~PositionCurve();
-		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
+
+		// Adds a key, replacing any existing key at the same time.
+		void addKey(const PositionKey& key);
+
+		LLVector3 getValue(F32 time, F32 duration, U32& cursor) const;
+
+		LL_INLINE LLVector3 getValue(F32 time, F32 duration) const
+		{
+			U32 cursor = 0;
+			return getValue(time, duration, cursor);
+		}
+
+		LL_INLINE U32 size() const						{ return mTimes.size(); }
 
 	public:
-		InterpolationType	mInterpolationType;
-		S32					mNumKeys;
-		typedef std::map<F32, PositionKey> key_map_t;
-		key_map_t			mKeys;
-		PositionKey			mLoopInKey;
-		PositionKey			mLoopOutKey;
+		InterpolationType		mInterpolationType;
+		S32						mNumKeys;
+		std::vector<F32>		mTimes;
+		std::vector<LLVector3>	mPositions;
+		PositionKey				mLoopInKey;
+		PositionKey				mLoopOutKey;
+	};
+
+	// Per motion instance key cursors for a JointMotion.
+	struct KeyCursors
+	{
+		LL_INLINE KeyCursors()
+		:	mScale(0),
+			mRotation(0),
+			mPosition(0)
+		{
+		}
+
+		U32 mScale;
+		U32 mRotation;
+		U32 mPosition;
 	};
 
 	class JointMotion
 	{
 	public:
-		void update(LLJointState* joint_state, F32 time, F32 duration);
+		void update(LLJointState* joint_state, F32 time, F32 duration,
+					KeyCursors& cursors);
 
 	public:
 		PositionCurve			mPositionCurve;
@@ -448,6 +503,8 @@ public:
 protected:
 	JointMotionList*	mJointMotionList;
 	std::vector<LLPointer<LLJointState> > mJointStates;
+	// Key cursors, one per joint motion in mJointMotionList.
+	std::vector<KeyCursors>	mKeyCursors;
 	LLJoint*			mPelvisp;
 	LLCharacter*		mCharacter;
 	typedef std::list<JointConstraint*>	constraint_list_t;
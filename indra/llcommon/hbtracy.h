@@ -33,6 +33,10 @@
 #ifndef LL_HBTRACY_H
 #define LL_HBTRACY_H
 
+// When LL_TRACE_CAPTURE is defined and non-zero, all the timers below also
+// feed the (Tracy server-less) trace capture ring buffers.
+#include "lltracecapture.h"
+
 #if TRACY_ENABLE
 
 // Tracy configuration: this must match exactly the configuration used to
@@ -67,7 +71,7 @@
 // down in release builds): the 'name' parameter can be anything (and shall not
 // be added to EFastTimerType) but, by convention, all such timers are named
 // following the TRC_* pattern in the viewer code.
-# define LL_TRACY_TIMER(name) ZoneScopedN(#name)
+# define LL_TRACY_TIMER(name) ZoneScopedN(#name); LL_TRACE_ZONE(name)
 
 // When TRACY_ENABLE is defined and greater than 2, we also enable fast timers.
 # if TRACY_ENABLE > 2
@@ -80,23 +84,24 @@
 
 // Use both Tracy and fast timers
 #  define LL_FAST_TIMER(name) LLFastTimer name(LLFastTimer::name); \
-							  ZoneScopedN(#name)
+							  ZoneScopedN(#name); LL_TRACE_ZONE(name)
 
 #  define LL_FAST_TIMERS(cond, name1, name2) \
 	LLFastTimer ftm(cond ? LLFastTimer::name1 : LLFastTimer::name2); \
-	ZoneScopedN(#name1)
+	ZoneScopedN(#name1); LL_TRACE_ZONE(name1)
 
 # else	// LL_FAST_TIMERS_ENABLED
 
 // Replace fast timers with Tracy
-#  define LL_FAST_TIMER(name) ZoneScopedN(#name)
+#  define LL_FAST_TIMER(name) ZoneScopedN(#name); LL_TRACE_ZONE(name)
 
 // Tracy only accepts constexpr parameters for zone names, so that name cannot
 // be made conditional. We simply use the first passed name, regardless of the
 // condition (we need two names for fast timers only when a (hard coded) dual-
 // parenting of that timer is needed; Tracy does not need this since parenting
 // is auto-determined).
-#  define LL_FAST_TIMERS(cond, name1, name2) ZoneScopedN(#name1)
+#  define LL_FAST_TIMERS(cond, name1, name2) ZoneScopedN(#name1); \
+												 LL_TRACE_ZONE(name1)
 
 # endif	// LL_FAST_TIMERS_ENABLED
 
@@ -125,11 +130,13 @@ extern const char* trc_mem_vertex;
 #else 	// TRACY_ENABLE
 
 # define LL_FAST_TIMERS_ENABLED 1
-# define LL_FAST_TIMER(name) LLFastTimer name(LLFastTimer::name)
+# define LL_FAST_TIMER(name) LLFastTimer name(LLFastTimer::name); \
+							 LL_TRACE_ZONE(name)
 # define LL_FAST_TIMERS(cond, name1, name2) \
-	LLFastTimer ftm(cond ? LLFastTimer::name1 : LLFastTimer::name2)
-// This is a no-op for fast timers
-# define LL_TRACY_TIMER(name)
+	LLFastTimer ftm(cond ? LLFastTimer::name1 : LLFastTimer::name2); \
+	LL_TRACE_ZONE(name1)
+// This is a no-op for fast timers (but not for the trace capture)
+# define LL_TRACY_TIMER(name) LL_TRACE_ZONE(name)
 
 // These are always no-operations when Tracy is not in use
 # define LL_TRACY_ALLOC(ptr, size, name)
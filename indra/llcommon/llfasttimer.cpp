@@ -48,6 +48,12 @@ U64 LLFastTimer::sCountAverage[LLFastTimer::FTM_NUM_TYPES];
 U64 LLFastTimer::sCalls[LLFastTimer::FTM_NUM_TYPES];
 U64 LLFastTimer::sCallHistory[FTM_HISTORY_NUM][LLFastTimer::FTM_NUM_TYPES];
 U64 LLFastTimer::sCallAverage[LLFastTimer::FTM_NUM_TYPES];
+U64 LLFastTimer::sAllocs[LLFastTimer::FTM_NUM_TYPES];
+U64 LLFastTimer::sAllocBytes[LLFastTimer::FTM_NUM_TYPES];
+U64 LLFastTimer::sAllocAverage[LLFastTimer::FTM_NUM_TYPES];
+U64 LLFastTimer::sAllocBytesAverage[LLFastTimer::FTM_NUM_TYPES];
+U64 LLFastTimer::sAllocHistory[FTM_HISTORY_NUM][LLFastTimer::FTM_NUM_TYPES];
+U64 LLFastTimer::sAllocBytesHistory[FTM_HISTORY_NUM][LLFastTimer::FTM_NUM_TYPES];
 S32 LLFastTimer::sCurFrameIndex = -1;
 S32 LLFastTimer::sLastFrameIndex = -1;
 bool LLFastTimer::sPauseHistory = false;
@@ -100,6 +106,12 @@ void LLFastTimer::reset()
 			sCallHistory[hidx][i] = sCalls[i];
 			sCallAverage[i] = (sCallAverage[i] * sCurFrameIndex +
 							   sCalls[i]) / (sCurFrameIndex + 1);
+			sAllocHistory[hidx][i] = sAllocs[i];
+			sAllocAverage[i] = (sAllocAverage[i] * sCurFrameIndex +
+								sAllocs[i]) / (sCurFrameIndex + 1);
+			sAllocBytesHistory[hidx][i] = sAllocBytes[i];
+			sAllocBytesAverage[i] = (sAllocBytesAverage[i] * sCurFrameIndex +
+									 sAllocBytes[i]) / (sCurFrameIndex + 1);
 		}
 		sLastFrameIndex = sCurFrameIndex;
 	}
@@ -109,6 +121,8 @@ void LLFastTimer::reset()
 		{
 			sCountAverage[i] = 0;
 			sCallAverage[i] = 0;
+			sAllocAverage[i] = 0;
+			sAllocBytesAverage[i] = 0;
 		}
 	}
 
@@ -118,6 +132,8 @@ void LLFastTimer::reset()
 	{
 		sCounter[i] = 0;
 		sCalls[i] = 0;
+		sAllocs[i] = 0;
+		sAllocBytes[i] = 0;
 	}
 	sCurDepth = 0;
 }
@@ -373,6 +373,15 @@ public:
 
 	static U64 countsPerSecond()				{ return sClockResolution; }
 
+	// Called by LLMemory::recordAllocation(), for the main thread only, when
+	// the allocations profiler is enabled. The allocation is accounted for
+	// against the innermost running timer.
+	LL_INLINE static void recordAllocation(size_t size)
+	{
+		++sAllocs[sCurType];
+		sAllocBytes[sCurType] += size;
+	}
+
 private:
 	LL_INLINE static U64 getCPUClockCount()
 	{
@@ -414,6 +423,13 @@ public:
 	static U64				sCallAverage[FTM_NUM_TYPES];
 	static U64				sCountHistory[FTM_HISTORY_NUM][FTM_NUM_TYPES];
 	static U64				sCallHistory[FTM_HISTORY_NUM][FTM_NUM_TYPES];
+	// Allocations profiler statistics
+	static U64				sAllocs[FTM_NUM_TYPES];
+	static U64				sAllocBytes[FTM_NUM_TYPES];
+	static U64				sAllocAverage[FTM_NUM_TYPES];
+	static U64				sAllocBytesAverage[FTM_NUM_TYPES];
+	static U64				sAllocHistory[FTM_HISTORY_NUM][FTM_NUM_TYPES];
+	static U64				sAllocBytesHistory[FTM_HISTORY_NUM][FTM_NUM_TYPES];
 };
 
 #endif 	// LL_FAST_TIMERS_ENABLED
@@ -34,6 +34,9 @@
 
 #include "llmemory.h"
 
+#include <atomic>
+
+#include "llfasttimer.h"
 #include "llsys.h"
 
 #if LL_JEMALLOC
@@ -70,6 +73,17 @@ U32 LLMemory::sAllocatedMemInKB = 0;
 U32 LLMemory::sAllocatedPageSizeInKB = 0;
 bool LLMemory::sFailedAllocation = false;
 bool LLMemory::sFailedAllocationOnce = false;
+bool LLMemory::sAllocProfiling = false;
+
+// Allocations profiler per-tag counters (updated from any thread).
+static std::atomic<U64> sTagAllocs[LL_ALLOC_NUM_TAGS];
+static std::atomic<U64> sTagBytes[LL_ALLOC_NUM_TAGS];
+// Main thread only: totals at the end of the previous frame, and last frame
+// deltas.
+static U64 sTagLastAllocs[LL_ALLOC_NUM_TAGS];
+static U64 sTagLastBytes[LL_ALLOC_NUM_TAGS];
+static U64 sTagFrameAllocs[LL_ALLOC_NUM_TAGS];
+static U64 sTagFrameBytes[LL_ALLOC_NUM_TAGS];
 #if LL_LINUX && !LL_JEMALLOC
 // Stats: number of successful malloc timming.
 static U32 sTrimmed = 0;
@@ -121,6 +135,65 @@ void LLMemory::allocationFailed(size_t size)
 	}
 }
 
+//static
+void LLMemory::recordAllocation(size_t size, U32 tag)
+{
+	if (tag < LL_ALLOC_NUM_TAGS)
+	{
+		sTagAllocs[tag].fetch_add(1, std::memory_order_relaxed);
+		sTagBytes[tag].fetch_add(size, std::memory_order_relaxed);
+	}
+#if LL_FAST_TIMERS_ENABLED
+	if (is_main_thread())
+	{
+		LLFastTimer::recordAllocation(size);
+	}
+#endif
+}
+
+//static
+void LLMemory::updateAllocStats()
+{
+	for (U32 i = 0; i < LL_ALLOC_NUM_TAGS; ++i)
+	{
+		U64 allocs = sTagAllocs[i].load(std::memory_order_relaxed);
+		U64 bytes = sTagBytes[i].load(std::memory_order_relaxed);
+		sTagFrameAllocs[i] = allocs - sTagLastAllocs[i];
+		sTagFrameBytes[i] = bytes - sTagLastBytes[i];
+		sTagLastAllocs[i] = allocs;
+		sTagLastBytes[i] = bytes;
+	}
+}
+
+//static
+const char* LLMemory::getAllocTagName(U32 tag)
+{
+	static const char* names[] =
+	{
+		"MEM_ALIGNED",
+		"MEM_ALIGNED_16",
+		"MEM_IMAGE",
+		"MEM_VOLUME_16",
+		"MEM_VOLUME_64"
+	};
+	return tag < LL_ALLOC_NUM_TAGS ? names[tag] : "UNKNOWN";
+}
+
+//static
+void LLMemory::getAllocStats(U32 tag, U64& frame_count, U64& frame_bytes,
+							 U64& total_count, U64& total_bytes)
+{
+	if (tag >= LL_ALLOC_NUM_TAGS)
+	{
+		frame_count = frame_bytes = total_count = total_bytes = 0;
+		return;
+	}
+	frame_count = sTagFrameAllocs[tag];
+	frame_bytes = sTagFrameBytes[tag];
+	total_count = sTagAllocs[tag].load(std::memory_order_relaxed);
+	total_bytes = sTagBytes[tag].load(std::memory_order_relaxed);
+}
+
 //static
 void LLMemory::updateMemoryInfo(bool trim_heap)
 {
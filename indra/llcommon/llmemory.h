@@ -68,6 +68,33 @@ void ll_assert_aligned_error();
 # define ll_assert_aligned(ptr,alignment)
 #endif
 
+// Memory pools/allocation types tags for the allocations profiler. These
+// match the Tracy memory logging names (see hbtracy.h).
+enum ELLAllocTag : U32
+{
+	LL_ALLOC_ALIGNED,
+	LL_ALLOC_ALIGNED_16,
+	LL_ALLOC_IMAGE,
+	// Only builds using jemalloc will see those used/reported (they will
+	// appear as aligned memory types for the other builds):
+	LL_ALLOC_VOLUME,
+	LL_ALLOC_VOLUME_64,
+
+	LL_ALLOC_NUM_TAGS
+};
+
+// Accounts for an allocation in the allocations profiler, when enabled. This
+// only costs a (well predicted) test on a static boolean when disabled.
+#define LL_PROFILE_ALLOC(ptr, size, tag) \
+	do \
+	{ \
+		if (LL_UNLIKELY(LLMemory::sAllocProfiling) && (ptr)) \
+		{ \
+			LLMemory::recordAllocation(size, tag); \
+		} \
+	} \
+	while (0)
+
 // Purely static class
 class LLMemory
 {
@@ -118,6 +145,34 @@ public:
 
 	static std::string getInfo();
 
+	// Allocations profiler. When enabled, all allocations done via the
+	// viewer custom allocators (ll_aligned_*(), image and volume memory) are
+	// counted, both per tag and per fast timer (the latter for the main
+	// thread only, against the innermost running timer).
+	LL_INLINE static void setAllocProfiling(bool enable)
+	{
+		sAllocProfiling = enable;
+	}
+
+	LL_INLINE static bool allocProfiling()		{ return sAllocProfiling; }
+
+	// Do not call directly: use the LL_PROFILE_ALLOC() macro instead.
+	static void recordAllocation(size_t size, U32 tag);
+
+	// Must be called from the main thread, once per frame; computes the per-
+	// tag statistics for the last frame.
+	static void updateAllocStats();
+
+	static const char* getAllocTagName(U32 tag);
+	// Last frame and total (since profiling was enabled) statistics.
+	static void getAllocStats(U32 tag, U64& frame_count, U64& frame_bytes,
+							  U64& total_count, U64& total_bytes);
+
+public:
+	// Public for speed in LL_PROFILE_ALLOC(); use setAllocProfiling() to
+	// change it.
+	static bool sAllocProfiling;
+
 private:
 	static bool sFailedAllocation;
 	static bool sFailedAllocationOnce;
@@ -169,6 +224,7 @@ LL_INLINE void* ll_aligned_malloc_16(size_t size, bool track_failure = true)
 	}
 
 	LL_TRACY_ALLOC(ptr, size, trc_mem_align16);
+	LL_PROFILE_ALLOC(ptr, size, LL_ALLOC_ALIGNED_16);
 
 	return ptr;
 }
@@ -218,6 +274,7 @@ LL_INLINE void* ll_aligned_realloc_16(void* ptr, size_t size, size_t old_size)
 			free(ptr);
 		}
 		LL_TRACY_ALLOC(ret, size, trc_mem_align16);
+		LL_PROFILE_ALLOC(ret, size, LL_ALLOC_ALIGNED_16);
 		return ret;
 	}
 	LLMemory::allocationFailed(size);
@@ -228,6 +285,7 @@ LL_INLINE void* ll_aligned_realloc_16(void* ptr, size_t size, size_t old_size)
 		LLMemory::allocationFailed(size);
 	}
 	LL_TRACY_ALLOC(ret, size, trc_mem_align16);
+	LL_PROFILE_ALLOC(ret, size, LL_ALLOC_ALIGNED_16);
 	return ret;
 }
 
@@ -258,6 +316,7 @@ LL_INLINE void* ll_aligned_malloc(size_t size, int align)
 	}
 
 	LL_TRACY_ALLOC(addr, size, trc_mem_align);
+	LL_PROFILE_ALLOC(addr, size, LL_ALLOC_ALIGNED);
 
 	return addr;
 }
@@ -33,28 +33,25 @@
 
 #include "linden_common.h"
 
+#include <thread>
+
 #include "llstringtable.h"
 
 LLStringTable gStringTable(32768);
 
 // Helper function
-static U32 make_hash(const char* str, U32 max_entries)
+static U32 make_hash(const char* str)
 {
-	U32 retval = 0;
-	if (*str)
-	{
-		retval = digest64to32(HBXXH64::digest(str));
-	}
-	// max_entries is guaranteed to be a power of 2
-	return retval & (max_entries - 1);
+	return *str ? digest64to32(HBXXH64::digest(str)) : 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // LLStringTableEntry class
 ///////////////////////////////////////////////////////////////////////////////
 
-LLStringTableEntry::LLStringTableEntry(const char* str)
+LLStringTableEntry::LLStringTableEntry(const char* str, U32 hash)
 :	mString(NULL),
+	mHash(hash),
 	mCount(1)
 {
 	// Copy string
@@ -79,8 +76,16 @@ LLStringTableEntry::~LLStringTableEntry()
 // LLStringTable class
 ///////////////////////////////////////////////////////////////////////////////
 
+// Key of a string in the overflow map, truncated like the entries strings.
+static std::string overflow_key(const char* str)
+{
+	return std::string(str, strnlen(str, MAX_STRINGS_LENGTH - 1));
+}
+
 LLStringTable::LLStringTable(S32 tablesize)
-:	mUniqueEntries(0)
+:	mUniqueEntries(0),
+	mOverflowEntries(0),
+	mPendingInserts(0)
 {
 	if (tablesize <= 0)
 	{
@@ -104,65 +109,90 @@ LLStringTable::LLStringTable(S32 tablesize)
 	}
 	mMaxEntries = tablesize;
 
-	// Allocate strings
-	mStringList = new string_list_ptr_t[mMaxEntries];
-	// Clear strings
-	for (U32 i = 0; i < mMaxEntries; ++i)
+	// Allocate and clear the slots
+	U32 slots = mMaxEntries * 2;
+	mSlotsMask = slots - 1;
+	mSlots = new std::atomic<LLStringTableEntry*>[slots];
+	for (U32 i = 0; i < slots; ++i)
 	{
-		mStringList[i] = NULL;
+		mSlots[i].store(NULL, std::memory_order_relaxed);
 	}
 }
 
 LLStringTable::~LLStringTable()
 {
-	if (mStringList)
+	if (mSlots)
 	{
-		for (U32 i = 0; i < mMaxEntries; ++i)
+		for (U32 i = 0; i <= mSlotsMask; ++i)
 		{
-			if (mStringList[i])
+			LLStringTableEntry* entry =
+				mSlots[i].load(std::memory_order_relaxed);
+			if (entry)
 			{
-				for (string_list_t::iterator iter = mStringList[i]->begin(),
-											 end = mStringList[i]->end();
-					 iter != end; ++iter)
-				{
-					LLStringTableEntry* entry = *iter;
-					if (entry)
-					{
-						delete entry;
-					}
-				}
-				delete mStringList[i];
+				delete entry;
 			}
 		}
-		delete[] mStringList;
-		mStringList = NULL;
+		delete[] mSlots;
+		mSlots = NULL;
 	}
+	for (overflow_map_t::iterator it = mOverflow.begin(),
+								  end = mOverflow.end();
+		 it != end; ++it)
+	{
+		delete it->second;
+	}
+	mOverflow.clear();
 }
 
-LLStringTableEntry* LLStringTable::checkStringEntry(const char* str)
+LLStringTableEntry* LLStringTable::checkSlotEntry(const char* str, U32 hash)
 {
-	if (str)
+	for (U32 i = hash & mSlotsMask, probes = 0; probes <= mSlotsMask;
+		 i = (i + 1) & mSlotsMask, ++probes)
 	{
-		U32 hash_value = make_hash(str, mMaxEntries);
-		string_list_t* strlist = mStringList[hash_value];
-		if (strlist)
+		LLStringTableEntry* entry = mSlots[i].load(std::memory_order_acquire);
+		if (!entry)
 		{
-			for (string_list_t::iterator iter = strlist->begin(),
-										 end = strlist->end();
-										 iter != end; ++iter)
-			{
-				LLStringTableEntry* entry = *iter;
-				char* ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					return entry;
-				}
-			}
+			break;
+		}
+		if (entry->mHash == hash &&
+			!strncmp(entry->mString, str, MAX_STRINGS_LENGTH))
+		{
+			return entry;
 		}
 	}
 	return NULL;
 }
 
+LLStringTableEntry* LLStringTable::checkStringEntry(const char* str)
+{
+	if (!str)
+	{
+		return NULL;
+	}
+	LLStringTableEntry* entry = checkSlotEntry(str, make_hash(str));
+	if (!entry && mOverflowEntries)
+	{
+		entry = checkOverflowEntry(str);
+	}
+	return entry;
+}
+
+// Reserves a slot for a new entry; returns false when all the slots we may
+// use are already reserved. Reserved slots are never given back, so that
+// once the table is full, it stays full.
+bool LLStringTable::reserveSlot()
+{
+	U32 reserved = mUniqueEntries.load();
+	while (reserved < mMaxEntries)
+	{
+		if (mUniqueEntries.compare_exchange_weak(reserved, reserved + 1))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 LLStringTableEntry* LLStringTable::addStringEntry(const char* str)
 {
 	if (!str)
@@ -170,77 +200,142 @@ LLStringTableEntry* LLStringTable::addStringEntry(const char* str)
 		return NULL;
 	}
 
-	U32 hash_value = make_hash(str, mMaxEntries);
-	string_list_t* strlist = mStringList[hash_value];
-	if (strlist)
+	U32 hash = make_hash(str);
+	LLStringTableEntry* newentry = NULL;
+	for (U32 i = hash & mSlotsMask, probes = 0; probes <= mSlotsMask;
+		 i = (i + 1) & mSlotsMask, ++probes)
 	{
-		for (string_list_t::iterator iter = strlist->begin(),
-									 end = strlist->end();
-			 iter != end; ++iter)
+		LLStringTableEntry* entry = mSlots[i].load(std::memory_order_acquire);
+		if (!entry)
+		{
+			if (!newentry)
+			{
+				// Count ourselves as pending before reserving, so that
+				// addOverflowEntry() cannot miss our insertion.
+				++mPendingInserts;
+				if (!reserveSlot())
+				{
+					// All the slots we may use are reserved: use the overflow
+					// map instead.
+					--mPendingInserts;
+					return addOverflowEntry(str, hash);
+				}
+				newentry = new LLStringTableEntry(str, hash);
+			}
+			if (mSlots[i].compare_exchange_strong(entry, newentry,
+												  std::memory_order_acq_rel,
+												  std::memory_order_acquire))
+			{
+				--mPendingInserts;
+				LL_DEBUGS("StringTable") << mUniqueEntries << "/"
+										 << mMaxEntries << " unique entries."
+										 << LL_ENDL;
+				return newentry;
+			}
+			// Another thread just filled this slot, and 'entry' now points to
+			// its entry: check whether it is for the same string.
+		}
+		if (entry->mHash == hash &&
+			!strncmp(entry->mString, str, MAX_STRINGS_LENGTH))
 		{
-			LLStringTableEntry* entry = *iter;
-			char* entry_str = entry->mString;
-			if (!strncmp(entry_str, str, MAX_STRINGS_LENGTH))
+			entry->incCount();
+			if (newentry)
 			{
-				entry->incCount();
-				return entry;
+				// Lost the race against another thread adding this string:
+				// our reserved slot stays unused.
+				delete newentry;
+				--mPendingInserts;
 			}
+			return entry;
 		}
 	}
-	else
+
+	// Cannot normally happen, since there are twice as many slots as the
+	// maximum number of entries.
+	if (newentry)
 	{
-		strlist = new string_list_t;
-		mStringList[hash_value] = strlist;
+		delete newentry;
+		--mPendingInserts;
 	}
+	return addOverflowEntry(str, hash);
+}
 
-	// Not found, so add !
-	if (++mUniqueEntries > mMaxEntries)
+void LLStringTable::removeString(const char* str)
+{
+	if (!str || (mOverflowEntries && removeOverflowString(str)))
 	{
-		llerrs << "String table too small to store a new entry: "
-			   << mMaxEntries << " stored." << llendl;
+		return;
 	}
+	LLStringTableEntry* entry = checkStringEntry(str);
+	if (!entry)
+	{
+		return;
+	}
+	if (entry->mCount.fetch_sub(1) <= 0)
+	{
+		++entry->mCount;
+		llwarns << "Trying to remove too many strings !" << llendl;
+	}
+	// Note: the entry is kept in the table, even when its count reached zero
+	// (see the comment in llstringtable.h).
+}
 
-	LLStringTableEntry* newentry = new LLStringTableEntry(str);
-	strlist->push_front(newentry);
-	LL_DEBUGS("StringTable") << mUniqueEntries << "/" << mMaxEntries
-							 << " unique entries." << LL_ENDL;
-	return newentry;
+LLStringTableEntry* LLStringTable::checkOverflowEntry(const char* str)
+{
+	LLMutexLock lock(mOverflowMutex);
+	overflow_map_t::iterator it = mOverflow.find(overflow_key(str));
+	return it != mOverflow.end() ? it->second : NULL;
 }
 
-void LLStringTable::removeString(const char* str)
+LLStringTableEntry* LLStringTable::addOverflowEntry(const char* str, U32 hash)
 {
-	if (!str)
+	LLMutexLock lock(mOverflowMutex);
+
+	// Wait for the threads which reserved a slot before the table got full
+	// to fill it: the slots then cannot change any more, and we may check
+	// whether one of these threads just added our string there.
+	while (mPendingInserts)
 	{
-		return;
+		std::this_thread::yield();
+	}
+	LLStringTableEntry* slot_entry = checkSlotEntry(str, hash);
+	if (slot_entry)
+	{
+		slot_entry->incCount();
+		return slot_entry;
 	}
 
-	U32 hash_value = make_hash(str, mMaxEntries);
-	string_list_t* strlist = mStringList[hash_value];
-	if (!strlist)
+	LLStringTableEntry*& entry = mOverflow[overflow_key(str)];
+	if (entry)
 	{
-		return;
+		entry->incCount();
+		return entry;
 	}
+	llwarns_once << "String table full (" << mMaxEntries
+				 << " entries): using the overflow map." << llendl;
+	entry = new LLStringTableEntry(str, hash);
+	++mOverflowEntries;
+	return entry;
+}
 
-	for (string_list_t::iterator iter = strlist->begin(), end = strlist->end();
-		 iter != end; ++iter)
+// Returns true when 'str' was found in the overflow map.
+bool LLStringTable::removeOverflowString(const char* str)
+{
+	LLMutexLock lock(mOverflowMutex);
+	overflow_map_t::iterator it = mOverflow.find(overflow_key(str));
+	if (it == mOverflow.end())
 	{
-		LLStringTableEntry* entry = *iter;
-		char* entry_str = entry->mString;
-		if (!strncmp(entry_str, str, MAX_STRINGS_LENGTH))
-		{
-			if (!entry->decCount())
-			{
-				if (!mUniqueEntries)
-				{
-					llerrs << "Trying to remove too many strings !" << llendl;
-				}
-				--mUniqueEntries;
-				strlist->remove(entry);
-				delete entry;
-			}
-			return;
-		}
+		return false;
+	}
+	LLStringTableEntry* entry = it->second;
+	if (entry->mCount.fetch_sub(1) <= 0)
+	{
+		++entry->mCount;
+		llwarns << "Trying to remove too many strings !" << llendl;
 	}
+	// Note: like for the slots, the entry is kept even when its count reached
+	// zero, since checkStringEntry() callers may still hold it.
+	return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -34,11 +34,13 @@
 #ifndef LL_STRING_TABLE_H
 #define LL_STRING_TABLE_H
 
+#include <atomic>
 #include <list>
 #include <set>
 
 #include "hbfastmap.h"
 #include "hbxxh.h"
+#include "llmutex.h"
 
 constexpr U32 MAX_STRINGS_LENGTH = 256;
 
@@ -49,19 +51,32 @@ constexpr U32 MAX_STRINGS_LENGTH = 256;
 class LLStringTableEntry
 {
 public:
-	LLStringTableEntry(const char* str);
+	LLStringTableEntry(const char* str, U32 hash);
 	~LLStringTableEntry();
 
 	LL_INLINE void incCount()		{ ++mCount; }
 	LL_INLINE bool decCount()		{ return --mCount != 0; }
 
 public:
-	char*	mString;
-	S32		mCount;
+	char*				mString;
+	U32					mHash;
+	std::atomic<S32>	mCount;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 // LLStringTable class
+//
+// This is an open addressing hash table which may be used from any thread:
+// looking up an existing string never blocks (and never takes any lock), and
+// inserting a new string only involves a compare-and-swap on its slot. For
+// this to work, entries are never moved nor removed from the table before it
+// gets destroyed: removeString() only decrements the reference count of the
+// string entry (which gets "resurrected" by any later addString() call).
+// Once all the slots got reserved, new strings go to a mutex-protected
+// overflow map. Its entries are never freed either, since checkStringEntry()
+// callers keep the returned pointers without holding any lock. A string is
+// always stored only once, either in the slots or in the overflow map, so
+// that its entry pointer may be used as its identity (see LLXMLNode).
 ///////////////////////////////////////////////////////////////////////////////
 
 class LLStringTable
@@ -112,13 +127,37 @@ public:
 
 	void removeString(const char* str);
 
+	// Number of strings stored in the overflow map.
+	LL_INLINE U32 getOverflowEntries() const	{ return mOverflowEntries; }
+
+private:
+	LLStringTableEntry* checkSlotEntry(const char* str, U32 hash);
+	bool reserveSlot();
+	LLStringTableEntry* checkOverflowEntry(const char* str);
+	LLStringTableEntry* addOverflowEntry(const char* str, U32 hash);
+	bool removeOverflowString(const char* str);
+
 public:
-	U32					mMaxEntries;
-	U32					mUniqueEntries;
+	U32									mMaxEntries;
+	// Number of reserved slots. It never decreases, so that once it reached
+	// mMaxEntries, the slots cannot change any more. A few of these may stay
+	// unused, after insertion races lost against another thread adding the
+	// same string.
+	std::atomic<U32>					mUniqueEntries;
 
-	typedef std::list<LLStringTableEntry*> string_list_t;
-	typedef string_list_t* string_list_ptr_t;
-	string_list_ptr_t*	mStringList;
+private:
+	// Twice mMaxEntries slots, to keep the probe sequences short.
+	std::atomic<LLStringTableEntry*>*	mSlots;
+	U32									mSlotsMask;
+
+	// Strings which did not fit in the slots, keyed by their (possibly
+	// truncated) text.
+	typedef fast_hmap<std::string, LLStringTableEntry*> overflow_map_t;
+	overflow_map_t						mOverflow;
+	LLMutex								mOverflowMutex;
+	std::atomic<U32>					mOverflowEntries;
+	// Number of threads holding a reserved slot they did not fill yet.
+	std::atomic<U32>					mPendingInserts;
 };
 
 extern LLStringTable gStringTable;
@@ -165,6 +165,9 @@ void LLThread::threadRun()
 	}
 	tracy::SetThreadName(mThreadName);
 #endif
+#if LL_TRACE_CAPTURE
+	LLTraceCapture::setThreadName(mName);
+#endif
 
 	mID = tThreadId;
 	llinfos << "Running thread " << mName << " with Id: " << mID << llendl;
@@ -170,6 +170,10 @@ void LLThreadPool::run(const std::string& name)
 {
 	llinfos << "Starting thread: " << name << llendl;
 
+#if LL_TRACE_CAPTURE
+	LLTraceCapture::setThreadName(name);
+#endif
+
 	mThreadNamesMutex.lock();
 #if TRACY_ENABLE
 	if (!mThreadPoolName)
@@ -0,0 +1,219 @@
+/**
+ * @file lltracecapture.cpp
+ * @brief Lightweight per-thread zones capture, dumped as Chrome traces.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#if LL_TRACE_CAPTURE
+
+#include <mutex>
+#include <vector>
+
+#include "lltracecapture.h"
+
+#include "llfile.h"
+
+namespace
+{
+	struct TraceEvent
+	{
+		const char*	mName;
+		U64			mStart;
+		U64			mEnd;
+	};
+
+	// Ring buffer owned by a thread: only that thread writes to it, and the
+	// dumping thread only reads the events published via mHead.
+	struct ThreadBuffer
+	{
+		ThreadBuffer(U32 id, const std::string& name)
+		:	mId(id),
+			mName(name),
+			mHead(0)
+		{
+		}
+
+		U32						mId;
+		std::string				mName;		// Protected by sBuffersMutex
+		std::atomic<U32>		mHead;
+		TraceEvent				mEvents[LLTraceCapture::RING_SIZE];
+	};
+
+	// The buffers are kept till the program exits, so that the zones of the
+	// threads which already exited are still dumped.
+	std::mutex sBuffersMutex;
+	std::vector<ThreadBuffer*> sBuffers;
+
+	thread_local ThreadBuffer* tBuffer = NULL;
+	thread_local std::string tThreadName;
+
+	ThreadBuffer* register_thread()
+	{
+		std::lock_guard<std::mutex> lock(sBuffersMutex);
+		U32 id = sBuffers.size() + 1;
+		if (tThreadName.empty())
+		{
+			tThreadName = llformat("Thread %u", id);
+		}
+		tBuffer = new ThreadBuffer(id, tThreadName);
+		sBuffers.push_back(tBuffer);
+		return tBuffer;
+	}
+
+	void json_escape(std::string& str)
+	{
+		std::string escaped;
+		escaped.reserve(str.size());
+		for (size_t i = 0, count = str.size(); i < count; ++i)
+		{
+			char c = str[i];
+			if (c == '"' || c == '\\')
+			{
+				escaped += '\\';
+			}
+			else if ((U8)c < 32)
+			{
+				c = ' ';
+			}
+			escaped += c;
+		}
+		str.swap(escaped);
+	}
+}
+
+//static
+std::atomic<bool> LLTraceCapture::sEnabled(false);
+
+//static
+void LLTraceCapture::setEnabled(bool enable)
+{
+	if (enable != enabled())
+	{
+		sEnabled.store(enable, std::memory_order_relaxed);
+		llinfos << "Trace capture " << (enable ? "enabled." : "disabled.")
+				<< llendl;
+	}
+}
+
+//static
+void LLTraceCapture::setThreadName(const std::string& name)
+{
+	tThreadName = name;
+	if (tBuffer)
+	{
+		std::lock_guard<std::mutex> lock(sBuffersMutex);
+		tBuffer->mName = name;
+	}
+}
+
+//static
+void LLTraceCapture::record(const char* name, U64 start, U64 end)
+{
+	ThreadBuffer* bufferp = tBuffer;
+	if (LL_UNLIKELY(!bufferp))
+	{
+		bufferp = register_thread();
+	}
+	U32 head = bufferp->mHead.load(std::memory_order_relaxed);
+	TraceEvent& event = bufferp->mEvents[head & (RING_SIZE - 1)];
+	event.mName = name;
+	event.mStart = start;
+	event.mEnd = end;
+	bufferp->mHead.store(head + 1, std::memory_order_release);
+}
+
+//static
+bool LLTraceCapture::dump(const std::string& filename)
+{
+	llofstream file(filename.c_str());
+	if (!file.is_open())
+	{
+		llwarns << "Could not open file for writing: " << filename << llendl;
+		return false;
+	}
+
+	// The oldest events of each ring may get overwritten while we read them;
+	// skip a few of them to avoid dumping torn events.
+	constexpr U32 MAX_EVENTS = RING_SIZE - RING_SIZE / 16;
+
+	U32 total = 0;
+	file << "{\"traceEvents\":[";
+	bool first = true;
+	std::lock_guard<std::mutex> lock(sBuffersMutex);
+	for (size_t i = 0, count = sBuffers.size(); i < count; ++i)
+	{
+		ThreadBuffer* bufferp = sBuffers[i];
+
+		std::string name = bufferp->mName;
+		json_escape(name);
+		if (!first)
+		{
+			file << ",";
+		}
+		first = false;
+		file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+			 << bufferp->mId << ",\"args\":{\"name\":\"" << name << "\"}}";
+
+		U32 head = bufferp->mHead.load(std::memory_order_acquire);
+		U32 events = llmin(head, MAX_EVENTS);
+		for (U32 j = head - events; j != head; ++j)
+		{
+			const TraceEvent& event = bufferp->mEvents[j & (RING_SIZE - 1)];
+			if (!event.mName || event.mEnd < event.mStart)
+			{
+				continue;
+			}
+			file << ",\n{\"name\":\"" << event.mName
+				 << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << bufferp->mId
+				 << ",\"ts\":" << event.mStart << ",\"dur\":"
+				 << event.mEnd - event.mStart << "}";
+			++total;
+		}
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	file.close();
+
+	llinfos << "Dumped " << total << " zones for " << sBuffers.size()
+			<< " threads into: " << filename << llendl;
+	return true;
+}
+
+#else	// LL_TRACE_CAPTURE
+
+// To avoid the LNK4221 warning under Windows while compiling...
+# if LL_WINDOWS && !LL_CLANG
+namespace
+{
+	void* dummy;
+}
+# endif
+
+#endif	// LL_TRACE_CAPTURE
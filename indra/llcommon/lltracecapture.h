@@ -0,0 +1,122 @@
+/**
+ * @file lltracecapture.h
+ * @brief Lightweight per-thread zones capture, dumped as Chrome traces.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRACECAPTURE_H
+#define LL_LLTRACECAPTURE_H
+
+#if LL_TRACE_CAPTURE
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "llpreprocessor.h"
+#include "stdtypes.h"
+
+// Post-mortem timeline capture, not needing any Tracy server connection. The
+// LL_FAST_TIMER(), LL_FAST_TIMERS() and LL_TRACY_TIMER() zones (see hbtracy.h)
+// are recorded, while the capture is enabled, into a per-thread ring buffer
+// which only the owning thread writes to (no lock is taken when recording).
+// The buffers of all the threads may then be dumped at any time into a Chrome
+// trace events JSON file, that can be loaded in chrome://tracing or in the
+// Perfetto UI (https://ui.perfetto.dev/).
+
+class LLTraceCapture
+{
+public:
+	// Number of zones kept per thread; must be a power of 2.
+	static constexpr U32 RING_SIZE = 16384;
+
+	LL_INLINE static bool enabled()
+	{
+		return sEnabled.load(std::memory_order_relaxed);
+	}
+
+	static void setEnabled(bool enable);
+
+	// Names the calling thread in the dumped traces.
+	static void setThreadName(const std::string& name);
+
+	// Time stamp in microseconds, for use with record().
+	LL_INLINE static U64 now()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Records a zone for the calling thread. 'name' must be a string literal
+	// (or at least outlive the capture buffers).
+	static void record(const char* name, U64 start, U64 end);
+
+	// Writes the zones captured so far by all threads into 'filename'.
+	// Returns false on failure to open the file.
+	static bool dump(const std::string& filename);
+
+private:
+	static std::atomic<bool> sEnabled;
+};
+
+// Scoped zone, as used by the timers macros in hbtracy.h.
+class LLTraceZone
+{
+public:
+	LL_INLINE LLTraceZone(const char* name)
+	:	mName(LLTraceCapture::enabled() ? name : NULL)
+	{
+		if (mName)
+		{
+			mStart = LLTraceCapture::now();
+		}
+	}
+
+	LL_INLINE ~LLTraceZone()
+	{
+		if (mName)
+		{
+			LLTraceCapture::record(mName, mStart, LLTraceCapture::now());
+		}
+	}
+
+private:
+	const char*	mName;
+	U64			mStart;
+};
+
+# define LL_TRACE_ZONE(name) LLTraceZone trc_##name(#name)
+
+#else	// LL_TRACE_CAPTURE
+
+# define LL_TRACE_ZONE(name)
+
+#endif	// LL_TRACE_CAPTURE
+
+#endif	// LL_LLTRACECAPTURE_H
@@ -412,6 +412,7 @@ LL_INLINE void* allocate_texture_mem(size_t size)
 	addr = malloc(size);
 #endif
 	LL_TRACY_ALLOC(addr, size, trc_mem_image);
+	LL_PROFILE_ALLOC(addr, size, LL_ALLOC_IMAGE);
 
 	if (LL_UNLIKELY(addr == NULL))
 	{
@@ -107,6 +107,10 @@ constexpr int HTTP_CONNECTION_LIMIT_MAX = 256;
 constexpr long HTTP_PIPELINING_DEFAULT = 0L;
 constexpr long HTTP_PIPELINING_MAX = 20L;
 
+// HTTP/2 multiplexing limits (streams per connection)
+constexpr long HTTP_HTTP2_STREAMS_DEFAULT = 0L;
+constexpr long HTTP_HTTP2_STREAMS_MAX = 100L;
+
 // Miscellaneous defaults
 constexpr bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 constexpr long HTTP_THROTTLE_RATE_DEFAULT = 0L;
@@ -114,8 +118,15 @@ constexpr long HTTP_THROTTLE_RATE_DEFAULT = 0L;
 // Tuning parameters
 
 // Time worker thread sleeps after a pass through the request, ready and active
-// queues.
+// queues, when the policy layer has time-based work pending (retries,
+// throttling) or with the legacy (non event-driven) service loop. With the
+// event-driven loop, the wait is interrupted by network activity or new
+// requests.
 constexpr int HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS = 2;
+
+// Maximum time the event-driven worker thread waits for network activity on
+// the active requests (or for a new request) before running a new pass.
+constexpr int HTTP_SERVICE_LOOP_WAIT_MAX_MS = 100;
 }
 
 #endif	// _LLCORE_HTTP_INTERNAL_H_
@@ -34,6 +34,7 @@
 #include "llcorehttppolicy.h"
 #include "llcoremutex.h"
 #include "llhttpconstants.h"
+#include "lltimer.h"
 
 namespace
 {
@@ -47,13 +48,19 @@ namespace LLCore
 {
 U64 HttpLibcurl::sDownloadedBytes = 0;
 U64 HttpLibcurl::sUploadedBytes = 0;
+U64 HttpLibcurl::sCompletedRequests = 0;
+U64 HttpLibcurl::sHttp2Streams = 0;
+U64 HttpLibcurl::sNewConnections = 0;
 
 HttpLibcurl::HttpLibcurl(HttpService* service)
 :	mService(service),
 	mPolicyCount(0),
 	mMultiHandles(NULL),
+	mClassMultiHandles(NULL),
+	mSharedMultiHandle(NULL),
 	mActiveHandles(NULL),
-	mDirtyPolicy(NULL)
+	mDirtyPolicy(NULL),
+	mWakeupHandle(NULL)
 {
 }
 
@@ -73,21 +80,35 @@ void HttpLibcurl::shutdown()
 		cancelRequest(op);
 	}
 
+	{
+		LLCoreInt::HttpScopedLock lock(mWakeupMutex);
+		mWakeupHandle = NULL;
+	}
+
 	if (mMultiHandles)
 	{
 		for (int policy_class = 0; policy_class < mPolicyCount; ++policy_class)
 		{
-			CURLM* multi_handle(mMultiHandles[policy_class]);
+			CURLM* multi_handle(mClassMultiHandles[policy_class]);
 			if (multi_handle)
 			{
 				curl_multi_cleanup(multi_handle);
-				mMultiHandles[policy_class] = NULL;
+				mClassMultiHandles[policy_class] = NULL;
 			}
+			mMultiHandles[policy_class] = NULL;
+		}
+		if (mSharedMultiHandle)
+		{
+			curl_multi_cleanup(mSharedMultiHandle);
+			mSharedMultiHandle = NULL;
 		}
 
 		delete[] mMultiHandles;
 		mMultiHandles = NULL;
 
+		delete[] mClassMultiHandles;
+		mClassMultiHandles = NULL;
+
 		delete[] mActiveHandles;
 		mActiveHandles = NULL;
 
@@ -105,12 +126,15 @@ void HttpLibcurl::start(int policy_count)
 
 	mPolicyCount = policy_count;
 	mMultiHandles = new CURLM*[mPolicyCount];
+	mClassMultiHandles = new CURLM*[mPolicyCount];
 	mActiveHandles = new int[mPolicyCount];
 	mDirtyPolicy = new bool[mPolicyCount];
 
 	for (int policy_class = 0; policy_class < mPolicyCount; ++policy_class)
 	{
-		if ((mMultiHandles[policy_class] = curl_multi_init()) != NULL)
+		mClassMultiHandles[policy_class] = curl_multi_init();
+		mMultiHandles[policy_class] = mClassMultiHandles[policy_class];
+		if (mMultiHandles[policy_class])
 		{
 			mActiveHandles[policy_class] = 0;
 			mDirtyPolicy[policy_class] = false;
@@ -122,6 +146,9 @@ void HttpLibcurl::start(int policy_count)
 			llassert(false);
 		}
 	}
+
+	LLCoreInt::HttpScopedLock lock(mWakeupMutex);
+	mWakeupHandle = mClassMultiHandles[0];
 }
 
 HttpService::ELoopSpeed HttpLibcurl::processTransport()
@@ -134,6 +161,7 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 	}
 
 	// Give libcurl some cycles to do I/O & callbacks
+	bool shared_done = false;
 	for (int policy_class = 0; policy_class < mPolicyCount; ++policy_class)
 	{
 		CURLM* multi_handle = mMultiHandles[policy_class];
@@ -159,6 +187,17 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 			continue;
 		}
 
+		if (multi_handle == mSharedMultiHandle)
+		{
+			// Only perform once per pass on the multi handle shared by the
+			// HTTP/2 policy classes.
+			if (shared_done)
+			{
+				continue;
+			}
+			shared_done = true;
+		}
+
 		int running;
 		CURLMcode status(CURLM_CALL_MULTI_PERFORM);
 		do
@@ -180,9 +219,10 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 
 				completeRequest(multi_handle, handle, result);
 				handle = NULL;			// No longer valid on return
-				// If anything completes, we may have a free slot.
-				ret = HttpService::NORMAL;
-				// Turning around quickly reduces connection gap by 7-10ms.
+				// If anything completes, we may have a free slot, so loop
+				// again immediately. Turning around quickly reduces
+				// connection gap by 7-10ms.
+				ret = HttpService::SPIN;
 			}
 			else if (msg->msg != CURLMSG_NONE)
 			{
@@ -193,13 +233,142 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 		}
 	}
 
-	if (!mActiveOps.empty())
+	if (ret != HttpService::SPIN && !mActiveOps.empty())
 	{
 		ret = HttpService::NORMAL;
 	}
 	return ret;
 }
 
+#if LIBCURL_VERSION_NUM >= 0x074400	// curl_multi_poll() needs v7.68.0+
+
+static void add_wait_fds(const fd_set& set, int max_fd, short events,
+						 std::vector<curl_waitfd>& fds)
+{
+	curl_waitfd wfd;
+	wfd.events = events;
+	wfd.revents = 0;
+# if LL_WINDOWS
+	// Under Windows, fd_set is an array of sockets, not a bit field.
+	for (u_int i = 0; i < set.fd_count; ++i)
+	{
+		wfd.fd = set.fd_array[i];
+		fds.push_back(wfd);
+	}
+# else
+	for (int fd = 0; fd <= max_fd; ++fd)
+	{
+		if (FD_ISSET(fd, &set))
+		{
+			wfd.fd = fd;
+			fds.push_back(wfd);
+		}
+	}
+# endif
+}
+
+void HttpLibcurl::waitForActivity(int max_wait_ms)
+{
+	if (!mClassMultiHandles || !mClassMultiHandles[0])
+	{
+		ms_sleep(max_wait_ms);
+		return;
+	}
+
+	// We can only poll on one multi handle (the own one of the first policy
+	// class), so we add the sockets of the other multi handles (including the
+	// shared HTTP/2 one) as extra file descriptors.
+	CURLM* poll_handle = mClassMultiHandles[0];
+	bool shared_done = false;
+	mWaitFds.clear();
+	fd_set read_fds, write_fds, exc_fds;
+	for (int policy_class = 0; policy_class < mPolicyCount; ++policy_class)
+	{
+		CURLM* multi_handle = mMultiHandles[policy_class];
+		if (!multi_handle || multi_handle == poll_handle ||
+			!mActiveHandles[policy_class])
+		{
+			continue;
+		}
+		if (multi_handle == mSharedMultiHandle)
+		{
+			if (shared_done)
+			{
+				continue;
+			}
+			shared_done = true;
+		}
+
+		// Honour this multi handle own timeouts (the polled one is taken
+		// care of by curl_multi_poll() itself).
+		long timeout = -1;
+		if (curl_multi_timeout(multi_handle, &timeout) == CURLM_OK &&
+			timeout >= 0 && timeout < max_wait_ms)
+		{
+			max_wait_ms = (int)timeout;
+		}
+
+		FD_ZERO(&read_fds);
+		FD_ZERO(&write_fds);
+		FD_ZERO(&exc_fds);
+		int max_fd = -1;
+		if (curl_multi_fdset(multi_handle, &read_fds, &write_fds, &exc_fds,
+							 &max_fd) != CURLM_OK)
+		{
+			max_wait_ms = llmin(max_wait_ms,
+								HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+			continue;
+		}
+		if (max_fd < 0)
+		{
+			// Active requests but no socket to wait on yet (e.g. name
+			// resolving in progress): do not wait for long.
+			max_wait_ms = llmin(max_wait_ms,
+								HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+			continue;
+		}
+		add_wait_fds(read_fds, max_fd, CURL_WAIT_POLLIN, mWaitFds);
+		add_wait_fds(write_fds, max_fd, CURL_WAIT_POLLOUT, mWaitFds);
+		add_wait_fds(exc_fds, max_fd, CURL_WAIT_POLLPRI, mWaitFds);
+	}
+
+	if (max_wait_ms <= 0)
+	{
+		return;
+	}
+
+	CURLMcode code = curl_multi_poll(poll_handle,
+									 mWaitFds.empty() ? NULL : mWaitFds.data(),
+									 mWaitFds.size(), max_wait_ms, NULL);
+	if (code != CURLM_OK)
+	{
+		check_curl_multi_code(code);
+		ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+	}
+}
+
+void HttpLibcurl::wakeup()
+{
+	LLCoreInt::HttpScopedLock lock(mWakeupMutex);
+	if (mWakeupHandle)
+	{
+		curl_multi_wakeup(mWakeupHandle);
+	}
+}
+
+#else	// Legacy libcurl: just sleep.
+
+void HttpLibcurl::waitForActivity(int max_wait_ms)
+{
+	ms_sleep(llmin(max_wait_ms, HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS));
+}
+
+void HttpLibcurl::wakeup()
+{
+}
+
+#endif
+
 // Caller has provided us with a ref count on op.
 void HttpLibcurl::addOp(const HttpOpRequest::ptr_t& op)
 {
@@ -300,11 +469,35 @@ bool HttpLibcurl::completeRequest(CURLM* multi_handle, CURL* handle,
 	double ubytes = 0;
 	CURLcode ccode = curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD, &dbytes);
 	CURLcode ccode2 = curl_easy_getinfo(handle, CURLINFO_SIZE_UPLOAD, &ubytes);
-	if (ccode == CURLE_OK || ccode2 == CURLE_OK)
+	long new_connections = 0;
+	if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS,
+						  &new_connections) != CURLE_OK)
+	{
+		new_connections = 0;
+	}
+	long http_version = 0;
+#if LIBCURL_VERSION_NUM >= 0x073200	// CURLINFO_HTTP_VERSION needs v7.50.0+
+	if (curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION,
+						  &http_version) != CURLE_OK)
+	{
+		http_version = 0;
+	}
+#endif
 	{
 		LLCoreInt::HttpScopedLock lock(sStatMutex);
-		sDownloadedBytes += dbytes;
-		sUploadedBytes += ubytes;
+		if (ccode == CURLE_OK || ccode2 == CURLE_OK)
+		{
+			sDownloadedBytes += dbytes;
+			sUploadedBytes += ubytes;
+		}
+		++sCompletedRequests;
+		sNewConnections += new_connections;
+#if LIBCURL_VERSION_NUM >= 0x073200
+		if (http_version == CURL_HTTP_VERSION_2_0)
+		{
+			++sHttp2Streams;
+		}
+#endif
 	}
 
 	HttpHandle ophandle = NULL;
@@ -457,13 +650,40 @@ void HttpLibcurl::policyUpdated(int policy_class)
 		// pipelined-to-non-pipelined transition that is fatal at the moment.
 
 		HttpPolicyClass& options(policy.getClassOptions(policy_class));
-		CURLM* multi_handle(mMultiHandles[policy_class]);
+		CURLM* multi_handle(mClassMultiHandles[policy_class]);
 		CURLMcode code;
 
 		// Enable policy if stalled
 		policy.stallPolicy(policy_class, false);
 		mDirtyPolicy[policy_class] = false;
 
+		if (options.mHttp2Streams > 0)
+		{
+			// Switch to the shared HTTP/2 multiplexing multi handle.
+			if (!mSharedMultiHandle)
+			{
+				mSharedMultiHandle = curl_multi_init();
+				if (!mSharedMultiHandle)
+				{
+					llwarns << "Failed to allocate the shared multi handle in libcurl. HTTP/2 multiplexing disabled for policy class: "
+							<< policy_class << llendl;
+					mMultiHandles[policy_class] = multi_handle;
+					return;
+				}
+			}
+			mMultiHandles[policy_class] = mSharedMultiHandle;
+			updateSharedMultiHandle();
+			return;
+		}
+
+		bool was_shared = mMultiHandles[policy_class] == mSharedMultiHandle;
+		mMultiHandles[policy_class] = multi_handle;
+		if (was_shared && mSharedMultiHandle)
+		{
+			// Limits of the shared multi handle may need to be lowered.
+			updateSharedMultiHandle();
+		}
+
 		if (options.mPipelining > 1)
 		{
 			// We will try to do pipelining on this multihandle
@@ -506,6 +726,59 @@ void HttpLibcurl::policyUpdated(int policy_class)
 	}
 }
 
+void HttpLibcurl::updateSharedMultiHandle()
+{
+	// The shared multi handle connections cache is dimensioned after the
+	// largest limits of the HTTP/2 policy classes using it: these classes
+	// share their connections, so summing their limits would defeat the
+	// purpose of the sharing.
+	HttpPolicy& policy(mService->getPolicy());
+	long per_host_limit = 0;
+	long total_limit = 0;
+	long streams = 0;
+	for (int policy_class = 0; policy_class < mPolicyCount; ++policy_class)
+	{
+		if (mMultiHandles[policy_class] != mSharedMultiHandle)
+		{
+			continue;
+		}
+		const HttpPolicyClass& options(policy.getClassOptions(policy_class));
+		per_host_limit = llmax(per_host_limit,
+							   long(options.mPerHostConnectionLimit));
+		total_limit = llmax(total_limit, long(options.mConnectionLimit));
+		streams = llmax(streams, options.mHttp2Streams);
+	}
+	if (!streams)
+	{
+		// No more class using it: leave it as is, for when a class would
+		// switch back to HTTP/2 multiplexing.
+		return;
+	}
+
+	// Multiplexing is the only mode ever set on the shared multi handle, so
+	// changing its limits while requests are active is safe (unlike what
+	// happens with pipelining transitions, see policyUpdated()).
+	CURLMcode code = curl_multi_setopt(mSharedMultiHandle, CURLMOPT_PIPELINING,
+									   CURLPIPE_MULTIPLEX);
+	check_curl_multi_code(code, CURLMOPT_PIPELINING);
+	code = curl_multi_setopt(mSharedMultiHandle, CURLMOPT_MAX_HOST_CONNECTIONS,
+							 per_host_limit);
+	check_curl_multi_code(code, CURLMOPT_MAX_HOST_CONNECTIONS);
+	code = curl_multi_setopt(mSharedMultiHandle,
+							 CURLMOPT_MAX_TOTAL_CONNECTIONS, total_limit);
+	check_curl_multi_code(code, CURLMOPT_MAX_TOTAL_CONNECTIONS);
+#if LIBCURL_VERSION_NUM >= 0x074300	// Needs v7.67.0+
+	code = curl_multi_setopt(mSharedMultiHandle,
+							 CURLMOPT_MAX_CONCURRENT_STREAMS, streams);
+	check_curl_multi_code(code, CURLMOPT_MAX_CONCURRENT_STREAMS);
+#endif
+	LL_DEBUGS("CoreHttp") << "Shared HTTP/2 multi handle limits: "
+						  << per_host_limit << " connections per host, "
+						  << total_limit << " connections in total, "
+						  << streams << " streams per connection."
+						  << LL_ENDL;
+}
+
 // ---------------------------------------
 // HttpLibcurl::HandleCache
 // ---------------------------------------
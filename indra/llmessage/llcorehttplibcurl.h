@@ -35,6 +35,7 @@
 #include "llcorehttpinternal.h"
 #include "llcorehttprequest.h"
 #include "llcorehttpservice.h"
+#include "llcoremutex.h"
 #include "llerror.h"
 #include "hbfastset.h"
 
@@ -75,6 +76,19 @@ public:
 	// Threading: called by worker thread.
 	HttpService::ELoopSpeed processTransport();
 
+	// Waits for network activity on the active requests of all the policy
+	// classes, for a wakeup() call, or for 'max_wait_ms' (or less when
+	// libcurl needs to be serviced sooner for its own timeouts).
+	//
+	// Threading: called by worker thread.
+	void waitForActivity(int max_wait_ms);
+
+	// Interrupts any ongoing waitForActivity() call, or causes the next one
+	// to return immediately.
+	//
+	// Threading: callable by any thread.
+	void wakeup();
+
 	// Add request to the active list. Caller is expected to have provided us
 	// with a reference count on the op to hold the request (no additional
 	// reference will be added).
@@ -134,6 +148,14 @@ public:
 	static LL_INLINE U64 getDownloadedBytes()	{ return sDownloadedBytes; }
 	static LL_INLINE U64 getUploadedBytes()		{ return sUploadedBytes; }
 
+	// Requests (and HTTP/2 streams) versus connections statistics: number of
+	// completed requests, how many of them were HTTP/2 streams, and how many
+	// new connections had to be opened for them (the others re-used an
+	// existing connection, be it via keep-alive or HTTP/2 multiplexing).
+	static LL_INLINE U64 getCompletedRequests()	{ return sCompletedRequests; }
+	static LL_INLINE U64 getHttp2Streams()		{ return sHttp2Streams; }
+	static LL_INLINE U64 getNewConnections()	{ return sNewConnections; }
+
 protected:
 	// Invoked when libcurl has indicated a request has been processed to
 	// completion and we need to move the request to a new state.
@@ -142,6 +164,10 @@ protected:
 	// Invoked to cancel an active request, mainly during shutdown and destroy.
 	void cancelRequest(const opReqPtr_t& op);
 
+	// Sets the options of the multi handle shared by the policy classes in
+	// HTTP/2 multiplexing mode, based on the options of all these classes.
+	void updateSharedMultiHandle();
+
 	// Simple request handle cache for libcurl.
 	//
 	// Handle creation is somewhat slow and chunky in libcurl and there's a
@@ -198,12 +224,33 @@ protected:
 	active_set_t		mActiveOps;
 
 	int					mPolicyCount;
-	CURLM**				mMultiHandles;	// One handle per policy class
+	// Multi handle in use for each policy class: either its own one (from
+	// mClassMultiHandles) or the shared one for HTTP/2 multiplexing classes.
+	CURLM**				mMultiHandles;
+	CURLM**				mClassMultiHandles;	// One owned handle per policy class
+	// Multi handle shared by all the policy classes in HTTP/2 multiplexing
+	// mode, so that they share a single connections cache and their requests
+	// to the same host get multiplexed over the same connections. Created on
+	// first use.
+	CURLM*				mSharedMultiHandle;
 	int*				mActiveHandles;	// Active count per policy class
 	bool*				mDirtyPolicy;	// Dirty policy update waiting for stall (per pc)
 
+	// Extra sockets to wait on, for the multi handles other than the own one
+	// of the first policy class, which is the one we poll on. Kept as a member to avoid
+	// re-allocations.
+	std::vector<curl_waitfd>	mWaitFds;
+
+	// The multi handle used for polling and wake-ups, protected by a mutex
+	// since wakeup() may be called by any thread (including during shutdown).
+	LLCoreInt::HttpMutex	mWakeupMutex;
+	CURLM*					mWakeupHandle;
+
 	static U64			sDownloadedBytes;
 	static U64			sUploadedBytes;
+	static U64			sCompletedRequests;
+	static U64			sHttp2Streams;
+	static U64			sNewConnections;
 };
 
 }  // End namespace LLCore
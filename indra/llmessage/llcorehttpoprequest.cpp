@@ -718,7 +718,28 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService* service)
 	{
 		xfer_timeout = timeout;
 	}
-	if (cpolicy.mPipelining > 1L)
+	if (cpolicy.mHttp2Streams > 0L)
+	{
+		// HTTP/2 multiplexing: the streams share the connections, so the
+		// transfers may get delayed by the other streams on the same
+		// connection, just like with pipelining.
+		xfer_timeout *= 2L;
+#if LIBCURL_VERSION_NUM >= 0x072f00
+		// Negotiate HTTP/2 via ALPN for HTTPS URLs only (plain HTTP requests
+		// stay HTTP/1.1, since HTTP/2 upgrades over clear text are seldom
+		// supported by servers and cost a round trip).
+		code = curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION,
+								CURL_HTTP_VERSION_2TLS);
+		check_curl_easy_code(code, CURLOPT_HTTP_VERSION);
+		// Wait for an existing connection to confirm whether it can do
+		// multiplexing rather than opening a new connection straight away:
+		// this is what allows to get several streams on a single connection
+		// when a burst of requests is issued to a new host.
+		code = curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+		check_curl_easy_code(code, CURLOPT_PIPEWAIT);
+#endif
+	}
+	else if (cpolicy.mPipelining > 1L)
 	{
 		// Pipelining affects both connection and transfer timeout values.
 		// Requests that are added to a pipeling immediately have completed
@@ -229,10 +229,22 @@ int HttpPolicy::processReadyQueue()
 
 		int active = transport.getActiveCountInClass(policy_class);
 		// Expect negatives here
-		int active_limit = state.mOptions.mPipelining > 1L ?
-								state.mOptions.mPerHostConnectionLimit *
-								state.mOptions.mPipelining :
-						 		state.mOptions.mConnectionLimit;
+		int active_limit;
+		if (state.mOptions.mHttp2Streams > 0L)
+		{
+			// HTTP/2 multiplexing: streams over the per-host connections
+			active_limit = state.mOptions.mPerHostConnectionLimit *
+						   state.mOptions.mHttp2Streams;
+		}
+		else if (state.mOptions.mPipelining > 1L)
+		{
+			active_limit = state.mOptions.mPerHostConnectionLimit *
+						   state.mOptions.mPipelining;
+		}
+		else
+		{
+			active_limit = state.mOptions.mConnectionLimit;
+		}
 		int needed = active_limit - active;	// Expect negatives here
 		if (needed > 0)
 		{
@@ -308,9 +320,11 @@ int HttpPolicy::processReadyQueue()
 		}
 
 	throttle_on:
-		if (!readyq.empty() || !retryq.empty())
+		// If anything is ready, continue looping... But when all the
+		// connection slots of this class are busy, there is no need to poll:
+		// a request completion will cause the service loop to spin again.
+		if (!retryq.empty() || (needed > 0 && !readyq.empty()))
 		{
-			// If anything is ready, continue looping...
 			result = HttpService::NORMAL;
 		}
 	}
@@ -37,6 +37,7 @@ HttpPolicyClass::HttpPolicyClass()
 	mPerHostConnectionLimit(HTTP_CONNECTION_LIMIT_DEFAULT),
 	mPipelining(HTTP_PIPELINING_DEFAULT),
 	mThrottleRate(HTTP_THROTTLE_RATE_DEFAULT),
+	mHttp2Streams(HTTP_HTTP2_STREAMS_DEFAULT),
 	mTrace(0L)
 {
 }
@@ -49,6 +50,7 @@ HttpPolicyClass& HttpPolicyClass::operator=(const HttpPolicyClass& other)
 		mPerHostConnectionLimit = other.mPerHostConnectionLimit;
 		mPipelining = other.mPipelining;
 		mThrottleRate = other.mThrottleRate;
+		mHttp2Streams = other.mHttp2Streams;
 		mTrace = other.mTrace;
 	}
 	return *this;
@@ -59,6 +61,7 @@ HttpPolicyClass::HttpPolicyClass(const HttpPolicyClass& other)
 	mPerHostConnectionLimit(other.mPerHostConnectionLimit),
 	mPipelining(other.mPipelining),
 	mThrottleRate(other.mThrottleRate),
+	mHttp2Streams(other.mHttp2Streams),
 	mTrace(other.mTrace)
 {
 }
@@ -86,6 +89,10 @@ HttpStatus HttpPolicyClass::set(HttpRequest::EPolicyOption opt, long value)
 			mThrottleRate = llclamp(value, 0L, 1000000L);
 			break;
 
+		case HttpRequest::PO_HTTP2_STREAMS:
+			mHttp2Streams = llclamp(value, 0L, HTTP_HTTP2_STREAMS_MAX);
+			break;
+
 		case HttpRequest::PO_TRACE:
 			mTrace = llclamp(value, HTTP_TRACE_MIN, HTTP_TRACE_MAX);
 			break;
@@ -118,6 +125,10 @@ HttpStatus HttpPolicyClass::get(HttpRequest::EPolicyOption opt,
 			*value = mThrottleRate;
 			break;
 
+		case HttpRequest::PO_HTTP2_STREAMS:
+			*value = mHttp2Streams;
+			break;
+
 		default:
 			return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
 	}
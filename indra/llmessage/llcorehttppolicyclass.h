@@ -59,6 +59,7 @@ public:
 	long mPerHostConnectionLimit;
 	long mPipelining;
 	long mThrottleRate;
+	long mHttp2Streams;
 	long mTrace;
 };
 
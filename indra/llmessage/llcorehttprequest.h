@@ -202,6 +202,20 @@ public:
 		// Per-class only
 		PO_THROTTLE_RATE,
 
+		// Long value that, when positive, switches the policy class to HTTP/2
+		// multiplexing and gives the maximum number of concurrent streams
+		// per connection. Such classes share a single libcurl multi handle
+		// (and thus its connection cache), so that requests from several
+		// classes to the same host get multiplexed over the same connections.
+		// PO_PER_HOST_CONNECTION_LIMIT then gives the number of connections
+		// per host and the class concurrency becomes that limit multiplied by
+		// the number of streams. HTTP/2 is negotiated via ALPN over TLS only;
+		// plain HTTP requests keep using HTTP/1.1. The default, zero, keeps
+		// the class on HTTP/1.1 (with optional pipelining, see above).
+		//
+		// Per-class only
+		PO_HTTP2_STREAMS,
+
 		// Controls the callback function used to control SSL CTX certificate
 		// verification.
 		//
@@ -29,6 +29,7 @@
 #include "llcorehttprequestqueue.h"
 
 #include "llcorehttpoperation.h"
+#include "llcorehttpservice.h"
 #include "llcoremutex.h"
 
 using namespace LLCoreInt;
@@ -87,6 +88,11 @@ HttpStatus HttpRequestQueue::addOp(const HttpRequestQueue::opPtr_t& op)
 	if (wake)
 	{
 		mQueueCV.notify_all();
+		// The worker thread may also be waiting for network activity: wake it
+		// up as well. Note that we only need to do this when the queue was
+		// empty, since the worker thread always swaps the whole queue content
+		// with an empty one after waking up.
+		wakeService();
 	}
 	return HttpStatus();
 }
@@ -139,6 +145,17 @@ void HttpRequestQueue::fetchAll(bool wait, OpContainer& ops)
 void HttpRequestQueue::wakeAll()
 {
 	mQueueCV.notify_all();
+	wakeService();
+}
+
+//static
+void HttpRequestQueue::wakeService()
+{
+	HttpService* service = HttpService::instanceOf();
+	if (service)
+	{
+		service->wakeup();
+	}
 }
 
 bool HttpRequestQueue::stopQueue()
@@ -110,6 +110,10 @@ public:
 	// Threading: callable by any thread.
 	bool stopQueue();
 
+protected:
+	// Wakes up the service worker thread when it waits for network activity.
+	static void wakeService();
+
 protected:
 	OpContainer							mQueue;
 	LLCoreInt::HttpMutex				mQueueMutex;
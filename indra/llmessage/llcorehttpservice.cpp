@@ -36,6 +36,7 @@
 #include "llsys.h"
 #include "llthread.h"
 #include "lltimer.h"
+#include "hbtracy.h"
 
 namespace LLCore
 {
@@ -139,11 +140,13 @@ const HttpService::OptionDescriptor HttpService::sOptionDesc[] =
 	{ true,		true,	true,	true,	false	},	// PO_TRACE
 	{ true,		true,	false,	true,	false	},	// PO_ENABLE_PIPELINING
 	{ true,		true,	false,	true,	false	},	// PO_THROTTLE_RATE
+	{ true,		true,	false,	true,	false	},	// PO_HTTP2_STREAMS
 	{ false,	false,	true,	false,	true	}	// PO_SSL_VERIFY_CALLBACK
 };
 
 HttpService* HttpService::sInstance = NULL;
 volatile HttpService::EState HttpService::sState = NOT_INITIALIZED;
+LLAtomicBool HttpService::sEventDrivenLoop(true);
 
 HttpService::HttpService()
 :	mRequestQueue(NULL),
@@ -259,6 +262,15 @@ void HttpService::startThread()
 	sState = RUNNING;
 }
 
+// Threading: callable by any thread.
+void HttpService::wakeup()
+{
+	if (mTransport)
+	{
+		mTransport->wakeup();
+	}
+}
+
 // Tries to find the given request handle on any of the request queues and
 // cancels the operation. Returns true if the request was cancelled.
 // Threading: callable by the worker thread.
@@ -303,30 +315,60 @@ void HttpService::shutdown()
 }
 
 // Working thread loop-forever method. Gives time to each of the request queue,
-// policy layer and transport layer pieces and then either sleeps for a small
-// time or waits for a request to come in. Repeats until requested to stop.
+// policy layer and transport layer pieces and then either loops immediately
+// (when requests completed and may have freed connection slots), waits for
+// network activity or a new request (with a timeout which is short when the
+// policy layer has time-based work pending) or waits for a request to come in.
+// Repeats until requested to stop.
 void HttpService::threadRun(HttpThread* thread)
 {
 	boost::this_thread::disable_interruption di;
 
+#if LL_TRACE_CAPTURE
+	LLTraceCapture::setThreadName("HTTP service");
+#endif
+
 	int loop = REQUEST_SLEEP;
 	while (!mExitRequested)
 	{
 		loop = (int)processRequestQueue((ELoopSpeed)loop);
 
 		// Process ready queue issuing new requests as needed
-		int new_loop = (int)mPolicy->processReadyQueue();
-		loop = (std::min)(loop, new_loop);
+		int policy_loop;
+		{
+			LL_TRACY_TIMER(TRC_HTTP_POLICY);
+			policy_loop = (int)mPolicy->processReadyQueue();
+		}
+		loop = (std::min)(loop, policy_loop);
 
 		// Give libcurl some cycles
-		new_loop = mTransport->processTransport();
+		int new_loop;
+		{
+			LL_TRACY_TIMER(TRC_HTTP_TRANSPORT);
+			new_loop = mTransport->processTransport();
+		}
 		loop = (std::min)(loop, new_loop);
 
 		// Determine whether to spin, sleep briefly or sleep for next request
-		if (loop != (int)REQUEST_SLEEP)
+		if (loop == (int)REQUEST_SLEEP)
 		{
+			continue;
+		}
+		if (!sEventDrivenLoop)
+		{
+			// Legacy loop: always sleep, even when requests completed, so that
+			// it stays a faithful baseline for benchmarking.
 			ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+			continue;
+		}
+		if (loop == (int)SPIN)
+		{
+			continue;
 		}
+		LL_TRACY_TIMER(TRC_HTTP_WAIT);
+		mTransport->waitForActivity(policy_loop == (int)NORMAL ?
+										HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS :
+										HTTP_SERVICE_LOOP_WAIT_MAX_MS);
 	}
 
 	shutdown();
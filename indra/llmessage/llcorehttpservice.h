@@ -94,6 +94,7 @@ public:
 	// of multiple requests.
 	enum ELoopSpeed
 	{
+		SPIN,			// loop again immediately (requests completed)
 		NORMAL,			// continuous polling of request, ready, active queues
 		REQUEST_SLEEP	// can sleep indefinitely waiting for request queue write
 	};
@@ -142,6 +143,22 @@ public:
 	// Threading: callable by worker thread.
 	LL_INLINE void stopRequested()					{ mExitRequested = 1U; }
 
+	// Wakes up the worker thread when it is waiting for network activity on
+	// the active requests. Used when new requests are queued.
+	// Threading: callable by any thread.
+	void wakeup();
+
+	// When true (the default), the worker thread waits for network activity,
+	// new requests or wake-ups between its passes, instead of sleeping for a
+	// fixed delay (legacy loop, kept for benchmarking purposes).
+	// Threading: callable by any thread.
+	LL_INLINE static void setEventDrivenLoop(bool enable)
+	{
+		sEventDrivenLoop = enable;
+	}
+
+	LL_INLINE static bool isEventDrivenLoop()		{ return sEventDrivenLoop; }
+
 	// Threading: callable by worker thread.
 	void shutdown();
 
@@ -208,6 +225,7 @@ protected:
 
 	// === shared data ===
 	static volatile EState				sState;
+	static LLAtomicBool					sEventDrivenLoop;
 	HttpRequestQueue*					mRequestQueue;	// Refcounted
 	LLAtomicU32							mExitRequested;
 	HttpThread*							mThread;
@@ -2117,6 +2117,20 @@ void LLMessageSystem::summarizeLogs(std::ostream& str)
 					  tmp_str.c_str(), (F32)bytes * kbps);
 	str << buffer << std::endl;
 
+	str << std::endl << "Connections (curl HTTP traffic):" << std::endl;
+	U64 requests = LLCore::HttpLibcurl::getCompletedRequests();
+	U64 connections = LLCore::HttpLibcurl::getNewConnections();
+	tmp_str = U64_to_str(requests);
+	buffer = llformat("Total requests:            %20s (%s HTTP/2 streams)",
+					  tmp_str.c_str(),
+					  U64_to_str(LLCore::HttpLibcurl::getHttp2Streams()).c_str());
+	str << buffer << std::endl;
+	tmp_str = U64_to_str(connections);
+	buffer = llformat("Total new connections:     %20s (%5.2f requests per connection)",
+					  tmp_str.c_str(),
+					  connections ? (F32)requests / (F32)connections : 0.f);
+	str << buffer << std::endl;
+
 	str << "END MESSAGE LOG SUMMARY" << std::endl;
 }
 
@@ -3168,13 +3182,10 @@ void LLMessageSystem::sendUntrustedSimulatorMessageCoro(const LLHost& host,
 
 LL_INLINE U32 message_hash_my_string(const char* str)
 {
-	U32 retval = 0;
-	while (*str++)
-	{
-		retval += *str;
-		retval <<= 1;
-	}
-	return retval % MESSAGE_NUMBER_OF_HASH_BUCKETS;
+	// MESSAGE_NUMBER_OF_HASH_BUCKETS is a power of 2
+	return *str ? digest64to32(HBXXH64::digest(str)) &
+				  (MESSAGE_NUMBER_OF_HASH_BUCKETS - 1)
+				: 0;
 }
 
 LLMessageStringTable::LLMessageStringTable()
@@ -3182,7 +3193,7 @@ LLMessageStringTable::LLMessageStringTable()
 {
 	for (U32 i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; ++i)
 	{
-		mEmpty[i] = true;
+		mState[i].store(SLOT_EMPTY, std::memory_order_relaxed);
 		mString[i][0] = 0;
 	}
 }
@@ -3190,32 +3201,47 @@ LLMessageStringTable::LLMessageStringTable()
 char* LLMessageStringTable::getString(const char* str)
 {
 	U32 hash_value = message_hash_my_string(str);
-	while (!mEmpty[hash_value])
+	for (U32 probes = 0; probes < MESSAGE_NUMBER_OF_HASH_BUCKETS; ++probes)
 	{
-		if (!strncmp(str, mString[hash_value], MESSAGE_MAX_STRINGS_LENGTH))
+		U8 state = mState[hash_value].load(std::memory_order_acquire);
+		if (state == SLOT_EMPTY)
 		{
-			return mString[hash_value];
+			if (mState[hash_value].compare_exchange_strong(state,
+														   SLOT_WRITING,
+														   std::memory_order_acquire))
+			{
+				// Not found, so add it !
+				strncpy(mString[hash_value], str, MESSAGE_MAX_STRINGS_LENGTH);
+				mString[hash_value][MESSAGE_MAX_STRINGS_LENGTH - 1] = 0;
+				mState[hash_value].store(SLOT_READY,
+										 std::memory_order_release);
+				if (++mUsed >= MESSAGE_NUMBER_OF_HASH_BUCKETS - 1)
+				{
+					llinfos << "Dumping string table before crashing on HashTable full !"
+							<< llendl;
+					for (U32 i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; ++i)
+					{
+						llinfos << "Entry #" << i << ": " << mString[i]
+								<< llendl;
+					}
+				}
+				return mString[hash_value];
+			}
+			// Another thread took this slot first; 'state' got updated.
 		}
-		else
+		while (state == SLOT_WRITING)
 		{
-			++hash_value;
-			hash_value %= MESSAGE_NUMBER_OF_HASH_BUCKETS;
+			// Another thread is copying its string in this slot: wait for it.
+			state = mState[hash_value].load(std::memory_order_acquire);
 		}
-	}
-	// Not found, so add it !
-	strncpy(mString[hash_value], str, MESSAGE_MAX_STRINGS_LENGTH);
-	mString[hash_value][MESSAGE_MAX_STRINGS_LENGTH - 1] = 0;
-	mEmpty[hash_value] = false;
-	if (++mUsed >= MESSAGE_NUMBER_OF_HASH_BUCKETS - 1)
-	{
-		llinfos << "Dumping string table before crashing on HashTable full !"
-				<< llendl;
-		for (U32 i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; ++i)
+		if (!strncmp(str, mString[hash_value], MESSAGE_MAX_STRINGS_LENGTH))
 		{
-			llinfos << "Entry #" << i << ": " << mString[i] << llendl;
+			return mString[hash_value];
 		}
+		hash_value = (hash_value + 1) & (MESSAGE_NUMBER_OF_HASH_BUCKETS - 1);
 	}
-	return mString[hash_value];
+	llerrs << "Message string table full !" << llendl;
+	return NULL;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
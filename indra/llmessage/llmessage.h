@@ -79,11 +79,21 @@ protected:
 public:
 	LLMessageStringTable();
 
+	// Thread-safe: lookups of already interned strings never block, and a
+	// new string only blocks the threads probing its slot while it is copied.
 	char* getString(const char* str);
 
+private:
+	enum : U8
+	{
+		SLOT_EMPTY = 0,
+		SLOT_WRITING,
+		SLOT_READY
+	};
+
 public:
-	U32	 mUsed;
-	bool mEmpty[MESSAGE_NUMBER_OF_HASH_BUCKETS];
+	std::atomic<U32>	mUsed;
+	std::atomic<U8>		mState[MESSAGE_NUMBER_OF_HASH_BUCKETS];
 	char mString[MESSAGE_NUMBER_OF_HASH_BUCKETS][MESSAGE_MAX_STRINGS_LENGTH];
 };
 
@@ -38,8 +38,10 @@
 #include "llmath.h"
 #include "llvector3.h"
 
-U32 gPatchSize;
-U32 gWordBits;
+// Per-thread coding state, so that patches may be decoded concurrently by
+// several threads.
+thread_local U32 gPatchSize;
+thread_local U32 gWordBits;
 
 void init_patch_coding(LLBitPack& bitpack)
 {
@@ -772,56 +772,45 @@ void get_patch_group_header(LLGroupHeader *gopp)
 // Formerly in patch_idct.cpp
 ///////////////////////////////////////////////////////////////////////////////
 
-LLGroupHeader* gGOPP;
-
-void set_group_of_patch_header(LLGroupHeader* gopp)
+// Decompression tables for a given patch size. They are built only once per
+// patch size and never modified afterwards, so they can be shared between
+// threads.
+struct LLPatchDecompressor::Tables
 {
-	gGOPP = gopp;
-}
+	Tables(S32 size);
 
-F32 gPatchDequantizeTable[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
-void build_patch_dequantize_table(S32 size)
+	alignas(16) F32	mDequantize[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+	alignas(16) F32	mICosines[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+	S32				mDeCopyMatrix[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+};
+
+LLPatchDecompressor::Tables::Tables(S32 size)
 {
 	for (S32 j = 0; j < size; ++j)
 	{
 		for (S32 i = 0; i < size; ++i)
 		{
-			gPatchDequantizeTable[j * size + i] = (1.f + 2.f * (i + j));
+			mDequantize[j * size + i] = 1.f + 2.f * (i + j);
 		}
 	}
-}
-
-S32	gCurrentDeSize = 0;
 
-F32	gPatchICosines[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
-
-void setup_patch_icosines(S32 size)
-{
 	F32 oosob = F_PI * 0.5f / size;
-
 	for (S32 u = 0; u < size; ++u)
 	{
 		for (S32 n = 0; n < size; ++n)
 		{
-			gPatchICosines[u * size + n] = cosf((2.f * n + 1.f) * u * oosob);
+			mICosines[u * size + n] = cosf((2.f * n + 1.f) * u * oosob);
 		}
 	}
-}
-
-S32	gDeCopyMatrix[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
 
-void build_decopy_matrix(S32 size)
-{
 	bool b_diag = false;
 	bool b_right = true;
-
 	S32 i = 0;
 	S32 j = 0;
 	S32 count = 0;
-
 	while (i < size && j < size)
 	{
-		gDeCopyMatrix[j * size + i] = count++;
+		mDeCopyMatrix[j * size + i] = count++;
 
 		if (!b_diag)
 		{
@@ -876,544 +865,225 @@ void build_decopy_matrix(S32 size)
 	}
 }
 
-void init_patch_decompressor(S32 size)
+LLPatchDecompressor::LLPatchDecompressor(S32 size)
+:	mTables(NULL),
+	mSize(0)
 {
-	if (size != gCurrentDeSize)
-	{
-		gCurrentDeSize = size;
-		build_patch_dequantize_table(size);
-		setup_patch_icosines(size);
-		build_decopy_matrix(size);
-	}
+	setPatchSize(size);
 }
 
-LL_INLINE void idct_line(F32* linein, F32* lineout, S32 line)
+void LLPatchDecompressor::setPatchSize(S32 size)
 {
-	F32 total;
-	F32* pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-	F32 oosob = 2.f / 16.f;
-	S32	line_size = line * NORMAL_PATCH_SIZE;
-	F32* tlinein;
-	F32* tpcp;
-
-	for (S32 n = 0; n < NORMAL_PATCH_SIZE; ++n)
+	// Only 16x16 and 32x32 patches are supported by the protocol.
+	if (size != NORMAL_PATCH_SIZE && size != LARGE_PATCH_SIZE)
 	{
-		tpcp = pcp + n;
-		tlinein = linein + line_size;
-
-		total = OO_SQRT2 * (*(tlinein++));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein) * (*(tpcp += NORMAL_PATCH_SIZE));
+		llwarns_once << "Unsupported patch size: " << size << llendl;
+		size = size < LARGE_PATCH_SIZE ? NORMAL_PATCH_SIZE : LARGE_PATCH_SIZE;
+	}
+	if (size == mSize)
+	{
+		return;
+	}
+	mSize = size;
 
-		*(lineout + line_size + n) = total * oosob;
+	// Function-local statics: their construction is thread-safe.
+	if (size == NORMAL_PATCH_SIZE)
+	{
+		static const Tables normal_tables(NORMAL_PATCH_SIZE);
+		mTables = &normal_tables;
 	}
-#else
-	F32 oosob = 2.f / size;
-	S32 size = gGOPP->patch_size;
-	S32 line_size = line * size;
-	for (S32 n = 0; n < size; ++n)
+	else
 	{
-		total = OO_SQRT2*linein[line_size];
-		for (S32 u = 1; u < size; ++u)
-		{
-			total += linein[line_size + u] * pcp[u * size + n];
-		}
-		lineout[line_size + n] = total * oosob;
+		static const Tables large_tables(LARGE_PATCH_SIZE);
+		mTables = &large_tables;
 	}
-#endif
 }
 
-LL_INLINE void idct_line_large_slow(F32* linein, F32* lineout, S32 line)
+// Inverse DCT of a SIZE x SIZE block, in place. Four outputs are computed at
+// once, each SIMD lane performing the very same sequence of operations as the
+// former scalar idct_column() and idct_line() functions did for the
+// corresponding coefficient, so that the results do not change.
+template<S32 SIZE>
+static void idct_patch(F32* block, const F32* icosines)
 {
-	F32 total;
-	F32* pcp = gPatchICosines;
+	alignas(16) F32 temp[SIZE * SIZE];
 
-	F32 oosob = 2.f / 32.f;
-	S32	line_size = line * LARGE_PATCH_SIZE;
-	F32* tlinein;
-	F32* tpcp;
+	const __m128 oosqrt2 = _mm_set1_ps(OO_SQRT2);
 
-	for (S32 n = 0; n < LARGE_PATCH_SIZE; ++n)
+	// Columns pass
+	for (S32 n = 0; n < SIZE; ++n)
 	{
-		tpcp = pcp + n;
-		tlinein = linein + line_size;
-
-		total = OO_SQRT2 * (*(tlinein++));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		*(lineout + line_size + n) = total * oosob;
+		F32* out = temp + n * SIZE;
+		for (S32 column = 0; column < SIZE; column += 4)
+		{
+			const F32* in = block + column;
+			__m128 total = _mm_mul_ps(oosqrt2, _mm_load_ps(in));
+			for (S32 u = 1; u < SIZE; ++u)
+			{
+				total = _mm_add_ps(total,
+								   _mm_mul_ps(_mm_load_ps(in + u * SIZE),
+											  _mm_set1_ps(icosines[u * SIZE +
+																   n])));
+			}
+			_mm_store_ps(out + column, total);
+		}
 	}
-}
-
-// Nota Bene: assumes that coefficients beyond 128 are 0 !
-
-void idct_line_large(F32* linein, F32* lineout, S32 line)
-{
-	F32 total;
-	F32 *pcp = gPatchICosines;
-
-	F32 oosob = 2.f / 32.f;
-	S32	line_size = line*LARGE_PATCH_SIZE;
-	F32* tlinein;
-	F32* tpcp;
-	F32* baselinein = linein + line_size;
-	F32* baselineout = lineout + line_size;
 
-	for (S32 n = 0; n < LARGE_PATCH_SIZE; ++n)
+	// Lines pass
+	const __m128 oosob = _mm_set1_ps(2.f / (F32)SIZE);
+	for (S32 line = 0; line < SIZE; ++line)
 	{
-		tpcp = pcp++;
-		tlinein = baselinein;
-
-		total = OO_SQRT2 * (*(tlinein++));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein) * (*(tpcp));
-
-		*baselineout++ = total * oosob;
+		const F32* in = temp + line * SIZE;
+		F32* out = block + line * SIZE;
+		const __m128 first = _mm_mul_ps(oosqrt2, _mm_set1_ps(in[0]));
+		for (S32 n = 0; n < SIZE; n += 4)
+		{
+			__m128 total = first;
+			for (S32 u = 1; u < SIZE; ++u)
+			{
+				total = _mm_add_ps(total,
+								   _mm_mul_ps(_mm_set1_ps(in[u]),
+											  _mm_load_ps(icosines + u * SIZE +
+														  n)));
+			}
+			_mm_store_ps(out + n, _mm_mul_ps(total, oosob));
+		}
 	}
 }
 
-LL_INLINE void idct_column(F32* linein, F32* lineout, S32 column)
+// The former scalar inverse DCT, column by column then line by line.
+static void idct_patch_scalar(F32* block, const F32* icosines, S32 size)
 {
-	F32 total;
-	F32 *pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-	F32* tlinein;
-	F32* tpcp;
+	F32 temp[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
 
-	for (S32 n = 0; n < NORMAL_PATCH_SIZE; ++n)
+	for (S32 column = 0; column < size; ++column)
 	{
-		tpcp = pcp + n;
-		tlinein = linein + column;
-
-		total = OO_SQRT2*(*tlinein);
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE) * (*(tpcp += NORMAL_PATCH_SIZE));
-
-		*(lineout + (n<<4) + column) = total;
+		for (S32 n = 0; n < size; ++n)
+		{
+			F32 total = OO_SQRT2 * block[column];
+			for (S32 u = 1; u < size; ++u)
+			{
+				total += block[u * size + column] * icosines[u * size + n];
+			}
+			temp[n * size + column] = total;
+		}
 	}
 
-#else
-	S32	size = gGOPP->patch_size;
-	S32 u;
-	S32 u_size;
-
-	for (n = 0; n < size; n++)
+	F32 oosob = 2.f / (F32)size;
+	for (S32 line = 0; line < size; ++line)
 	{
-		total = OO_SQRT2*linein[column];
-		for (u = 1; u < size; u++)
+		S32 line_size = line * size;
+		for (S32 n = 0; n < size; ++n)
 		{
-			u_size = u*size;
-			total += linein[u_size + column]*pcp[u_size+n];
+			F32 total = OO_SQRT2 * temp[line_size];
+			for (S32 u = 1; u < size; ++u)
+			{
+				total += temp[line_size + u] * icosines[u * size + n];
+			}
+			block[line_size + n] = total * oosob;
 		}
-		lineout[size*n + column] = total;
 	}
-#endif
 }
 
-LL_INLINE void idct_column_large_slow(F32* linein, F32* lineout, S32 column)
+// Dequantizes the 'cpatch' coefficients into 'block', in natural order, and
+// returns the multiplier and offset to apply to the inverse DCT results.
+LL_INLINE static void dequantize_patch(F32* block, const S32* cpatch,
+									   const LLPatchHeader* ph, S32 size,
+									   const S32* decopy_matrix, const F32* dq,
+									   F32& mult, F32& addval)
 {
-	F32 total;
-	F32* pcp = gPatchICosines;
-
-	F32* tlinein;
-	F32* tpcp;
+	S32 prequant = (ph->quant_wbits >> 4) + 2;
+	F32 ooq = 1.f / (F32)(1 << prequant);
+	mult = ooq * (F32)ph->range;
+	addval = mult * (F32)(1 << (prequant - 1)) + ph->dc_offset;
 
-	for (S32 n = 0; n < LARGE_PATCH_SIZE; ++n)
+	for (S32 i = 0, surface = size * size; i < surface; ++i)
 	{
-		tpcp = pcp + n;
-		tlinein = linein + column;
-
-		total = OO_SQRT2 * (*tlinein);
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
-
-		*(lineout + (n << 5) + column) = total;
+		block[i] = cpatch[decopy_matrix[i]] * dq[i];
 	}
 }
 
-// Nota Bene: assumes that coefficients beyond 128 are 0!
-
-void idct_column_large(F32* linein, F32* lineout, S32 column)
+LL_INLINE static void copy_patch(F32* patch, S32 stride, const F32* block,
+								 S32 size, F32 mult, F32 addval)
 {
-	F32 total;
-	F32* pcp = gPatchICosines;
-
-	F32* tlinein;
-	F32* tpcp;
-	F32* baselinein = linein + column;
-	F32* baselineout = lineout + column;
-
-	for (S32 n = 0; n < LARGE_PATCH_SIZE; ++n)
+	for (S32 j = 0; j < size; ++j)
 	{
-		tpcp = pcp++;
-		tlinein = baselinein;
-
-		total = OO_SQRT2 * (*tlinein);
-		for (S32 m = 1; m < NORMAL_PATCH_SIZE; ++m)
+		F32* tpatch = patch + j * stride;
+		const F32* tblock = block + j * size;
+		for (S32 i = 0; i < size; ++i)
 		{
-			total += *(tlinein += LARGE_PATCH_SIZE) * (*(tpcp += LARGE_PATCH_SIZE));
+			tpatch[i] = tblock[i] * mult + addval;
 		}
-
-		*(baselineout + (n << 5)) = total;
 	}
 }
 
-LL_INLINE void idct_patch(F32* block)
+void LLPatchDecompressor::decompress(F32* patch, S32 stride, const S32* cpatch,
+									 const LLPatchHeader* ph) const
 {
-	F32 temp[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+	alignas(16) F32 block[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+	F32 mult, addval;
+	dequantize_patch(block, cpatch, ph, mSize, mTables->mDeCopyMatrix,
+					 mTables->mDequantize, mult, addval);
 
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-	idct_column(block, temp, 0);
-	idct_column(block, temp, 1);
-	idct_column(block, temp, 2);
-	idct_column(block, temp, 3);
-
-	idct_column(block, temp, 4);
-	idct_column(block, temp, 5);
-	idct_column(block, temp, 6);
-	idct_column(block, temp, 7);
-
-	idct_column(block, temp, 8);
-	idct_column(block, temp, 9);
-	idct_column(block, temp, 10);
-	idct_column(block, temp, 11);
-
-	idct_column(block, temp, 12);
-	idct_column(block, temp, 13);
-	idct_column(block, temp, 14);
-	idct_column(block, temp, 15);
-
-	idct_line(temp, block, 0);
-	idct_line(temp, block, 1);
-	idct_line(temp, block, 2);
-	idct_line(temp, block, 3);
-
-	idct_line(temp, block, 4);
-	idct_line(temp, block, 5);
-	idct_line(temp, block, 6);
-	idct_line(temp, block, 7);
-
-	idct_line(temp, block, 8);
-	idct_line(temp, block, 9);
-	idct_line(temp, block, 10);
-	idct_line(temp, block, 11);
-
-	idct_line(temp, block, 12);
-	idct_line(temp, block, 13);
-	idct_line(temp, block, 14);
-	idct_line(temp, block, 15);
-#else
-	S32	size = gGOPP->patch_size;
-	for (S32 i = 0; i < size; ++i)
+	if (mSize == NORMAL_PATCH_SIZE)
 	{
-		idct_column(block, temp, i);
+		idct_patch<NORMAL_PATCH_SIZE>(block, mTables->mICosines);
 	}
-	for (S32 i = 0; i < size; ++i)
+	else
 	{
-		idct_line(temp, block, i);
+		idct_patch<LARGE_PATCH_SIZE>(block, mTables->mICosines);
 	}
-#endif
-}
-
-LL_INLINE void idct_patch_large(F32* block)
-{
-	F32 temp[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
 
-	idct_column_large_slow(block, temp, 0);
-	idct_column_large_slow(block, temp, 1);
-	idct_column_large_slow(block, temp, 2);
-	idct_column_large_slow(block, temp, 3);
-
-	idct_column_large_slow(block, temp, 4);
-	idct_column_large_slow(block, temp, 5);
-	idct_column_large_slow(block, temp, 6);
-	idct_column_large_slow(block, temp, 7);
-
-	idct_column_large_slow(block, temp, 8);
-	idct_column_large_slow(block, temp, 9);
-	idct_column_large_slow(block, temp, 10);
-	idct_column_large_slow(block, temp, 11);
-
-	idct_column_large_slow(block, temp, 12);
-	idct_column_large_slow(block, temp, 13);
-	idct_column_large_slow(block, temp, 14);
-	idct_column_large_slow(block, temp, 15);
-
-	idct_column_large_slow(block, temp, 16);
-	idct_column_large_slow(block, temp, 17);
-	idct_column_large_slow(block, temp, 18);
-	idct_column_large_slow(block, temp, 19);
-
-	idct_column_large_slow(block, temp, 20);
-	idct_column_large_slow(block, temp, 21);
-	idct_column_large_slow(block, temp, 22);
-	idct_column_large_slow(block, temp, 23);
-
-	idct_column_large_slow(block, temp, 24);
-	idct_column_large_slow(block, temp, 25);
-	idct_column_large_slow(block, temp, 26);
-	idct_column_large_slow(block, temp, 27);
-
-	idct_column_large_slow(block, temp, 28);
-	idct_column_large_slow(block, temp, 29);
-	idct_column_large_slow(block, temp, 30);
-	idct_column_large_slow(block, temp, 31);
-
-	idct_line_large_slow(temp, block, 0);
-	idct_line_large_slow(temp, block, 1);
-	idct_line_large_slow(temp, block, 2);
-	idct_line_large_slow(temp, block, 3);
-
-	idct_line_large_slow(temp, block, 4);
-	idct_line_large_slow(temp, block, 5);
-	idct_line_large_slow(temp, block, 6);
-	idct_line_large_slow(temp, block, 7);
-
-	idct_line_large_slow(temp, block, 8);
-	idct_line_large_slow(temp, block, 9);
-	idct_line_large_slow(temp, block, 10);
-	idct_line_large_slow(temp, block, 11);
-
-	idct_line_large_slow(temp, block, 12);
-	idct_line_large_slow(temp, block, 13);
-	idct_line_large_slow(temp, block, 14);
-	idct_line_large_slow(temp, block, 15);
-
-	idct_line_large_slow(temp, block, 16);
-	idct_line_large_slow(temp, block, 17);
-	idct_line_large_slow(temp, block, 18);
-	idct_line_large_slow(temp, block, 19);
-
-	idct_line_large_slow(temp, block, 20);
-	idct_line_large_slow(temp, block, 21);
-	idct_line_large_slow(temp, block, 22);
-	idct_line_large_slow(temp, block, 23);
-
-	idct_line_large_slow(temp, block, 24);
-	idct_line_large_slow(temp, block, 25);
-	idct_line_large_slow(temp, block, 26);
-	idct_line_large_slow(temp, block, 27);
-
-	idct_line_large_slow(temp, block, 28);
-	idct_line_large_slow(temp, block, 29);
-	idct_line_large_slow(temp, block, 30);
-	idct_line_large_slow(temp, block, 31);
+	copy_patch(patch, stride, block, mSize, mult, addval);
 }
 
-S32	gDitherNoise = 128;
-
-void decompress_patch(F32* patch, S32* cpatch, LLPatchHeader* ph)
+void LLPatchDecompressor::decompressReference(F32* patch, S32 stride,
+											  const S32* cpatch,
+											  const LLPatchHeader* ph) const
 {
-	F32	block[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
-	F32* tblock = block;
-	F32* tpatch;
-
-	LLGroupHeader* gopp = gGOPP;
-	S32 size = gopp->patch_size;
-	F32 range = ph->range;
-	S32 prequant = (ph->quant_wbits >> 4) + 2;
-	S32 quantize = 1<<prequant;
-	F32 hmin = ph->dc_offset;
-	S32 stride = gopp->stride;
+	F32 block[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+	F32 mult, addval;
+	dequantize_patch(block, cpatch, ph, mSize, mTables->mDeCopyMatrix,
+					 mTables->mDequantize, mult, addval);
+	idct_patch_scalar(block, mTables->mICosines, mSize);
+	copy_patch(patch, stride, block, mSize, mult, addval);
+}
 
-	F32	ooq = 1.f / (F32)quantize;
-	F32* dq = gPatchDequantizeTable;
-	S32* decopy_matrix = gDeCopyMatrix;
+// Legacy, non reentrant API, kept for the wind and cloud layers, which only
+// decode a couple of small patches per packet.
 
-	F32	mult = ooq * range;
-	F32	addval = mult * (F32)(1 << (prequant - 1)) + hmin;
+static LLGroupHeader* sGOPP = NULL;
+static LLPatchDecompressor sDecompressor;
 
-	for (S32 i = 0; i < size*size; ++i)
-	{
-		*(tblock++) = *(cpatch + *(decopy_matrix++)) * (*dq++);
-	}
+void set_group_of_patch_header(LLGroupHeader* gopp)
+{
+	sGOPP = gopp;
+}
 
-	if (size == 16)
-	{
-		idct_patch(block);
-	}
-	else
-	{
-		idct_patch_large(block);
-	}
+void init_patch_decompressor(S32 size)
+{
+	sDecompressor.setPatchSize(size);
+}
 
-	for (S32 j = 0; j < size; ++j)
-	{
-		tpatch = patch + j * stride;
-		tblock = block + j * size;
-		for (S32 i = 0; i < size; ++i)
-		{
-			*(tpatch++) = *(tblock++) * mult + addval;
-		}
-	}
+void decompress_patch(F32* patch, S32* cpatch, LLPatchHeader* ph)
+{
+	sDecompressor.decompress(patch, sGOPP->stride, cpatch, ph);
 }
 
 void decompress_patchv(LLVector3* v, S32* cpatch, LLPatchHeader* ph)
 {
+	S32 size = sDecompressor.getPatchSize();
 	F32 block[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
-	F32* tblock = block;
-	LLVector3* tvec;
-
-	LLGroupHeader* gopp = gGOPP;
-	S32 size = gopp->patch_size;
-	F32 range = ph->range;
-	S32 prequant = (ph->quant_wbits >> 4) + 2;
-	S32 quantize = 1 << prequant;
-	F32 hmin = ph->dc_offset;
-	S32 stride = gopp->stride;
-
-	F32 ooq = 1.f / (F32)quantize;
-	F32* dq = gPatchDequantizeTable;
-	S32* decopy_matrix = gDeCopyMatrix;
-
-	F32 mult = ooq * range;
-	F32 addval = mult*(F32)(1 << (prequant - 1)) + hmin;
-
-	for (S32 i = 0; i < size * size; ++i)
-	{
-		*(tblock++) = *(cpatch + *(decopy_matrix++)) * (*dq++);
-	}
-
-	if (size == 16)
-	{
-		idct_patch(block);
-	}
-	else
-	{
-		idct_patch_large(block);
-	}
+	sDecompressor.decompress(block, size, cpatch, ph);
 
+	S32 stride = sGOPP->stride;
 	for (S32 j = 0; j < size; ++j)
 	{
-		tvec = v + j * stride;
-		tblock = block + j*size;
+		LLVector3* tvec = v + j * stride;
+		F32* tblock = block + j * size;
 		for (S32 i = 0; i < size; ++i)
 		{
-			(*tvec++).mV[VZ] = *(tblock++) * mult + addval;
+			(tvec++)->mV[VZ] = *(tblock++);
 		}
 	}
 }
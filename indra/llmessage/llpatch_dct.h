@@ -88,7 +88,37 @@ void prescan_patch(F32* patch, LLPatchHeader* php, F32& zmax, F32& zmin);
 void compress_patch(F32* patch, S32* cpatch, LLPatchHeader* php, S32 prequant);
 void get_patch_group_header(LLGroupHeader* gopp);
 
-// Decompression routines
+// Reentrant patch decompressor: it only refers to immutable tables, so that
+// several instances may be used at once by different threads (e.g. to decode
+// terrain patches off the main thread). The inverse DCT is vectorized, four
+// coefficients at a time.
+class LLPatchDecompressor
+{
+public:
+	LLPatchDecompressor(S32 patch_size = NORMAL_PATCH_SIZE);
+
+	// Only NORMAL_PATCH_SIZE and LARGE_PATCH_SIZE are supported.
+	void setPatchSize(S32 patch_size);
+	LL_INLINE S32 getPatchSize() const			{ return mSize; }
+
+	// Decompresses the 'cpatch' coefficients (as decoded by decode_patch())
+	// into 'patch', rows being 'stride' floats apart.
+	void decompress(F32* patch, S32 stride, const S32* cpatch,
+					const LLPatchHeader* ph) const;
+
+	// Same as decompress(), with the former scalar inverse DCT code. Slow:
+	// only kept as a reference to check the vectorized code against.
+	void decompressReference(F32* patch, S32 stride, const S32* cpatch,
+							 const LLPatchHeader* ph) const;
+
+private:
+	struct Tables;
+	const Tables*	mTables;
+	S32				mSize;
+};
+
+// Decompression routines (not reentrant: they use a global decompressor and
+// group header).
 void set_group_of_patch_header(LLGroupHeader* gopp);
 void init_patch_decompressor(S32 size);
 void decompress_patch(F32* patch, S32* cpatch, LLPatchHeader* ph);
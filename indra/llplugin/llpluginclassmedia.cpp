@@ -47,6 +47,7 @@ std::string LLPluginClassMedia::sOpenIdCookieHost;
 std::string LLPluginClassMedia::sOpenIdCookiePath;
 std::string LLPluginClassMedia::sOpenIdCookieName;
 std::string LLPluginClassMedia::sOpenIdCookieValue;
+bool LLPluginClassMedia::sDoubleBufferedFrames = true;
 
 static int LOW_PRIORITY_TEXTURE_SIZE_DEFAULT = 256;
 
@@ -115,7 +116,12 @@ void LLPluginClassMedia::reset()
 	mRequestedTextureInternalFormat = mRequestedTextureFormat = 0;
 	mRequestedTextureType = 0;
 	mRequestedTextureSwapBytes = mRequestedTextureCoordsOpenGL = false;
-	mTextureSharedMemorySize = 0;
+	mTextureSharedMemorySize = mTextureBufferSize = 0;
+	mTextureBuffers = 1;
+	mFrontBuffer = 0;
+	mFrameSequence = mConsumedFrameSequence = 0;
+	mReadFrameSequence = mReleasedFrameSequence = 0;
+	mReadingFrame = false;
 	mTextureSharedMemoryName.clear();
 	mDefaultMediaWidth = mDefaultMediaHeight = 0;
 	mNaturalMediaWidth = mNaturalMediaHeight = 0;
@@ -131,7 +137,7 @@ void LLPluginClassMedia::reset()
 	mRequestedVolume = 1.f;
 	mPriority = PRIORITY_NORMAL;
 	mLowPrioritySizeLimit = LOW_PRIORITY_TEXTURE_SIZE_DEFAULT;
-	mAllowDownsample = false;
+	mAllowDownsample = mDoubleBufferedCapable = false;
 	mPadding = 0;
 	mLastMouseX = mLastMouseY = 0;
 	mStatus = LLPluginClassMediaOwner::MEDIA_NONE;
@@ -215,6 +221,13 @@ void LLPluginClassMedia::idle()
 		// Add an extra line for padding, just in case.
 		newsize += mRequestedTextureWidth * mRequestedTextureDepth;
 
+		// Double-buffered frames, when possible.
+		S32 buffers = mDoubleBufferedCapable && sDoubleBufferedFrames ? 2 : 1;
+		mTextureBufferSize = newsize;
+		mTextureBuffers = buffers;
+		mFrontBuffer = 0;
+		newsize *= buffers;
+
 		if (newsize != mTextureSharedMemorySize)
 		{
 			if (!mTextureSharedMemoryName.empty())
@@ -265,6 +278,11 @@ void LLPluginClassMedia::idle()
 		message.setValueS32("height", mRequestedMediaHeight);
 		message.setValueS32("texture_width", mRequestedTextureWidth);
 		message.setValueS32("texture_height", mRequestedTextureHeight);
+		if (mTextureBuffers > 1)
+		{
+			message.setValueS32("buffers", mTextureBuffers);
+			message.setValueS32("buffer_size", (S32)mTextureBufferSize);
+		}
 		message.setValueReal("background_r", mBackgroundColor.mV[VX]);
 		message.setValueReal("background_g", mBackgroundColor.mV[VY]);
 		message.setValueReal("background_b", mBackgroundColor.mV[VZ]);
@@ -303,10 +321,55 @@ unsigned char* LLPluginClassMedia::getBitsData()
 	if (mPlugin && !mTextureSharedMemoryName.empty())
 	{
 		result = mPlugin->getSharedMemoryAddress(mTextureSharedMemoryName);
+		if (result && mTextureBuffers > 1 && mFrontBuffer > 0)
+		{
+			result = (void*)((unsigned char*)result + mTextureBufferSize);
+		}
 	}
 	return (unsigned char*)result;
 }
 
+unsigned char* LLPluginClassMedia::acquireFrame()
+{
+	unsigned char* result = getBitsData();
+	if (result && mTextureBuffers > 1)
+	{
+		mReadingFrame = true;
+		mReadFrameSequence = mFrameSequence;
+	}
+	return result;
+}
+
+void LLPluginClassMedia::releaseFrame()
+{
+	if (mReadingFrame)
+	{
+		mReadingFrame = false;
+		sendFrameRelease();
+	}
+}
+
+void LLPluginClassMedia::sendFrameRelease()
+{
+	if (mTextureBuffers < 2)
+	{
+		return;
+	}
+
+	// We only ever read the last published frame, so all older frames can be
+	// overwritten by the plugin, but not the one we may still be reading.
+	U32 seq = mReadingFrame ? mReadFrameSequence : mFrameSequence;
+	if (seq <= 1 || seq - 1 <= mReleasedFrameSequence)
+	{
+		return;
+	}
+	mReleasedFrameSequence = seq - 1;
+
+	LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_MEDIA, "frame_released");
+	message.setValueS32("seq", (S32)mReleasedFrameSequence);
+	sendMessage(message);
+}
+
 void LLPluginClassMedia::setSize(int width, int height)
 {
 	if (width > 0 && height > 0)
@@ -396,7 +459,9 @@ bool LLPluginClassMedia::textureValid()
 
 bool LLPluginClassMedia::getDirty(LLRect* dirty_rect)
 {
-	bool result = !mDirtyRect.isEmpty();
+	// Nothing new to upload unless a new frame got published.
+	bool result = !mDirtyRect.isEmpty() &&
+				  mFrameSequence != mConsumedFrameSequence;
 
 	if (dirty_rect)
 	{
@@ -409,6 +474,7 @@ bool LLPluginClassMedia::getDirty(LLRect* dirty_rect)
 void LLPluginClassMedia::resetDirty()
 {
 	mDirtyRect = LLRect::null;
+	mConsumedFrameSequence = mFrameSequence;
 }
 
 std::string LLPluginClassMedia::translateModifiers(MASK modifiers)
@@ -981,6 +1047,8 @@ void LLPluginClassMedia::receivePluginMessage(const LLPluginMessage& message)
 
 			mAllowDownsample = message.getValueBoolean("allow_downsample");
 			mPadding = message.getValueS32("padding");
+			mDoubleBufferedCapable =
+				message.getValueBoolean("double_buffered");
 
 			setSizeInternal();
 
@@ -1015,6 +1083,25 @@ void LLPluginClassMedia::receivePluginMessage(const LLPluginMessage& message)
 					mDirtyRect.unionWith(new_rect);
 				}
 
+				// Plugins not sending sequence numbers get a local one.
+				if (message.hasValue("seq"))
+				{
+					mFrameSequence = (U32)message.getValueS32("seq");
+				}
+				else
+				{
+					++mFrameSequence;
+				}
+				// Since double-buffered plugins always write whole frames,
+				// the buffer of the last frame holds all the dirty pixels.
+				if (mTextureBuffers > 1)
+				{
+					mFrontBuffer = message.getValueS32("buffer") > 0 ? 1 : 0;
+					// Let the plugin reuse the buffer of the previous frame
+					// when we are not reading it.
+					sendFrameRelease();
+				}
+
 				LL_DEBUGS("Plugin") << "adjusted incoming rect is: ("
 									<< new_rect.mLeft << ", "
 									<< new_rect.mTop << ", "
@@ -79,8 +79,21 @@ public:
 	int getTextureHeight() const;
 
 	// This may return NULL. Callers need to check for and handle this case.
+	// With double-buffered frames, this returns the buffer holding the last
+	// frame published by the plugin.
 	unsigned char* getBitsData();
 
+	// Same as getBitsData(), but with double-buffered frames, the plugin is
+	// also prevented from overwriting the returned frame buffer till
+	// releaseFrame() is called. Use these when the frame is read after the
+	// next plugin messages could have been processed (e.g. by another
+	// thread).
+	unsigned char* acquireFrame();
+	void releaseFrame();
+
+	// Sequence number of the last frame published by the plugin.
+	LL_INLINE U32 getFrameSequence() const				{ return mFrameSequence; }
+
 	// Get the format details of the texture data. These may return 0 if they
 	// have not been set up yet. The caller needs to detect this case.
 	LL_INLINE int getTextureDepth() const				{ return mRequestedTextureDepth; }
@@ -110,9 +123,22 @@ public:
 	// you call idle() again.
 	bool textureValid();
 
+	// Returns true when a new frame (i.e. one with a different sequence
+	// number than at the last resetDirty() call) got published with a non-
+	// empty dirty rect.
 	bool getDirty(LLRect* dirty_rect = NULL);
 	void resetDirty();
 
+	// When true (the default), plugins advertizing support for it in their
+	// "texture_params" message are given two frame buffers in their texture
+	// shared memory segment; they then write each new frame into the buffer
+	// not holding the last published one, so that the latter can be read
+	// (and uploaded to GL, possibly by another thread) without tearing.
+	LL_INLINE static void setDoubleBufferedFrames(bool b)
+	{
+		sDoubleBufferedFrames = b;
+	}
+
 	typedef enum
 	{
 		MOUSE_EVENT_DOWN,
@@ -415,6 +441,10 @@ protected:
 
 	void setSizeInternal();
 
+	// Tells a double-buffered plugin up to which frame sequence number it may
+	// overwrite its frame buffers.
+	void sendFrameRelease();
+
 	std::string translateModifiers(MASK modifiers);
 
 protected:
@@ -432,6 +462,23 @@ protected:
 
 	std::string								mTextureSharedMemoryName;
 	size_t									mTextureSharedMemorySize;
+	// Size of each frame buffer in the texture shared memory segment, and
+	// number of buffers (1 or 2).
+	size_t									mTextureBufferSize;
+	S32										mTextureBuffers;
+	// Buffer holding the last published frame
+	S32										mFrontBuffer;
+
+	// Last published frame sequence number, and the one that was current at
+	// the last resetDirty() call.
+	U32										mFrameSequence;
+	U32										mConsumedFrameSequence;
+	// Sequence number of the frame being read between acquireFrame() and
+	// releaseFrame() calls, and last sequence number released to the plugin
+	// (i.e. frames up to that one will not be read any more by the viewer).
+	U32										mReadFrameSequence;
+	U32										mReleasedFrameSequence;
+	bool									mReadingFrame;
 
 	// default media size for the plugin, from the texture_params message.
 	int										mDefaultMediaWidth;
@@ -539,6 +586,9 @@ protected:
 
 	bool									mAllowDownsample;
 
+	// True when the plugin can deal with double-buffered frames
+	bool									mDoubleBufferedCapable;
+
 	// The mRequestedTexture* fields are only valid when this is true
 	bool									mTextureParamsReceived;
 
@@ -561,6 +611,8 @@ private:
 	static std::string						sOpenIdCookiePath;
 	static std::string						sOpenIdCookieName;
 	static std::string						sOpenIdCookieValue;
+
+	static bool								sDoubleBufferedFrames;
 };
 
 #endif // LL_LLPLUGINCLASSMEDIA_H
@@ -244,18 +244,33 @@ void* LLPluginMessage::getValuePointer(const std::string& key) const
 }
 
 // Flattens the message into a string.
-std::string LLPluginMessage::generate() const
+std::string LLPluginMessage::generate(bool binary) const
 {
 	std::ostringstream result;
 
+	if (binary)
+	{
+		LLSDSerialize::toBinary(mMessage, result);
+	}
+	else
+	{
 #if 0	// Pretty XML may be slightly easier to deal with while debugging...
-	LLSDSerialize::toXML(mMessage, result);
+		LLSDSerialize::toXML(mMessage, result);
 #endif
-	LLSDSerialize::toPrettyXML(mMessage, result);
+		LLSDSerialize::toPrettyXML(mMessage, result);
+	}
 
 	return result.str();
 }
 
+//static
+bool LLPluginMessage::isBinary(const std::string& message)
+{
+	// Binary LLSD messages are maps, which serialization starts with '{',
+	// while XML messages start with '<' (possibly after some white space).
+	return !message.empty() && message[0] == '{';
+}
+
 // Parses an incoming message into component parts. Clears all existing state
 // before starting the parse. Returns -1 on failure, otherwise returns the
 // number of key/value pairs in the incoming message.
@@ -266,7 +281,16 @@ int LLPluginMessage::parse(const std::string& message)
 
 	std::istringstream input(message);
 
-	S32 parse_result = LLSDSerialize::fromXML(mMessage, input);
+	S32 parse_result;
+	if (isBinary(message))
+	{
+		parse_result = LLSDSerialize::fromBinary(mMessage, input,
+												 message.size());
+	}
+	else
+	{
+		parse_result = LLSDSerialize::fromXML(mMessage, input);
+	}
 
 	return (int)parse_result;
 }
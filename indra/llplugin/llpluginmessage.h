@@ -97,14 +97,22 @@ public:
 	// Gets the value of a key as a pointer.
 	void* getValuePointer(const std::string& key) const;
 
-	// Flattens the message into a string
-	std::string generate() const;
+	// Flattens the message into a string. When 'binary' is true, the
+	// compact binary LLSD serialization is used instead of XML: only use it
+	// over a message pipe for which the binary framing got negotiated (see
+	// LLPluginMessagePipeOwner::setBinaryFraming()), since binary messages
+	// may contain NUL characters.
+	std::string generate(bool binary = false) const;
 
 	// Parses an incoming message into component parts (this clears out any
-	// existing state before starting the parse). Returns -1 on failure,
-	// otherwise returns the number of key/value pairs in the message.
+	// existing state before starting the parse). Both XML and binary LLSD
+	// messages are accepted. Returns -1 on failure, otherwise returns the
+	// number of key/value pairs in the message.
 	int parse(const std::string& message);
 
+	// Returns true when 'message' is a binary LLSD serialized message.
+	static bool isBinary(const std::string& message);
+
 private:
 	LLSD mMessage;
 };
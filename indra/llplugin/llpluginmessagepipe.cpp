@@ -35,14 +35,22 @@
 #include "llpluginmessagepipe.h"
 
 #include "llapr.h"
+#include "llpluginmessage.h"
 #include "llbufferstream.h"
 #include "lltimer.h"				// For ms_sleep()
 
 static const char MESSAGE_DELIMITER = '\0';
+// Binary frames start with this marker, which cannot start an XML message,
+// followed with the payload size as a 32 bits big endian integer.
+static const char BINARY_FRAME_MARKER = '\x01';
+constexpr size_t BINARY_FRAME_HEADER_SIZE = 5;
+// Sanity limit for the size of binary frames.
+constexpr size_t BINARY_FRAME_MAX_SIZE = 64 * 1024 * 1024;
 
 LLPluginMessagePipeOwner::LLPluginMessagePipeOwner()
 :	mMessagePipe(NULL),
-	mSocketError(APR_SUCCESS)
+	mSocketError(APR_SUCCESS),
+	mBinaryFraming(false)
 {
 }
 
@@ -70,10 +78,12 @@ bool LLPluginMessagePipeOwner::writeMessageRaw(const std::string& message)
 {
 	if (mMessagePipe)
 	{
-		return mMessagePipe->addMessage(message);
+		return mMessagePipe->addMessage(message, mBinaryFraming);
 	}
 
-	llwarns << "Dropping message: " << message << llendl;
+	llwarns << "Dropping message: "
+			<< (LLPluginMessage::isBinary(message) ? "<binary LLSD>"
+												   : message) << llendl;
 	return false;
 }
 
@@ -104,7 +114,7 @@ LLPluginMessagePipe::~LLPluginMessagePipe()
 }
 
 // Queues the message for later output
-bool LLPluginMessagePipe::addMessage(const std::string& message)
+bool LLPluginMessagePipe::addMessage(const std::string& message, bool binary)
 {
 	mOutputMutex.lock();
 
@@ -115,8 +125,23 @@ bool LLPluginMessagePipe::addMessage(const std::string& message)
 		mOutputStartIndex = 0;
 	}
 
-	mOutput += message;
-	mOutput += MESSAGE_DELIMITER;	// message separator
+	if (binary)
+	{
+		U32 size = (U32)message.size();
+		char header[BINARY_FRAME_HEADER_SIZE];
+		header[0] = BINARY_FRAME_MARKER;
+		header[1] = char((size >> 24) & 0xff);
+		header[2] = char((size >> 16) & 0xff);
+		header[3] = char((size >> 8) & 0xff);
+		header[4] = char(size & 0xff);
+		mOutput.append(header, BINARY_FRAME_HEADER_SIZE);
+		mOutput += message;
+	}
+	else
+	{
+		mOutput += message;
+		mOutput += MESSAGE_DELIMITER;	// message separator
+	}
 
 	mOutputMutex.unlock();
 
@@ -160,9 +185,11 @@ bool LLPluginMessagePipe::pumpOutput()
 	{
 		mOutputMutex.lock();
 
-		const char* output_data = &(mOutput.data()[mOutputStartIndex]);
-		if (*output_data != '\0')
+		// Note: we cannot test for a NUL character at the start index like
+		// we used to, since binary frames may contain some.
+		if (mOutputStartIndex < mOutput.size())
 		{
+			const char* output_data = mOutput.data() + mOutputStartIndex;
 			// Write any outgoing messages
 			apr_size_t in_size = (apr_size_t)(mOutput.size() -
 											  mOutputStartIndex);
@@ -332,24 +359,63 @@ bool LLPluginMessagePipe::pumpInput(F64 timeout)
 	return result;
 }
 
+bool LLPluginMessagePipe::extractMessage(std::string& message)
+{
+	if (mInput.empty())
+	{
+		return false;
+	}
+
+	if (mInput[0] == BINARY_FRAME_MARKER)
+	{
+		if (mInput.size() < BINARY_FRAME_HEADER_SIZE)
+		{
+			return false;	// Incomplete header
+		}
+		const unsigned char* header = (const unsigned char*)mInput.data();
+		size_t size = ((size_t)header[1] << 24) | ((size_t)header[2] << 16) |
+					  ((size_t)header[3] << 8) | (size_t)header[4];
+		if (size > BINARY_FRAME_MAX_SIZE)
+		{
+			llwarns << "Invalid binary frame size (" << size
+					<< "), discarding input." << llendl;
+			mInput.clear();
+			return false;
+		}
+		if (mInput.size() < BINARY_FRAME_HEADER_SIZE + size)
+		{
+			return false;	// Incomplete frame
+		}
+		message.assign(mInput, BINARY_FRAME_HEADER_SIZE, size);
+		mInput.erase(0, BINARY_FRAME_HEADER_SIZE + size);
+		return true;
+	}
+
+	size_t delim = mInput.find(MESSAGE_DELIMITER);
+	if (delim == std::string::npos)
+	{
+		return false;
+	}
+	message.assign(mInput, 0, delim);
+	mInput.erase(0, delim + 1);
+	return true;
+}
+
 void LLPluginMessagePipe::processInput()
 {
-	// Look for input delimiter(s) in the input buffer.
+	// Look for complete message(s) in the input buffer.
 	std::string message;
-	size_t delim;
 	mInputMutex.lock();
-	while ((delim = mInput.find(MESSAGE_DELIMITER)) != std::string::npos)
+	while (extractMessage(message))
 	{
 		// Let the owner process this message
 		if (mOwner)
 		{
-			// Pull the message out of the input buffer before calling
+			// The message was pulled out of the input buffer before calling
 			// receiveMessageRaw. It is now possible for this function to get
 			// called recursively (in the case where the plugin makes a
 			// blocking request) and this guarantees that the messages will get
 			// dequeued correctly.
-			message.assign(mInput, 0, delim);
-			mInput.erase(0, delim + 1);
 			mInputMutex.unlock();
 			mOwner->receiveMessageRaw(message);
 			mInputMutex.lock();
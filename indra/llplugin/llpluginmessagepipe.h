@@ -58,6 +58,13 @@ public:
 	// LLPluginMessagePipeOwner: do not use !
 	virtual void setMessagePipe(LLPluginMessagePipe* message_pipe);
 
+	// Once both ends of the pipe agreed on it (during the "hello" and
+	// "load_plugin" handshake), messages are sent as length-prefixed binary
+	// LLSD frames instead of NUL-terminated XML. Incoming messages are always
+	// accepted in both formats.
+	LL_INLINE void setBinaryFraming(bool b)	{ mBinaryFraming = b; }
+	LL_INLINE bool hasBinaryFraming() const	{ return mBinaryFraming; }
+
 protected:
 	// Returns false if writeMessageRaw() would drop the message
 	LL_INLINE bool canSendMessage()			{ return mMessagePipe != NULL; }
@@ -71,6 +78,7 @@ protected:
 protected:
 	LLPluginMessagePipe*	mMessagePipe;
 	apr_status_t			mSocketError;
+	bool					mBinaryFraming;
 };
 
 class LLPluginMessagePipe
@@ -87,7 +95,9 @@ public:
 	// process_impl should send any remaining data and exit.
 	LL_INLINE void clearOwner()				{ mOwner = NULL; }
 	
-	bool addMessage(const std::string& message);
+	// When 'binary' is true, 'message' is sent in a length-prefixed frame
+	// (it may then contain NUL characters), else it is NUL-terminated.
+	bool addMessage(const std::string& message, bool binary = false);
 
 	bool pump(F64 timeout = 0.0);
 	bool pumpOutput();
@@ -96,6 +106,10 @@ public:
 protected:	
 	void processInput();
 
+	// Extracts the next complete message (if any) from mInput, which must be
+	// locked by the caller. Returns false when no complete message is found.
+	bool extractMessage(std::string& message);
+
 	// Used internally by pump()
 	void setSocketTimeout(apr_interval_time_t timeout_usec);
 	
@@ -156,10 +156,15 @@ void LLPluginProcessChild::idle()
 				break;
 
 			case STATE_CONNECTED:
-				sendMessageToParent(LLPluginMessage(LLPLUGIN_MESSAGE_CLASS_INTERNAL,
-													"hello"));
+			{
+				LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_INTERNAL,
+										"hello");
+				// Let the parent know we can deal with binary framing.
+				message.setValueBoolean("binary_framing", true);
+				sendMessageToParent(message);
 				setState(STATE_PLUGIN_LOADING);
 				break;
+			}
 
 			case STATE_PLUGIN_LOADING:
 				if (!mPluginFile.empty())
@@ -341,9 +346,11 @@ void LLPluginProcessChild::sendMessageToPlugin(const LLPluginMessage& message)
 
 void LLPluginProcessChild::sendMessageToParent(const LLPluginMessage& message)
 {
-	std::string buffer = message.generate();
+	std::string buffer = message.generate(hasBinaryFraming());
 
-	LL_DEBUGS("Plugin") << "Sending to parent: " << buffer << LL_ENDL;
+	LL_DEBUGS("Plugin") << "Sending to parent: "
+						<< (hasBinaryFraming() ? message.getName() : buffer)
+						<< LL_ENDL;
 
 	writeMessageRaw(buffer);
 }
@@ -352,12 +359,15 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string& message)
 {
 	// Incoming message from the TCP Socket
 
-	LL_DEBUGS("Plugin") << "Received from parent: " << message << LL_ENDL;
-
 	// Decode this message
 	LLPluginMessage parsed;
 	parsed.parse(message);
 
+	LL_DEBUGS("Plugin") << "Received from parent: "
+						<< (LLPluginMessage::isBinary(message) ? parsed.getName()
+															   : message)
+						<< LL_ENDL;
+
 	if (mBlockingRequest)
 	{
 		// We are blocking the plugin waiting for a response.
@@ -390,6 +400,11 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string& message)
 			{
 				mPluginFile = parsed.getValue("file");
 				mPluginDir = parsed.getValue("dir");
+				if (parsed.getValueBoolean("binary_framing"))
+				{
+					// The parent agreed to use binary framing.
+					setBinaryFraming(true);
+				}
 			}
 			else if (message_name == "shutdown_plugin")
 			{
@@ -488,7 +503,16 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string& message)
 	if (pass_message && mInstance)
 	{
 		LLTimer elapsed;
-		mInstance->sendMessage(message);
+		if (LLPluginMessage::isBinary(message))
+		{
+			// The plugin API passes messages as C strings, so plugins only
+			// ever deal with XML messages.
+			mInstance->sendMessage(parsed.generate());
+		}
+		else
+		{
+			mInstance->sendMessage(message);
+		}
 		mCPUElapsed += elapsed.getElapsedTimeF64();
 	}
 }
@@ -510,12 +534,12 @@ void LLPluginProcessChild::receivePluginMessage(const std::string& message)
 
 	// *FIXME: how should we handle queueing here?
 
+	// Decode this message
+	LLPluginMessage parsed;
+	parsed.parse(message);
+
 	// Intercept certain base messages (responses to ones sent by this class)
 	{
-		// Decode this message
-		LLPluginMessage parsed;
-		parsed.parse(message);
-
 		if (parsed.hasValue("blocking_request"))
 		{
 			mBlockingRequest = true;
@@ -586,7 +610,16 @@ void LLPluginProcessChild::receivePluginMessage(const std::string& message)
 	{
 		LL_DEBUGS("Plugin") << "Passing through to parent: " << message
 							<< LL_ENDL;
-		writeMessageRaw(message);
+		if (hasBinaryFraming())
+		{
+			// Re-serialize in binary form: this saves the (busier) parent
+			// process the costly XML parsing.
+			writeMessageRaw(parsed.generate(true));
+		}
+		else
+		{
+			writeMessageRaw(message);
+		}
 	}
 
 	while (mBlockingRequest)
@@ -44,6 +44,7 @@ std::string LLPluginProcessParent::sMediaBrowserVersion;
 apr_pollset_t* LLPluginProcessParent::sPollSet = NULL;
 bool LLPluginProcessParent::sPollsetNeedsRebuild = false;
 bool LLPluginProcessParent::sUseReadThread = false;
+bool LLPluginProcessParent::sUseBinaryFraming = true;
 LLThread* LLPluginProcessParent::sReadThread = NULL;
 LLMutex LLPluginProcessParent::sInstancesMutex;
 LLPluginProcessParent::instances_map_t LLPluginProcessParent::sInstances;
@@ -136,7 +137,8 @@ LLPluginProcessParent::LLPluginProcessParent(LLPluginProcessParentOwner* owner)
 	mBoundPort = 0;
 	mState = STATE_UNINITIALIZED;
 	mSleepTime = mCPUUsage = 0.0;
-	mDisableTimeout = mPolledInput = mBlocked = mDebug = false;
+	mDisableTimeout = mPolledInput = mBlocked = mDebug =
+		mPeerBinaryFraming = false;
 	mPollFD.client_data = NULL;
 
 	mPluginLaunchTimeout = 60.f;
@@ -641,7 +643,20 @@ void LLPluginProcessParent::idle()
 											"load_plugin");
 					message.setValue("file", mPluginFile);
 					message.setValue("dir", mPluginDir);
+					bool binary = mPeerBinaryFraming && sUseBinaryFraming;
+					if (binary)
+					{
+						message.setValueBoolean("binary_framing", true);
+					}
+					// Sent with the XML framing: the plugin process only
+					// switches to binary framing on reception.
 					sendMessage(message);
+					if (binary)
+					{
+						LL_DEBUGS("Plugin") << "Using binary messages framing"
+											<< LL_ENDL;
+						setBinaryFraming(true);
+					}
 				}
 
 				setState(STATE_LOADING);
@@ -769,8 +784,10 @@ void LLPluginProcessParent::sendMessage(const LLPluginMessage& message)
 		mHeartbeat.setTimerExpirySec(mPluginLockupTimeout);
 	}
 
-	std::string buffer = message.generate();
-	LL_DEBUGS("Plugin") << "Sending: " << buffer << LL_ENDL;
+	std::string buffer = message.generate(hasBinaryFraming());
+	LL_DEBUGS("Plugin") << "Sending: "
+						<< (hasBinaryFraming() ? message.getName() : buffer)
+						<< LL_ENDL;
 	writeMessageRaw(buffer);
 
 	// Try to send message immediately.
@@ -1053,11 +1070,14 @@ void LLPluginProcessParent::servicePoll()
 
 void LLPluginProcessParent::receiveMessageRaw(const std::string& message)
 {
-	LL_DEBUGS("Plugin") << "Received: " << message << LL_ENDL;
-
 	LLPluginMessage parsed;
 	if (parsed.parse(message) != LLSDParser::PARSE_FAILURE)
 	{
+		LL_DEBUGS("Plugin") << "Received: "
+							<< (LLPluginMessage::isBinary(message) ? parsed.getName()
+																   : message)
+							<< LL_ENDL;
+
 		if (parsed.hasValue("blocking_request"))
 		{
 			mBlocked = true;
@@ -1115,6 +1135,7 @@ void LLPluginProcessParent::receiveMessage(const LLPluginMessage& message)
 		{
 			if (mState == STATE_CONNECTED)
 			{
+				mPeerBinaryFraming = message.getValueBoolean("binary_framing");
 				// Plugin host has launched. Tell it which plugin to load.
 				setState(STATE_HELLO);
 			}
@@ -161,6 +161,11 @@ public:
 	static void setUseReadThread(bool use_read_thread);
 	LL_INLINE static bool getUseReadThread()	{ return sUseReadThread; }
 
+	// When true (the default), binary framing of the messages is negotiated
+	// with the plugins processes launched afterwards.
+	LL_INLINE static void setUseBinaryFraming(bool b)	{ sUseBinaryFraming = b; }
+	LL_INLINE static bool getUseBinaryFraming()			{ return sUseBinaryFraming; }
+
 	LL_INLINE static const std::string& getMediaBrowserVersion()
 	{
 		return sMediaBrowserVersion;
@@ -245,6 +250,8 @@ private:
 	bool						mProcessStarted;
 	bool						mDisableTimeout;
 	bool						mBlocked;
+	// True when the plugin process offered binary framing in its "hello"
+	bool						mPeerBinaryFraming;
 	bool						mPolledInput;
 	bool						mDebug;
 
@@ -255,6 +262,7 @@ private:
 	static instances_map_t		sInstances;
 	static LLThread*			sReadThread;
 	static bool					sUseReadThread;
+	static bool					sUseBinaryFraming;
 	static bool					sPollsetNeedsRebuild;
 };
 
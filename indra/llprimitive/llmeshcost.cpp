@@ -0,0 +1,161 @@
+/**
+ * @file llmeshcost.cpp
+ * @brief Mesh assets streaming cost computations
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmeshcost.h"
+
+#include "llmath.h"
+#include "llsd.h"
+
+// Indexed by LOD number
+static const char* sLODHeaderNames[] =
+{
+	"lowest_lod",
+	"low_lod",
+	"medium_lod",
+	"high_lod"
+};
+
+//static
+void LLMeshCost::getLODSizes(const LLSD& header, S32* sizes)
+{
+	for (S32 i = 0; i < 4; ++i)
+	{
+		const char* name = sLODHeaderNames[i];
+		sizes[i] = header.has(name) ? header[name]["size"].asInteger() : 0;
+	}
+}
+
+//static
+bool LLMeshCost::fillLODSizes(S32* sizes)
+{
+	if (sizes[3] <= 0)
+	{
+		sizes[3] = llmax(0, sizes[2], sizes[1], sizes[0]);
+	}
+	if (sizes[3] == 0)
+	{
+		return false;
+	}
+	for (S32 i = 2; i >= 0; --i)
+	{
+		if (sizes[i] <= 0)
+		{
+			sizes[i] = sizes[i + 1];
+		}
+	}
+	return true;
+}
+
+//static
+F32 LLMeshCost::estimateTrisByLOD(const S32* sizes, F32* est_tris,
+								  S32 discount, S32 min_size,
+								  F32 bytes_per_tri)
+{
+	F32 max = 0.f;
+	for (S32 i = 0; i < 4; ++i)
+	{
+		S32 size = llmax(sizes[i] - discount, min_size);
+		F32 tris = (F32)size / bytes_per_tri;
+		if (tris > max)
+		{
+			max = tris;
+		}
+		est_tris[i] = tris;
+	}
+	return max;
+}
+
+//static
+F32 LLMeshCost::getRadiusWeightedTris(const F32* est_tris, F32 radius)
+{
+	constexpr F32 MAX_DISTANCE = 512.f;
+	constexpr F32 K1 = 1.f / 0.03f;
+	constexpr F32 K2 = 1.f / 0.06f;
+	constexpr F32 K3 = 1.f / 0.24f;
+	F32 dlowest = llmin(radius * K1, MAX_DISTANCE);
+	F32 dlow = llmin(radius * K2, MAX_DISTANCE);
+	F32 dmid = llmin(radius * K3, MAX_DISTANCE);
+
+	// Area of a circle that encompasses region (see MAINT-6559):
+	constexpr F32 MAX_AREA = 102944.f;
+	constexpr F32 MIN_AREA = 1.f;
+
+	F32 high_area = llmin(F_PI * dmid * dmid, MAX_AREA);
+	F32 mid_area = llmin(F_PI * dlow * dlow, MAX_AREA);
+	F32 low_area = llmin(F_PI * dlowest * dlowest, MAX_AREA);
+	F32 lowest_area = MAX_AREA;
+
+	lowest_area -= low_area;
+	low_area -= mid_area;
+	mid_area -= high_area;
+
+	high_area = llclamp(high_area, MIN_AREA, MAX_AREA);
+	mid_area = llclamp(mid_area, MIN_AREA, MAX_AREA);
+	low_area = llclamp(low_area, MIN_AREA, MAX_AREA);
+	lowest_area = llclamp(lowest_area, MIN_AREA, MAX_AREA);
+
+	F32 inv_total_area = 1.f / (high_area + mid_area + low_area + lowest_area);
+	high_area *= inv_total_area;
+	mid_area *= inv_total_area;
+	low_area *= inv_total_area;
+	lowest_area *= inv_total_area;
+
+	return est_tris[3] * high_area + est_tris[2] * mid_area +
+		   est_tris[1] * low_area + est_tris[0] * lowest_area;
+}
+
+//static
+F32 LLMeshCost::getChargedTris(const F32* est_tris)
+{
+	F32 charged_tris = est_tris[3];
+	F32 allowed_tris = charged_tris;
+	constexpr F32 ENFORCE_FLOOR = 64.f;
+	for (S32 i = 2; i >= 0; --i)
+	{
+		// How many tris can we have in this LOD without affecting land
+		// impact ?
+		// - normally a LOD should be at most half the size of the previous
+		//   one
+		// - once we reach a floor of ENFORCE_FLOOR, do not require LODs to
+		//   get any smaller.
+		allowed_tris = llclamp(allowed_tris * 0.5f, ENFORCE_FLOOR,
+							   est_tris[i]);
+		F32 excess_tris = est_tris[i] - allowed_tris;
+		if (excess_tris > 0.f)
+		{
+			charged_tris += excess_tris;
+		}
+	}
+	return charged_tris;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file llmeshcost.h
+ * @brief Mesh assets streaming cost computations
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESHCOST_H
+#define LL_LLMESHCOST_H
+
+#include "stdtypes.h"
+
+class LLSD;
+
+// Default values of the MeshMetaDataDiscount, MeshMinimumByteSize,
+// MeshBytesPerTriangle and MeshTriangleBudget viewer settings.
+constexpr S32 MESH_COST_METADATA_DISCOUNT = 384;
+constexpr S32 MESH_COST_MINIMUM_BYTE_SIZE = 16;
+constexpr F32 MESH_COST_BYTES_PER_TRIANGLE = 16.f;
+constexpr F32 MESH_COST_TRIANGLE_BUDGET = 250000.f;
+
+constexpr F32 ANIMATED_OBJECT_COST_PER_KTRI = 1.5f;
+
+// Purely static class holding the mesh streaming cost formulas, shared by the
+// viewer (LLMeshCostData) and the meshconverter tool. The per-LOD arrays are
+// indexed by LOD number: 0 = lowest, 3 = highest.
+class LLMeshCost
+{
+public:
+	LLMeshCost() = delete;
+	~LLMeshCost() = delete;
+
+	// Reads the per-LOD sizes from the "size" field of the LOD entries in a
+	// mesh header. Missing LODs get a zero size.
+	static void getLODSizes(const LLSD& header, S32* sizes);
+
+	// Replaces missing (zero-sized) LODs with the next higher one, and the
+	// missing highest LOD with the largest one. Returns false when all LODs
+	// are missing.
+	static bool fillLODSizes(S32* sizes);
+
+	// Estimates the triangle counts for each LOD, from their byte sizes.
+	// Returns the largest estimate.
+	static F32 estimateTrisByLOD(const S32* sizes, F32* est_tris,
+								 S32 discount = MESH_COST_METADATA_DISCOUNT,
+								 S32 min_size = MESH_COST_MINIMUM_BYTE_SIZE,
+								 F32 bytes_per_tri =
+									MESH_COST_BYTES_PER_TRIANGLE);
+
+	// Triangle count as computed by original streaming cost formula.
+	// Triangles in each LOD are weighted based on how frequently they will be
+	// seen for an object of the given bounding sphere radius.
+	static F32 getRadiusWeightedTris(const F32* est_tris, F32 radius);
+
+	// Triangle count used by triangle-based cost formula. Based on triangles
+	// in highest LOD plus potentially partial charges for lower LODs depending
+	// on complexity.
+	static F32 getChargedTris(const F32* est_tris);
+
+	// Streaming cost. This should match the server-side calculation for the
+	// corresponding volume.
+	LL_INLINE static F32 getRadiusBasedCost(const F32* est_tris, F32 radius,
+											F32 triangle_budget =
+												MESH_COST_TRIANGLE_BUDGET)
+	{
+		return getRadiusWeightedTris(est_tris, radius) * 15000.f /
+			   triangle_budget;
+	}
+
+	// New streaming cost formula, currently only used for animated objects.
+	LL_INLINE static F32 getTriangleBasedCost(const F32* est_tris)
+	{
+		return getTriangleBasedCost(getChargedTris(est_tris));
+	}
+
+	LL_INLINE static F32 getTriangleBasedCost(F32 charged_tris)
+	{
+		return ANIMATED_OBJECT_COST_PER_KTRI * 0.001f * charged_tris;
+	}
+};
+
+#endif	// LL_LLMESHCOST_H
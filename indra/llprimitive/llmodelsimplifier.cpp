@@ -0,0 +1,617 @@
+/**
+ * @file llmodelsimplifier.cpp
+ * @brief LLModelSimplifier class implementation
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <sstream>
+
+#include "llmodelsimplifier.h"
+
+#include "llmeshoptimizer.h"
+#include "llmodel.h"
+
+//static
+LLModel* LLModelSimplifier::simplify(LLModel* base, const std::string& label,
+									 U32 method, F32 indices_decim,
+									 F32 lod_err_thres, bool limit_triangles,
+									 std::vector<std::string>& log)
+{
+	LLVolumeParams volume_params;
+	volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+	LLModel* target_model = new LLModel(volume_params, 0.f);
+
+	target_model->mLabel = label;
+	target_model->mSubmodelID = base->mSubmodelID;
+	target_model->setNumVolumeFaces(base->getNumVolumeFaces());
+
+	// Carry over normalized transform into simplified model
+	for (U32 i = 0, count = base->getNumVolumeFaces(); i < count; ++i)
+	{
+		LLVolumeFace& src = base->getVolumeFace(i);
+		LLVolumeFace& dst = target_model->getVolumeFace(i);
+		dst.mNormalizedScale = src.mNormalizedScale;
+	}
+
+	constexpr F32 allowed_ratio_drift = 1.8f;
+
+	U32 model_meshopt_mode = method;
+
+	std::ostringstream out;
+	out << "Model " << target_model->mLabel;
+
+	F32 ratio = 0.f;
+
+	// Ideally this should run not per model, but combine all sub-models with
+	// origin model as well.
+	if (model_meshopt_mode == PRECISE)
+	{
+		// Run meshoptimizer for each face
+		for (U32 face_idx = 0, count = base->getNumVolumeFaces();
+			 face_idx < count; ++face_idx)
+		{
+			ratio = simplifyPerFace(base, target_model, face_idx,
+									indices_decim, lod_err_thres, FULL, log);
+			if (ratio < 0.f)
+			{
+				break;
+			}
+		}
+		if (ratio < 0.f)
+		{
+			model_meshopt_mode = AUTO;
+		}
+		else
+		{
+			out << " simplified using per face method.";
+		}
+	}
+
+	if (model_meshopt_mode == AUTO)
+	{
+		// Remove progressively more data if we cannot reach the target. Run
+		// meshoptimizer for each model/object, up to 8 faces in one model.
+		ratio = simplifyPerModel(base, target_model, indices_decim,
+								 lod_err_thres, FULL);
+		bool done = ratio * allowed_ratio_drift >= indices_decim;
+		if (done)
+		{
+			out << " simplified using per model method.";
+		}
+		else
+		{
+			ratio = simplifyPerModel(base, target_model, indices_decim,
+									 lod_err_thres, NO_NORMALS);
+			done = ratio * allowed_ratio_drift >= indices_decim;
+			if (done)
+			{
+				out << " simplified using per model method without normals.";
+			}
+		}
+		if (!done)
+		{
+			ratio = simplifyPerModel(base, target_model, indices_decim,
+									 lod_err_thres, NO_UVS);
+			done = ratio * allowed_ratio_drift >= indices_decim;
+			if (done)
+			{
+				out << " simplified using per model method without UVs.";
+			}
+		}
+		if (!done)
+		{
+			// Try sloppy variant if normal one failed to simplify model
+			// enough. Use per-model, sloppy optimization
+			ratio = simplifyPerModel(base, target_model, indices_decim,
+									 lod_err_thres, NO_TOPOLOGY);
+			// Sloppy has a tendency to error into lower side, so a request for
+			// 100 triangles turns into ~70; check for significant difference
+			// from target decimation.
+			constexpr F32 sloppy_ratio_drift = 1.4f;
+			if (limit_triangles &&
+				(ratio < 0.f || ratio > indices_decim * sloppy_ratio_drift))
+			{
+				// Apply a correction to compensate.
+				// (indices_decim / res_ratio) by itself is likely to overshoot
+				// to a different side due to overal lack of precision, and we
+				// do not need an ideal result, which likely does not exist,
+				// just a better one, so a partial correction is enough.
+				F32 sloppy_decimator = indices_decim * 0.5f *
+									   (indices_decim / ratio + 1.f);
+				ratio = simplifyPerModel(base, target_model, sloppy_decimator,
+										 lod_err_thres, NO_TOPOLOGY);
+			}
+			if (ratio < 0.f)
+			{
+				// Sloppy variant failed to generate triangles. Can happen with
+				// models that are too simple as is. Fallback to normal method.
+				if (simplifyPerModel(base, target_model, indices_decim,
+									 lod_err_thres, FULL) < 0.f)
+				{
+					// Failed again !  Fall back to sloppy per face method
+					model_meshopt_mode = SLOPPY;
+				}
+				else
+				{
+					out << " simplified using per model sloppy method.";
+				}
+			}
+		}
+	}
+
+	if (model_meshopt_mode == SLOPPY)
+	{
+		for (U32 face_idx = 0, count = base->getNumVolumeFaces();
+			 face_idx < count; ++face_idx)
+		{
+			if (simplifyPerFace(base, target_model, face_idx, indices_decim,
+								lod_err_thres, NO_TOPOLOGY, log) < 0)
+			{
+				simplifyPerFace(base, target_model, face_idx, indices_decim,
+								lod_err_thres, FULL, log);
+			}
+		}
+		out << " simplified using per face sloppy method.";
+	}
+
+	log.emplace_back(out.str());
+
+	// Blind-copy skin weights and just take closest skin weight to point on
+	// decimated mesh for now (auto-generating LODs with skin weights is still
+	// a bit of an open problem).
+	target_model->mPosition = base->mPosition;
+	target_model->mSkinWeights = base->mSkinWeights;
+	target_model->mSkinInfo.clone(base->mSkinInfo);
+	// Copy materials list
+	target_model->mMaterialList = base->mMaterialList;
+
+	return target_model;
+}
+
+//static
+F32 LLModelSimplifier::simplifyPerModel(LLModel* base_model,
+										LLModel* target_model,
+										F32 indices_decim, F32 error_threshold,
+										S32 simplification_mode)
+{
+	U32 num_vol_faces = base_model->getNumVolumeFaces();
+
+	// Figure out buffer size
+	S32 size_indices = 0;
+	S32 size_vertices = 0;
+	for (U32 i = 0; i < num_vol_faces; ++i)
+	{
+		const LLVolumeFace& face = base_model->getVolumeFace(i);
+		size_indices += face.mNumIndices;
+		size_vertices += face.mNumVertices;
+	}
+
+	if (size_indices < 3)
+	{
+		return -1.f;
+	}
+
+	// Allocate buffers; note that we are using U32 buffer instead of U16.
+	size_t indices_bytes = size_indices * sizeof(U32);
+	U32* output_indices = (U32*)allocate_volume_mem(indices_bytes);
+	U32* combined_indices = (U32*)allocate_volume_mem(indices_bytes);
+
+	// Extra space for normals and text coords
+	S32 tc_bytes_size = (size_vertices * sizeof(LLVector2) + 0xF) & ~0xF;
+	LLVector4a* combined_positions =
+		(LLVector4a*)allocate_volume_mem_64(sizeof(LLVector4a) * 3 *
+											size_vertices +	tc_bytes_size);
+	LLVector4a* combined_normals = combined_positions + size_vertices;
+	LLVector2* combined_tex_coords = (LLVector2*)(combined_normals +
+												  size_vertices);
+
+	// Copy indices and vertices into new buffers
+	S32 combined_positions_shift = 0;
+	S32 indices_idx_shift = 0;
+	S32 combined_indices_shift = 0;
+	for (U32 i = 0; i < num_vol_faces; ++i)
+	{
+		const LLVolumeFace& face = base_model->getVolumeFace(i);
+
+		// Vertices
+		S32 copy_bytes = face.mNumVertices * sizeof(LLVector4a);
+		LLVector4a::memcpyNonAliased16((F32*)(combined_positions +
+											  combined_positions_shift),
+									   (F32*)face.mPositions, copy_bytes);
+
+		// Normals
+		LLVector4a::memcpyNonAliased16((F32*)(combined_normals +
+											  combined_positions_shift),
+									   (F32*)face.mNormals, copy_bytes);
+
+		// Texture coords
+		copy_bytes = face.mNumVertices * sizeof(LLVector2);
+		memcpy((void*)(combined_tex_coords + combined_positions_shift),
+			   (void*)face.mTexCoords, copy_bytes);
+
+		combined_positions_shift += face.mNumVertices;
+
+		// Sadly, indices cannot use a simple memcpy; we need to adjust each
+		// value...
+		for (U32 j = 0, count = face.mNumIndices; j < count; ++j)
+		{
+			combined_indices[combined_indices_shift++] = face.mIndices[j] +
+														 indices_idx_shift;
+		}
+
+		indices_idx_shift += face.mNumVertices;
+	}
+
+	// Generate a shadow buffer if necessary. Welds vertices together if
+	// possible.
+	U32* shadow_indices = NULL;
+	// If FULL, just leave as is, since model was remaped on a
+	// per face basis. Similar for NO_TOPOLOGY, it is pointless
+	// since sloppy simplification ignores all topology, including normals and
+	// UVs (which can be significantly affected).
+	if (simplification_mode == NO_NORMALS)
+	{
+		// Strip normals, reflections should restore relatively correctly.
+		shadow_indices = (U32*)allocate_volume_mem(indices_bytes);
+		LLMeshOptimizer::generateShadowIndexBuffer32(shadow_indices,
+													 combined_indices,
+													 size_indices,
+													 combined_positions, NULL,
+													 combined_tex_coords,
+													 size_vertices);
+	}
+	else if (simplification_mode == NO_UVS)
+	{
+		// Strip UVs, which can heavily affect textures
+		shadow_indices = (U32*)allocate_volume_mem(indices_bytes);
+		LLMeshOptimizer::generateShadowIndexBuffer32(shadow_indices,
+												     combined_indices,
+												     size_indices,
+												     combined_positions,
+												     NULL, NULL,
+													 size_vertices);
+	}
+	U32* source_indices = shadow_indices ? shadow_indices : combined_indices;
+
+	//  Now that we have buffers, optimize
+
+	// How far from original the model is, 1.f == 100%
+	F32 result_code = 0.f;
+
+	S32 target_indices;
+	if (indices_decim > 0.f)
+	{
+		// Leave at least one triangle
+		target_indices = llmax(3, llfloor(size_indices / indices_decim));
+	}
+	else
+	{
+		// Indices_decimator can be zero for error_threshold based calculations
+		target_indices = 3;
+	}
+
+	S32 type_size = sizeof(LLVector4a);
+	bool sloppy = simplification_mode == NO_TOPOLOGY;
+	S32 new_indices = LLMeshOptimizer::simplify32(output_indices,
+												  source_indices,
+												  size_indices,
+												  combined_positions,
+												  size_vertices, type_size,
+												  target_indices,
+												  error_threshold, sloppy,
+												  &result_code);
+	if (result_code < 0)
+	{
+		llwarns << "Negative result code from meshoptimizer for model: "
+				<< target_model->mLabel << " - Target indices: "
+				<< target_indices << " - New indices: " << new_indices
+				<< " - Original count: " << size_indices << llendl;
+	}
+
+	// Free unused buffers
+	free_volume_mem(combined_indices);
+	free_volume_mem(shadow_indices);
+	combined_indices = shadow_indices = NULL;
+
+	if (new_indices < 3)
+	{
+		// Model should have at least one visible triangle
+		free_volume_mem(output_indices);
+		free_volume_mem_64(combined_positions);
+		return -1.f;
+	}
+
+	// Repack back into individual faces
+
+	LLVector4a* buffer_positions =
+		(LLVector4a*)allocate_volume_mem_64(sizeof(LLVector4a) * 3 *
+											size_vertices + tc_bytes_size);
+	LLVector4a* buffer_normals = buffer_positions + size_vertices;
+	LLVector2* buffer_tex_coords = (LLVector2*)(buffer_normals +
+												size_vertices);
+	size_t buffer_idx_size = (size_indices * sizeof(U16) + 0xF) & ~0xF;
+	U16* buffer_indices = (U16*)allocate_volume_mem(buffer_idx_size);
+	S32* old_to_new_positions_map = new S32[size_vertices];
+
+	indices_idx_shift = 0;
+	U32 valid_faces = 0;
+
+	// Crude method to copy indices back into face
+	for (U32 i = 0; i < num_vol_faces; ++i)
+	{
+		const LLVolumeFace& face = base_model->getVolumeFace(i);
+
+		S32 range = indices_idx_shift + face.mNumVertices;
+		S32 buf_positions_copied = 0;
+		S32 buf_indices_copied = 0;
+		bool copy_triangle = false;
+
+		for (S32 j = 0; j < size_vertices; ++j)
+		{
+			old_to_new_positions_map[j] = -1;
+		}
+
+		// Copy relevant indices and vertices
+		for (S32 j = 0; j < new_indices; ++j)
+		{
+			U32 idx = output_indices[j];
+			if (j % 3 == 0)
+			{
+				copy_triangle = idx >= (U32)indices_idx_shift &&
+								idx < (U32)range;
+			}
+			if (!copy_triangle)
+			{
+				continue;
+			}
+			// If it is a new position, we need to copy it
+			if (old_to_new_positions_map[idx] == -1)
+			{
+				// Validate size
+				if (buf_positions_copied >= (S32)U16_MAX)
+				{
+					llwarns << "Over triangle limit. Failed to optimize in 'per object' mode, falling back to per face variant for model: "
+							<< target_model->mLabel << " - Target indices: "
+							<< target_indices << " - New indices: "
+							<< new_indices << " - Original count: "
+							<< size_indices << " - Error threshold: "
+							<< error_threshold << llendl;
+					// Abort as cleanly as possible (i.e. properly release
+					// temp buffers, unlike what happens in LL's code). HB
+					new_indices = -1;	// Forces a 'return -1;' at the end.
+					// This will force a clean exit from the outer loop. HB
+					buf_positions_copied = U16_MAX;
+					break;
+				}
+
+				// Copy everything
+				buffer_positions[buf_positions_copied] =
+					combined_positions[idx];
+				buffer_normals[buf_positions_copied] = combined_normals[idx];
+				buffer_tex_coords[buf_positions_copied] =
+					combined_tex_coords[idx];
+
+				old_to_new_positions_map[idx] = buf_positions_copied;
+				buffer_indices[buf_indices_copied++] = buf_positions_copied++;
+			}
+			else	// Existing position
+			{
+				buffer_indices[buf_indices_copied++] =
+					old_to_new_positions_map[idx];
+			}
+		}
+
+		if (buf_positions_copied >= U16_MAX)
+		{
+			break;
+		}
+
+		LLVolumeFace& new_face = target_model->getVolumeFace(i);
+
+		if (buf_indices_copied < 3)
+		{
+			// Face was optimized away
+			new_face.resizeIndices(3);
+			new_face.resizeVertices(1);
+			memset((void*)new_face.mIndices, 0, sizeof(U16) * 3);
+			new_face.mPositions[0].clear(); // Set first vertice to 0
+			new_face.mNormals[0].clear();
+			new_face.mTexCoords[0].clear();
+		}
+		else
+		{
+			new_face.resizeIndices(buf_indices_copied);
+			new_face.resizeVertices(buf_positions_copied);
+			new_face.allocateTangents(buf_positions_copied);
+
+			S32 idx_size = (buf_indices_copied * sizeof(U16) + 0xF) & ~0xF;
+			LLVector4a::memcpyNonAliased16((F32*)new_face.mIndices,
+										   (F32*)buffer_indices, idx_size);
+
+			S32 vert_size = buf_positions_copied * sizeof(LLVector4a);
+			LLVector4a::memcpyNonAliased16((F32*)new_face.mPositions,
+										   (F32*)buffer_positions, vert_size);
+			LLVector4a::memcpyNonAliased16((F32*)new_face.mNormals,
+										   (F32*)buffer_normals, vert_size);
+
+			U32 tex_size = (buf_positions_copied * sizeof(LLVector2) +
+							0xF) & ~0xF;
+			LLVector4a::memcpyNonAliased16((F32*)new_face.mTexCoords,
+										   (F32*)buffer_tex_coords, tex_size);
+			++valid_faces;
+		}
+
+		indices_idx_shift += face.mNumVertices;
+	}
+
+	delete[] old_to_new_positions_map;
+	free_volume_mem(output_indices);
+	free_volume_mem_64(combined_positions);
+	free_volume_mem_64(buffer_positions);
+	free_volume_mem(buffer_indices);
+
+	if (new_indices < 3 || !valid_faces)
+	{
+		// Model should have at least one visible triangle
+		if (!sloppy)
+		{
+			// Should only happen with sloppy; non sloppy should not be capable
+			// of optimizing mesh away.
+			llwarns << "Failed to generate triangles for model: "
+					<< target_model->mLabel << " - Target Indices: "
+					<< target_indices << " - Original count: " << size_indices
+					<< " - Error treshold: " << error_threshold << llendl;
+		}
+		return -1.f;
+	}
+
+	return (F32)size_indices / (F32)new_indices;
+}
+
+//static
+F32 LLModelSimplifier::simplifyPerFace(LLModel* base_model,
+									   LLModel* target_model, U32 face_idx,
+									   F32 indices_ratio, F32 err_threshold,
+									   S32 simplification_mode,
+									   std::vector<std::string>& log)
+{
+	const LLVolumeFace& face = base_model->getVolumeFace(face_idx);
+	S32 size_indices = face.mNumIndices;
+	if (size_indices < 3)
+	{
+		return -1.f;
+	}
+
+	size_t size = (size_indices * sizeof(U16) + 0xF) & ~0xF;
+	U16* output = (U16*)allocate_volume_mem(size);
+
+	// Generate a shadow buffer if necessary. Welds vertices together if
+	// possible.
+	U16* shadow_indices = NULL;
+	// If FULL, just leave as is, since model was remaped on a
+	// per face basis. Similar for NO_TOPOLOGY, it is pointless
+	// since sloppy simplification ignores all topology, including normals and
+	// UVs (which can be significantly affected).
+	if (simplification_mode == NO_NORMALS)
+	{
+		// Strip normals, reflections should restore relatively correctly.
+		shadow_indices = (U16*)allocate_volume_mem(size);
+		LLMeshOptimizer::generateShadowIndexBuffer16(shadow_indices,
+													 face.mIndices,
+													 size_indices,
+													 face.mPositions, NULL,
+													 face.mTexCoords,
+													 face.mNumVertices);
+	}
+	else if (simplification_mode == NO_UVS)
+	{
+		// Strip UVs, which can heavily affect textures
+		shadow_indices = (U16*)allocate_volume_mem(size);
+		LLMeshOptimizer::generateShadowIndexBuffer16(shadow_indices,
+													 face.mIndices,
+													 size_indices,
+													 face.mPositions, NULL,
+													 NULL, face.mNumVertices);
+	}
+	U16* source_indices = shadow_indices ? shadow_indices : face.mIndices;
+
+	// How far from original the model is, with 1.f == 100%.
+	F32 result_code = 0.f;
+	S32 target_indices;
+	if (indices_ratio > 0.f)
+	{
+		// Leave at least one triangle
+		target_indices = llmax(3, llfloor(size_indices / indices_ratio));
+	}
+	else
+	{
+		target_indices = 3;
+	}
+	S32 type_size = sizeof(LLVector4a);
+	bool sloppy = simplification_mode == NO_TOPOLOGY;
+	S32 new_indices = LLMeshOptimizer::simplify16(output, source_indices,
+												  size_indices,
+												  face.mPositions,
+												  face.mNumVertices, type_size,
+												  target_indices,
+												  err_threshold, sloppy,
+												  &result_code);
+	if (result_code < 0)
+	{
+		llwarns << "Negative result code from meshoptimizer for face "
+				<< face_idx << " of model: " << target_model->mLabel
+				<< " - Target indices: " << target_indices
+				<< " - New indices: " << new_indices << " - Original count: "
+				<< size_indices << " - Error treshold: " << err_threshold
+				<< llendl;
+	}
+
+	LLVolumeFace& new_face = target_model->getVolumeFace(face_idx);
+	new_face = face;  // Copy old values
+
+	if (new_indices < 3)
+	{
+		if (!sloppy)
+		{
+			// meshopt_optimizeSloppy() can optimize triangles away even if
+			// target_indices is > 2, but optimize() is not supposed to...
+			std::ostringstream out;
+			out << "No indices generated by meshoptimizer for face "
+				<< face_idx << " of model: " << target_model->mLabel
+				<< " - Target indices: " << target_indices
+				<< " - Original count: " << size_indices
+				<< " - Error treshold: " << err_threshold;
+			log.emplace_back(out.str());
+			// Face got optimized away; generate an empty triangle.
+			new_face.resizeIndices(3);
+			new_face.resizeVertices(1);
+			memset((void*)new_face.mIndices, 0, sizeof(U16) * 3);
+			new_face.mPositions[0].clear();
+			new_face.mNormals[0].clear();
+			new_face.mTexCoords[0].clear();
+		}
+	}
+	else	// Assign new values
+	{
+		// Wipes out mIndices, so new_face cannot substitute output
+		new_face.resizeIndices(new_indices);
+		S32 idx_size = (new_indices * sizeof(U16) + 0xF) & ~0xF;
+		LLVector4a::memcpyNonAliased16((F32*)new_face.mIndices, (F32*)output,
+									   idx_size);
+		// Clear unused values
+		new_face.optimize();
+	}
+
+	free_volume_mem(output);
+	free_volume_mem(shadow_indices);
+
+	return new_indices < 3 ? -1.f : (F32)size_indices / (F32)new_indices;
+}
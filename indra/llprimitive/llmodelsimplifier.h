@@ -0,0 +1,97 @@
+/**
+ * @file llmodelsimplifier.h
+ * @brief LLModelSimplifier class definition
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMODELSIMPLIFIER_H
+#define LL_LLMODELSIMPLIFIER_H
+
+#include <string>
+#include <vector>
+
+#include "stdtypes.h"
+
+class LLModel;
+
+// Purely static class, generating simplified (lower LOD) models with the
+// meshoptimizer library. Its methods only read the base model and do not touch
+// any shared state, so they may be called from any thread. Used by the model
+// upload floater and by the mesh converter tool.
+class LLModelSimplifier
+{
+public:
+	LLModelSimplifier() = delete;
+	~LLModelSimplifier() = delete;
+
+	// Simplification methods
+	enum
+	{
+		// Automatically selects method based on model or face.
+		AUTO,
+		// Per face simplification, falling back to AUTO on failure.
+		PRECISE,
+		// Per face sloppy simplification.
+		SLOPPY
+	};
+
+	// Returns a new model, named 'label', simplified from 'base_model' with
+	// 'indices_decim' as the wanted ratio of the base/simplified indices
+	// counts and 'error_threshold' as the maximum allowed error (0.f to 1.f).
+	// 'limit_triangles' must be true when 'indices_decim' was derived from a
+	// triangles count limit, so that the undershoot of the sloppy algorithm
+	// gets compensated. The messages worth logging are appended to 'log'. The
+	// returned model got a zero reference count and is not validated: it is up
+	// to the caller to call LLModel::validate() on it.
+	static LLModel* simplify(LLModel* base_model, const std::string& label,
+							 U32 method, F32 indices_decim,
+							 F32 error_threshold, bool limit_triangles,
+							 std::vector<std::string>& log);
+
+private:
+	enum
+	{
+		FULL,
+		NO_NORMALS,
+		NO_UVS,
+		NO_TOPOLOGY,
+	};
+
+	// These return the reached simplification ratio, or -1.f on failure to
+	// simplify the model.
+	static F32 simplifyPerModel(LLModel* base_model, LLModel* target_model,
+								F32 indices_ratio, F32 error_threshold,
+								S32 simplification_mode);
+	static F32 simplifyPerFace(LLModel* base_model, LLModel* target_model,
+							   U32 face_idx, F32 indices_ratio,
+							   F32 error_threshold, S32 simplification_mode,
+							   std::vector<std::string>& log);
+};
+
+#endif	// LL_LLMODELSIMPLIFIER_H
@@ -34,6 +34,7 @@
 
 #include "llprimitive.h"
 
+#include "hbxxh.h"
 #include "llcolor4u.h"
 #include "lldatapacker.h"
 #include "llmaterialid.h"
@@ -55,6 +56,9 @@
 F32 OBJECT_MIN_HOLE_SIZE = 0.05f;
 F32 OBJECT_HOLLOW_MAX = 0.95f;
 
+U32 LLPrimitive::sTEUpdates = 0;
+U32 LLPrimitive::sTEUpdatesSkipped = 0;
+
 // Old inverted texture: "7595d345-a24c-e7ef-f0bd-78793792133e";
 const char* SCULPT_DEFAULT_TEXTURE = "be293869-d0d9-0a69-5989-ad27f1946fd4";
 
@@ -78,7 +82,9 @@ LLPrimitive::LLPrimitive()
 	mMiscFlags(0),
 	mNumBumpmapTEs(0),
 	mPrimitiveCode(0),
-	mMaterial(LL_MCODE_STONE)
+	mMaterial(LL_MCODE_STONE),
+	mTEBlockDigest(0),
+	mTEBlockVersion(U32_MAX)
 {
 	mChanged = UNCHANGED;
 	mScale.set(1.f, 1.f, 1.f);
@@ -1036,7 +1042,15 @@ S32 LLPrimitive::unpackTEMessage(LLMessageSystem* mesgsys,
 	{
 		return retval;
 	}
-	return applyParsedTEMessage(tec);
+
+	U64 digest = HBXXH64::digest(tec.packed_buffer, tec.size);
+	if (isTEBlockUnchanged(digest))
+	{
+		return TEM_CHANGE_NONE;
+	}
+	retval = applyParsedTEMessage(tec);
+	setTEBlockApplied(digest);
+	return retval;
 }
 
 S32 LLPrimitive::unpackTEMessage(LLDataPacker& dp)
@@ -1066,6 +1080,14 @@ S32 LLPrimitive::unpackTEMessage(LLDataPacker& dp)
 	// unpack functions, just add the missing null byte.
 	data.packed_buffer[size++] = 0x00;
 
+	// Do not bother unpacking and re-applying a block identical to the last
+	// one we applied.
+	U64 digest = HBXXH64::digest(data.packed_buffer, size);
+	if (isTEBlockUnchanged(digest))
+	{
+		return TEM_CHANGE_NONE;
+	}
+
 	U32 face_count = llmin((U32)getNumTEs(), MAX_TES);
 
 	U8* cur_ptr = data.packed_buffer;
@@ -1140,9 +1162,32 @@ S32 LLPrimitive::unpackTEMessage(LLDataPacker& dp)
 
 		retval |= setTEColor(i, color);
 	}
+	setTEBlockApplied(digest);
 	return retval;
 }
 
+// Most object updates re-send the same texture entry block, even though
+// nothing changed in it. Since applying it entails virtual setter calls (with
+// textures and materials lookups in LLViewerObject) for each face, we keep the
+// digest of the last applied block to skip them altogether.
+bool LLPrimitive::isTEBlockUnchanged(U64 digest)
+{
+	++sTEUpdates;
+	if (digest == mTEBlockDigest &&
+		mTextureList.getVersion() == mTEBlockVersion)
+	{
+		++sTEUpdatesSkipped;
+		return true;
+	}
+	return false;
+}
+
+void LLPrimitive::setTEBlockApplied(U64 digest)
+{
+	mTEBlockDigest = digest;
+	mTEBlockVersion = mTextureList.getVersion();
+}
+
 U8 LLPrimitive::getExpectedNumTEs() const
 {
 	U8 expected_face_count = 0;
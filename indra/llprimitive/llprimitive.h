@@ -444,6 +444,12 @@ public:
 	// Set along with PRIM_FLAG_SITTING
 	static constexpr U32 PRIM_FLAG_SITTING_ON_GROUND	= 0x1 << 9;
 
+	// Texture entry update messages statistics: total number of updates, and
+	// number of updates skipped because they carried the same data as the
+	// last update applied to the same primitive.
+	static U32 sTEUpdates;
+	static U32 sTEUpdatesSkipped;
+
 	LLPrimitive();
 	~LLPrimitive() override;
 
@@ -585,6 +591,12 @@ protected:
 private:
 	void updateNumBumpmap(U8 index, U8 bump);
 
+	// Returns true when the packed texture entry block with 'digest' is the
+	// last one applied to this primitive and the textures list did not change
+	// since, i.e. when re-applying it would not change anything.
+	bool isTEBlockUnchanged(U64 digest);
+	void setTEBlockApplied(U64 digest);
+
 protected:
 	LLPointer<LLVolume> mVolumep;
 	LLVector3			mVelocity;			// Moving speed
@@ -596,6 +608,12 @@ protected:
 	U8					mMaterial;			// Material code
 	U8					mNumTEs;			// Number of faces on the primitve
 	U8                  mNumBumpmapTEs;     // Number of bumpmap TEs.
+
+private:
+	// Digest of the last applied packed texture entry block, and version of
+	// mTextureList just after it got applied.
+	U64					mTEBlockDigest;
+	U32					mTEBlockVersion;
 };
 
 #endif
@@ -62,6 +62,7 @@ LLTextureEntry* LLPrimTextureList::newTextureEntry()
 }
 
 LLPrimTextureList::LLPrimTextureList()
+:	mVersion(0)
 {
 }
 
@@ -80,6 +81,7 @@ void LLPrimTextureList::clear()
 		*itr++ = NULL;
 	}
 	mEntryList.clear();
+	++mVersion;
 }
 
 // Clears current entries, copies contents of other_list; this is somewhat
@@ -114,6 +116,8 @@ void LLPrimTextureList::copy(const LLPrimTextureList& other_list)
 	{
 		mEntryList.emplace_back(other_list.getTexture(index)->newCopy());
 	}
+
+	++mVersion;
 }
 
 // Clears current copies, takes contents of other_list, clears other_list
@@ -122,6 +126,7 @@ void LLPrimTextureList::take(LLPrimTextureList& other_list)
 	clear();
 	mEntryList = other_list.mEntryList;
 	other_list.mEntryList.clear();
+	++other_list.mVersion;
 }
 
 // Copies LLTextureEntry 'te' and returns TEM_CHANGE_TEXTURE if successful,
@@ -154,6 +159,7 @@ S32 LLPrimTextureList::copyTexture(U8 index, const LLTextureEntry* te)
 	{
 		mEntryList[index] = LLPrimTextureList::newTextureEntry();
 	}
+	++mVersion;
 	return TEM_CHANGE_TEXTURE;
 }
 
@@ -173,6 +179,7 @@ S32 LLPrimTextureList::takeTexture(U8 index, LLTextureEntry* te)
 	delete mEntryList[index];
 
 	mEntryList[index] = te;
+	++mVersion;
 
 	return TEM_CHANGE_TEXTURE;
 }
@@ -191,7 +198,7 @@ S32 LLPrimTextureList::setID(U8 index, const LLUUID& id)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setID(id);
+		return bumpOnChange(mEntryList[index]->setID(id));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -200,7 +207,7 @@ S32 LLPrimTextureList::setColor(U8 index, const LLColor3& color)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setColor(color);
+		return bumpOnChange(mEntryList[index]->setColor(color));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -209,7 +216,7 @@ S32 LLPrimTextureList::setColor(U8 index, const LLColor4& color)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setColor(color);
+		return bumpOnChange(mEntryList[index]->setColor(color));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -218,7 +225,7 @@ S32 LLPrimTextureList::setAlpha(U8 index, F32 alpha)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setAlpha(alpha);
+		return bumpOnChange(mEntryList[index]->setAlpha(alpha));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -227,7 +234,7 @@ S32 LLPrimTextureList::setScale(U8 index, F32 s, F32 t)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setScale(s, t);
+		return bumpOnChange(mEntryList[index]->setScale(s, t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -236,7 +243,7 @@ S32 LLPrimTextureList::setScaleS(U8 index, F32 s)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setScaleS(s);
+		return bumpOnChange(mEntryList[index]->setScaleS(s));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -245,7 +252,7 @@ S32 LLPrimTextureList::setScaleT(U8 index, F32 t)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setScaleT(t);
+		return bumpOnChange(mEntryList[index]->setScaleT(t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -254,7 +261,7 @@ S32 LLPrimTextureList::setOffset(U8 index, F32 s, F32 t)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setOffset(s, t);
+		return bumpOnChange(mEntryList[index]->setOffset(s, t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -263,7 +270,7 @@ S32 LLPrimTextureList::setOffsetS(U8 index, F32 s)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setOffsetS(s);
+		return bumpOnChange(mEntryList[index]->setOffsetS(s));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -272,7 +279,7 @@ S32 LLPrimTextureList::setOffsetT(U8 index, F32 t)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setOffsetT(t);
+		return bumpOnChange(mEntryList[index]->setOffsetT(t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -281,7 +288,7 @@ S32 LLPrimTextureList::setRotation(U8 index, F32 r)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setRotation(r);
+		return bumpOnChange(mEntryList[index]->setRotation(r));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -290,7 +297,7 @@ S32 LLPrimTextureList::setBumpShinyFullbright(U8 index, U8 bump)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setBumpShinyFullbright(bump);
+		return bumpOnChange(mEntryList[index]->setBumpShinyFullbright(bump));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -299,7 +306,7 @@ S32 LLPrimTextureList::setMediaTexGen(U8 index, U8 media)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setMediaTexGen(media);
+		return bumpOnChange(mEntryList[index]->setMediaTexGen(media));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -308,7 +315,7 @@ S32 LLPrimTextureList::setBumpMap(U8 index, U8 bump)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setBumpmap(bump);
+		return bumpOnChange(mEntryList[index]->setBumpmap(bump));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -317,7 +324,7 @@ S32 LLPrimTextureList::setBumpShiny(U8 index, U8 bump_shiny)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setBumpShiny(bump_shiny);
+		return bumpOnChange(mEntryList[index]->setBumpShiny(bump_shiny));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -326,7 +333,7 @@ S32 LLPrimTextureList::setTexGen(U8 index, U8 texgen)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setTexGen(texgen);
+		return bumpOnChange(mEntryList[index]->setTexGen(texgen));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -335,7 +342,7 @@ S32 LLPrimTextureList::setShiny(U8 index, U8 shiny)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setShiny(shiny);
+		return bumpOnChange(mEntryList[index]->setShiny(shiny));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -344,7 +351,7 @@ S32 LLPrimTextureList::setFullbright(U8 index, U8 fullbright)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setFullbright(fullbright);
+		return bumpOnChange(mEntryList[index]->setFullbright(fullbright));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -353,7 +360,7 @@ S32 LLPrimTextureList::setMediaFlags(U8 index, U8 media_flags)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setMediaFlags(media_flags);
+		return bumpOnChange(mEntryList[index]->setMediaFlags(media_flags));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -362,7 +369,7 @@ S32 LLPrimTextureList::setGlow(U8 index, F32 glow)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setGlow(glow);
+		return bumpOnChange(mEntryList[index]->setGlow(glow));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -371,7 +378,7 @@ S32 LLPrimTextureList::setMaterialID(U8 index, const LLMaterialID& matidp)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setMaterialID(matidp);
+		return bumpOnChange(mEntryList[index]->setMaterialID(matidp));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -380,7 +387,7 @@ S32 LLPrimTextureList::setMaterialParams(U8 index, const LLMaterialPtr paramsp)
 {
 	if (index != 255 && index < mEntryList.size())
 	{
-		return mEntryList[index]->setMaterialParams(paramsp);
+		return bumpOnChange(mEntryList[index]->setMaterialParams(paramsp));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -408,6 +415,10 @@ void LLPrimTextureList::setSize(S32 new_size)
 	}
 
 	S32 current_size = mEntryList.size();
+	if (new_size != current_size)
+	{
+		++mVersion;
+	}
 
 	if (new_size > current_size)
 	{
@@ -443,6 +454,6 @@ void LLPrimTextureList::setAllIDs(const LLUUID& id)
 	texture_list_t::iterator itr = mEntryList.begin();
 	while (itr != mEntryList.end())
 	{
-		(*itr++)->setID(id);
+		bumpOnChange((*itr++)->setID(id));
 	}
 }
@@ -114,6 +114,15 @@ public:
 
 	S32 size() const;
 
+	// Returns a counter incremented each time the list is resized, any of its
+	// entries is replaced, or any of its entries got changed via one of the
+	// setters above. Used by LLPrimitive to detect when a texture entry update
+	// message carries the same data as the last one it applied.
+	// Note: changes done directly on the entries returned by getTexture() are
+	// not accounted for; they must only touch data which is not part of the
+	// texture entry messages (selection, media data, GLTF materials).
+	LL_INLINE U32 getVersion() const				{ return mVersion; }
+
 #if 0
 	void forceResize(S32 new_size);
 #endif
@@ -127,8 +136,18 @@ private:
 	{
 	}
 
+	LL_INLINE S32 bumpOnChange(S32 change)
+	{
+		if (change)
+		{
+			++mVersion;
+		}
+		return change;
+	}
+
 protected:
-	texture_list_t mEntryList;
+	texture_list_t	mEntryList;
+	U32				mVersion;
 };
 
 #endif
@@ -1548,6 +1548,7 @@ LL_INLINE void* allocate_volume_mem(size_t size)
 #if LL_JEMALLOC
 	addr = mallocx(size, LLVolumeFace::getMallocxFlags16());
 	LL_TRACY_ALLOC(addr, size, trc_mem_volume);
+	LL_PROFILE_ALLOC(addr, size, LL_ALLOC_VOLUME);
 #else
 	addr = ll_aligned_malloc_16(size);
 #endif
@@ -1593,6 +1594,7 @@ LL_INLINE void* realloc_volume_mem(void* ptr, size_t size, size_t old_size)
 		LLMemory::allocationFailed(size);
 	}
 	LL_TRACY_ALLOC(addr, size, trc_mem_volume);
+	LL_PROFILE_ALLOC(addr, size, LL_ALLOC_VOLUME);
 	return addr;
 #else
 	return ll_aligned_realloc_16(ptr, size, old_size);
@@ -1608,6 +1610,7 @@ LL_INLINE void* allocate_volume_mem_64(size_t size)
 #if LL_JEMALLOC
 	addr = mallocx(size, LLVolumeFace::getMallocxFlags64());
 	LL_TRACY_ALLOC(addr, size, trc_mem_volume64);
+	LL_PROFILE_ALLOC(addr, size, LL_ALLOC_VOLUME_64);
 #else
 	addr = ll_aligned_malloc(size, 64);
 #endif
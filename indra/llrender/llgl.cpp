@@ -339,6 +339,8 @@ LLGLManager::LLGLManager()
 	mHasTextureSwizzle(false),
 	mHasGpuShader4(false),
 	mHasGpuShader5(false),
+	mHasProgramBinary(false),
+	mHasBufferStorage(false),
 	mUseDepthClamp(false),
 	mIsAMD(false),
 	mIsNVIDIA(false),
@@ -708,6 +710,8 @@ void LLGLManager::asLLSD(LLSD& info)
 	info["has_anisotropic"] = mHasAnisotropic;
 	info["has_cubemap_array"] = mHasCubeMapArray;
 	info["has_debug_output"] = mHasDebugOutput;
+	info["has_program_binary"] = mHasProgramBinary;
+	info["has_buffer_storage"] = mHasBufferStorage;
 	info["has_nvx_mem_info"] = mHasNVXMemInfo;
 	info["has_ati_mem_info"] = mHasATIMemInfo;
 	// Got requirements for our renderer ?
@@ -773,6 +777,23 @@ void LLGLManager::initExtensions()
 	mHasGpuShader5 = epoxy_has_gl_extension("GL_ARB_gpu_shader5");
 #endif
 
+#if GL_ARB_get_program_binary
+	if (mGLVersion >= 4.1f ||
+		epoxy_has_gl_extension("GL_ARB_get_program_binary"))
+	{
+		// Some drivers expose the extension but do not support any binary
+		// format, in which case glProgramBinary() would always fail.
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		mHasProgramBinary = formats > 0;
+	}
+#endif
+
+#if GL_ARB_buffer_storage
+	mHasBufferStorage = mGLVersion >= 4.4f ||
+						epoxy_has_gl_extension("GL_ARB_buffer_storage");
+#endif
+
 #if GL_ARB_texture_swizzle
 	mHasTextureSwizzle = mGLVersion >= 3.3f ||
 						 epoxy_has_gl_extension("GL_ARB_texture_swizzle");
@@ -129,6 +129,8 @@ public:
 	bool mHasTextureSwizzle;
 	bool mHasGpuShader4;
 	bool mHasGpuShader5;
+	bool mHasProgramBinary;
+	bool mHasBufferStorage;
 
 	// GPU vendor flags
 	bool mIsAMD;
@@ -36,6 +36,7 @@
 
 #include "llglslshader.h"
 
+#include "hbxxh.h"
 #include "llshadermgr.h"
 #include "llrendertarget.h"
 #include "llvertexbuffer.h"
@@ -283,7 +284,8 @@ LLGLSLShader::LLGLSLShader()
 	mTimerQuery(0),
 	mSamplesQuery(0),
 	mPrimitivesQuery(0),
-	mRiggedVariant(NULL)
+	mRiggedVariant(NULL),
+	mObjectsDigestp(NULL)
 {
 }
 
@@ -434,31 +436,104 @@ bool LLGLSLShader::createShader(hash_vector_t* attributes,
 	mDefines["OLD_SELECT"] = "1";
 #endif
 
-	// Compile new source
-	for (files_map_t::iterator it = mShaderFiles.begin();
-		 it != mShaderFiles.end(); ++it)
-	{
-		GLuint shaderhandle =
-			shadermgr->loadShaderFile(it->first, mShaderLevel, it->second,
-									  &mDefines,
-									  mFeatures.mIndexedTextureChannels);
-		llinfos << "Creating shader: " << mName << " - Level: " << mShaderLevel
-				<< " - File: " << it->first << LL_ENDL;
-		if (shaderhandle)
+	// Number of indexed texture channels for our own shader files, before
+	// attachShaderFeatures() possibly changes it.
+	S32 channels = mFeatures.mIndexedTextureChannels;
+	S32 shader_level = mShaderLevel;
+
+	// When the program binaries cache is in use, compute the key of this
+	// program from the preprocessed sources of all its shader objects (own
+	// files, then features in attachment order) and the reserved attributes,
+	// and try and load the corresponding binary instead of compiling and
+	// linking the program.
+	U64 binary_key = 0;
+	bool from_binary = false;
+	if (shadermgr->hasProgramBinaryCache())
+	{
+		HBXXH64 hash;
+		bool cacheable = true;
+		for (files_map_t::iterator it = mShaderFiles.begin(),
+								   end = mShaderFiles.end();
+			 it != end; ++it)
+		{
+			const LLShaderMgr::ShaderSource* sourcep =
+				shadermgr->getShaderSource(it->first, mShaderLevel,
+										   it->second, &mDefines, channels);
+			if (!sourcep)
+			{
+				cacheable = false;
+				break;
+			}
+			hash.update((const void*)&sourcep->mDigest, sizeof(U64));
+		}
+		if (cacheable)
+		{
+			mObjectsDigestp = &hash;
+			cacheable = shadermgr->attachShaderFeatures(this);
+			mObjectsDigestp = NULL;
+		}
+		if (cacheable)
+		{
+			for (U32 i = 0, count = LLShaderMgr::sReservedAttribs.size();
+				 i < count; ++i)
+			{
+				hash.update(LLShaderMgr::sReservedAttribs[i]);
+			}
+			binary_key = shadermgr->getProgramBinaryKey(hash.digest());
+			from_binary = shadermgr->loadProgramBinary(mProgramObject,
+													   binary_key);
+		}
+		if (from_binary)
 		{
-			attachObject(shaderhandle);
+			llinfos << "Loaded shader: " << mName << " - Level: "
+					<< mShaderLevel << " - From program binaries cache."
+					<< llendl;
 		}
 		else
 		{
-			success = false;
+			// Restore what the dry run of attachShaderFeatures() changed,
+			// and ask for a retrievable binary on link.
+			mFeatures.mIndexedTextureChannels = channels;
+			if (cacheable)
+			{
+				glProgramParameteri(mProgramObject,
+									GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+									GL_TRUE);
+			}
+			else
+			{
+				binary_key = 0;
+			}
 		}
 	}
 
-	// Attach existing objects
-	if (!shadermgr->attachShaderFeatures(this))
+	if (!from_binary)
 	{
-		unloadInternal();
-		return false;
+		// Compile new source
+		for (files_map_t::iterator it = mShaderFiles.begin();
+			 it != mShaderFiles.end(); ++it)
+		{
+			GLuint shaderhandle =
+				shadermgr->loadShaderFile(it->first, mShaderLevel, it->second,
+										  &mDefines, channels);
+			llinfos << "Creating shader: " << mName << " - Level: "
+					<< mShaderLevel << " - File: " << it->first << LL_ENDL;
+			if (shaderhandle)
+			{
+				attachObject(shaderhandle);
+			}
+			else
+			{
+				success = false;
+			}
+		}
+
+		// Attach existing objects
+		if (!shadermgr->attachShaderFeatures(this))
+		{
+			unloadInternal();
+			return false;
+		}
 	}
 
 	if (gGLManager.mGLSLVersionMajor < 2 && gGLManager.mGLSLVersionMinor < 3)
@@ -473,7 +548,7 @@ bool LLGLSLShader::createShader(hash_vector_t* attributes,
 	// Map attributes and uniforms
 	if (success)
 	{
-		success = mapAttributes(attributes);
+		success = mapAttributes(attributes, !from_binary);
 	}
 	else
 	{
@@ -504,6 +579,13 @@ bool LLGLSLShader::createShader(hash_vector_t* attributes,
 		return false;
 	}
 
+	// Only cache the binary when no shader file fell back to a lower level,
+	// since the key was computed from the sources at the requested level.
+	if (binary_key && !from_binary && mShaderLevel == shader_level)
+	{
+		shadermgr->saveProgramBinary(mProgramObject, binary_key);
+	}
+
 	if (mFeatures.mIndexedTextureChannels > 0)
 	{
 		// Override texture channels for indexed texture rendering
@@ -555,6 +637,11 @@ bool LLGLSLShader::attachVertexObject(const char* object)
 		LLShaderMgr::sVertexShaderObjects.find(object);
 	if (it != LLShaderMgr::sVertexShaderObjects.end())
 	{
+		if (mObjectsDigestp)
+		{
+			hashObjectDigest(it->second);
+			return true;
+		}
 		stop_glerror();
 		glAttachShader(mProgramObject, it->second);
 		stop_glerror();
@@ -580,6 +667,11 @@ bool LLGLSLShader::attachFragmentObject(const char* object)
 		LLShaderMgr::sFragmentShaderObjects.find(object);
 	if (it != LLShaderMgr::sFragmentShaderObjects.end())
 	{
+		if (mObjectsDigestp)
+		{
+			hashObjectDigest(it->second);
+			return true;
+		}
 		stop_glerror();
 		glAttachShader(mProgramObject, it->second);
 		stop_glerror();
@@ -591,6 +683,18 @@ bool LLGLSLShader::attachFragmentObject(const char* object)
 	return false;
 }
 
+void LLGLSLShader::hashObjectDigest(GLuint object)
+{
+	U64 digest = 0;
+	LLShaderMgr::digests_map_t::const_iterator it =
+		LLShaderMgr::sShaderObjectDigests.find(object);
+	if (it != LLShaderMgr::sShaderObjectDigests.end())
+	{
+		digest = it->second;
+	}
+	mObjectsDigestp->update((const void*)&digest, sizeof(U64));
+}
+
 void LLGLSLShader::attachObject(GLuint object)
 {
 	if (!object)
@@ -612,20 +716,24 @@ void LLGLSLShader::attachObjects(GLuint* objects, S32 count)
 	}
 }
 
-bool LLGLSLShader::mapAttributes(const hash_vector_t* attributes)
+bool LLGLSLShader::mapAttributes(const hash_vector_t* attributes, bool link)
 {
-	// Before linking, make sure reserved attributes always have consistent
-	// locations
-	for (U32 i = 0, count = LLShaderMgr::sReservedAttribs.size();
-		 i < count; ++i)
+	bool res = true;
+	if (link)
 	{
-		const char* name = LLShaderMgr::sReservedAttribs[i].c_str();
-		glBindAttribLocation(mProgramObject, i, (const GLchar*)name);
-	}
+		// Before linking, make sure reserved attributes always have
+		// consistent locations
+		for (U32 i = 0, count = LLShaderMgr::sReservedAttribs.size();
+			 i < count; ++i)
+		{
+			const char* name = LLShaderMgr::sReservedAttribs[i].c_str();
+			glBindAttribLocation(mProgramObject, i, (const GLchar*)name);
+		}
 
-	// Link the program
-	bool res = LLShaderMgr::getInstance()->linkProgramObject(mProgramObject,
-															 false);
+		// Link the program
+		res = LLShaderMgr::getInstance()->linkProgramObject(mProgramObject,
+															false);
+	}
 
 	mAttribute.clear();
 	U32 num_attrs = attributes ? attributes->size() : 0;
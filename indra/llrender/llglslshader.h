@@ -39,6 +39,7 @@
 #include "llrender.h"
 #include "llstringtable.h"
 
+class HBXXH64;
 class LLRenderTarget;
 
 class LLShaderFeatures
@@ -139,8 +140,11 @@ public:
 	bool attachVertexObject(const char* object);
 	bool attachFragmentObject(const char* object);
 	void attachObject(GLuint object);
+	void hashObjectDigest(GLuint object);
 	void attachObjects(GLuint* objects = NULL, S32 count = 0);
-	bool mapAttributes(const hash_vector_t* attributes);
+	// When 'link' is false, the program is expected to have been loaded from
+	// a program binary, and only the attributes locations are read back.
+	bool mapAttributes(const hash_vector_t* attributes, bool link = true);
 	bool mapUniforms(const hash_vector_t* uniforms);
 	void mapUniform(S32 index, const hash_vector_t* uniforms);
 
@@ -329,6 +333,11 @@ public:
 	// *HACK: flag used for optimization in LLDrawPoolAlpha and LLPipeline
 	bool							mCanBindFast;
 
+	// When not NULL, attachVertexObject() and attachFragmentObject() do not
+	// attach anything but hash the named objects source digests into it
+	// (used to compute the program binaries cache keys).
+	HBXXH64*						mObjectsDigestp;
+
 	static std::set<LLGLSLShader*>	sInstances;
 	static LLGLSLShader*			sCurBoundShaderPtr;
 	static S32						sIndexedTextureChannels;
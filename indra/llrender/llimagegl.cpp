@@ -57,6 +57,9 @@ bool LLImageGL::sPreserveDiscard = false;
 bool LLImageGL::sCompressTextures = false;
 bool LLImageGL::sSetSubImagePerLine = false;
 bool LLImageGL::sSyncInThread = true;
+U32 LLImageGL::sLastFrameUploadBytes = 0;
+U32 LLImageGL::sLastFrameStagedBytes = 0;
+F32 LLImageGL::sLastFrameStallTime = 0.f;
 U32 LLImageGL::sCompressThreshold = 262144U;
 F32 LLImageGL::sLastFrameTime = 0.f;
 LLImageGL* LLImageGL::sDefaultGLImagep = NULL;
@@ -215,9 +218,245 @@ bool LLImageGL::isCompressed() const
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Textures upload staging, via a persistently mapped pixel buffer object.
+// The buffer is split into segments which are used in turn: a fence is
+// inserted when leaving a segment, and it gets waited for (which is then
+// accounted as a stall) before that segment is reused. Uploads larger than a
+// segment are not staged.
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr U32 STAGING_SEGMENTS = 4;
+constexpr U32 STAGING_ALIGNMENT = 256;
+
+static U32 sStagingSize = 0;
+static U32 sStagingSegmentSize = 0;
+static U32 sStagingSegment = 0;
+static U32 sStagingOffset = 0;
+static U32 sStagingBuffer = 0;
+static U8* sStagingDatap = NULL;
+static GLsync sStagingFences[STAGING_SEGMENTS] = { NULL };
+// Set on failure, so that we do not retry to create a staging buffer until
+// its size is changed.
+static bool sStagingFailed = false;
+
+// Main thread uploads statistics for the current frame
+static U32 sFrameUploadBytes = 0;
+static U32 sFrameStagedBytes = 0;
+static F32 sFrameStallTime = 0.f;
+
+static void destroy_staging_buffer()
+{
+	for (U32 i = 0; i < STAGING_SEGMENTS; ++i)
+	{
+		if (sStagingFences[i])
+		{
+			glDeleteSync(sStagingFences[i]);
+			sStagingFences[i] = NULL;
+		}
+	}
+	if (sStagingBuffer)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sStagingBuffer);
+		if (sStagingDatap)
+		{
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &sStagingBuffer);
+		sStagingBuffer = 0;
+		clear_glerror();
+	}
+	sStagingDatap = NULL;
+}
+
+static bool create_staging_buffer()
+{
+	if (sStagingBuffer)
+	{
+		return true;
+	}
+	if (sStagingFailed || !sStagingSize || !gGLManager.mHasBufferStorage ||
+		!gGLManager.mHasSync)
+	{
+		return false;
+	}
+
+#if GL_ARB_buffer_storage
+	constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+								 GL_MAP_COHERENT_BIT;
+	clear_glerror();
+	glGenBuffers(1, &sStagingBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sStagingBuffer);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, sStagingSize, NULL, flags);
+	sStagingDatap = (U8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+										  sStagingSize, flags);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (glGetError() == GL_NO_ERROR && sStagingDatap)
+	{
+		sStagingSegmentSize = (sStagingSize / STAGING_SEGMENTS) &
+							  ~(STAGING_ALIGNMENT - 1);
+		sStagingSegment = sStagingOffset = 0;
+		llinfos << "Using a " << sStagingSize / 1048576
+				<< "MB persistently mapped buffer for textures uploads."
+				<< llendl;
+		return true;
+	}
+#endif
+
+	llwarns << "Could not create the textures upload staging buffer: staging disabled."
+			<< llendl;
+	destroy_staging_buffer();
+	sStagingFailed = true;
+	return false;
+}
+
+// Returns the offset in the staging buffer where 'bytes' bytes of data may be
+// copied, or -1 when they cannot be staged.
+static S64 alloc_staging(U32 bytes)
+{
+	U32 size = (bytes + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+	if (size > sStagingSegmentSize)
+	{
+		return -1;
+	}
+
+	if (sStagingOffset + size > sStagingSegmentSize)
+	{
+		// Fence the current segment and move on to the next one
+		sStagingFences[sStagingSegment] =
+			glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		sStagingSegment = (sStagingSegment + 1) % STAGING_SEGMENTS;
+		sStagingOffset = 0;
+
+		GLsync& fence = sStagingFences[sStagingSegment];
+		if (fence)
+		{
+			GLenum status = glClientWaitSync(fence, 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED)
+			{
+				// The GL did not consume this segment data yet: we must stall
+				// (for up to one second).
+				LLTimer stall_timer;
+				status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+										  1000000000);
+				sFrameStallTime += stall_timer.getElapsedTimeF32() * 1000.f;
+			}
+			glDeleteSync(fence);
+			fence = NULL;
+			if (status != GL_ALREADY_SIGNALED &&
+				status != GL_CONDITION_SATISFIED)
+			{
+				llwarns << "Failed to wait for a staging buffer fence: staging disabled."
+						<< llendl;
+				destroy_staging_buffer();
+				sStagingFailed = true;
+				return -1;
+			}
+		}
+	}
+
+	U32 offset = sStagingSegment * sStagingSegmentSize + sStagingOffset;
+	sStagingOffset += size;
+	return offset;
+}
+
+// Returns the size in bytes of an uncompressed image, or 0 for unmanaged
+// formats.
+static U32 upload_bytes(U32 width, U32 height, U32 pixformat, U32 pixtype)
+{
+	U32 pixel_bytes;
+	switch (pixtype)
+	{
+		case GL_UNSIGNED_BYTE:
+		case GL_BYTE:
+			pixel_bytes = 1;
+			break;
+
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT:
+			pixel_bytes = 2;
+			break;
+
+		case GL_UNSIGNED_INT:
+		case GL_INT:
+		case GL_FLOAT:
+			pixel_bytes = 4;
+			break;
+
+		case GL_UNSIGNED_INT_8_8_8_8_REV:
+			// Packed type: one component per pixel
+			return width * height * 4;
+
+		default:
+			return 0;
+	}
+
+	switch (pixformat)
+	{
+		case GL_RED:
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+			break;
+
+		case GL_RG:
+		case GL_LUMINANCE_ALPHA:
+			pixel_bytes *= 2;
+			break;
+
+		case GL_RGB:
+		case GL_BGR:
+			pixel_bytes *= 3;
+			break;
+
+		case GL_RGBA:
+		case GL_BGRA:
+			pixel_bytes *= 4;
+			break;
+
+		default:
+			return 0;
+	}
+
+	return width * height * pixel_bytes;
+}
+
+// Uploads the image via the staging buffer when possible, returning true on
+// success.
+static bool staged_tex_image(U32 target, S32 miplevel, S32 intformat,
+							 U32 width, U32 height, U32 pixformat,
+							 U32 pixtype, const void* pixels, U32 bytes)
+{
+	// Note: GL_UNPACK_ALIGNMENT is set to 1 by LLRender, so the source data
+	// is always tightly packed.
+	if (!bytes || !pixels || pixtype != GL_UNSIGNED_BYTE ||
+		!create_staging_buffer())
+	{
+		return false;
+	}
+
+	S64 offset = alloc_staging(bytes);
+	if (offset < 0)
+	{
+		return false;
+	}
+
+	memcpy(sStagingDatap + offset, pixels, bytes);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sStagingBuffer);
+	glTexImage2D(target, miplevel, intformat, width, height, 0, pixformat,
+				 pixtype, (const void*)(uintptr_t)offset);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	sFrameStagedBytes += bytes;
+	return true;
+}
+
 //static
 void LLImageGL::destroyGL(bool save_state)
 {
+	// It will be re-created on next use, after GL restoration
+	destroy_staging_buffer();
+
 	for (S32 stage = 0; stage < gGLManager.mNumTextureImageUnits; ++stage)
 	{
 		gGL.getTexUnit(stage)->unbind(LLTexUnit::TT_TEXTURE);
@@ -559,11 +798,29 @@ void LLImageGL::dumpStaleList()
 			<< llendl;
 }
 
+//static
+void LLImageGL::setUploadStagingSize(U32 size_mb)
+{
+	U32 size = llmin(size_mb, 1024U) * 1048576;
+	if (size != sStagingSize)
+	{
+		destroy_staging_buffer();
+		sStagingSize = size;
+		sStagingFailed = false;
+	}
+}
+
 //static
 void LLImageGL::updateStats(F32 current_time)
 {
 	sLastFrameTime = current_time;
 	sBoundTexMemBytes = sCurBoundTexBytes;
+
+	sLastFrameUploadBytes = sFrameUploadBytes;
+	sLastFrameStagedBytes = sFrameStagedBytes;
+	sLastFrameStallTime = sFrameStallTime;
+	sFrameUploadBytes = sFrameStagedBytes = 0;
+	sFrameStallTime = 0.f;
 }
 
 bool LLImageGL::updateBindStats() const
@@ -1281,8 +1538,20 @@ void LLImageGL::setManualImage(U32 target, S32 miplevel, S32 intformat,
 	else
 #endif
 	{
-		glTexImage2D(target, miplevel, intformat, width, height, 0, pixformat,
-					 pixtype, pixels);
+		U32 bytes = 0;
+		bool main_thread = pixels && is_main_thread();
+		if (main_thread)
+		{
+			bytes = upload_bytes(width, height, pixformat, pixtype);
+			sFrameUploadBytes += bytes;
+		}
+		if (!main_thread ||
+			!staged_tex_image(target, miplevel, intformat, width, height,
+							  pixformat, pixtype, pixels, bytes))
+		{
+			glTexImage2D(target, miplevel, intformat, width, height, 0,
+						 pixformat, pixtype, pixels);
+		}
 	}
 	image_bound(width, height, pixformat);
 	stop_glerror();
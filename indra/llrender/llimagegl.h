@@ -107,6 +107,11 @@ public:
 	// Needs to be called every frame
 	static void updateStats(F32 current_time);
 
+	// Sets the size in megabytes of the persistently mapped pixel buffer used
+	// to stage the textures uploads done in the main thread (0 to disable the
+	// staging). Needs GL_ARB_buffer_storage and GL_ARB_sync.
+	static void setUploadStagingSize(U32 size_mb);
+
 	bool updateBindStats() const;
 	LL_INLINE void forceUpdateBindStats() const
 	{
@@ -391,6 +396,13 @@ public:
 	// image creation, to avoid stalling at all the main thread GL pipeline. HB
 	static bool				sSyncInThread;
 
+	// Textures upload statistics for the last completed frame, for uploads
+	// done in the main thread: total uploaded bytes, bytes which went through
+	// the staging buffer and time in ms spent waiting for staging fences.
+	static U32				sLastFrameUploadBytes;
+	static U32				sLastFrameStagedBytes;
+	static F32				sLastFrameStallTime;
+
 private:
 	typedef fast_hset<LLImageGL*> glimage_list_t;
 	static glimage_list_t	sImageList;
@@ -32,9 +32,13 @@
 
 #include "linden_common.h"
 
+#include <algorithm>
+
 #include "llshadermgr.h"
 
+#include "hbxxh.h"
 #include "lldir.h"
+#include "lldiriterator.h"
 #include "llrender.h"
 
 #if LL_DARWIN
@@ -51,10 +55,28 @@
 LLShaderMgr* LLShaderMgr::sInstance = NULL;
 LLShaderMgr::shaders_map_t LLShaderMgr::sVertexShaderObjects;
 LLShaderMgr::shaders_map_t LLShaderMgr::sFragmentShaderObjects;
+LLShaderMgr::digests_map_t LLShaderMgr::sShaderObjectDigests;
 LLShaderMgr::reserved_strings_t LLShaderMgr::sReservedAttribs;
 LLShaderMgr::reserved_strings_t LLShaderMgr::sReservedUniforms;
 
+// Magic number for our program binary files ("LLPB")
+constexpr U32 PROGRAM_BINARY_MAGIC = 0x4250424c;
+
+// Header of our program binary files, followed by the binary itself.
+struct ProgramBinaryHeader
+{
+	U32	mMagic;
+	U32	mFormat;	// Driver-specific binary format
+	U64	mKey;		// Program binary key, to detect (unlikely) collisions
+};
+
 LLShaderMgr::LLShaderMgr()
+:	mDriverDigest(0),
+	mSourcesHits(0),
+	mSourcesMisses(0),
+	mBinaryHits(0),
+	mBinaryMisses(0),
+	mBinaryRejects(0)
 {
 	sInstance = this;
 }
@@ -620,20 +642,25 @@ void LLShaderMgr::dumpObjectLog(bool is_program, GLuint ret, bool warns)
 	}
 }
 
-void LLShaderMgr::dumpShaderSource(U32 shader_count, GLchar** shader_text)
+void LLShaderMgr::dumpShaderSource(const std::string& text)
 {
 	llinfos << "\n";
-	for (U32 i = 0; i < shader_count; ++i)
+	U32 line = 0;
+	for (size_t start = 0, len = text.size(); start < len; )
 	{
-		llcont << i << ": " << shader_text[i];
+		size_t end = text.find('\n', start);
+		end = end == std::string::npos ? len : end + 1;
+		llcont << line++ << ": " << text.substr(start, end - start);
+		start = end;
 	}
 	llcont << llendl;
 }
 
-GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
-								   S32& shader_level, U32 type,
-								   LLGLSLShader::defines_map_t* defines,
-								   S32 texture_index_channels)
+const LLShaderMgr::ShaderSource* LLShaderMgr::getShaderSource(const std::string& filename,
+															  S32 shader_level,
+															  U32 type,
+															  LLGLSLShader::defines_map_t* defines,
+															  S32 texture_index_channels)
 {
 #if LL_DARWIN
 	// Ensure work-around for missing GLSL funcs gets propogated to feature
@@ -644,41 +671,88 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
 	}
 #endif
 
-	LL_DEBUGS("ShaderLoading") << "Loading shader file: " << filename
-							   << " class " << shader_level << LL_ENDL;
-
 	if (filename.empty())
 	{
-		return 0;
+		return NULL;
 	}
 
-	// Read in from file
-	LLFILE* file = NULL;
-
-	S32 try_gpu_class = shader_level;
-	S32 gpu_class;
-
 	// Find the most relevant file
+	std::string fname;
 	const std::string& prefix = getShaderDirPrefix();
-	for (gpu_class = try_gpu_class; gpu_class > 0; --gpu_class)
+	for (S32 gpu_class = shader_level; gpu_class > 0; --gpu_class)
 	{
 		// Search from the current GPU class down to class 1 to find the most
 		// relevant shader
-		std::string fname = prefix + llformat("%d", gpu_class) +
-							LL_DIR_DELIM_STR + filename;
-		file = LLFile::open(fname, "r");
-		if (file)
+		fname = prefix + llformat("%d", gpu_class) + LL_DIR_DELIM_STR +
+				filename;
+		if (LLFile::isfile(fname))
+		{
+			break;	// Done
+		}
+		fname.clear();
+	}
+	if (fname.empty())
+	{
+		llwarns << "GLSL Shader file not found: " << filename << llendl;
+		return NULL;
+	}
+
+	// Compute the key of the preprocessed source in our cache: it must
+	// account for everything that changes the resulting text.
+	HBXXH64 hash;
+	hash.update(fname);
+	time_t mtime = LLFile::lastModidied(fname);
+	hash.update((const void*)&mtime, sizeof(time_t));
+	S32 params[] =
+	{
+		(S32)type,
+		texture_index_channels,
+		gGLManager.mGLSLVersionMajor,
+		gGLManager.mGLSLVersionMinor,
+		(S32)gUsePBRShaders,
+		(S32)gGLManager.mIsAMD,
+		(S32)gGLManager.mIsNVIDIA,
+		(S32)gGLManager.mHasGpuShader4,
+		(S32)gGLManager.mHasGpuShader5
+	};
+	hash.update((const void*)params, sizeof(params));
+	if (defines && !defines->empty())
+	{
+		// Hash maps iteration order is not guaranteed: sort the definitions.
+		std::vector<std::string> defs;
+		defs.reserve(defines->size());
+		for (LLGLSLShader::defines_map_t::iterator iter = defines->begin(),
+												   end = defines->end();
+			 iter != end; ++iter)
 		{
-			LL_DEBUGS("ShaderLoading") << "Loading file: " << fname << LL_ENDL;
-			break; // Done
+			defs.emplace_back(iter->first + " " + iter->second + "\n");
 		}
+		std::sort(defs.begin(), defs.end());
+		for (U32 i = 0, count = defs.size(); i < count; ++i)
+		{
+			hash.update(defs[i]);
+		}
+	}
+	U64 key = hash.digest();
+
+	sources_map_t::iterator it = mShaderSources.find(key);
+	if (it != mShaderSources.end())
+	{
+		++mSourcesHits;
+		LL_DEBUGS("ShaderLoading") << "Using cached source for: " << fname
+								   << LL_ENDL;
+		return &it->second;
 	}
+	++mSourcesMisses;
 
+	// Read in from file
+	LLFILE* file = LLFile::open(fname, "r");
 	if (!file)
 	{
-		llwarns << "GLSL Shader file not found: " << filename << llendl;
-		return 0;
+		llwarns << "Could not open GLSL Shader file: " << fname << llendl;
+		return NULL;
 	}
+	LL_DEBUGS("ShaderLoading") << "Loading file: " << fname << LL_ENDL;
 
 	bool found_header = false;
 	std::vector<std::string> header, body;
@@ -989,74 +1063,87 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
 
 	// We cannot have any shaders longer than 4096 lines...
 	constexpr U32 MAX_SHADER_TEXT_SIZE = 4096;
-	GLchar* text[MAX_SHADER_TEXT_SIZE];
-	U32 count = 0;
+	if (header.size() + body.size() >= MAX_SHADER_TEXT_SIZE)
+	{
+		llwarns << "Shader file " << filename
+				<< " is too large (more than 4096 lines): shader loading skipped."
+				<< llendl;
+		return NULL;
+	}
+
+	ShaderSource& source = mShaderSources[key];
 	// #version must come first in the directives...
-	text[count++] = (GLchar*)strdup(glsl_version.c_str());
-	// Copy shader header text into memory
-	for (U32 i = 0, lines = header.size();
-		 i < lines && count < MAX_SHADER_TEXT_SIZE; ++i)
+	source.mText = glsl_version;
+	// Copy shader header text
+	for (U32 i = 0, lines = header.size(); i < lines; ++i)
 	{
-		text[count++] = (GLchar*)strdup(header[i].c_str());
+		source.mText += header[i];
 	}
-	// Copy shader body text into memory
-	for (U32 i = 0, lines = body.size();
-		 i < lines && count < MAX_SHADER_TEXT_SIZE; ++i)
+	// Copy shader body text
+	for (U32 i = 0, lines = body.size(); i < lines; ++i)
 	{
-		text[count++] = (GLchar*)strdup(body[i].c_str());
+		source.mText += body[i];
 	}
+	source.mDigest = HBXXH64::digest(source.mText);
 
 	LL_DEBUGS("ShaderPreprocessing") << filename << " text:\n"
-									 << "----------------------------------\n";
-	for (U32 i = 0; i < count; ++i)
-	{
-		LL_CONT << text[i];
-	}
-	LL_CONT << "----------------------------------" << LL_ENDL;
+									 << "----------------------------------\n"
+									 << source.mText
+									 << "----------------------------------"
+									 << LL_ENDL;
+
+	return &source;
+}
+
+void LLShaderMgr::clearShaderSources()
+{
+	mShaderSources.clear();
+}
+
+GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
+								   S32& shader_level, U32 type,
+								   LLGLSLShader::defines_map_t* defines,
+								   S32 texture_index_channels)
+{
+	LL_DEBUGS("ShaderLoading") << "Loading shader file: " << filename
+							   << " class " << shader_level << LL_ENDL;
 
-	GLenum error = GL_NO_ERROR;
-	if (count >= MAX_SHADER_TEXT_SIZE)
+	const ShaderSource* sourcep = getShaderSource(filename, shader_level,
+												  type, defines,
+												  texture_index_channels);
+	if (!sourcep)
 	{
-		llwarns << "Shader file " << filename
-				<< " is too large (more than 4096 lines): shader loading skipped."
-				<< llendl;
-		++error;	// Flag an error, we do not care which. HB
+		return 0;
 	}
 
-	GLuint ret = 0;
-	if (error == GL_NO_ERROR)
+	// Create the shader object
+	clear_glerror();
+	GLuint ret = glCreateShader(type);
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR)
 	{
-		// Create the shader object
-		clear_glerror();
-		ret = glCreateShader(type);
-		error = glGetError();
-		if (error != GL_NO_ERROR)
+		llwarns << "GL error in glCreateShader: " << error
+				<< " - Shader file: " << filename << llendl;
+		if (ret)
 		{
-			llwarns << "GL error in glCreateShader: " << error
-					<< " - Shader file: " << filename << llendl;
-			if (ret)
-			{
-				glDeleteShader(ret); // We no longer need that handle
-				ret = 0;
-			}
-			clear_glerror();
+			glDeleteShader(ret); // We no longer need that handle
+			ret = 0;
 		}
+		clear_glerror();
 	}
 
 	// Load source
 	if (ret)
 	{
-		glShaderSource(ret, count, (const GLchar**)text, NULL);
+		const GLchar* text = (const GLchar*)sourcep->mText.c_str();
+		glShaderSource(ret, 1, &text, NULL);
 		error = glGetError();
 		if (error != GL_NO_ERROR)
 		{
 			llwarns << "GL error in glShaderSource: " << error
 					<< " - Shader file: " << filename << llendl;
-			if (ret)
-			{
-				glDeleteShader(ret); // We no longer need that handle
-				ret = 0;
-			}
+			glDeleteShader(ret); // We no longer need that handle
+			ret = 0;
 			clear_glerror();
 		}
 	}
@@ -1093,7 +1180,7 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
 			if (gDebugGL)
 			{
 				dumpObjectLog(false, ret);
-				dumpShaderSource(count, text);
+				dumpShaderSource(sourcep->mText);
 			}
 			glDeleteShader(ret); // We no longer need that handle
 			ret = 0;
@@ -1101,12 +1188,6 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
 		}
 	}
 
-	// Free memory
-	for (GLuint i = 0; i < count; i++)
-	{
-		free(text[i]);
-	}
-
 	// Successfully loaded, save results
 	if (ret)
 	{
@@ -1124,7 +1205,7 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
 			llwarns << "Unmanaged shader type " << type << " for: "
 					<< filename << llendl;
 		}
-		shader_level = try_gpu_class;
+		sShaderObjectDigests[ret] = sourcep->mDigest;
 		return ret;
 	}
 
@@ -1139,6 +1220,173 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename,
 						  texture_index_channels);
 }
 
+void LLShaderMgr::setProgramBinaryCache(const std::string& dir)
+{
+	mProgramBinaryDir.clear();
+	if (dir.empty() || !gGLManager.mHasProgramBinary)
+	{
+		return;
+	}
+
+	if (!LLFile::isdir(dir) && !LLFile::mkdir(dir))
+	{
+		llwarns << "Could not create the program binaries cache directory: "
+				<< dir << llendl;
+		return;
+	}
+
+	// Program binaries are only valid for the driver which produced them,
+	// so purge them whenever the driver changed.
+	std::string signature = gGLManager.mGLVendor + "\n" +
+							gGLManager.mGLRenderer + "\n" +
+							gGLManager.mGLVersionString + "\n";
+	std::string stamp_file = dir + LL_DIR_DELIM_STR + "driver.txt";
+	std::string stamp;
+	size_t size = LLFile::getFileSize(stamp_file);
+	if (size > 0 && size < 4096)
+	{
+		stamp.resize(size);
+		if (LLFile::readEx(stamp_file, (void*)stamp.data(), 0,
+						   size) != (S32)size)
+		{
+			stamp.clear();
+		}
+	}
+	if (stamp != signature)
+	{
+		U32 count = LLDirIterator::deleteFilesInDir(dir, "*.bin");
+		if (count)
+		{
+			llinfos << "GL driver changed: purged " << count
+					<< " cached program binaries." << llendl;
+		}
+		LLFile::remove(stamp_file);
+		if (LLFile::writeEx(stamp_file, (void*)signature.data(), 0,
+							signature.size()) != (S32)signature.size())
+		{
+			llwarns << "Could not write: " << stamp_file
+					<< " - Program binaries cache disabled." << llendl;
+			return;
+		}
+	}
+
+	mProgramBinaryDir = dir + LL_DIR_DELIM_STR;
+	mDriverDigest = HBXXH64::digest(signature);
+	llinfos << "Using program binaries cache in: " << dir << llendl;
+}
+
+std::string LLShaderMgr::getProgramBinaryFilename(U64 key) const
+{
+	return mProgramBinaryDir + llformat("%016llx.bin", key);
+}
+
+bool LLShaderMgr::loadProgramBinary(GLuint program, U64 key)
+{
+	if (mProgramBinaryDir.empty() || !program)
+	{
+		return false;
+	}
+
+	std::string filename = getProgramBinaryFilename(key);
+	size_t size = LLFile::getFileSize(filename);
+	if (size <= sizeof(ProgramBinaryHeader))
+	{
+		++mBinaryMisses;
+		return false;
+	}
+
+	std::vector<U8> buffer(size);
+	ProgramBinaryHeader* headerp = (ProgramBinaryHeader*)buffer.data();
+	if (LLFile::readEx(filename, buffer.data(), 0, size) != (S32)size ||
+		headerp->mMagic != PROGRAM_BINARY_MAGIC || headerp->mKey != key)
+	{
+		llwarns << "Invalid program binary file: " << filename << llendl;
+		LLFile::remove(filename);
+		++mBinaryMisses;
+		return false;
+	}
+
+	clear_glerror();
+	glProgramBinary(program, headerp->mFormat,
+					buffer.data() + sizeof(ProgramBinaryHeader),
+					size - sizeof(ProgramBinaryHeader));
+	GLint success = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (glGetError() != GL_NO_ERROR || success == GL_FALSE)
+	{
+		// This may legitimately happen (e.g. after a driver update which did
+		// not change its version string): just fall back to compiling.
+		LL_DEBUGS("ShaderLoading") << "Program binary rejected by the driver: "
+								   << filename << LL_ENDL;
+		LLFile::remove(filename);
+		clear_glerror();
+		++mBinaryRejects;
+		return false;
+	}
+
+	++mBinaryHits;
+	return true;
+}
+
+void LLShaderMgr::saveProgramBinary(GLuint program, U64 key)
+{
+	if (mProgramBinaryDir.empty() || !program)
+	{
+		return;
+	}
+
+	clear_glerror();
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		clear_glerror();
+		return;
+	}
+
+	size_t size = sizeof(ProgramBinaryHeader) + length;
+	std::vector<U8> buffer(size);
+	ProgramBinaryHeader* headerp = (ProgramBinaryHeader*)buffer.data();
+	GLenum format = 0;
+	glGetProgramBinary(program, length, NULL, &format,
+					   buffer.data() + sizeof(ProgramBinaryHeader));
+	if (glGetError() != GL_NO_ERROR)
+	{
+		clear_glerror();
+		return;
+	}
+	headerp->mMagic = PROGRAM_BINARY_MAGIC;
+	headerp->mFormat = format;
+	headerp->mKey = key;
+
+	// Write to a temporary file first, so that an interrupted write never
+	// leaves a truncated binary behind.
+	std::string filename = getProgramBinaryFilename(key);
+	std::string tmpname = filename + ".tmp";
+	LLFile::remove(tmpname);
+	if (LLFile::writeEx(tmpname, buffer.data(), 0, size) != (S32)size ||
+		!LLFile::rename(tmpname, filename))
+	{
+		llwarns << "Could not save program binary: " << filename << llendl;
+		LLFile::remove(tmpname);
+	}
+}
+
+void LLShaderMgr::logCacheStats()
+{
+	llinfos << "Shader sources cache: " << mSourcesHits << " hits, "
+			<< mSourcesMisses << " misses, " << mShaderSources.size()
+			<< " entries." << llendl;
+	if (!mProgramBinaryDir.empty())
+	{
+		llinfos << "Program binaries cache: " << mBinaryHits << " hits, "
+				<< mBinaryMisses << " misses, " << mBinaryRejects
+				<< " rejected." << llendl;
+	}
+	mSourcesHits = mSourcesMisses = 0;
+	mBinaryHits = mBinaryMisses = mBinaryRejects = 0;
+}
+
 bool LLShaderMgr::linkProgramObject(GLuint obj, bool suppress_errors)
 {
 	// Check for errors
@@ -33,6 +33,7 @@
 #ifndef LL_SHADERMGR_H
 #define LL_SHADERMGR_H
 
+#include "hbfastmap.h"
 #include "llglslshader.h"
 
 class LLShaderMgr
@@ -304,6 +305,56 @@ public:
 						  LLGLSLShader::defines_map_t* defines = NULL,
 						  S32 texture_index_channels = -1);
 
+	// Preprocessed shader source (GLSL version line, header defines and file
+	// body), ready to be passed to the GLSL compiler.
+	struct ShaderSource
+	{
+		std::string	mText;
+		// Hash of mText, used to build the program binaries cache keys.
+		U64			mDigest;
+	};
+
+	// Returns the (cached) preprocessed source for 'filename', searched from
+	// 'shader_level' down to class 1, or NULL when no such file exists. The
+	// sources cache is keyed on everything that influences the preprocessing
+	// (file path and modification date, type, defines, texture channels, GL
+	// version and vendor flags), so a cache hit avoids re-reading and
+	// re-assembling the file. The cache is meant to be cleared with
+	// clearShaderSources() once all shaders are (re)loaded.
+	const ShaderSource* getShaderSource(const std::string& filename,
+										S32 shader_level, U32 type,
+										LLGLSLShader::defines_map_t* defines,
+										S32 texture_index_channels);
+	void clearShaderSources();
+
+	// Sets the directory used to store linked program binaries; an empty
+	// string disables the program binaries cache. Cached binaries are purged
+	// whenever the GL driver (vendor, renderer or version) changed.
+	void setProgramBinaryCache(const std::string& dir);
+	LL_INLINE bool hasProgramBinaryCache() const
+	{
+		return !mProgramBinaryDir.empty();
+	}
+
+	// Returns a key for the program binaries cache, combining the driver
+	// signature with 'digest' (a hash of the program shader objects sources
+	// and attributes bindings).
+	LL_INLINE U64 getProgramBinaryKey(U64 digest) const
+	{
+		return mDriverDigest ^ digest;
+	}
+
+	// Tries and loads the cached binary for 'key' into 'program'. Returns
+	// true on success, false on a cache miss or when the driver rejected the
+	// binary (in which case the latter is removed from the cache).
+	bool loadProgramBinary(GLuint program, U64 key);
+	// Saves the binary of the successfully linked 'program' under 'key'.
+	void saveProgramBinary(GLuint program, U64 key);
+
+	// Logs the sources and program binaries caches statistics, then resets
+	// them.
+	void logCacheStats();
+
 	// Implemented in the application to actually point to the shader directory
 	virtual const std::string& getShaderDirPrefix() const = 0;
 
@@ -314,7 +365,21 @@ public:
 private:
 	bool validateProgramObject(GLuint obj);
 	void dumpObjectLog(bool is_program, GLuint ret, bool warns = true);
-	void dumpShaderSource(U32 shader_count, GLchar** shader_text);
+	void dumpShaderSource(const std::string& text);
+	std::string getProgramBinaryFilename(U64 key) const;
+
+private:
+	typedef safe_hmap<U64, ShaderSource> sources_map_t;
+	sources_map_t				mShaderSources;
+
+	std::string					mProgramBinaryDir;
+	U64							mDriverDigest;
+
+	U32							mSourcesHits;
+	U32							mSourcesMisses;
+	U32							mBinaryHits;
+	U32							mBinaryMisses;
+	U32							mBinaryRejects;
 
 public:
 	// Map of shader names to compiled
@@ -322,6 +387,9 @@ public:
 	typedef std::map<std::string, GLuint>::const_iterator map_citer_t;
 	static shaders_map_t		sVertexShaderObjects;
 	static shaders_map_t		sFragmentShaderObjects;
+	// Map of compiled shader objects to their preprocessed source digest
+	typedef fast_hmap<GLuint, U64> digests_map_t;
+	static digests_map_t		sShaderObjectDigests;
 
 	// Global (reserved slot) shader parameters
 	typedef std::vector<std::string> reserved_strings_t;
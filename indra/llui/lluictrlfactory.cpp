@@ -41,6 +41,7 @@
 #include "llcolor4.h"
 #include "llcontrol.h"
 #include "lldir.h"
+#include "hbxxh.h"
 #include "llmenugl.h"
 
 const char XML_HEADER[] = "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n";
@@ -139,6 +140,119 @@ const std::vector<std::string>& LLUICtrlFactory::getXUIPaths()
 	return sXUIPaths;
 }
 
+// Binary cache of the merged, layered XUI trees. Each XUI file gets its own
+// cache file, named after the hash of the file name and of the XUI paths list
+// (which encompasses the skin and language), holding a format version, the
+// list of the layer files with their size and modification time, and the
+// serialized tree. Any change in the layer files invalidates the cache.
+
+constexpr U32 XUI_CACHE_MAGIC = 0x43495558;	// "XUIC"
+constexpr U32 XUI_CACHE_VERSION = 1;
+
+static std::string get_xui_cache_filename(const std::string& xui_filename,
+										  const std::vector<std::string>& paths)
+{
+	const std::string cache_dir = gDirUtilp->getCacheDir();
+	if (cache_dir.empty())
+	{
+		// Cache directory not yet setup
+		return cache_dir;
+	}
+
+	HBXXH64 hash;
+	hash.update(xui_filename);
+	for (U32 i = 0, count = paths.size(); i < count; ++i)
+	{
+		hash.update("|");
+		hash.update(paths[i]);
+	}
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE,
+										  llformat("xui_%016llx.cache",
+												   hash.digest()));
+}
+
+// Appends the layer file name, size and modification time to 'stamps'
+static void append_xui_stamp(std::string& stamps, const std::string& filename)
+{
+	llstat stat_data;
+	if (LLFile::stat(filename, &stat_data) == 0)
+	{
+		stamps += llformat("%s|%lld|%lld\n", filename.c_str(),
+						   (S64)stat_data.st_size, (S64)stat_data.st_mtime);
+	}
+	else
+	{
+		stamps += filename + "|-1|-1\n";
+	}
+}
+
+static bool load_xui_cache(const std::string& cache_filename,
+						   const std::string& stamps, LLXMLNodePtr& root)
+{
+	llifstream file(cache_filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	std::string data((std::istreambuf_iterator<char>(file)),
+					 std::istreambuf_iterator<char>());
+	file.close();
+
+	// Header: magic, version, stamps size, then stamps
+	constexpr size_t header_size = 3 * sizeof(U32);
+	if (data.size() < header_size)
+	{
+		return false;
+	}
+	U32 header[3];
+	memcpy((void*)header, (const void*)data.data(), header_size);
+	if (header[0] != XUI_CACHE_MAGIC || header[1] != XUI_CACHE_VERSION ||
+		header[2] != stamps.size() ||
+		data.compare(header_size, stamps.size(), stamps) != 0)
+	{
+		LL_DEBUGS("XUICache") << "Stale cache file: " << cache_filename
+							  << LL_ENDL;
+		return false;
+	}
+
+	const char* buffer = data.data() + header_size + stamps.size();
+	root = LLXMLNode::readFromBinary(buffer, data.data() + data.size());
+	if (root.isNull())
+	{
+		llwarns << "Corrupted XUI cache file: " << cache_filename << llendl;
+		return false;
+	}
+
+	return true;
+}
+
+static void save_xui_cache(const std::string& cache_filename,
+						   const std::string& stamps, LLXMLNodePtr& root)
+{
+	std::string data;
+	U32 header[3] = { XUI_CACHE_MAGIC, XUI_CACHE_VERSION, (U32)stamps.size() };
+	data.append((const char*)header, sizeof(header));
+	data.append(stamps);
+	root->writeToBinary(data);
+
+	// Write to a temporary file and rename it, so that a concurrent viewer
+	// session never reads a partially written cache file.
+	std::string temp_filename = cache_filename + ".tmp";
+	llofstream file(temp_filename.c_str(),
+					std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return;
+	}
+	file.write(data.data(), data.size());
+	bool success = file.good();
+	file.close();
+	if (!success || !LLFile::rename(temp_filename, cache_filename))
+	{
+		LLFile::remove(temp_filename);
+	}
+}
+
 bool LLUICtrlFactory::getLayeredXMLNode(const std::string& xui_filename,
 										LLXMLNodePtr& root)
 {
@@ -161,15 +275,9 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string& xui_filename,
 		}
 	}
 
-	if (!LLXMLNode::parseFile(full_filename, root, NULL))
-	{
-		llwarns << "Problem reading UI description file: " << full_filename
-				<< llendl;
-		return false;
-	}
-
-	LLXMLNodePtr upd_root;
-	std::string layer_filename, node_name, upd_name;
+	// Find the override layers, if any
+	std::vector<std::string> layers;
+	std::string layer_filename;
 	for (std::vector<std::string>::const_iterator it = sXUIPaths.begin(),
 												  end = sXUIPaths.end();
 		 it != end; ++it)
@@ -178,16 +286,47 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string& xui_filename,
 		if (it == sXUIPaths.begin()) continue;
 
 		layer_filename = gDirUtilp->findSkinnedFilename(*it, xui_filename);
-		if (layer_filename.empty())
+		if (!layer_filename.empty())
 		{
-			// No localized version of this file, that's ok, keep looking
-			continue;
+			layers.emplace_back(layer_filename);
+		}
+		// else: no localized version of this file, that's ok, keep looking
+	}
+
+	std::string cache_filename, stamps;
+	if (LLUI::sConfigGroup &&
+		LLUI::sConfigGroup->getBool(LL_CONTROL("XUIBinaryCache")))
+	{
+		cache_filename = get_xui_cache_filename(xui_filename, sXUIPaths);
+	}
+	if (!cache_filename.empty())
+	{
+		append_xui_stamp(stamps, full_filename);
+		for (U32 i = 0, count = layers.size(); i < count; ++i)
+		{
+			append_xui_stamp(stamps, layers[i]);
+		}
+		if (load_xui_cache(cache_filename, stamps, root))
+		{
+			return true;
 		}
+	}
 
-		if (!LLXMLNode::parseFile(layer_filename, upd_root, NULL))
+	if (!LLXMLNode::parseFile(full_filename, root, NULL))
+	{
+		llwarns << "Problem reading UI description file: " << full_filename
+				<< llendl;
+		return false;
+	}
+
+	LLXMLNodePtr upd_root;
+	std::string node_name, upd_name;
+	for (U32 i = 0, count = layers.size(); i < count; ++i)
+	{
+		if (!LLXMLNode::parseFile(layers[i], upd_root, NULL))
 		{
 			llwarns << "Problem reading localized UI description file: "
-					<< *it + LL_DIR_DELIM_STR + xui_filename << llendl;
+					<< layers[i] << llendl;
 			return false;
 		}
 
@@ -200,6 +339,11 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string& xui_filename,
 		}
 	}
 
+	if (!cache_filename.empty())
+	{
+		save_xui_cache(cache_filename, stamps, root);
+	}
+
 	return true;
 }
 
@@ -345,17 +345,53 @@ LLSD LLControlVariable::getSaveValue(bool user_value) const
 	return user_value && mValues.size() > 1 ? mValues[1] : mValues[0];
 }
 
+////////////////////////////////////////////////////////////////////////////
+
+//static
+LLAtomicBool LLControlGroup::sCountStringLookups(false);
+
 LLControlVariablePtr LLControlGroup::getControl(const char* name)
 {
 	if (!name || !*name)
 	{
 		return LLControlVariablePtr();
 	}
-	ctrl_name_table_t::iterator iter = mNameTable.find(name);
-	return iter == mNameTable.end() ? LLControlVariablePtr() : iter->second;
+	LLControlVariable* controlp = getControl(LLControlKey(name));
+	if (controlp && LL_UNLIKELY(sCountStringLookups))
+	{
+		// Controls may be looked up by name from other threads than the main
+		// one...
+		LLMutexLock lock(mStringLookupsMutex);
+		++mStringLookups[controlp];
+	}
+	return controlp;
 }
 
-////////////////////////////////////////////////////////////////////////////
+LLControlVariable* LLControlGroup::getControl(const LLControlKey& key)
+{
+	ctrl_hash_table_t::const_iterator it = mHashTable.find(key.mHash);
+	if (it == mHashTable.end())
+	{
+		return NULL;
+	}
+	// The hash identifies the control, unless it is shared by several
+	// controls (see declareControl()), in which case we fall back to the name
+	// table. Note: a name not matching any control could still hash the same
+	// as an existing control, but with 64 bits hashes, the odds are 1 in
+	// 1.8e19, and such a lookup would be a bug in the first place.
+	if (LL_UNLIKELY(!mCollidingHashes.empty() &&
+					mCollidingHashes.count(key.mHash)))
+	{
+		if (!key.mName)
+		{
+			return NULL;
+		}
+		ctrl_name_table_t::iterator iter = mNameTable.find(key.mName);
+		return iter == mNameTable.end() ? NULL : iter->second.get();
+	}
+	llassert(!key.mName || it->second->mName == key.mName);
+	return it->second;
+}
 
 LLControlGroup::LLControlGroup(const std::string& name)
 :	LLInstanceTracker<LLControlGroup, std::string>(name)
@@ -381,6 +417,12 @@ LLControlGroup::~LLControlGroup()
 
 void LLControlGroup::cleanup()
 {
+	{
+		LLMutexLock lock(mStringLookupsMutex);
+		mStringLookups.clear();
+	}
+	mCollidingHashes.clear();
+	mHashTable.clear();
 	mNameTable.clear();
 }
 
@@ -408,7 +450,11 @@ LLControlVariable* LLControlGroup::declareControl(const char* name,
 												  bool persist,
 												  bool hide_from_user)
 {
-	LLControlVariable* controlp = getControl(name);
+	// Note: the hashed lookup does not compare names, so we must use the
+	// name table here.
+	ctrl_name_table_t::iterator iter = mNameTable.find(name);
+	LLControlVariable* controlp =
+		iter != mNameTable.end() ? iter->second.get() : NULL;
 	if (!controlp)
  	{
 		// If is does not yet exist, create the control and add it to the name
@@ -416,6 +462,14 @@ LLControlVariable* LLControlGroup::declareControl(const char* name,
 		controlp = new LLControlVariable(name, type, initial_val, comment,
 										 persist, hide_from_user);
 		mNameTable.emplace(name, controlp);
+		U64 hash = LLControlKey::hash(name);
+		if (!mHashTable.emplace(hash, controlp).second)
+		{
+			// Extremely unlikely, but not impossible... Such a control will
+			// still be found by getControl(), via the name table.
+			llwarns << "Hash collision for control: " << name << llendl;
+			mCollidingHashes.emplace(hash);
+		}
 	}
 	// Sometimes we need to declare a control *after* it has been loaded from a
 	// settings file.
@@ -601,12 +655,9 @@ LLColor4 LLControlGroup::getColor(const char* name)
 {
 	LL_DEBUGS("GetControlCalls") << "Requested control: " << name << LL_ENDL;
 
-	ctrl_name_table_t::const_iterator i = mNameTable.find(name);
-
-	if (i != mNameTable.end())
+	LLControlVariable* controlp = getControl(name);
+	if (controlp)
 	{
-		LLControlVariable* controlp = i->second;
-
 		switch (controlp->mType)
 		{
 			case TYPE_COL4:
@@ -653,8 +704,7 @@ LLSD LLControlGroup::getLLSD(const char* name)
 
 bool LLControlGroup::controlExists(const char* name)
 {
-	ctrl_name_table_t::iterator iter = mNameTable.find(name);
-	return iter != mNameTable.end();
+	return name && getControl(LLControlKey(name)) != NULL;
 }
 
 //-------------------------------------------------------------------
@@ -1131,6 +1181,47 @@ void LLControlGroup::resetToDefaults()
 	}
 }
 
+void LLControlGroup::dumpStringLookups(U32 frames, U32 max_entries)
+{
+	std::vector<std::pair<U32, LLControlVariable*> > sorted;
+	{
+		LLMutexLock lock(mStringLookupsMutex);
+		sorted.reserve(mStringLookups.size());
+		for (lookups_count_map_t::const_iterator it = mStringLookups.begin(),
+												 end = mStringLookups.end();
+			 it != end; ++it)
+		{
+			sorted.emplace_back(it->second, it->first);
+		}
+		mStringLookups.clear();
+	}
+	if (sorted.empty())
+	{
+		llinfos << "No string lookup recorded for control group: "
+				<< getKey() << llendl;
+		return;
+	}
+
+	std::sort(sorted.begin(), sorted.end(),
+			  [](const std::pair<U32, LLControlVariable*>& a,
+				 const std::pair<U32, LLControlVariable*>& b)
+			  {
+				return a.first > b.first;
+			  });
+
+	F32 per_frame = frames ? 1.f / (F32)frames : 1.f;
+	llinfos << "Most looked up by name controls for control group "
+			<< getKey() << " over " << frames << " frames:";
+	for (U32 i = 0, count = llmin(max_entries, (U32)sorted.size());
+		 i < count; ++i)
+	{
+		llcont << "\n" << sorted[i].second->getName() << ": "
+			   << sorted[i].first << " lookups ("
+			   << (F32)sorted[i].first * per_frame << " per frame)";
+	}
+	llcont << llendl;
+}
+
 void LLControlGroup::applyToAll(ApplyFunctor* func)
 {
 	for (ctrl_name_table_t::iterator iter = mNameTable.begin();
@@ -38,6 +38,10 @@
 #include "boost/bind.hpp"
 #include "boost/signals2.hpp"
 
+#include "hbfastmap.h"
+#include "hbfastset.h"
+#include "llatomic.h"
+#include "llmutex.h"
 #include "llpointer.h"
 #include "llpreprocessor.h"
 #include "llstring.h"
@@ -151,6 +155,45 @@ private:
 
 typedef LLPointer<LLControlVariable> LLControlVariablePtr;
 
+// Control name associated with its hash, used for hashed control lookups.
+// When built with the LL_CONTROL() macro from a string literal, the hash gets
+// computed at compile time, so that the lookup only costs a hash map probe:
+//   bool foo = gSavedSettings.getBool(LL_CONTROL("RenderFoo"));
+class LLControlKey
+{
+public:
+	LL_INLINE constexpr LLControlKey(const char* name)
+	:	mName(name),
+		mHash(hash(name))
+	{
+	}
+
+	LL_INLINE constexpr LLControlKey(const char* name, U64 hash)
+	:	mName(name),
+		mHash(hash)
+	{
+	}
+
+	// 64 bits FNV-1a hash of the control name.
+	LL_INLINE static constexpr U64 hash(const char* name)
+	{
+		U64 hash = 14695981039346656037ULL;
+		while (name && *name)
+		{
+			hash = (hash ^ (U64)(U8)*name++) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+public:
+	const char*	mName;
+	U64			mHash;
+};
+
+#define LL_CONTROL(name) \
+	LLControlKey(name, std::integral_constant<U64, \
+											 LLControlKey::hash(name)>::value)
+
 // Helper functions for converting between static types and LLControl values
 template <class T>
 eControlType get_control_type()
@@ -188,7 +231,10 @@ public:
 	~LLControlGroup();
 	void cleanup();
 
+	// String lookup: the name gets hashed on each call.
 	LLControlVariablePtr getControl(const char* name);
+	// Hashed lookup, to be used with LL_CONTROL() in often called code.
+	LLControlVariable* getControl(const LLControlKey& key);
 
 	struct ApplyFunctor
 	{
@@ -294,6 +340,29 @@ public:
 		return convert_from_llsd<T>(ctrlp->getValue(), ctrlp->type(), name);
 	}
 
+	// Generic getter for hashed keys
+	template<typename T> T get(const LLControlKey& key)
+	{
+		LLControlVariable* ctrlp = getControl(key);
+		if (!ctrlp)
+		{
+			llwarns << "Control " << key.mName << " not found." << llendl;
+			return T();
+		}
+		return convert_from_llsd<T>(ctrlp->getValue(), ctrlp->type(),
+									key.mName);
+	}
+
+	LL_INLINE bool getBool(const LLControlKey& key)		{ return get<bool>(key); }
+	LL_INLINE S32 getS32(const LLControlKey& key)		{ return get<S32>(key); }
+	LL_INLINE U32 getU32(const LLControlKey& key)		{ return get<U32>(key); }
+	LL_INLINE F32 getF32(const LLControlKey& key)		{ return get<F32>(key); }
+
+	LL_INLINE std::string getString(const LLControlKey& key)
+	{
+		return get<std::string>(key);
+	}
+
 	void setBool(const char* name, bool val);
 	void setS32(const char* name, S32 val);
 	void setF32(const char* name, F32 val);
@@ -344,10 +413,33 @@ public:
 	// Resets all ignorables
 	void resetWarnings();
 
+	// Logs the controls most looked up by name (i.e. not via LL_CONTROL() or
+	// LLCachedControl) since the last call, with their average number of
+	// lookups per frame, then resets the counters. The counting only happens
+	// while sCountStringLookups is true.
+	void dumpStringLookups(U32 frames, U32 max_entries = 30);
+
+public:
+	static LLAtomicBool		sCountStringLookups;
+
 protected:
+	// Sorted by name, for saved settings files and the settings editor.
 	typedef std::map<std::string, LLControlVariablePtr> ctrl_name_table_t;
 	ctrl_name_table_t		mNameTable;
 
+	// Index of the above by name hash, for lookups.
+	typedef fast_hmap<U64, LLControlVariable*> ctrl_hash_table_t;
+	ctrl_hash_table_t		mHashTable;
+
+	typedef fast_hmap<LLControlVariable*, U32> lookups_count_map_t;
+	lookups_count_map_t		mStringLookups;
+	LLMutex					mStringLookupsMutex;
+
+	// Hashes shared by several controls, for which the lookups must go
+	// through the name table. Normally empty.
+	typedef fast_hset<U64> hashes_set_t;
+	hashes_set_t			mCollidingHashes;
+
 	std::set<std::string>	mWarnings;
 
 	std::string				mTypeString[TYPE_COUNT];
@@ -926,6 +926,138 @@ bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
 	return true;
 }
 
+static void binary_append_u32(std::string& buffer, U32 value)
+{
+	buffer.append((const char*)&value, sizeof(U32));
+}
+
+static void binary_append_string(std::string& buffer, const std::string& str)
+{
+	binary_append_u32(buffer, (U32)str.size());
+	buffer.append(str);
+}
+
+static bool binary_read_u32(const char*& buffer, const char* end, U32& value)
+{
+	if (end - buffer < (std::ptrdiff_t)sizeof(U32))
+	{
+		return false;
+	}
+	memcpy((void*)&value, (const void*)buffer, sizeof(U32));
+	buffer += sizeof(U32);
+	return true;
+}
+
+static bool binary_read_string(const char*& buffer, const char* end,
+							   std::string& str)
+{
+	U32 size;
+	if (!binary_read_u32(buffer, end, size) ||
+		(size_t)(end - buffer) < (size_t)size)
+	{
+		return false;
+	}
+	str.assign(buffer, size);
+	buffer += size;
+	return true;
+}
+
+void LLXMLNode::writeToBinary(std::string& buffer) const
+{
+	binary_append_u32(buffer, mIsAttribute ? 1 : 0);
+	binary_append_string(buffer, mName ? std::string(mName->mString)
+									   : std::string());
+	binary_append_string(buffer, mValue);
+	binary_append_string(buffer, mID);
+	binary_append_u32(buffer, mVersionMajor);
+	binary_append_u32(buffer, mVersionMinor);
+	binary_append_u32(buffer, mLength);
+	binary_append_u32(buffer, mPrecision);
+	binary_append_u32(buffer, (U32)mType);
+	binary_append_u32(buffer, (U32)mEncoding);
+	binary_append_u32(buffer, (U32)mLineNumber);
+
+	binary_append_u32(buffer, (U32)mAttributes.size());
+	for (LLXMLAttribList::const_iterator it = mAttributes.begin(),
+										 end = mAttributes.end();
+		 it != end; ++it)
+	{
+		it->second->writeToBinary(buffer);
+	}
+
+	// Children are written in their document order, i.e. following the
+	// double-linked list, so that they get re-added in the same order.
+	U32 count = 0;
+	size_t count_offset = buffer.size();
+	binary_append_u32(buffer, count);
+	if (mChildren.notNull())
+	{
+		for (LLXMLNode* child = mChildren->head; child;
+			 child = child->mNext)
+		{
+			child->writeToBinary(buffer);
+			++count;
+		}
+	}
+	memcpy((void*)(buffer.data() + count_offset), (const void*)&count,
+		   sizeof(U32));
+}
+
+//static
+LLXMLNodePtr LLXMLNode::readFromBinary(const char*& buffer, const char* end)
+{
+	U32 is_attribute, version_major, version_minor, length, precision, type,
+		encoding, line_number;
+	std::string name, value, id;
+	if (!binary_read_u32(buffer, end, is_attribute) ||
+		!binary_read_string(buffer, end, name) ||
+		!binary_read_string(buffer, end, value) ||
+		!binary_read_string(buffer, end, id) ||
+		!binary_read_u32(buffer, end, version_major) ||
+		!binary_read_u32(buffer, end, version_minor) ||
+		!binary_read_u32(buffer, end, length) ||
+		!binary_read_u32(buffer, end, precision) ||
+		!binary_read_u32(buffer, end, type) ||
+		!binary_read_u32(buffer, end, encoding) ||
+		!binary_read_u32(buffer, end, line_number) ||
+		type > (U32)TYPE_NODEREF || encoding > (U32)ENCODING_HEX)
+	{
+		return NULL;
+	}
+
+	LLXMLNodePtr node = new LLXMLNode(name.c_str(), is_attribute != 0);
+	node->mValue = std::move(value);
+	node->mID = std::move(id);
+	node->mVersionMajor = version_major;
+	node->mVersionMinor = version_minor;
+	node->mLength = length;
+	node->mPrecision = precision;
+	node->mType = (ValueType)type;
+	node->mEncoding = (Encoding)encoding;
+	node->mLineNumber = (S32)line_number;
+
+	// Attributes first, then children
+	for (U32 pass = 0; pass < 2; ++pass)
+	{
+		U32 count;
+		if (!binary_read_u32(buffer, end, count))
+		{
+			return NULL;
+		}
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLXMLNodePtr child = readFromBinary(buffer, end);
+			if (child.isNull() || child->mIsAttribute != (pass == 0))
+			{
+				return NULL;
+			}
+			node->addChild(child);
+		}
+	}
+
+	return node;
+}
+
 // static
 void LLXMLNode::writeHeaderToFile(LLFILE* out_file)
 {
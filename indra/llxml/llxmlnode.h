@@ -152,6 +152,13 @@ public:
 	static bool getLayeredXMLNode(LLXMLNodePtr& root,
 								  const std::vector<std::string>& paths);
 
+	// Compact binary serialization of this node and all its descendants,
+	// appended to 'buffer'. Used to cache parsed (and possibly merged) trees.
+	void writeToBinary(std::string& buffer) const;
+	// Rebuilds a tree from data written by writeToBinary(), advancing
+	// 'buffer'. Returns a NULL pointer on truncated or corrupted data.
+	static LLXMLNodePtr readFromBinary(const char*& buffer, const char* end);
+
 	// Write standard XML file header:
 	// <?xml version="1.0" encoding="utf-8" standalone="yes" ?>
 	static void writeHeaderToFile(LLFILE* out_file);
@@ -45,6 +45,9 @@ MediaPluginBase::MediaPluginBase(LLPluginInstance::sendMessageFunction host_send
 	mHostUserData(host_user_data),
 	mDeleteMe(false),
 	mPixels(0),
+	mPixelsBufferIndex(0),
+	mFrameSequence(0),
+	mReleasedSequence(0),
 	mWidth(0),
 	mHeight(0),
 	mTextureWidth(0),
@@ -52,6 +55,8 @@ MediaPluginBase::MediaPluginBase(LLPluginInstance::sendMessageFunction host_send
 	mDepth(0),
 	mStatus(STATUS_NONE)
 {
+	mPixelsBuffers[0] = mPixelsBuffers[1] = NULL;
+	mBufferSequence[0] = mBufferSequence[1] = 0;
 }
 
 std::string MediaPluginBase::statusString()
@@ -113,9 +118,65 @@ void MediaPluginBase::setDirty(int left, int top, int right, int bottom)
 	message.setValueS32("top", top);
 	message.setValueS32("right", right);
 	message.setValueS32("bottom", bottom);
+	message.setValueS32("seq", (S32)++mFrameSequence);
+	if (mPixelsBuffers[1])
+	{
+		message.setValueS32("buffer", mPixelsBufferIndex);
+		mBufferSequence[mPixelsBufferIndex] = mFrameSequence;
+		// Write the next frame into the other buffer, while the viewer reads
+		// this one.
+		mPixelsBufferIndex ^= 1;
+		mPixels = mPixelsBuffers[mPixelsBufferIndex];
+	}
 	sendMessage(message);
 }
 
+void MediaPluginBase::setPixelsBuffers(void* address,
+									   const LLPluginMessage& size_change)
+{
+	mPixelsBuffers[0] = (unsigned char*)address;
+	mPixelsBuffers[1] = NULL;
+	if (address && size_change.getValueS32("buffers") == 2)
+	{
+		S32 buffer_size = size_change.getValueS32("buffer_size");
+		if (buffer_size > 0)
+		{
+			mPixelsBuffers[1] = mPixelsBuffers[0] + buffer_size;
+		}
+	}
+	mPixelsBufferIndex = 0;
+	mPixels = mPixelsBuffers[0];
+	// Frames from the former segment do not matter any more.
+	mBufferSequence[0] = mBufferSequence[1] = 0;
+}
+
+void MediaPluginBase::clearPixelsBuffers()
+{
+	mPixels = mPixelsBuffers[0] = mPixelsBuffers[1] = NULL;
+	mPixelsBufferIndex = 0;
+	mBufferSequence[0] = mBufferSequence[1] = 0;
+}
+
+void MediaPluginBase::zeroPixelsBuffers(size_t size)
+{
+	for (int i = 0; i < 2; ++i)
+	{
+		if (mPixelsBuffers[i])
+		{
+			memset(mPixelsBuffers[i], 0, size);
+		}
+	}
+}
+
+void MediaPluginBase::frameReleased(const LLPluginMessage& message)
+{
+	U32 seq = (U32)message.getValueS32("seq");
+	if (seq > mReleasedSequence)
+	{
+		mReleasedSequence = seq;
+	}
+}
+
 void MediaPluginBase::sendStatus()
 {
 	LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_MEDIA, "media_status");
@@ -116,9 +116,63 @@ protected:
 	 * @param[in] right Right X-coordinate of area to redraw
 	 * @param[in] bottom Bottom Y-coordinate of area to redraw
 	 * Note: the (0,0) coordinates correspond to the top left corner.
+	 * The message also carries the frame sequence number and, with double-
+	 * buffered frames, the index of the buffer holding the frame; mPixels is
+	 * then switched to the other buffer, for the next frame.
 	 */
 	virtual void setDirty(int left, int top, int right, int bottom);
 
+	/**
+	 * Sets the pixel buffer(s) from the texture shared memory segment, as
+	 * described in the "size_change" message. Plugins advertizing double-
+	 * buffered frames support (via "double_buffered" in "texture_params")
+	 * must always write whole frames into mPixels before calling setDirty().
+	 *
+	 * @param[in] address Address of the texture shared memory segment
+	 * @param[in] size_change The "size_change" message
+	 */
+	void setPixelsBuffers(void* address, const LLPluginMessage& size_change);
+
+	/**
+	 * Returns true when the shared memory segment at 'address' holds our
+	 * pixel buffer(s).
+	 */
+	LL_INLINE bool isPixelsSegment(void* address) const
+	{
+		return address && address == mPixelsBuffers[0];
+	}
+
+	/**
+	 * Stops using the pixel buffer(s).
+	 */
+	void clearPixelsBuffers();
+
+	/**
+	 * Fills the pixel buffer(s) with zeroes.
+	 *
+	 * @param[in] size Size in bytes of each buffer to clear
+	 */
+	void zeroPixelsBuffers(size_t size);
+
+	/**
+	 * Returns true when mPixels may be written to. With double-buffered
+	 * frames, this is false while the viewer may still read the frame held
+	 * in that buffer: the plugin must then skip or delay its frame, rather
+	 * than overwrite it.
+	 */
+	LL_INLINE bool canWriteFrame() const
+	{
+		return !mPixelsBuffers[1] ||
+			   mBufferSequence[mPixelsBufferIndex] <= mReleasedSequence;
+	}
+
+	/**
+	 * Handles the "frame_released" message sent by the viewer.
+	 *
+	 * @param[in] message The "frame_released" message
+	 */
+	void frameReleased(const LLPluginMessage& message);
+
 protected:
 	// Map of shared memory names to shared memory.
 	typedef std::map<std::string, SharedSegmentInfo>	SharedSegmentMap;
@@ -134,6 +188,18 @@ protected:
 	// array may be misleading since 1 pixel > 1 char.
 	unsigned char*										mPixels;
 
+	// Frame buffers, the second one being NULL when not double-buffered.
+	unsigned char*										mPixelsBuffers[2];
+	// Index of the buffer mPixels points to.
+	int													mPixelsBufferIndex;
+
+	// Sequence number of the last published frame.
+	U32													mFrameSequence;
+	// Sequence numbers of the frames held in each buffer.
+	U32													mBufferSequence[2];
+	// Sequence number up to which the viewer released the frames.
+	U32													mReleasedSequence;
+
 	// *TODO documentation: what is this for ?  Does a texture have its own
 	// piece of shared memory ?  Updated on size_change_request, cleared on
 	// shm_remove.
@@ -114,6 +114,9 @@ private:
 	void unicodeInput(std::string event, LLSD native_key_data = LLSD::emptyMap());
 
 	void checkEditState();
+
+	// Publishes the frame kept in mPendingFrame, when any and possible.
+	void flushPendingFrame();
 	void setVolume();
 
 private:
@@ -136,6 +139,10 @@ private:
 
 	std::vector<std::string>	mPickedFiles;
 
+	// Last frame received while the viewer could still read the frame held in
+	// our next buffer, if any.
+	std::vector<unsigned char>	mPendingFrame;
+
 	std::string					mProxyHost;
 	U16							mProxyPort;
 	bool						mProxyEnabled;
@@ -237,13 +244,26 @@ void MediaPluginCEF::onPageChangedCallback(const unsigned char* pixels, int x,
 	{
 		if (mWidth == width && mHeight == height)
 		{
-			memcpy(mPixels, pixels, mWidth * mHeight * mDepth);
+			size_t size = mWidth * mHeight * mDepth;
+			if (canWriteFrame())
+			{
+				memcpy(mPixels, pixels, size);
+				mPendingFrame.clear();
+				setDirty(0, 0, mWidth, mHeight);
+			}
+			else
+			{
+				// Do not overwrite a frame the viewer may still be reading:
+				// keep this one till the viewer released its buffer.
+				mPendingFrame.assign(pixels, pixels + size);
+			}
 		}
 		else
 		{
+			// Nothing got written to mPixels, so do not publish it (this
+			// would be an old frame with double-buffering).
 			mCEFLib->setSize(mWidth, mHeight);
 		}
-		setDirty(0, 0, mWidth, mHeight);
 	}
 # if 1	// *HACK: to get the first scrollable page to draw
 	if (!mWheelHackDone)
@@ -255,6 +275,20 @@ void MediaPluginCEF::onPageChangedCallback(const unsigned char* pixels, int x,
 # endif
 }
 
+void MediaPluginCEF::flushPendingFrame()
+{
+	if (mPendingFrame.empty() || !mPixels || !canWriteFrame())
+	{
+		return;
+	}
+	if (mPendingFrame.size() == (size_t)(mWidth * mHeight * mDepth))
+	{
+		memcpy(mPixels, mPendingFrame.data(), mPendingFrame.size());
+		setDirty(0, 0, mWidth, mHeight);
+	}
+	mPendingFrame.clear();
+}
+
 void MediaPluginCEF::onLoadError(int status, const std::string error_text)
 {
 	std::stringstream msg;
@@ -575,6 +609,7 @@ void MediaPluginCEF::receiveMessage(const char* msgstr)
 			mCEFLib->update();
 			mVolumeCatcher.pump();
 			checkEditState();
+			flushPendingFrame();
 		}
 		else if (message_name == "cleanup")
 		{
@@ -600,9 +635,9 @@ void MediaPluginCEF::receiveMessage(const char* msgstr)
 			SharedSegmentMap::iterator iter = mSharedSegments.find(name);
 			if (iter != mSharedSegments.end())
 			{
-				if (mPixels == iter->second.mAddress)
+				if (isPixelsSegment(iter->second.mAddress))
 				{
-					mPixels = NULL;
+					clearPixelsBuffers();
 					mTextureSegmentName.clear();
 				}
 				mSharedSegments.erase(iter);
@@ -754,6 +789,8 @@ void MediaPluginCEF::receiveMessage(const char* msgstr)
 			message.setValueU32("format", GL_BGRA);
 			message.setValueU32("type", GL_UNSIGNED_BYTE);
 			message.setValueBoolean("coords_opengl", true);
+			// We always write whole frames
+			message.setValueBoolean("double_buffered", true);
 			sendMessage(message);
 		}
 		else if (message_name == "set_user_data_path")
@@ -796,6 +833,11 @@ void MediaPluginCEF::receiveMessage(const char* msgstr)
 						  << std::endl;
 			}
 		}
+		else if (message_name == "frame_released")
+		{
+			frameReleased(message_in);
+			flushPendingFrame();
+		}
 		else if (message_name == "size_change")
 		{
 			std::string name = message_in.getValue("name");
@@ -810,7 +852,8 @@ void MediaPluginCEF::receiveMessage(const char* msgstr)
 				SharedSegmentMap::iterator iter = mSharedSegments.find(name);
 				if (iter != mSharedSegments.end())
 				{
-					mPixels = (unsigned char*)iter->second.mAddress;
+					setPixelsBuffers(iter->second.mAddress, message_in);
+					mPendingFrame.clear();
 					mWidth = width;
 					mHeight = height;
 
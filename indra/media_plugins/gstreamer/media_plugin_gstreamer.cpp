@@ -467,6 +467,13 @@ bool MediaPluginGStreamer::update(int milliseconds)
 		return true;
 	}
 
+	// Leave the sample queued in the sink while the viewer may still read the
+	// frame held in our next buffer.
+	if (mPixels && !canWriteFrame())
+	{
+		return true;
+	}
+
 	GstSample* samplep = llgst_app_sink_pull_sample(mAppSink);
 	if (!samplep)
 	{
@@ -961,11 +968,11 @@ void MediaPluginGStreamer::receiveMessage(const char* message_string)
 				SharedSegmentMap::iterator iter = mSharedSegments.find(name);
 				if (iter != mSharedSegments.end())
 				{
-					if (mPixels == iter->second.mAddress)
+					if (isPixelsSegment(iter->second.mAddress))
 					{
 						// This is the currently active pixel buffer. Make sure
 						// we stop drawing to it.
-						mPixels = NULL;
+						clearPixelsBuffers();
 						mTextureSegmentName.clear();
 					}
 					mSharedSegments.erase(iter);
@@ -1001,8 +1008,14 @@ void MediaPluginGStreamer::receiveMessage(const char* message_string)
 				message.setValueBoolean("coords_opengl", true);
 				// We respond with grace and performance if asked to downscale
 				message.setValueBoolean("allow_downsample", true);
+				// We always write whole frames
+				message.setValueBoolean("double_buffered", true);
 				sendMessage(message);
 			}
+			else if (message_name == "frame_released")
+			{
+				frameReleased(message_in);
+			}
 			else if (message_name == "size_change")
 			{
 				std::string name = message_in.getValue("name");
@@ -1029,12 +1042,10 @@ void MediaPluginGStreamer::receiveMessage(const char* message_string)
 						mTextureSegmentName = name;
 						mTextureWidth = texture_width;
 						mTextureHeight = texture_height;
-						mPixels = (unsigned char*)it->second.mAddress;
-						if (mPixels)
-						{
-							memset(mPixels, 0,
-								   mTextureWidth * mTextureHeight * mDepth);
-						}
+						setPixelsBuffers(it->second.mAddress, message_in);
+						// Clear both frame buffers when double-buffered.
+						zeroPixelsBuffers(mTextureWidth * mTextureHeight *
+										  mDepth);
 					}
 
 					LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_MEDIA,
@@ -0,0 +1,654 @@
+/**
+ * @file meshconverter.cpp
+ * @brief Headless batch converter of COLLADA and glTF models into mesh assets
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+// This tool loads COLLADA (.dae) and glTF (.gltf, .glb) models with the same
+// loaders as the model upload floater, generates their LODs with the
+// meshoptimizer based simplifier, writes the resulting mesh assets (one
+// .llmesh file per model) and reports the streaming cost of each file, so
+// that models may be pre-validated and costed in batch, outside of the viewer.
+// Files are processed in parallel on a threads pool and the load, LODs
+// generation and write timings are reported, making it also usable as a
+// reproducible benchmark for the loaders and the simplifier.
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "boost/tokenizer.hpp"
+
+#include "llapr.h"
+#include "lldaeloader.h"
+#include "llerrorcontrol.h"
+#include "llfile.h"
+#include "llgltfloader.h"
+#include "lljoint.h"				// For LL_MAX_JOINTS_PER_MESH_OBJECT
+#include "llmeshcost.h"
+#include "llmodelsimplifier.h"
+#include "llmutex.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
+#include "llxmltree.h"
+
+// Indexed by LOD number
+static const char* sLODSuffixes[] =
+{
+	"_LOD0",
+	"_LOD1",
+	"_LOD2",
+	""
+};
+
+// Options
+static std::string sOutputDir;
+static U32 sMethod = LLModelSimplifier::AUTO;
+static F32 sDecimation = 3.f;
+// Same default as the viewer ImporterModelLimit setting
+static U32 sModelLimit = 768;
+static bool sPreprocessDAE = false;
+static bool sDryRun = false;
+static bool sVerbose = false;
+
+// The COLLADA DOM library and the DAE error handler set by LLDAELoader are
+// global, so only one DAE file may be parsed at any given time.
+static LLMutex sDAEMutex;
+
+struct ConversionJob
+{
+	ConversionJob(const std::string& filename)
+	:	mFilename(filename),
+		mLoader(NULL),
+		mState(LLModelLoader::STARTING),
+		mModels(0),
+		mInstances(0),
+		mFailedLODs(0),
+		mBytes(0),
+		mLoadTime(0.0),
+		mLODsTime(0.0),
+		mWriteTime(0.0),
+		mStreamingCost(0.f),
+		mTriangleCost(0.f),
+		mIsDAE(false)
+	{
+		for (S32 i = 0; i <= LLModel::LOD_HIGH; ++i)
+		{
+			mTriangles[i] = 0;
+		}
+	}
+
+	~ConversionJob()
+	{
+		delete mLoader;
+	}
+
+	std::string					mFilename;
+	std::string					mOutputBase;
+	std::string					mError;
+	std::vector<std::string>	mLog;
+	JointTransformMap			mJointTransformMap;
+	JointNameSet				mJointsFromNode;
+	LLModelLoader*				mLoader;
+	U32							mState;
+	U32							mModels;
+	U32							mInstances;
+	U32							mFailedLODs;
+	U32							mBytes;
+	S32							mTriangles[LLModel::LOD_HIGH + 1];
+	F64							mLoadTime;
+	F64							mLODsTime;
+	F64							mWriteTime;
+	F32							mStreamingCost;
+	F32							mTriangleCost;
+	bool						mIsDAE;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Streaming cost helpers
+///////////////////////////////////////////////////////////////////////////////
+
+// Returns the radius of the bounding sphere for a model instance, based on the
+// scale in its transform (like LLMeshUploadThread::decomposeMeshMatrix()).
+static F32 get_instance_radius(const LLMatrix4& transform)
+{
+	LLVector3 position = LLVector3::zero * transform;
+	LLVector3 scale((LLVector3::x_axis * transform - position).length(),
+					(LLVector3::y_axis * transform - position).length(),
+					(LLVector3::z_axis * transform - position).length());
+	return scale.length() * 0.5f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Avatar skeleton joint aliases
+///////////////////////////////////////////////////////////////////////////////
+
+// Adds the names and aliases of all the bones below 'node', like
+// LLAvatarAppearance::makeJointAliases() does.
+static void add_joint_aliases(LLXmlTreeNode* node, JointMap& aliases)
+{
+	static LLStdStringHandle name_string =
+		LLXmlTree::addAttributeString("name");
+	static LLStdStringHandle aliases_string =
+		LLXmlTree::addAttributeString("aliases");
+
+	boost::char_separator<char> sep(" ");
+	std::string name, list;
+	for (LLXmlTreeNode* child = node->getFirstChild(); child;
+		 child = node->getNextChild())
+	{
+		// Collision volumes are not joints.
+		if (!child->hasName("bone") ||
+			!child->getFastAttributeString(name_string, name))
+		{
+			continue;
+		}
+		aliases[name] = name;
+
+		list.clear();
+		child->getFastAttributeString(aliases_string, list);
+		boost::tokenizer<boost::char_separator<char> > tok(list, sep);
+		for (boost::tokenizer<boost::char_separator<char> >::iterator
+				it = tok.begin(), end = tok.end();
+			 it != end; ++it)
+		{
+			aliases[*it] = name;
+		}
+
+		add_joint_aliases(child, aliases);
+	}
+}
+
+static bool load_joint_aliases(const std::string& filename,
+							   JointMap& aliases)
+{
+	LLXmlTree tree;
+	if (!tree.parseFile(filename, false))
+	{
+		return false;
+	}
+	LLXmlTreeNode* root = tree.getRoot();
+	if (!root || !root->hasName("linden_skeleton"))
+	{
+		return false;
+	}
+	add_joint_aliases(root, aliases);
+	return !aliases.empty();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion proper
+///////////////////////////////////////////////////////////////////////////////
+
+static LLJoint* lookup_joint(const std::string&, void*)
+{
+	// There is no avatar to lookup joints from: the loader then only uses the
+	// joint positions found in the model file.
+	return NULL;
+}
+
+static void state_changed(U32 state, void* userdata)
+{
+	ConversionJob* job = (ConversionJob*)userdata;
+	if (job)
+	{
+		job->mState = state;
+	}
+}
+
+// Runs on the threads pool. All the models created here are only ever seen
+// by the calling thread, and they are all released before returning.
+static void convert(ConversionJob* job)
+{
+	LLModelLoader* loader = job->mLoader;
+
+	F64 start = LLTimer::getTotalSeconds();
+	bool loaded;
+	if (job->mIsDAE)
+	{
+		LLMutexLock lock(&sDAEMutex);
+		loaded = loader->doLoadModel();
+	}
+	else
+	{
+		loaded = loader->doLoadModel();
+	}
+	F64 now = LLTimer::getTotalSeconds();
+	job->mLoadTime = now - start;
+
+	if (!loaded || job->mState >= LLModelLoader::ERROR_PARSING ||
+		loader->mModelList.empty())
+	{
+		job->mError = llformat("failed to load (state %d)", job->mState);
+		loader->mModelList.clear();
+		loader->mScene.clear();
+		return;
+	}
+
+	LLModel::Decomposition decomp;
+	F32 est_tris[LLModel::LOD_HIGH + 1];
+	U32 count = loader->mModelList.size();
+	for (U32 i = 0; i < count; ++i)
+	{
+		LLModel* base = loader->mModelList[i];
+		if (!base || !base->getNumVolumeFaces())
+		{
+			continue;
+		}
+		++job->mModels;
+
+		// Generate the lower LODs, each one 'sDecimation' times smaller than
+		// the upper one, like the model upload floater does when generating
+		// all LODs at once.
+		start = LLTimer::getTotalSeconds();
+		LLPointer<LLModel> lods[LLModel::LOD_HIGH + 1];
+		lods[LLModel::LOD_HIGH] = base;
+		F32 indices_decim = 1.f;
+		for (S32 lod = LLModel::LOD_MEDIUM; lod >= LLModel::LOD_IMPOSTOR;
+			 --lod)
+		{
+			indices_decim *= sDecimation;
+			LLPointer<LLModel> model =
+				LLModelSimplifier::simplify(base,
+											base->mLabel + sLODSuffixes[lod],
+											sMethod, indices_decim, 1.f,
+											true, job->mLog);
+			if (!model->validate())
+			{
+				job->mLog.emplace_back("Invalid simplified model " +
+									   model->mLabel +
+									   ": using the upper LOD instead.");
+				++job->mFailedLODs;
+				model = lods[lod + 1];
+			}
+			lods[lod] = model;
+		}
+		for (S32 lod = 0; lod <= LLModel::LOD_HIGH; ++lod)
+		{
+			job->mTriangles[lod] += lods[lod]->getNumTriangles();
+		}
+		now = LLTimer::getTotalSeconds();
+		job->mLODsTime += now - start;
+
+		// Serialize the mesh asset, with the lowest LOD as the physics shape.
+		start = now;
+		std::ostringstream ostr;
+		bool skinned = !base->mSkinWeights.empty();
+		LLSD header =
+			LLModel::writeModel(ostr, lods[LLModel::LOD_IMPOSTOR],
+								lods[LLModel::LOD_HIGH],
+								lods[LLModel::LOD_MEDIUM],
+								lods[LLModel::LOD_LOW],
+								lods[LLModel::LOD_IMPOSTOR], decomp, skinned,
+								false, false, sDryRun, false,
+								base->mSubmodelID);
+		for (LLSD::map_const_iterator it = header.beginMap(),
+									  end = header.endMap();
+			 it != end; ++it)
+		{
+			if (it->second.has("size"))
+			{
+				job->mBytes += it->second["size"].asInteger();
+			}
+		}
+
+		if (!sDryRun)
+		{
+			std::string filename = job->mOutputBase;
+			if (count > 1)
+			{
+				filename += llformat("_%d", i + 1);
+			}
+			filename += ".llmesh";
+			llofstream outfile(filename.c_str(),
+							   std::ios::out | std::ios::binary);
+			if (!outfile.is_open())
+			{
+				job->mError = "could not write: " + filename;
+				break;
+			}
+			const std::string data = ostr.str();
+			outfile.write(data.data(), data.size());
+		}
+		job->mWriteTime += LLTimer::getTotalSeconds() - start;
+
+		// Accumulate the costs of all the instances of this model.
+		// Costs computed with the default values of the viewer settings.
+		S32 sizes[LLModel::LOD_HIGH + 1];
+		LLMeshCost::getLODSizes(header, sizes);
+		LLMeshCost::fillLODSizes(sizes);
+		LLMeshCost::estimateTrisByLOD(sizes, est_tris);
+		F32 tri_cost = LLMeshCost::getTriangleBasedCost(est_tris);
+		for (LLModelLoader::scene::iterator it = loader->mScene.begin(),
+											end = loader->mScene.end();
+			 it != end; ++it)
+		{
+			for (U32 j = 0, count2 = it->second.size(); j < count2; ++j)
+			{
+				LLModelInstance& instance = it->second[j];
+				if (instance.mModel.get() == base)
+				{
+					++job->mInstances;
+					F32 radius = get_instance_radius(instance.mTransform);
+					job->mStreamingCost +=
+						LLMeshCost::getRadiusBasedCost(est_tris, radius);
+					job->mTriangleCost += tri_cost;
+				}
+			}
+		}
+	}
+
+	if (!job->mModels && job->mError.empty())
+	{
+		job->mError = "no usable model found";
+	}
+
+	// Release the models now, on the thread that created them.
+	loader->mModelList.clear();
+	loader->mScene.clear();
+	while (!loader->mPhysicsQ.empty())
+	{
+		loader->mPhysicsQ.pop();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main program
+///////////////////////////////////////////////////////////////////////////////
+
+static void usage()
+{
+	std::cerr << "Usage: meshconverter [options] file.dae|file.gltf|file.glb ...\n"
+			  << "Options:\n"
+			  << "  -o <dir>       Output directory for the .llmesh files (default: same as\n"
+			  << "                 the model file).\n"
+			  << "  -j <threads>   Number of files processed in parallel (default: number\n"
+			  << "                 of CPU cores).\n"
+			  << "  -d <factor>    Triangles decimation factor between two LODs (default: 3).\n"
+			  << "  -m <method>    Simplification method: auto, precise or sloppy (default:\n"
+			  << "                 auto).\n"
+			  << "  -l <limit>     Maximum number of models generated when splitting DAE\n"
+			  << "                 meshes with more than 8 faces (default: 768, like the\n"
+			  << "                 viewer ImporterModelLimit setting).\n"
+			  << "  -s <file>      Path to avatar_skeleton.xml, needed to recognize joint\n"
+			  << "                 aliases in rigged meshes.\n"
+			  << "  -p             Pre-process DAE files (to fix invalid names and IDs).\n"
+			  << "  -n             Dry run: do not write any .llmesh file.\n"
+			  << "  -v             Verbose: print the loaders and simplifier messages.\n"
+			  << std::endl;
+}
+
+static std::string get_output_base(const std::string& filename)
+{
+	size_t i = filename.find_last_of("/\\");
+	std::string dir, name;
+	if (i == std::string::npos)
+	{
+		name = filename;
+	}
+	else
+	{
+		dir = filename.substr(0, i + 1);
+		name = filename.substr(i + 1);
+	}
+	i = name.rfind('.');
+	if (i != std::string::npos && i > 0)
+	{
+		name.resize(i);
+	}
+	if (sOutputDir.empty())
+	{
+		return dir + name;
+	}
+	return sOutputDir + LL_DIR_DELIM_STR + name;
+}
+
+int main(int argc, char** argv)
+{
+	ll_init_apr();
+	LLTimer::initClass();
+
+	// Set up llerror logging: warnings and errors only go to stderr, unless
+	// in verbose mode.
+	LLError::initForApplication(".");
+	LLError::setDefaultLevel(LLError::LEVEL_WARN);
+
+	U32 threads = llmax(1U, std::thread::hardware_concurrency());
+	std::string skeleton;
+	std::vector<std::string> files;
+	for (S32 i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "-o" && has_value)
+		{
+			sOutputDir = argv[++i];
+		}
+		else if (arg == "-j" && has_value)
+		{
+			threads = llclamp(atoi(argv[++i]), 1, 64);
+		}
+		else if (arg == "-d" && has_value)
+		{
+			sDecimation = llclamp((F32)atof(argv[++i]), 1.f, 100.f);
+		}
+		else if (arg == "-m" && has_value)
+		{
+			std::string method = argv[++i];
+			if (method == "auto")
+			{
+				sMethod = LLModelSimplifier::AUTO;
+			}
+			else if (method == "precise")
+			{
+				sMethod = LLModelSimplifier::PRECISE;
+			}
+			else if (method == "sloppy")
+			{
+				sMethod = LLModelSimplifier::SLOPPY;
+			}
+			else
+			{
+				usage();
+				return 1;
+			}
+		}
+		else if (arg == "-l" && has_value)
+		{
+			sModelLimit = llmax(1, atoi(argv[++i]));
+		}
+		else if (arg == "-s" && has_value)
+		{
+			skeleton = argv[++i];
+		}
+		else if (arg == "-p")
+		{
+			sPreprocessDAE = true;
+		}
+		else if (arg == "-n")
+		{
+			sDryRun = true;
+		}
+		else if (arg == "-v")
+		{
+			sVerbose = true;
+			LLError::setDefaultLevel(LLError::LEVEL_INFO);
+		}
+		else if (arg.empty() || arg[0] == '-')
+		{
+			usage();
+			return 1;
+		}
+		else
+		{
+			files.emplace_back(arg);
+		}
+	}
+	if (files.empty())
+	{
+		usage();
+		return 1;
+	}
+
+	JointMap joint_aliases;
+	if (!skeleton.empty() && !load_joint_aliases(skeleton, joint_aliases))
+	{
+		std::cerr << "Could not load the avatar skeleton from: " << skeleton
+				  << std::endl;
+		return 1;
+	}
+
+	// The loaders must be created and destroyed on the main thread.
+	std::vector<std::unique_ptr<ConversionJob> > jobs;
+	jobs.reserve(files.size());
+	for (U32 i = 0, count = files.size(); i < count; ++i)
+	{
+		const std::string& filename = files[i];
+		ConversionJob* job = new ConversionJob(filename);
+		jobs.emplace_back(job);
+		job->mOutputBase = get_output_base(filename);
+
+		std::string ext;
+		size_t pos = filename.rfind('.');
+		if (pos != std::string::npos)
+		{
+			ext = filename.substr(pos + 1);
+			LLStringUtil::toLower(ext);
+		}
+		if (ext == "dae")
+		{
+			job->mIsDAE = true;
+			job->mLoader = new LLDAELoader(filename, LLModel::LOD_HIGH, NULL,
+										   lookup_joint, NULL, state_changed,
+										   job, job->mJointTransformMap,
+										   job->mJointsFromNode,
+										   joint_aliases,
+										   LL_MAX_JOINTS_PER_MESH_OBJECT,
+										   sModelLimit, sPreprocessDAE);
+		}
+		else if (ext == "gltf" || ext == "glb")
+		{
+			job->mLoader = new LLGLTFLoader(filename, LLModel::LOD_HIGH, NULL,
+											lookup_joint, NULL, state_changed,
+											job, job->mJointTransformMap,
+											job->mJointsFromNode,
+											joint_aliases,
+											LL_MAX_JOINTS_PER_MESH_OBJECT);
+		}
+		else
+		{
+			job->mError = "unsupported file type";
+			continue;
+		}
+		job->mLoader->mTrySLM = false;
+	}
+
+	F64 start = LLTimer::getTotalSeconds();
+	{
+		LLThreadPool pool("MeshConverter", threads);
+		pool.start();
+		LLWorkQueue& queue = pool.getQueue();
+		for (U32 i = 0, count = jobs.size(); i < count; ++i)
+		{
+			ConversionJob* job = jobs[i].get();
+			if (job->mLoader)
+			{
+				queue.post([job]() { convert(job); });
+			}
+		}
+		// Closing the pool lets the threads process what is left in the queue
+		// before joining them.
+		pool.close();
+	}
+	F64 elapsed = LLTimer::getTotalSeconds() - start;
+
+	U32 failed = 0;
+	U32 models = 0;
+	F64 load_time = 0.0;
+	F64 lods_time = 0.0;
+	F64 write_time = 0.0;
+	for (U32 i = 0, count = jobs.size(); i < count; ++i)
+	{
+		const ConversionJob* job = jobs[i].get();
+		if (sVerbose)
+		{
+			for (U32 j = 0, count2 = job->mLog.size(); j < count2; ++j)
+			{
+				std::cout << job->mFilename << ": " << job->mLog[j] << "\n";
+			}
+		}
+		if (!job->mError.empty())
+		{
+			++failed;
+			std::cout << job->mFilename << ": ERROR: " << job->mError
+					  << std::endl;
+			continue;
+		}
+		models += job->mModels;
+		load_time += job->mLoadTime;
+		lods_time += job->mLODsTime;
+		write_time += job->mWriteTime;
+		std::cout << job->mFilename << ": " << job->mModels << " model(s), "
+				  << job->mInstances << " instance(s), triangles "
+				  << "(high/med/low/lowest): "
+				  << job->mTriangles[LLModel::LOD_HIGH] << "/"
+				  << job->mTriangles[LLModel::LOD_MEDIUM] << "/"
+				  << job->mTriangles[LLModel::LOD_LOW] << "/"
+				  << job->mTriangles[LLModel::LOD_IMPOSTOR] << ", "
+				  << job->mBytes << " bytes, streaming cost: "
+				  << llformat("%.3f", job->mStreamingCost)
+				  << " (animesh: " << llformat("%.3f", job->mTriangleCost)
+				  << ")";
+		if (job->mFailedLODs)
+		{
+			std::cout << ", " << job->mFailedLODs << " invalid LOD(s)";
+		}
+		std::cout << llformat(" - load: %.1fms, LODs: %.1fms, write: %.1fms",
+							  job->mLoadTime * 1000.0,
+							  job->mLODsTime * 1000.0,
+							  job->mWriteTime * 1000.0) << std::endl;
+	}
+
+	std::cout << jobs.size() - failed << " file(s) converted ("
+			  << models << " model(s)), " << failed << " failed, using "
+			  << threads << " thread(s)."
+			  << llformat(" Total time: %.3fs (cumulated: load %.3fs, LODs "
+						  "%.3fs, write %.3fs).", elapsed, load_time,
+						  lods_time, write_time)
+			  << std::endl;
+
+	// Destroy the loaders on the main thread.
+	jobs.clear();
+
+	ll_cleanup_apr();
+
+	return failed ? 1 : 0;
+}
@@ -42,11 +42,16 @@
 
 #include "curl/curlver.h"
 
+#include <algorithm>
+
 #include "llappcorehttp.h"
 
+#include "llcorehttplibcurl.h"
+#include "llcorehttpservice.h"
 #include "lldir.h"
 
 #include "llappviewer.h"
+#include "llcallbacklist.h"
 #include "llgridmanager.h"		// For gIsInSecondLife
 #include "lltexturefetch.h"
 #include "llviewercontrol.h"
@@ -66,62 +71,63 @@ static const struct
 	U32			mMax;
 	U32			mRate;
 	bool		mPipelined;
+	bool		mMultiplexed;
 	std::string	mKey;
 	const char*	mUsage;
 } init_data[LLAppCoreHttp::AP_COUNT] =
 {
 	{	// AP_DEFAULT
-		8,		4,		8,		0,		false,
+		8,		4,		8,		0,		false,	false,
 		"",
 		"other"
 	},
 	{	// AP_TEXTURE
-		12,		2,		32,		0,		true,
+		12,		2,		32,		0,		true,	true,
 		"TextureFetchConcurrency",
 		"texture fetch"
 	},
 	{	// AP_MESH1
-		32,		1,		128,	0,		false,
+		32,		1,		128,	0,		false,	false,
 		"MeshMaxConcurrentRequests",
 		"mesh fetch"
 	},
 	{	// AP_MESH2
-		16,		1,		32,		0,		true,
+		16,		1,		32,		0,		true,	true,
 		"Mesh2MaxConcurrentRequests",
 		"mesh2 fetch"
 	},
 	{	// AP_LARGE_MESH
-		4,		1,		8,		0,		false,
+		4,		1,		8,		0,		false,	true,
 		"",
 		"large mesh fetch"
 	},
 	{	// AP_ASSETS
-		8,		2,		32,		0,		true,
+		8,		2,		32,		0,		true,	false,
 		"AssetFetchConcurrency",
 		"asset fetch"
 	},
 	{	// AP_UPLOADS
-		2,		1,		8,		0,		false,
+		2,		1,		8,		0,		false,	false,
 		"",
 		"asset upload"
 	},
 	{	// AP_LONG_POLL
-		32,		32,		32,		0,		false,
+		32,		32,		32,		0,		false,	false,
 		"",
 		"long poll"
 	},
 	{	// AP_INVENTORY
-		8,		1,		16,		0,		true,
+		8,		1,		16,		0,		true,	false,
 		"",
 		"inventory"
 	},
 	{ // AP_MATERIALS
-		2,		1,		8,		0,		false,
+		2,		1,		8,		0,		false,	false,
 		"MaterialFetchConcurrency",
 		"material manager requests"
 	},
 	{ // AP_AGENT
-		2,		1,		32,		0,		false,
+		2,		1,		32,		0,		false,	false,
 		"Agent",
 		"Agent requests"
 	}
@@ -136,6 +142,7 @@ void setting_changed()
 LLAppCoreHttp::HttpClass::HttpClass()
 :	mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
 	mConnLimit(0U),
+	mHttp2Streams(0U),
 	mPipelined(false)
 {
 }
@@ -296,6 +303,39 @@ void LLAppCoreHttp::init()
 		llwarns << "Unable to set signal on global setting: HttpPipeliningOS"
 				<< llendl;
 	}
+	ctrl = gSavedSettings.getControl("HttpEventDrivenLoop");
+	if (ctrl.notNull())
+	{
+		mEventDrivenSignal =
+			ctrl->getSignal()->connect(boost::bind(&setting_changed));
+	}
+	else
+	{
+		llwarns << "Unable to set signal on global setting: HttpEventDrivenLoop"
+				<< llendl;
+	}
+	ctrl = gSavedSettings.getControl("HttpHTTP2Multiplexing");
+	if (ctrl.notNull())
+	{
+		mHttp2Signal =
+			ctrl->getSignal()->connect(boost::bind(&setting_changed));
+	}
+	else
+	{
+		llwarns << "Unable to set signal on global setting: HttpHTTP2Multiplexing"
+				<< llendl;
+	}
+	ctrl = gSavedSettings.getControl("HttpHTTP2Streams");
+	if (ctrl.notNull())
+	{
+		mHttp2StreamsSignal =
+			ctrl->getSignal()->connect(boost::bind(&setting_changed));
+	}
+	else
+	{
+		llwarns << "Unable to set signal on global setting: HttpHTTP2Streams"
+				<< llendl;
+	}
 
 	// Register signals for settings and state changes
 	for (S32 i = 0, count = init_data_size; i < count; ++i)
@@ -329,6 +369,9 @@ namespace
 	// case want the entire LLAppCoreHttp object to be destroyed at the end of
 	// the call.
 	void NoOpDeletor(LLCore::HttpHandler*)	{}
+
+	// Defined below, with the HTTP benchmark implementation.
+	void abort_http_benchmark();
 }
 
 void LLAppCoreHttp::requestStop()
@@ -346,6 +389,9 @@ void LLAppCoreHttp::requestStop()
 
 void LLAppCoreHttp::cleanup()
 {
+	// Do not leave any benchmark request in flight.
+	abort_http_benchmark();
+
 	if (mStopHandle == LLCORE_HTTP_HANDLE_INVALID)
 	{
 		// Should have been started already...
@@ -378,6 +424,9 @@ void LLAppCoreHttp::cleanup()
 	}
 	mPipelinedSignal.disconnect();
 	mOSPipelinedSignal.disconnect();
+	mEventDrivenSignal.disconnect();
+	mHttp2Signal.disconnect();
+	mHttp2StreamsSignal.disconnect();
 
 	delete mRequest;
 	mRequest = NULL;
@@ -414,6 +463,15 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 {
 	LLCore::HttpStatus status;
 
+	// Service thread loop mode
+	bool event_driven = gSavedSettings.getBool("HttpEventDrivenLoop");
+	if (initial || event_driven != LLCore::HttpService::isEventDrivenLoop())
+	{
+		LLCore::HttpService::setEventDrivenLoop(event_driven);
+		llinfos << "HTTP service loop is" << (initial ? " " : " now ")
+				<< (event_driven ? "event-driven" : "polling") << llendl;
+	}
+
 	// Global pipelining setting. Defaults to true (in ctor) if absent.
 	bool pipeline_changed = false;
 	bool pipelined = isPipeliningOn();
@@ -428,6 +486,14 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 				<< (pipelined ? "enabled" : "disabled") << llendl;
 	}
 
+	// Global HTTP/2 multiplexing setting, for the classes supporting it.
+	U32 http2_streams = 0;
+	if (gSavedSettings.getBool("HttpHTTP2Multiplexing"))
+	{
+		http2_streams = llclamp(gSavedSettings.getU32("HttpHTTP2Streams"),
+								1U, 100U);
+	}
+
 	for (S32 i = 0, count = init_data_size; i < count; ++i)
 	{
 		const EAppPolicy app_policy = (EAppPolicy)i;
@@ -481,6 +547,35 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 			}
 		}
 
+		// HTTP/2 multiplexing changes
+		bool multiplex_changed = false;
+		U32 streams = init_data[i].mMultiplexed ? http2_streams : 0;
+		if (streams != mHttpClasses[app_policy].mHttp2Streams)
+		{
+			LLCore::HttpHandle handle =
+				mRequest->setPolicyOption(LLCore::HttpRequest::PO_HTTP2_STREAMS,
+										  mHttpClasses[app_policy].mPolicy,
+										  (long)streams,
+										  LLCore::HttpHandler::ptr_t());
+			if (handle == LLCORE_HTTP_HANDLE_INVALID)
+			{
+				status = mRequest->getStatus();
+				llwarns << "Unable to set " << init_data[i].mUsage
+						<< " HTTP/2 multiplexing. Reason: "
+						<< status.toString() << llendl;
+			}
+			else
+			{
+				llinfos << "HTTP/2 multiplexing for " << init_data[i].mUsage
+						<< (streams ? " enabled with " : " disabled")
+						<< (streams ? llformat("%u streams per connection.",
+											   streams)
+									: std::string(".")) << llendl;
+				mHttpClasses[app_policy].mHttp2Streams = streams;
+				multiplex_changed = true;
+			}
+		}
+
 		// Get target connection concurrency value
 		U32 setting = init_data[i].mDefault;
 		std::string setting_name = init_data[i].mKey;
@@ -496,7 +591,7 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 			}
 		}
 
-		if (initial || pipeline_changed ||
+		if (initial || pipeline_changed || multiplex_changed ||
 			setting != mHttpClasses[app_policy].mConnLimit)
 		{
 			// Set it and report. Strategies depend on pipelining:
@@ -512,8 +607,21 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 			// setting. Transitions (region crossings, new avatars, etc) can
 			// request additional outbound connections to other servers via 2x
 			// total connection limit.
+			//
+			// HTTP/2 multiplexing. libcurl manages the connections, which are
+			// shared with the other multiplexed classes. The per-host limit is
+			// adjusted for the class concurrency (connections x streams) to
+			// stay close to the user-visible concurrency value, with the same
+			// 2x total connection limit as for pipelining.
+			U32 per_host = setting;
 			U32 limit = mHttpClasses[app_policy].mPipelined ? 2 * setting
 															: setting;
+			U32 streams = mHttpClasses[app_policy].mHttp2Streams;
+			if (streams)
+			{
+				per_host = llmax(1U, (setting + streams - 1) / streams);
+				limit = 2 * per_host;
+			}
 			LLCore::HttpHandle handle =
 				mRequest->setPolicyOption(LLCore::HttpRequest::PO_CONNECTION_LIMIT,
 										  mHttpClasses[app_policy].mPolicy,
@@ -531,7 +639,7 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 				handle =
 					mRequest->setPolicyOption(LLCore::HttpRequest::PO_PER_HOST_CONNECTION_LIMIT,
 											  mHttpClasses[app_policy].mPolicy,
-											  setting,
+											  per_host,
 											  LLCore::HttpHandler::ptr_t());
 				if (handle == LLCORE_HTTP_HANDLE_INVALID)
 				{
@@ -656,3 +764,400 @@ LLCore::HttpStatus LLAppCoreHttp::sslVerify(const std::string& url,
 
 	return result;
 }
+
+namespace
+{
+	// Records the completion time and size of the benchmark requests.
+	class HttpBenchmarkHandler final : public LLCore::HttpHandler
+	{
+	public:
+		HttpBenchmarkHandler(U32 requests)
+		:	mCompleted(0),
+			mFailed(0),
+			mBytes(0)
+		{
+			mLatencies.reserve(requests);
+		}
+
+		void onCompleted(LLCore::HttpHandle handle,
+						 LLCore::HttpResponse* response) override
+		{
+			++mCompleted;
+			issue_map_t::iterator it = mIssueTimes.find(handle);
+			if (!response->getStatus())
+			{
+				++mFailed;
+			}
+			else
+			{
+				mBytes += response->getBodySize();
+				if (it != mIssueTimes.end())
+				{
+					mLatencies.push_back(mTimer.getElapsedTimeF64() -
+										 it->second);
+				}
+			}
+			// Only the requests still pending are kept in the map.
+			if (it != mIssueTimes.end())
+			{
+				mIssueTimes.erase(it);
+			}
+		}
+
+	public:
+		typedef fast_hmap<LLCore::HttpHandle, F64> issue_map_t;
+		issue_map_t			mIssueTimes;
+		std::vector<F64>	mLatencies;
+		LLTimer				mTimer;
+		U32					mCompleted;
+		U32					mFailed;
+		U64					mBytes;
+	};
+
+	// Runs the benchmark passes asynchronously: the replies are collected
+	// from an idle callback and each pass is reported once all its requests
+	// completed or timed out. The first pass is a warm-up one (connections
+	// establishment, server caches), which is not accounted for. Then come
+	// BENCH_ROUNDS rounds of one pass with each service loop, the loop going
+	// first alternating from one round to the next, so that neither loop gets
+	// favoured by running in a warmer or colder state. A pass only starts once
+	// the requests of the previous one are all gone.
+	class HttpBenchmark
+	{
+	protected:
+		LOG_CLASS(HttpBenchmark);
+
+	public:
+		HttpBenchmark(const std::string& base_url, U32 requests,
+					  U32 range_size)
+		:	mBaseURL(base_url),
+			mRequests(requests),
+			mRangeSize(range_size),
+			mPass(0),
+			mIssued(0),
+			mDraining(false),
+			mStartRequests(0),
+			mStartStreams(0),
+			mStartConnections(0),
+			mHandlerp(NULL),
+			mEventDriven(LLCore::HttpService::isEventDrivenLoop()),
+			mOptions(new LLCore::HttpOptions)
+		{
+			sInstancep = this;
+			mOptions->setRetries(0);
+			mOptions->setTimeout(30);
+			// The stand-in server uses a self-signed certificate in HTTPS
+			// mode.
+			mOptions->setSSLVerifyPeer(false);
+			mOptions->setSSLVerifyHost(false);
+		}
+
+		~HttpBenchmark()
+		{
+			// Do not leave any of our requests behind.
+			if (mHandlerp)
+			{
+				cancelPending();
+			}
+			gIdleCallbacks.deleteFunction(onIdle, this);
+			LLCore::HttpService::setEventDrivenLoop(mEventDriven);
+			sInstancep = NULL;
+		}
+
+		// Issues the requests for the current pass and registers the idle
+		// callback. Returns false when no request could be issued.
+		bool startPass();
+
+		static void onIdle(void* userdata);
+
+		LL_INLINE static bool isRunning()		{ return sInstancep != NULL; }
+
+		// Called on viewer shutdown, before the HTTP service is destroyed.
+		LL_INLINE static void abort()
+		{
+			if (sInstancep)
+			{
+				llinfos << "Aborting the running HTTP benchmark." << llendl;
+				delete sInstancep;
+			}
+		}
+
+	private:
+		// Pass 0 is the warm-up pass, using the default service loop.
+		LL_INLINE bool isEventDrivenPass() const
+		{
+			if (mPass == 0)
+			{
+				return mEventDriven;
+			}
+			U32 round = (mPass - 1) / 2;
+			bool first = (mPass - 1) % 2 == 0;
+			return first == (round % 2 == 0);
+		}
+
+		void cancelPending();
+		void reportPass();
+		void reportSummary();
+
+	private:
+		struct LoopResults
+		{
+			LL_INLINE LoopResults()
+			:	mThroughput(0.0),
+				mMedian(0.0),
+				mP95(0.0),
+				mPasses(0)
+			{
+			}
+
+			F64	mThroughput;
+			F64	mMedian;
+			F64	mP95;
+			U32	mPasses;
+		};
+		// Indexed by isEventDrivenPass()
+		LoopResults						mResults[2];
+
+		std::string						mBaseURL;
+		U32								mRequests;
+		U32								mRangeSize;
+		U32								mPass;
+		U32								mIssued;
+		bool							mDraining;
+		LLTimer							mDrainTimer;
+		U64								mStartRequests;
+		U64								mStartStreams;
+		U64								mStartConnections;
+		HttpBenchmarkHandler*			mHandlerp;
+		bool							mEventDriven;
+		LLCore::HttpHandler::ptr_t		mHandler;
+		LLCore::HttpOptions::ptr_t		mOptions;
+		LLCore::HttpHeaders::ptr_t		mHeaders;
+		LLCore::HttpRequest				mRequest;
+
+		static HttpBenchmark*			sInstancep;
+
+		static constexpr U32			BENCH_ROUNDS = 3;
+		static constexpr U32			BENCH_PASSES = 1 + 2 * BENCH_ROUNDS;
+		// Seconds
+		static constexpr F64			PASS_TIMEOUT = 60.0;
+		static constexpr F64			DRAIN_TIMEOUT = 10.0;
+	};
+
+	HttpBenchmark* HttpBenchmark::sInstancep = NULL;
+
+	bool HttpBenchmark::startPass()
+	{
+		LLCore::HttpService::setEventDrivenLoop(isEventDrivenPass());
+
+		mStartRequests = LLCore::HttpLibcurl::getCompletedRequests();
+		mStartStreams = LLCore::HttpLibcurl::getHttp2Streams();
+		mStartConnections = LLCore::HttpLibcurl::getNewConnections();
+		mHandlerp = new HttpBenchmarkHandler(mRequests);
+		mHandler.reset(mHandlerp);
+		mHandlerp->mTimer.reset();
+
+		const LLAppCoreHttp& app_http = gAppViewerp->getAppCoreHttp();
+		mIssued = 0;
+		for (U32 i = 0; i < mRequests; ++i)
+		{
+			// Alternate between synthetic texture and mesh assets, fetching
+			// successive byte ranges in each of them.
+			bool mesh = i % 2 != 0;
+			std::string url = mBaseURL + (mesh ? "mesh/" : "texture/") +
+							  llformat("%u", i / 16);
+			LLAppCoreHttp::EAppPolicy policy =
+				mesh ? LLAppCoreHttp::AP_MESH2 : LLAppCoreHttp::AP_TEXTURE;
+			LLCore::HttpHandle handle =
+				mRequest.requestGetByteRange(app_http.getPolicy(policy), url,
+											 (i % 16) * mRangeSize,
+											 mRangeSize, mOptions, mHeaders,
+											 mHandler);
+			if (handle == LLCORE_HTTP_HANDLE_INVALID)
+			{
+				llwarns << "Failed to issue request to: " << url
+						<< " - Reason: " << mRequest.getStatus().toString()
+						<< llendl;
+				continue;
+			}
+			mHandlerp->mIssueTimes.emplace(handle,
+										   mHandlerp->mTimer.getElapsedTimeF64());
+			++mIssued;
+		}
+		if (!mIssued)
+		{
+			return false;
+		}
+
+		if (!gIdleCallbacks.containsFunction(onIdle, this))
+		{
+			gIdleCallbacks.addFunction(onIdle, this);
+		}
+		return true;
+	}
+
+	//static
+	void HttpBenchmark::onIdle(void* userdata)
+	{
+		HttpBenchmark* self = (HttpBenchmark*)userdata;
+		// Collect the replies without blocking the main thread.
+		self->mRequest.update(0L);
+		bool pending = self->mHandlerp->mCompleted < self->mIssued;
+		if (!self->mDraining)
+		{
+			// Wait for all the replies, with a safety timeout.
+			if (pending &&
+				self->mHandlerp->mTimer.getElapsedTimeF64() < PASS_TIMEOUT)
+			{
+				return;
+			}
+			self->reportPass();
+			if (pending)
+			{
+				// Cancel the requests still pending, and wait for them to be
+				// gone before starting the next pass, so that they do not
+				// weigh on the latter.
+				self->cancelPending();
+				self->mDraining = true;
+				self->mDrainTimer.reset();
+				return;
+			}
+		}
+		else if (pending &&
+				 self->mDrainTimer.getElapsedTimeF64() < DRAIN_TIMEOUT)
+		{
+			return;
+		}
+		else if (pending)
+		{
+			llwarns << self->mIssued - self->mHandlerp->mCompleted
+					<< " cancelled requests still pending; starting the next pass anyway."
+					<< llendl;
+		}
+		self->mDraining = false;
+
+		if (++self->mPass < BENCH_PASSES && self->startPass())
+		{
+			return;
+		}
+
+		self->reportSummary();
+		llinfos << "HTTP benchmark finished." << llendl;
+		delete self;
+	}
+
+	void HttpBenchmark::cancelPending()
+	{
+		HttpBenchmarkHandler::issue_map_t& pending = mHandlerp->mIssueTimes;
+		for (HttpBenchmarkHandler::issue_map_t::const_iterator
+				it = pending.begin(), end = pending.end();
+			 it != end; ++it)
+		{
+			mRequest.requestCancel(it->first, LLCore::HttpHandler::ptr_t());
+		}
+	}
+
+	void HttpBenchmark::reportPass()
+	{
+		F64 elapsed = mHandlerp->mTimer.getElapsedTimeF64();
+
+		std::vector<F64>& latencies = mHandlerp->mLatencies;
+		F64 median = 0.0;
+		F64 p95 = 0.0;
+		F64 max = 0.0;
+		F64 average = 0.0;
+		if (!latencies.empty())
+		{
+			std::sort(latencies.begin(), latencies.end());
+			size_t count = latencies.size();
+			median = latencies[count / 2];
+			p95 = latencies[(count * 95) / 100];
+			max = latencies.back();
+			for (size_t i = 0; i < count; ++i)
+			{
+				average += latencies[i];
+			}
+			average /= F64(count);
+		}
+		F64 throughput = F64(mHandlerp->mBytes) / (elapsed * 1048576.0);
+		bool event_driven = isEventDrivenPass();
+		if (mPass)
+		{
+			LoopResults& results = mResults[event_driven ? 1 : 0];
+			results.mThroughput += throughput;
+			results.mMedian += median;
+			results.mP95 += p95;
+			++results.mPasses;
+		}
+		llinfos << "HTTP benchmark, "
+				<< (mPass ? llformat("round %u", (mPass + 1) / 2)
+						  : std::string("warm-up pass"))
+				<< " (" << (event_driven ? "event-driven" : "polling")
+				<< " loop): " << mIssued << " requests issued, "
+				<< mHandlerp->mCompleted << " completed, "
+				<< mHandlerp->mFailed << " failed in " << elapsed
+				<< "s. Throughput: " << throughput << "MB/s. Latency (ms): average = " << average * 1000.0
+				<< ", median = " << median * 1000.0 << ", 95th percentile = "
+				<< p95 * 1000.0 << ", max = " << max * 1000.0
+				<< ". Transport: "
+				<< LLCore::HttpLibcurl::getCompletedRequests() - mStartRequests
+				<< " requests (of which "
+				<< LLCore::HttpLibcurl::getHttp2Streams() - mStartStreams
+				<< " HTTP/2 streams) over "
+				<< LLCore::HttpLibcurl::getNewConnections() - mStartConnections
+				<< " new connections." << llendl;
+	}
+
+	void HttpBenchmark::reportSummary()
+	{
+		for (S32 i = 1; i >= 0; --i)
+		{
+			const LoopResults& results = mResults[i];
+			if (!results.mPasses)
+			{
+				continue;
+			}
+			F64 passes = F64(results.mPasses);
+			llinfos << "HTTP benchmark, average over " << results.mPasses
+					<< " passes (" << (i ? "event-driven" : "polling")
+					<< " loop): throughput = "
+					<< results.mThroughput / passes
+					<< "MB/s, median latency = "
+					<< results.mMedian * 1000.0 / passes
+					<< "ms, 95th percentile latency = "
+					<< results.mP95 * 1000.0 / passes << "ms." << llendl;
+		}
+	}
+
+	void abort_http_benchmark()
+	{
+		HttpBenchmark::abort();
+	}
+}
+
+//static
+void LLAppCoreHttp::runBenchmark(const std::string& base_url, U32 requests,
+								 U32 range_size)
+{
+	if (!requests || !range_size || base_url.empty())
+	{
+		return;
+	}
+
+	if (HttpBenchmark::isRunning())
+	{
+		llwarns << "An HTTP benchmark is already running." << llendl;
+		return;
+	}
+
+	HttpBenchmark* benchp = new HttpBenchmark(base_url, requests, range_size);
+	if (benchp->startPass())
+	{
+		llinfos << "HTTP benchmark started; results will be logged as each pass completes."
+				<< llendl;
+	}
+	else
+	{
+		delete benchp;
+	}
+}
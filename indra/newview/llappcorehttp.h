@@ -242,6 +242,18 @@ public:
 	// Apply initial or new settings from the environment.
 	void refreshSettings(bool initial = false);
 
+	// Benchmarks the HTTP service latency and throughput with 'requests'
+	// concurrent byte-range GET requests of 'range_size' bytes, split between
+	// the texture and mesh policy classes, against a local stand-in server
+	// (see scripts/http-bench-server.py) at 'base_url'. After a warm-up pass,
+	// runs several rounds with both the event-driven and legacy service loops,
+	// alternating which one goes first, and logs the results of each pass and
+	// the averages for each loop. Runs asynchronously: the replies are
+	// collected from an idle callback, and each pass ends once all its
+	// requests completed, timed out or got cancelled.
+	static void runBenchmark(const std::string& base_url, U32 requests,
+							 U32 range_size);
+
 #if LL_CURL_BUG
 	// HACK: to work around libcurl bugs that sometimes cause the HTTP pipeline
 	// to return corrupted data... The idea of that hack is to temporarily turn
@@ -268,6 +280,8 @@ private:
 		// Policy class id for the class:
 		policy_t					mPolicy;
 		U32							mConnLimit;
+		// HTTP/2 streams per connection; 0 when not multiplexed:
+		U32							mHttp2Streams;
 		bool						mPipelined;
 		// Signal to global setting that affect this class (if any):
 		boost::signals2::connection mSettingsSignal;
@@ -282,6 +296,9 @@ private:
 	// Signals to global settings that affect us:
 	boost::signals2::connection		mPipelinedSignal;
 	boost::signals2::connection		mOSPipelinedSignal;
+	boost::signals2::connection		mEventDrivenSignal;
+	boost::signals2::connection		mHttp2Signal;
+	boost::signals2::connection		mHttp2StreamsSignal;
 
 #if LL_CURL_BUG
 	// When to restart HTTP pipelining after it got temporarily turned off
@@ -137,10 +137,12 @@
 #include "llhudeffectlookat.h"
 #include "llhudeffectspiral.h"
 #include "llhudmanager.h"
+#include "llidlescheduler.h"
 #include "llimmgr.h"
 #include "llinventorymodelfetch.h"
 #include "lllocalbitmaps.h"
 #include "lllocalgltfmaterials.h"
+#include "lllogchat.h"
 #include "llmeshrepository.h"
 #include "llmutelist.h"
 #include "llnotify.h"
@@ -710,6 +712,7 @@ static void settings_to_globals()
 #endif
 	LLImageGL::sSyncInThread =
 		gSavedSettings.getBool("RenderGLImageSyncInThread");
+	LLImageGL::setUploadStagingSize(gSavedSettings.getU32("RenderGLUploadStagingMB"));
 
 	// Clamp auto-open time to some minimum usable value
 	LLFolderView::sAutoOpenTime =
@@ -1376,7 +1379,7 @@ void LLAppViewer::idleAFKCheck(bool force_afk)
 		!gAgent.getAFK() && !gAgent.getBusy() && !gAgent.getAutoReply() &&
 		(force_afk || gAwayTriggerTimer.getElapsedTimeF32() > (F32)timeout))
 	{
-		U32 away_action = gSavedSettings.getU32("AwayAction");
+		U32 away_action = gSavedSettings.getU32(LL_CONTROL("AwayAction"));
 		switch (away_action)
 		{
 			case 0:
@@ -1509,9 +1512,6 @@ void LLAppViewer::frame(LLEventPump& mainloop)
 	{
 		LL_FAST_TIMER(FTM_POST_DISPLAY);
 
-		// Performing this once per frame is enough.
-		gMeshRepo.update();
-
 		// Register the actual frame render time (in ms) in the stats, before
 		// we would add any frame-limiting delay. HB
 		F32 frame_render_time = frame_timer.getElapsedTimeF64() * 1000.0;
@@ -1703,6 +1703,88 @@ void LLAppViewer::frame(LLEventPump& mainloop)
 	}
 }
 
+#if LL_TRACE_CAPTURE
+bool dump_trace_capture(const char* reason)
+{
+	std::string filename = llformat("trace_%s_%u.json", reason, gFrameCount);
+	filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, filename);
+	return LLTraceCapture::dump(filename);
+}
+
+// Syncs the trace capture state with the "TraceCapture" setting and dumps the
+// captured traces whenever the last frame took longer than the threshold set
+// with "TraceCaptureSpikeThreshold".
+static void trace_capture_frame_check()
+{
+	static LLCachedControl<bool> capture(gSavedSettings, "TraceCapture");
+	static LLCachedControl<F32> threshold(gSavedSettings,
+										  "TraceCaptureSpikeThreshold");
+	static LLTimer frame_timer;
+	static F64 last_dump = 0.0;
+	static bool init_needed = true;
+	if (init_needed)
+	{
+		init_needed = false;
+		LLTraceCapture::setThreadName("Main thread");
+	}
+
+	F64 frame_time = frame_timer.getElapsedTimeAndResetF64();
+	if (capture != LLTraceCapture::enabled())
+	{
+		LLTraceCapture::setEnabled(capture);
+		return;
+	}
+	// Do not dump more than once per minute, since a dump causes a spike on
+	// its own, and the ring buffers need time to fill up again anyway.
+	if (capture && threshold > 0.f && frame_time > (F64)threshold)
+	{
+		F64 now = LLTimer::getTotalSeconds();
+		if (now - last_dump > 60.0)
+		{
+			last_dump = now;
+			llinfos << "Frame time spike (" << frame_time
+					<< "s), dumping the trace capture..." << llendl;
+			dump_trace_capture("spike");
+		}
+	}
+}
+#endif
+
+// Registers the deferrable idle tasks with the idle scheduler, which runs
+// them within a per-frame time budget (see LLAppViewer::idle()).
+static void register_idle_tasks()
+{
+	// Note: the idle callbacks (UI updates, user-visible events processing,
+	// callbacks expecting to be called at each frame) and the gestures (which
+	// timing matters) are not deferrable and are not scheduled here.
+	gIdleScheduler.addTask("Loaded meshes notifications",
+						   []() { gMeshRepo.update(); },
+						   LLIdleScheduler::PRIORITY_HIGH, 2);
+	gIdleScheduler.addTask("Event notifier",
+						   []() { gEventNotifier.update(); },
+						   LLIdleScheduler::PRIORITY_NORMAL, 4);
+	gIdleScheduler.addTask("Inventory observers",
+						   []() { gInventory.idleNotifyObservers(); },
+						   LLIdleScheduler::PRIORITY_NORMAL, 4);
+	gIdleScheduler.addTask("Friends observers",
+						   []() { gAvatarTracker.idleNotifyObservers(); },
+						   LLIdleScheduler::PRIORITY_LOW, 10);
+	// Note: the area search update used to happen after the early return on
+	// gDisconnected in LLAppViewer::idle(), while the scheduler runs before.
+	gIdleScheduler.addTask("Area search",
+						   []()
+						   {
+								if (!gDisconnected)
+								{
+									LL_FAST_TIMER(FTM_AREASEARCH_UPDATE);
+									// Send background requests for the area
+									// search if needed
+									HBFloaterAreaSearch::idleUpdate();
+								}
+						   },
+						   LLIdleScheduler::PRIORITY_LOW, 10);
+}
+
 // Runs the main loop until time to quit. NOTE: for macOS, this method returns
 // at each frame, while for Linux and Windows, it only returns on shutdown.
 bool LLAppViewer::mainLoop()
@@ -1724,6 +1806,8 @@ bool LLAppViewer::mainLoop()
 		LLVoiceClient::init(gServicePumpIOp);
 
 		LLViewerJoystick::getInstance()->setNeedsReset(true);
+
+		register_idle_tasks();
 	}
 
 	LLEventPump& mainloop = gEventPumps.obtain("mainloop");
@@ -1735,6 +1819,13 @@ bool LLAppViewer::mainLoop()
 #endif
 	{
 #if LL_FAST_TIMERS_ENABLED
+		static LLCachedControl<bool> alloc_profiling(gSavedSettings,
+													 "AllocationProfiling");
+		LLMemory::setAllocProfiling(alloc_profiling);
+		if (alloc_profiling)
+		{
+			LLMemory::updateAllocStats();
+		}
 		// Must be outside of any timer instances
 		LLFastTimer::enabledFastTimers(gEnableFastTimers);
 		LLFastTimer::reset();
@@ -1742,6 +1833,9 @@ bool LLAppViewer::mainLoop()
 		frame(mainloop);
 #if TRACY_ENABLE
 		FrameMark;
+#endif
+#if LL_TRACE_CAPTURE
+		trace_capture_frame_check();
 #endif
 	}
 #if LL_DARWIN
@@ -1920,6 +2014,10 @@ bool LLAppViewer::cleanup()
 	gMeshRepo.shutdown();
 	llinfos << "Mesh repository shut down" << llendl;
 
+	// Write any pending chat/IM log line and stop the logs writer thread.
+	LLLogChat::cleanupClass();
+	llinfos << "Chat logs writer shut down" << llendl;
+
 	// Must clean up texture references before viewer window is destroyed.
 	LLHUDManager::updateEffects();
 	LLHUDObject::updateAll();
@@ -2238,6 +2336,8 @@ void LLAppViewer::initThreads()
 	// true = wait until all threads are started.
 	mGeneralThreadPool->start(true);
 	LLAudioDecodeMgr::setGeneralPoolSize(general_threads);
+	U32 cache_size = gSavedSettings.getU32("AudioDecodedCacheSize");
+	LLAudioDecodeMgr::setMemoryCacheSize(cache_size);
 }
 
 //static
@@ -3715,6 +3815,8 @@ void LLAppViewer::purgeCache()
 	LLVOCache::getInstance()->removeCache(LL_PATH_CACHE);
 	LLDiskCache::clear();
 	LLDirIterator::deleteFilesInDir(gDirUtilp->getCacheDir());
+	LLDirIterator::deleteFilesInDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE,
+																   "shader_cache"));
 	gSavedSettings.setBool("ClearAssetCache", false);
 	gSavedSettings.setBool("ClearTextureCache", false);
 	gSavedSettings.setBool("ClearObjectCache", false);
@@ -4120,13 +4222,11 @@ void LLAppViewer::idle(bool run_rlv_maintenance)
 	{
 		LL_FAST_TIMER(FTM_IDLE_CB);
 
-		// Do event notifications if necessary. Yes, we may want to move this
-		// elsewhere.
-		gEventNotifier.update();
-
 		gIdleCallbacks.callFunctions();
-		gInventory.idleNotifyObservers();
-		gAvatarTracker.idleNotifyObservers();
+
+		// Run the deferrable idle tasks (observers, event notifications,
+		// loaded meshes, etc) within the frame budget.
+		gIdleScheduler.run();
 
 		// The "new inventory" observer (used to auto-open newly received
 		// inventory items) gets triggered each time a new item appears in
@@ -4191,12 +4291,6 @@ void LLAppViewer::idle(bool run_rlv_maintenance)
 #endif
 	}
 
-	{
-		LL_FAST_TIMER(FTM_AREASEARCH_UPDATE);
-		// Send background requests for the area search is needed
-		HBFloaterAreaSearch::idleUpdate();
-	}
-
 	// After this point, in theory we should never see a dead object in the
 	// various object/drawable lists.
 
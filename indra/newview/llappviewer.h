@@ -414,4 +414,10 @@ extern bool					gAcceptCriticalMessage;
 constexpr size_t MAC_ADDRESS_BYTES = 6;
 extern unsigned char		gMACAddress[MAC_ADDRESS_BYTES];
 
+#if LL_TRACE_CAPTURE
+// Dumps the trace capture buffers into a new Chrome trace JSON file in the
+// logs directory, with 'reason' in its name. Returns false on failure.
+bool dump_trace_capture(const char* reason);
+#endif
+
 #endif // LL_LLAPPVIEWER_H
@@ -392,6 +392,7 @@ LLFastTimerView::LLFastTimerView(const std::string& name)
 	mMaxCountTotal(0),
 	mDisplayCenter(0),
 	mDisplayCalls(0),
+	mDisplayAllocs(0),
 	mDisplayHz(0),
 	mScrollIndex(0),
 	mHoverIndex(-1),
@@ -602,6 +603,16 @@ bool LLFastTimerView::handleMouseDown(S32 x, S32 y, MASK mask)
 		{
 			mDisplayHz = !mDisplayHz;
 		}
+		else if (mDisplayCalls && LLMemory::allocProfiling())
+		{
+			// Cycle through time, calls and allocations display
+			mDisplayCalls = 0;
+			mDisplayAllocs = 1;
+		}
+		else if (mDisplayAllocs)
+		{
+			mDisplayAllocs = 0;
+		}
 		else
 		{
 			mDisplayCalls = !mDisplayCalls;
@@ -819,6 +830,24 @@ void LLFastTimerView::draw()
 				  LLFontGL::TOP);
 	y -= texth + 2;
 
+	if (mDisplayAllocs)
+	{
+		// Last frame allocations per memory tag (for all threads)
+		std::string tags = "Last frame:";
+		U64 frame_count, frame_bytes, total_count, total_bytes;
+		for (U32 tag = 0; tag < LL_ALLOC_NUM_TAGS; ++tag)
+		{
+			LLMemory::getAllocStats(tag, frame_count, frame_bytes,
+									total_count, total_bytes);
+			tags += llformat(" %s {%llu, %.1fKB}",
+							 LLMemory::getAllocTagName(tag), frame_count,
+							 (F32)frame_bytes / 1024.f);
+		}
+		mFont->renderUTF8(tags, 0, x, y, LLColor4::white, LLFontGL::LEFT,
+						  LLFontGL::TOP);
+		y -= texth + 2;
+	}
+
 	// Calc the total ticks
 
 	S32 histmax = llmin(LLFastTimer::sLastFrameIndex + 1, MAX_VISIBLE_HISTORY);
@@ -908,6 +937,8 @@ void LLFastTimerView::draw()
 		S32 tidx = ft_display_table[i].timer;
 		F32 ms = 0;
 		S32 calls = 0;
+		U64 allocs = 0;
+		U64 alloc_bytes = 0;
 		if (mHoverBarIndex > 0 && mHoverIndex >= 0)
 		{
 			S32 hidx = (LLFastTimer::sLastFrameIndex + mHoverBarIndex - 1 -
@@ -916,14 +947,23 @@ void LLFastTimerView::draw()
 			U64 ticks = ticks_sum[bidx + 1][i];
 			ms = (F32)((F64)ticks * iclock_freq);
 			calls = (S32)LLFastTimer::sCallHistory[hidx][tidx];
+			allocs = LLFastTimer::sAllocHistory[hidx][tidx];
+			alloc_bytes = LLFastTimer::sAllocBytesHistory[hidx][tidx];
 		}
 		else
 		{
 			U64 ticks = ticks_sum[0][i];
 			ms = (F32)((F64)ticks * iclock_freq);
 			calls = (S32)LLFastTimer::sCallAverage[tidx];
+			allocs = LLFastTimer::sAllocAverage[tidx];
+			alloc_bytes = LLFastTimer::sAllocBytesAverage[tidx];
+		}
+		if (mDisplayAllocs)
+		{
+			line = llformat("%s {%llu, %.1fKB}", ft_display_table[i].desc,
+							allocs, (F32)alloc_bytes / 1024.f);
 		}
-		if (mDisplayCalls)
+		else if (mDisplayCalls)
 		{
 			line = llformat("%s (%d)", ft_display_table[i].desc, calls);
 		}
@@ -1558,6 +1598,60 @@ F64 LLFastTimerView::getTime(LLFastTimer::EFastTimerType tidx)
 	return (F64)ticks / (F64)LLFastTimer::countsPerSecond();
 }
 
+//static
+bool LLFastTimerView::dumpAllocations(const std::string& filename)
+{
+	std::string csv = "frame,timer,allocations,bytes\n";
+
+	// Per-frame and per-timer allocations, for the frames in history, from
+	// the oldest to the newest.
+	S32 last = LLFastTimer::sLastFrameIndex;
+	S32 frames = llmin(last + 1, FTM_HISTORY_NUM);
+	for (S32 frame = last - frames + 1; frame <= last; ++frame)
+	{
+		S32 hidx = frame % FTM_HISTORY_NUM;
+		for (S32 i = 0; i < FTV_DISPLAY_NUM; ++i)
+		{
+			S32 tidx = ft_display_table[i].timer;
+			U64 allocs = LLFastTimer::sAllocHistory[hidx][tidx];
+			if (allocs)
+			{
+				std::string desc = ft_display_table[i].desc;
+				LLStringUtil::trim(desc);
+				csv += llformat("%d,\"%s\",%llu,%llu\n", frame, desc.c_str(),
+								allocs,
+								LLFastTimer::sAllocBytesHistory[hidx][tidx]);
+			}
+		}
+	}
+
+	// Per memory tag last frame and total (since profiling was enabled) counts
+	// for all threads.
+	U64 frame_count, frame_bytes, total_count, total_bytes;
+	for (U32 tag = 0; tag < LL_ALLOC_NUM_TAGS; ++tag)
+	{
+		LLMemory::getAllocStats(tag, frame_count, frame_bytes, total_count,
+								total_bytes);
+		csv += llformat("last,\"%s\",%llu,%llu\n",
+						LLMemory::getAllocTagName(tag), frame_count,
+						frame_bytes);
+		csv += llformat("total,\"%s\",%llu,%llu\n",
+						LLMemory::getAllocTagName(tag), total_count,
+						total_bytes);
+	}
+
+	LLFile outfile(filename, "wb");
+	S64 size = csv.size();
+	if (outfile.write((const U8*)csv.data(), size) != size)
+	{
+		llwarns << "Failed to write allocations profile to: " << filename
+				<< llendl;
+		return false;
+	}
+	llinfos << "Allocations profile written to: " << filename << llendl;
+	return true;
+}
+
 #endif	// LL_FAST_TIMERS_ENABLED
 
 #if TRACY_ENABLE
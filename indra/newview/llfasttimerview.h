@@ -65,6 +65,11 @@ public:
 	S32 getLegendIndex(S32 y);
 	F64 getTime(LLFastTimer::EFastTimerType tidx);
 
+	// Writes the allocations profiler statistics (per fast timer and per
+	// frame, for the frames in history, plus per memory tag totals) as a CSV
+	// file. Returns false on failure.
+	static bool dumpAllocations(const std::string& filename);
+
 private:
 	void resize();
 	void setDisplayModeText();
@@ -84,6 +89,7 @@ private:
 	S32				mDisplayMode;
 	S32				mDisplayCenter;
 	S32				mDisplayCalls;
+	S32				mDisplayAllocs;
 	S32				mDisplayHz;
 	S32				mScrollIndex;
 	S32				mHoverIndex;
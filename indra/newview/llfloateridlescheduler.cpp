@@ -0,0 +1,137 @@
+/**
+ * @file llfloateridlescheduler.cpp
+ * @brief The LLFloaterIdleScheduler class definition
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llfloateridlescheduler.h"
+
+#include "llscrolllistctrl.h"
+#include "lltextbox.h"
+#include "lluictrlfactory.h"
+
+#include "llidlescheduler.h"
+
+LLFloaterIdleScheduler::LLFloaterIdleScheduler(const LLSD&)
+:	mTasksList(NULL),
+	mBudgetText(NULL)
+{
+	LLUICtrlFactory::getInstance()->buildFloater(this,
+												 "floater_idle_scheduler.xml");
+}
+
+//virtual
+bool LLFloaterIdleScheduler::postBuild()
+{
+	mTasksList = getChild<LLScrollListCtrl>("tasks_list");
+	mBudgetText = getChild<LLTextBox>("budget_text");
+	refresh();
+	return true;
+}
+
+//virtual
+void LLFloaterIdleScheduler::draw()
+{
+	// Refreshing at every frame would be pointless (unreadable) and costly.
+	if (mRefreshTimer.getElapsedTimeF32() > 0.5f)
+	{
+		refresh();
+	}
+
+	LLFloater::draw();
+}
+
+//virtual
+void LLFloaterIdleScheduler::refresh()
+{
+	mRefreshTimer.reset();
+
+	mBudgetText->setTextArg("[BUDGET]",
+							llformat("%.2f",
+									 gIdleScheduler.getBudget() * 1000.0));
+	mBudgetText->setTextArg("[USED]",
+							llformat("%.2f",
+									 gIdleScheduler.getLastUsedTime() *
+									 1000.0));
+	mBudgetText->setTextArg("[DEFERRED]",
+							llformat("%u", gIdleScheduler.getLastDeferred()));
+
+	S32 scrollpos = mTasksList->getScrollPos();
+	mTasksList->deleteAllItems();
+
+	const LLIdleScheduler::tasks_vec_t& tasks = gIdleScheduler.getTasks();
+	for (U32 i = 0, count = tasks.size(); i < count; ++i)
+	{
+		const LLIdleScheduler::Task& task = tasks[i];
+
+		LLSD element;
+		element["id"] = LLSD::Integer(i);
+
+		LLSD& name_column = element["columns"][0];
+		name_column["column"] = "name";
+		name_column["value"] = task.mName;
+		if (!task.mRanLastFrame)
+		{
+			// Show tasks deferred at last frame in italics
+			name_column["font-style"] = "ITALIC";
+		}
+
+		LLSD& prio_column = element["columns"][1];
+		prio_column["column"] = "priority";
+		prio_column["value"] =
+			LLIdleScheduler::getPriorityName(task.mPriority);
+
+		LLSD& avg_column = element["columns"][2];
+		avg_column["column"] = "average";
+		avg_column["value"] = llformat("%.3f", task.mAverageCost * 1000.0);
+
+		LLSD& last_column = element["columns"][3];
+		last_column["column"] = "last";
+		last_column["value"] = llformat("%.3f", task.mLastCost * 1000.0);
+
+		LLSD& runs_column = element["columns"][4];
+		runs_column["column"] = "runs";
+		runs_column["value"] = llformat("%u", task.mRuns);
+
+		LLSD& deferred_column = element["columns"][5];
+		deferred_column["column"] = "deferred";
+		deferred_column["value"] = llformat("%u", task.mDeferrals);
+
+		LLSD& max_column = element["columns"][6];
+		max_column["column"] = "max_skip";
+		max_column["value"] = llformat("%u", task.mMaxSkippedFrames);
+
+		mTasksList->addElement(element);
+	}
+
+	mTasksList->setScrollPos(scrollpos);
+}
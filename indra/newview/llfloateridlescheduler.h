@@ -0,0 +1,70 @@
+/**
+ * @file llfloateridlescheduler.h
+ * @brief The LLFloaterIdleScheduler class declaration
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLFLOATERIDLESCHEDULER_H
+#define LL_LLFLOATERIDLESCHEDULER_H
+
+#include "llfloater.h"
+#include "lltimer.h"
+
+class LLScrollListCtrl;
+class LLTextBox;
+
+// Debug floater showing the idle scheduler budget and tasks statistics.
+
+class LLFloaterIdleScheduler final
+:	public LLFloater, public LLFloaterSingleton<LLFloaterIdleScheduler>
+{
+	friend class LLUISingleton<LLFloaterIdleScheduler,
+							   VisibilityPolicy<LLFloater> >;
+
+protected:
+	LOG_CLASS(LLFloaterIdleScheduler);
+
+private:
+	// Open only via LLFloaterSingleton interface, i.e. showInstance() or
+	// toggleInstance().
+	LLFloaterIdleScheduler(const LLSD&);
+
+	bool postBuild() override;
+	void draw() override;
+
+	void refresh() override;
+
+private:
+	LLScrollListCtrl*	mTasksList;
+	LLTextBox*			mBudgetText;
+	LLFrameTimer		mRefreshTimer;
+};
+
+#endif	// LL_LLFLOATERIDLESCHEDULER_H
@@ -38,6 +38,7 @@
 #include "llfloatermodelpreview.h"
 
 #include "llanimationstates.h"
+#include "llapp.h"
 #include "llbutton.h"
 #include "llcallbacklist.h"
 #include "llcheckboxctrl.h"
@@ -51,7 +52,7 @@
 #include "llimagegl.h"
 #include "lljoint.h"
 #include "llmatrix4a.h"
-#include "llmeshoptimizer.h"
+#include "llmodelsimplifier.h"
 #include "llnotifications.h"
 #include "llrender.h"
 #include "llscrolllistctrl.h"
@@ -63,11 +64,13 @@
 #include "lltextbox.h"
 #include "lltexteditor.h"
 #include "lluictrlfactory.h"
+#include "llworkqueue.h"
 
 // Do not move upwards because conflicting definitions in that header !
 #include "glod/glod.h"
 
 #include "llagent.h"
+#include "llappviewer.h"		// For gMainloopWorkp
 #include "lldrawable.h"
 #include "llface.h"
 #include "llgridmanager.h"
@@ -468,6 +471,10 @@ bool LLFloaterModelPreview::postBuild()
 	childSetAction("reset_btn", onReset, this);
 	childSetAction("cancel_btn", onCancel, this);
 
+	mCancelLODsBtn = getChild<LLButton>("cancel_lods_btn");
+	mCancelLODsBtn->setClickedCallback(onCancelLODs, this);
+	mCancelLODsBtn->setVisible(false);
+
 	childSetCommitCallback("preview_lod_combo", onPreviewLODCommit, this);
 
 	childSetCommitCallback("upload_skin", onUploadSkinCommit, this);
@@ -915,6 +922,8 @@ void LLFloaterModelPreview::draw()
 
 	mModelPreview->update();
 
+	mCancelLODsBtn->setVisible(mModelPreview->hasPendingLODJobs());
+
 	if (!mModelPreview->mLoading)
 	{
 		if (mSentFeeRequest)
@@ -927,6 +936,15 @@ void LLFloaterModelPreview::draw()
 			childSetTextArg("status", "[STATUS]",
 							getString("status_uploading"));
 		}
+		else if (mModelPreview->hasPendingLODJobs())
+		{
+			U32 total;
+			U32 pending = mModelPreview->getLODJobsProgress(total);
+			LLUIString msg = getString("status_generating_lods");
+			msg.setArg("[DONE]", llformat("%d", total - pending));
+			msg.setArg("[TOTAL]", llformat("%d", total));
+			childSetTextArg("status", "[STATUS]", msg.getString());
+		}
 		else if (mModelPreview->mLoadState == LLModelLoader::ERROR_MATERIALS)
 		{
 			childSetTextArg("status", "[STATUS]",
@@ -1271,6 +1289,18 @@ void LLFloaterModelPreview::onCancel(void* userdata)
 	}
 }
 
+//static
+void LLFloaterModelPreview::onCancelLODs(void* userdata)
+{
+	LLFloaterModelPreview* self = (LLFloaterModelPreview*)userdata;
+	if (self && self->mModelPreview)
+	{
+		self->mModelPreview->cancelLODJobs();
+		self->addLineToLog("LODs generation cancelled.");
+		self->mModelPreview->refresh();
+	}
+}
+
 //static
 void LLFloaterModelPreview::onPhysicsStageCancel(void* userdata)
 {
@@ -2250,7 +2280,8 @@ bool LLFloaterModelPreview::isModelUploadAllowed()
 	bool allow_upload = mHasUploadPerm && !mUploadModelUrl.empty();
 	if (mModelPreview)
 	{
-		allow_upload &= mModelPreview->mModelNoErrors;
+		allow_upload &= mModelPreview->mModelNoErrors &&
+						!mModelPreview->hasPendingLODJobs();
 	}
 	LL_DEBUGS("MeshUpload") << "mHasUploadPerm = " << mHasUploadPerm
 							<< " - mUploadModelUrl = " << mUploadModelUrl
@@ -2324,6 +2355,9 @@ void LLFloaterModelPreview::DecompRequest::completed()
 // LLModelPreview
 //-----------------------------------------------------------------------------
 
+//static
+std::vector<LLModelPreview::retired_t> LLModelPreview::sRetiredBaseModels;
+
 LLModelPreview::LLModelPreview(S32 width, S32 height,
 							   LLFloaterModelPreview* fmp)
 :	LLViewerDynamicTexture(width, height, 3, ORDER_MIDDLE, false),
@@ -2358,6 +2392,8 @@ LLModelPreview::LLModelPreview(S32 width, S32 height,
 	mLastJointUpdate(false),
 	mHasDegenerate(false),
 	mWarnPhysModel(false),
+	mLODJobsCtx(std::make_shared<LODJobsContext>()),
+	mDeferredNormalsOp(NORMALS_NONE),
 	mImporterDebug(LLCachedControl<bool>(gSavedSettings, "MeshImporterDebug"))
 {
 	for (U32 i = 0; i < LLModel::NUM_LODS; ++i)
@@ -2381,6 +2417,9 @@ LLModelPreview::LLModelPreview(S32 width, S32 height,
 
 LLModelPreview::~LLModelPreview()
 {
+	// The jobs still running on the threads pool are reading our base models.
+	retireBaseModels();
+
 	if (mModelLoader)
 	{
 		mModelLoader->shutdown();
@@ -3060,6 +3099,10 @@ void LLModelPreview::clearModel(S32 lod)
 {
 	if (lod >= 0 && lod <= LLModel::LOD_PHYSICS)
 	{
+		if (lod < LLModel::NUM_LODS)
+		{
+			cancelLODJobs(lod);
+		}
 		mVertexBuffer[lod].clear();
 		mModel[lod].clear();
 		mScene[lod].clear();
@@ -3282,6 +3325,15 @@ void LLModelPreview::clearIncompatible(S32 lod)
 		{
 			if (countRootModels(mModel[i]) != lod_size)
 			{
+				if (i == LLModel::LOD_HIGH)
+				{
+					// Base models are about to be replaced.
+					retireBaseModels();
+				}
+				else
+				{
+					cancelLODJobs(i);
+				}
 				mModel[i].clear();
 				mScene[i].clear();
 				mVertexBuffer[i].clear();
@@ -3387,6 +3439,17 @@ void LLModelPreview::loadModelCallback(S32 lod)
 	mLodsWithParsingError.erase(std::remove(mLodsWithParsingError.begin(),
 											mLodsWithParsingError.end(), lod),
 								mLodsWithParsingError.end());
+
+	// The loaded models replace any LOD still being generated, and the base
+	// models may get replaced as well.
+	if (lod == -1 || lod == LLModel::LOD_HIGH)
+	{
+		retireBaseModels();
+	}
+	else
+	{
+		cancelLODJobs(lod);
+	}
 	if (mLodsWithParsingError.empty())
 	{
 		mFMP->mCalculateBtn->setEnabled(true);
@@ -3674,6 +3737,16 @@ void LLModelPreview::generateNormals()
 		return;
 	}
 
+	// We may modify the base models faces, which must not happen while LOD
+	// generation jobs are reading them: do it once they are done.
+	if (which_lod == LLModel::LOD_HIGH && !mBaseModel.empty() &&
+		baseModelsInUse())
+	{
+		mDeferredNormalsOp = NORMALS_GENERATE;
+		return;
+	}
+	mDeferredNormalsOp = NORMALS_NONE;
+
 	F32 angle_cutoff = mFMP->childGetValue("crease_angle").asReal();
 	mRequestedCreaseAngle[which_lod] = angle_cutoff;
 	angle_cutoff *= DEG_TO_RAD;
@@ -3737,10 +3810,20 @@ void LLModelPreview::restoreNormals()
 		return;
 	}
 
+	mDeferredNormalsOp = NORMALS_NONE;
+
 	if (!mBaseModelFacesCopy.empty())
 	{
 		llassert(mBaseModelFacesCopy.size() == mBaseModel.size());
 
+		// Do not modify the base models faces while LOD generation jobs are
+		// reading them: do it once they are done.
+		if (baseModelsInUse())
+		{
+			mDeferredNormalsOp = NORMALS_RESTORE;
+			return;
+		}
+
 		vv_LLVolumeFace_t::const_iterator itf = mBaseModelFacesCopy.begin();
 		for (LLModelLoader::model_list::iterator it = mBaseModel.begin(),
 												 end = mBaseModel.end();
@@ -3875,6 +3958,13 @@ bool LLModelPreview::genGlodLODs(S32 which_lod, U32 decimation,
 		return true; // Do not try the meshoptimizer method !
 	}
 
+	// The GLOD-generated models supersede any pending meshoptimizer job for
+	// the same LOD(s).
+	if (which_lod >= -1 && which_lod < LLModel::NUM_LODS)
+	{
+		cancelLODJobs(which_lod);
+	}
+
 	llinfos << "Generating lod " << which_lod << " using GLOD." << llendl;
 
 	// Allow LoD from -1 to LLModel::LOD_PHYSICS
@@ -4366,426 +4456,6 @@ bool LLModelPreview::genGlodLODs(S32 which_lod, U32 decimation,
 	return true;
 }
 
-F32 LLModelPreview::genMeshOptimizerPerModel(LLModel* base_model,
-											 LLModel* target_model,
-											 F32 indices_decim,
-											 F32 error_threshold,
-											 S32 simplification_mode)
-{
-	U32 num_vol_faces = base_model->getNumVolumeFaces();
-
-	// Figure out buffer size
-	S32 size_indices = 0;
-	S32 size_vertices = 0;
-	for (U32 i = 0; i < num_vol_faces; ++i)
-	{
-		const LLVolumeFace& face = base_model->getVolumeFace(i);
-		size_indices += face.mNumIndices;
-		size_vertices += face.mNumVertices;
-	}
-
-	if (size_indices < 3)
-	{
-		return -1.f;
-	}
-
-	// Allocate buffers; note that we are using U32 buffer instead of U16.
-	size_t indices_bytes = size_indices * sizeof(U32);
-	U32* output_indices = (U32*)allocate_volume_mem(indices_bytes);
-	U32* combined_indices = (U32*)allocate_volume_mem(indices_bytes);
-
-	// Extra space for normals and text coords
-	S32 tc_bytes_size = (size_vertices * sizeof(LLVector2) + 0xF) & ~0xF;
-	LLVector4a* combined_positions =
-		(LLVector4a*)allocate_volume_mem_64(sizeof(LLVector4a) * 3 *
-											size_vertices +	tc_bytes_size);
-	LLVector4a* combined_normals = combined_positions + size_vertices;
-	LLVector2* combined_tex_coords = (LLVector2*)(combined_normals +
-												  size_vertices);
-
-	// Copy indices and vertices into new buffers
-	S32 combined_positions_shift = 0;
-	S32 indices_idx_shift = 0;
-	S32 combined_indices_shift = 0;
-	for (U32 i = 0; i < num_vol_faces; ++i)
-	{
-		const LLVolumeFace& face = base_model->getVolumeFace(i);
-
-		// Vertices
-		S32 copy_bytes = face.mNumVertices * sizeof(LLVector4a);
-		LLVector4a::memcpyNonAliased16((F32*)(combined_positions +
-											  combined_positions_shift),
-									   (F32*)face.mPositions, copy_bytes);
-
-		// Normals
-		LLVector4a::memcpyNonAliased16((F32*)(combined_normals +
-											  combined_positions_shift),
-									   (F32*)face.mNormals, copy_bytes);
-
-		// Texture coords
-		copy_bytes = face.mNumVertices * sizeof(LLVector2);
-		memcpy((void*)(combined_tex_coords + combined_positions_shift),
-			   (void*)face.mTexCoords, copy_bytes);
-
-		combined_positions_shift += face.mNumVertices;
-
-		// Sadly, indices cannot use a simple memcpy; we need to adjust each
-		// value...
-		for (U32 j = 0, count = face.mNumIndices; j < count; ++j)
-		{
-			combined_indices[combined_indices_shift++] = face.mIndices[j] +
-														 indices_idx_shift;
-		}
-
-		indices_idx_shift += face.mNumVertices;
-	}
-
-	// Generate a shadow buffer if necessary. Welds vertices together if
-	// possible.
-	U32* shadow_indices = NULL;
-	// If MESH_OPTIMIZER_FULL, just leave as is, since model was remaped on a
-	// per face basis. Similar for MESH_OPTIMIZER_NO_TOPOLOGY, it is pointless
-	// since sloppy simplification ignores all topology, including normals and
-	// UVs (which can be significantly affected).
-	if (simplification_mode == MESH_OPTIMIZER_NO_NORMALS)
-	{
-		// Strip normals, reflections should restore relatively correctly.
-		shadow_indices = (U32*)allocate_volume_mem(indices_bytes);
-		LLMeshOptimizer::generateShadowIndexBuffer32(shadow_indices,
-													 combined_indices,
-													 size_indices,
-													 combined_positions, NULL,
-													 combined_tex_coords,
-													 size_vertices);
-	}
-	else if (simplification_mode == MESH_OPTIMIZER_NO_UVS)
-	{
-		// Strip UVs, which can heavily affect textures
-		shadow_indices = (U32*)allocate_volume_mem(indices_bytes);
-		LLMeshOptimizer::generateShadowIndexBuffer32(shadow_indices,
-												     combined_indices,
-												     size_indices,
-												     combined_positions,
-												     NULL, NULL,
-													 size_vertices);
-	}
-	U32* source_indices = shadow_indices ? shadow_indices : combined_indices;
-
-	//  Now that we have buffers, optimize
-
-	// How far from original the model is, 1.f == 100%
-	F32 result_code = 0.f;
-
-	S32 target_indices;
-	if (indices_decim > 0.f)
-	{
-		// Leave at least one triangle
-		target_indices = llmax(3, llfloor(size_indices / indices_decim));
-	}
-	else
-	{
-		// Indices_decimator can be zero for error_threshold based calculations
-		target_indices = 3;
-	}
-
-	S32 type_size = LLVertexBuffer::sTypeSize[LLVertexBuffer::TYPE_VERTEX];
-	bool sloppy = simplification_mode == MESH_OPTIMIZER_NO_TOPOLOGY;
-	S32 new_indices = LLMeshOptimizer::simplify32(output_indices,
-												  source_indices,
-												  size_indices,
-												  combined_positions,
-												  size_vertices, type_size,
-												  target_indices,
-												  error_threshold, sloppy,
-												  &result_code);
-	if (result_code < 0)
-	{
-		llwarns << "Negative result code from meshoptimizer for model: "
-				<< target_model->mLabel << " - Target indices: "
-				<< target_indices << " - New indices: " << new_indices
-				<< " - Original count: " << size_indices << llendl;
-	}
-
-	// Free unused buffers
-	free_volume_mem(combined_indices);
-	free_volume_mem(shadow_indices);
-	combined_indices = shadow_indices = NULL;
-
-	if (new_indices < 3)
-	{
-		// Model should have at least one visible triangle
-		free_volume_mem(output_indices);
-		free_volume_mem_64(combined_positions);
-		return -1.f;
-	}
-
-	// Repack back into individual faces
-
-	LLVector4a* buffer_positions =
-		(LLVector4a*)allocate_volume_mem_64(sizeof(LLVector4a) * 3 *
-											size_vertices + tc_bytes_size);
-	LLVector4a* buffer_normals = buffer_positions + size_vertices;
-	LLVector2* buffer_tex_coords = (LLVector2*)(buffer_normals +
-												size_vertices);
-	size_t buffer_idx_size = (size_indices * sizeof(U16) + 0xF) & ~0xF;
-	U16* buffer_indices = (U16*)allocate_volume_mem(buffer_idx_size);
-	S32* old_to_new_positions_map = new S32[size_vertices];
-
-	indices_idx_shift = 0;
-	U32 valid_faces = 0;
-
-	// Crude method to copy indices back into face
-	for (U32 i = 0; i < num_vol_faces; ++i)
-	{
-		const LLVolumeFace& face = base_model->getVolumeFace(i);
-
-		S32 range = indices_idx_shift + face.mNumVertices;
-		S32 buf_positions_copied = 0;
-		S32 buf_indices_copied = 0;
-		bool copy_triangle = false;
-
-		for (S32 j = 0; j < size_vertices; ++j)
-		{
-			old_to_new_positions_map[j] = -1;
-		}
-
-		// Copy relevant indices and vertices
-		for (S32 j = 0; j < new_indices; ++j)
-		{
-			U32 idx = output_indices[j];
-			if (j % 3 == 0)
-			{
-				copy_triangle = idx >= (U32)indices_idx_shift &&
-								idx < (U32)range;
-			}
-			if (!copy_triangle)
-			{
-				continue;
-			}
-			// If it is a new position, we need to copy it
-			if (old_to_new_positions_map[idx] == -1)
-			{
-				// Validate size
-				if (buf_positions_copied >= (S32)U16_MAX)
-				{
-					llwarns << "Over triangle limit. Failed to optimize in 'per object' mode, falling back to per face variant for model: "
-							<< target_model->mLabel << " - Target indices: "
-							<< target_indices << " - New indices: "
-							<< new_indices << " - Original count: "
-							<< size_indices << " - Error threshold: "
-							<< error_threshold << llendl;
-					// Abort as cleanly as possible (i.e. properly release
-					// temp buffers, unlike what happens in LL's code). HB
-					new_indices = -1;	// Forces a 'return -1;' at the end.
-					// This will force a clean exit from the outer loop. HB
-					buf_positions_copied = U16_MAX;
-					break;
-				}
-
-				// Copy everything
-				buffer_positions[buf_positions_copied] =
-					combined_positions[idx];
-				buffer_normals[buf_positions_copied] = combined_normals[idx];
-				buffer_tex_coords[buf_positions_copied] =
-					combined_tex_coords[idx];
-
-				old_to_new_positions_map[idx] = buf_positions_copied;
-				buffer_indices[buf_indices_copied++] = buf_positions_copied++;
-			}
-			else	// Existing position
-			{
-				buffer_indices[buf_indices_copied++] =
-					old_to_new_positions_map[idx];
-			}
-		}
-
-		if (buf_positions_copied >= U16_MAX)
-		{
-			break;
-		}
-
-		LLVolumeFace& new_face = target_model->getVolumeFace(i);
-
-		if (buf_indices_copied < 3)
-		{
-			// Face was optimized away
-			new_face.resizeIndices(3);
-			new_face.resizeVertices(1);
-			memset((void*)new_face.mIndices, 0, sizeof(U16) * 3);
-			new_face.mPositions[0].clear(); // Set first vertice to 0
-			new_face.mNormals[0].clear();
-			new_face.mTexCoords[0].clear();
-		}
-		else
-		{
-			new_face.resizeIndices(buf_indices_copied);
-			new_face.resizeVertices(buf_positions_copied);
-			new_face.allocateTangents(buf_positions_copied);
-
-			S32 idx_size = (buf_indices_copied * sizeof(U16) + 0xF) & ~0xF;
-			LLVector4a::memcpyNonAliased16((F32*)new_face.mIndices,
-										   (F32*)buffer_indices, idx_size);
-
-			S32 vert_size = buf_positions_copied * sizeof(LLVector4a);
-			LLVector4a::memcpyNonAliased16((F32*)new_face.mPositions,
-										   (F32*)buffer_positions, vert_size);
-			LLVector4a::memcpyNonAliased16((F32*)new_face.mNormals,
-										   (F32*)buffer_normals, vert_size);
-
-			U32 tex_size = (buf_positions_copied * sizeof(LLVector2) +
-							0xF) & ~0xF;
-			LLVector4a::memcpyNonAliased16((F32*)new_face.mTexCoords,
-										   (F32*)buffer_tex_coords, tex_size);
-			++valid_faces;
-		}
-
-		indices_idx_shift += face.mNumVertices;
-	}
-
-	delete[] old_to_new_positions_map;
-	free_volume_mem(output_indices);
-	free_volume_mem_64(combined_positions);
-	free_volume_mem_64(buffer_positions);
-	free_volume_mem(buffer_indices);
-
-	if (new_indices < 3 || !valid_faces)
-	{
-		// Model should have at least one visible triangle
-		if (!sloppy)
-		{
-			// Should only happen with sloppy; non sloppy should not be capable
-			// of optimizing mesh away.
-			llwarns << "Failed to generate triangles for model: "
-					<< target_model->mLabel << " - Target Indices: "
-					<< target_indices << " - Original count: " << size_indices
-					<< " - Error treshold: " << error_threshold << llendl;
-		}
-		return -1.f;
-	}
-
-	return (F32)size_indices / (F32)new_indices;
-}
-
-F32 LLModelPreview::genMeshOptimizerPerFace(LLModel* base_model,
-											LLModel* target_model,
-											U32 face_idx, F32 indices_ratio,
-											F32 err_threshold,
-											S32 simplification_mode)
-{
-	const LLVolumeFace& face = base_model->getVolumeFace(face_idx);
-	S32 size_indices = face.mNumIndices;
-	if (size_indices < 3)
-	{
-		return -1.f;
-	}
-
-	size_t size = (size_indices * sizeof(U16) + 0xF) & ~0xF;
-	U16* output = (U16*)allocate_volume_mem(size);
-
-	// Generate a shadow buffer if necessary. Welds vertices together if
-	// possible.
-	U16* shadow_indices = NULL;
-	// If MESH_OPTIMIZER_FULL, just leave as is, since model was remaped on a
-	// per face basis. Similar for MESH_OPTIMIZER_NO_TOPOLOGY, it is pointless
-	// since sloppy simplification ignores all topology, including normals and
-	// UVs (which can be significantly affected).
-	if (simplification_mode == MESH_OPTIMIZER_NO_NORMALS)
-	{
-		// Strip normals, reflections should restore relatively correctly.
-		shadow_indices = (U16*)allocate_volume_mem(size);
-		LLMeshOptimizer::generateShadowIndexBuffer16(shadow_indices,
-													 face.mIndices,
-													 size_indices,
-													 face.mPositions, NULL,
-													 face.mTexCoords,
-													 face.mNumVertices);
-	}
-	else if (simplification_mode == MESH_OPTIMIZER_NO_UVS)
-	{
-		// Strip UVs, which can heavily affect textures
-		shadow_indices = (U16*)allocate_volume_mem(size);
-		LLMeshOptimizer::generateShadowIndexBuffer16(shadow_indices,
-													 face.mIndices,
-													 size_indices,
-													 face.mPositions, NULL,
-													 NULL, face.mNumVertices);
-	}
-	U16* source_indices = shadow_indices ? shadow_indices : face.mIndices;
-
-	// How far from original the model is, with 1.f == 100%.
-	F32 result_code = 0.f;
-	S32 target_indices;
-	if (indices_ratio > 0.f)
-	{
-		// Leave at least one triangle
-		target_indices = llmax(3, llfloor(size_indices / indices_ratio));
-	}
-	else
-	{
-		target_indices = 3;
-	}
-	S32 type_size = LLVertexBuffer::sTypeSize[LLVertexBuffer::TYPE_VERTEX];
-	bool sloppy = simplification_mode == MESH_OPTIMIZER_NO_TOPOLOGY;
-	S32 new_indices = LLMeshOptimizer::simplify16(output, source_indices,
-												  size_indices,
-												  face.mPositions,
-												  face.mNumVertices, type_size,
-												  target_indices,
-												  err_threshold, sloppy,
-												  &result_code);
-	if (result_code < 0)
-	{
-		llwarns << "Negative result code from meshoptimizer for face "
-				<< face_idx << " of model: " << target_model->mLabel
-				<< " - Target indices: " << target_indices
-				<< " - New indices: " << new_indices << " - Original count: "
-				<< size_indices << " - Error treshold: " << err_threshold
-				<< llendl;
-	}
-
-	LLVolumeFace& new_face = target_model->getVolumeFace(face_idx);
-	new_face = face;  // Copy old values
-
-	if (new_indices < 3)
-	{
-		if (!sloppy)
-		{
-			// meshopt_optimizeSloppy() can optimize triangles away even if
-			// target_indices is > 2, but optimize() is not supposed to...
-			std::ostringstream out;
-			out << "No indices generated by meshoptimizer for face "
-				<< face_idx << " of model: " << target_model->mLabel
-				<< " - Target indices: " << target_indices
-				<< " - Original count: " << size_indices
-				<< " - Error treshold: " << err_threshold;
-			llinfos << out.str() << llendl;
-			mFMP->addLineToLog(out.str());
-			// Face got optimized away; generate an empty triangle.
-			new_face.resizeIndices(3);
-			new_face.resizeVertices(1);
-			memset((void*)new_face.mIndices, 0, sizeof(U16) * 3);
-			new_face.mPositions[0].clear();
-			new_face.mNormals[0].clear();
-			new_face.mTexCoords[0].clear();
-		}
-	}
-	else	// Assign new values
-	{
-		// Wipes out mIndices, so new_face cannot substitute output
-		new_face.resizeIndices(new_indices);
-		S32 idx_size = (new_indices * sizeof(U16) + 0xF) & ~0xF;
-		LLVector4a::memcpyNonAliased16((F32*)new_face.mIndices, (F32*)output,
-									   idx_size);
-		// Clear unused values
-		new_face.optimize();
-	}
-
-	free_volume_mem(output);
-	free_volume_mem(shadow_indices);
-
-	return new_indices < 3 ? -1.f : (F32)size_indices / (F32)new_indices;
-}
-
 void LLModelPreview::genMeshOptimizerLODs(S32 which_lod, S32 meshopt_mode,
 										  U32 decimation, bool with_tri_limit)
 {
@@ -4809,6 +4479,9 @@ void LLModelPreview::genMeshOptimizerLODs(S32 which_lod, S32 meshopt_mode,
 		return;
 	}
 
+	// Any batch still pending for the LOD(s) to generate is now obsolete.
+	cancelLODJobs(which_lod);
+
 	if (mBaseModel.empty())
 	{
 		return;
@@ -4872,19 +4545,17 @@ void LLModelPreview::genMeshOptimizerLODs(S32 which_lod, S32 meshopt_mode,
 
 	mMaxTriangleLimit = base_triangle_count;
 
-	LLGLSLShader* shader = LLGLSLShader::sCurBoundShaderPtr;
-	if (shader)
-	{
-		shader->unbind();
-	}
+	static LLWorkQueue::weak_t general_queue =
+		LLWorkQueue::getNamedInstance("General");
 
-	// Build models
+	// Queue one job per model and per LOD
 	S32 start = LLModel::LOD_HIGH;
 	S32 end = 0;
 	if (which_lod != -1)
 	{
 		start = end = which_lod;
 	}
+	U32 models_count = mBaseModel.size();
 	for (S32 lod = start; lod >= end; --lod)
 	{
 		if (which_lod == -1)
@@ -4898,227 +4569,242 @@ void LLModelPreview::genMeshOptimizerLODs(S32 which_lod, S32 meshopt_mode,
 		mRequestedErrorThreshold[lod] = lod_err_thres * 100.f;
 		mRequestedLoDMode[lod] = lod_mode;
 
-		mModel[lod].clear();
-		mModel[lod].resize(mBaseModel.size());
-		mVertexBuffer[lod].clear();
+		lod_ctx_ptr_t ctx = mLODJobsCtx;
+		U32 gen = ctx->mGeneration[lod].get();
+		lod_batch_ptr_t batch(new LODJobsBatch(lod, models_count, gen));
+		mLODJobs[lod] = batch;
 
-		constexpr F32 allowed_ratio_drift = 1.8f;
-
-		for (U32 mdl_idx = 0; mdl_idx < mBaseModel.size(); ++mdl_idx)
+		for (U32 mdl_idx = 0; mdl_idx < models_count; ++mdl_idx)
 		{
+			// Note: the base models are kept alive and unchanged by the main
+			// thread for as long as the jobs of their context are in flight
+			// (see retireBaseModels() and baseModelsInUse()), so we can
+			// safely pass raw pointers to the worker.
 			LLModel* base = mBaseModel[mdl_idx];
+			++ctx->mInFlight;
+			if (!gMainloopWorkp ||
+				!gMainloopWorkp->postTo(general_queue,
+										// Work done on general queue
+										[ctx, base, mdl_idx, lod, gen,
+										 meshopt_mode, lod_mode,
+										 indices_decim, lod_err_thres]()
+										{
+											LODJobResult result;
+											result.mIndex = mdl_idx;
+											// Skip cancelled jobs
+											if (ctx->mGeneration[lod].get() ==
+													gen)
+											{
+												simplifyModel(base, lod,
+															  meshopt_mode,
+															  lod_mode,
+															  indices_decim,
+															  lod_err_thres,
+															  result);
+											}
+											--ctx->mInFlight;
+											return result;
+										},
+										// Callback to main thread
+										[this, ctx, batch](LODJobResult result)
+										{
+											pruneRetiredBaseModels();
+											if (ctx->mGeneration[batch->mLOD].get() !=
+													batch->mGeneration)
+											{
+												// Stale result and the
+												// preview may be gone: just
+												// destroy the orphaned model.
+												LLPointer<LLModel> model =
+													result.mModel;
+												return;
+											}
+											onLODJobDone(batch, result);
+										}))
+			{
+				// Threads pool gone (viewer shutting down): simplify on the
+				// main thread instead.
+				--ctx->mInFlight;
+				LODJobResult result;
+				result.mIndex = mdl_idx;
+				simplifyModel(base, lod, meshopt_mode, lod_mode,
+							  indices_decim, lod_err_thres, result);
+				onLODJobDone(batch, result);
+				if (ctx->mGeneration[lod].get() != gen)
+				{
+					// Model validation failed and the floater got closed.
+					return;
+				}
+			}
+		}
+	}
+}
 
-			LLVolumeParams volume_params;
-			volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
-			mModel[lod][mdl_idx] = new LLModel(volume_params, 0.f);
+//static
+void LLModelPreview::simplifyModel(LLModel* base, S32 lod, S32 meshopt_mode,
+								   U32 lod_mode, F32 indices_decim,
+								   F32 lod_err_thres, LODJobResult& result)
+{
+	U32 method = LLModelSimplifier::AUTO;
+	if (meshopt_mode == MESH_OPTIMIZER_PRECISE)
+	{
+		method = LLModelSimplifier::PRECISE;
+	}
+	else if (meshopt_mode == MESH_OPTIMIZER_SLOPPY)
+	{
+		method = LLModelSimplifier::SLOPPY;
+	}
+	result.mModel =
+		LLModelSimplifier::simplify(base, base->mLabel + get_lod_suffix(lod),
+									method, indices_decim, lod_err_thres,
+									lod_mode == LIMIT_TRIANGLES, result.mLog);
+	result.mValid = result.mModel->validate();
+}
 
-			std::string name = base->mLabel + get_lod_suffix(lod);
-			mModel[lod][mdl_idx]->mLabel = name;
-			mModel[lod][mdl_idx]->mSubmodelID = base->mSubmodelID;
-			mModel[lod][mdl_idx]->setNumVolumeFaces(base->getNumVolumeFaces());
+void LLModelPreview::onLODJobDone(const lod_batch_ptr_t& batch,
+								  LODJobResult& result)
+{
+	// Take ownership of the new model, so that it gets properly destroyed,
+	// should it be discarded.
+	LLPointer<LLModel> model = result.mModel;
+	if (mLODJobsCtx->mGeneration[batch->mLOD].get() != batch->mGeneration)
+	{
+		return;
+	}
 
-			LLModel* target_model = mModel[lod][mdl_idx];
+	for (U32 i = 0, count = result.mLog.size(); i < count; ++i)
+	{
+		llinfos << result.mLog[i] << llendl;
+		mFMP->addLineToLog(result.mLog[i]);
+	}
 
-			// Carry over normalized transform into simplified model
-			for (U32 i = 0, count = base->getNumVolumeFaces(); i < count; ++i)
-			{
-				LLVolumeFace& src = base->getVolumeFace(i);
-				LLVolumeFace& dst = target_model->getVolumeFace(i);
-				dst.mNormalizedScale = src.mNormalizedScale;
-			}
+	if (!result.mValid)
+	{
+		cancelLODJobs();
+		model_error("Invalid meshoptimizer model generated when creating LODs.");
+		mFMP->close();
+		return;
+	}
 
-			S32 model_meshopt_mode = meshopt_mode;
+	batch->mResults[result.mIndex] = model;
+	if (--batch->mPending == 0)
+	{
+		publishLODModels(*batch);
+	}
+}
 
-			std::ostringstream out;
-			out << "Model " << target_model->mLabel << " - LOD" << lod;
+void LLModelPreview::publishLODModels(LODJobsBatch& batch)
+{
+	S32 lod = batch.mLOD;
+	if (mLODJobs[lod].get() == &batch)
+	{
+		mLODJobs[lod].reset();
+	}
 
-			F32 ratio = 0.f;
+	mModel[lod].swap(batch.mResults);
+	mVertexBuffer[lod].clear();
 
-			// Ideally this should run not per model, but combine all sub-
-			// models with origin model as well.
-			if (model_meshopt_mode == MESH_OPTIMIZER_PRECISE)
-			{
-				// Run meshoptimizer for each face
-				for (U32 face_idx = 0, count = base->getNumVolumeFaces();
-					 face_idx < count; ++face_idx)
-				{
-					ratio = genMeshOptimizerPerFace(base, target_model,
-													face_idx, indices_decim,
-													lod_err_thres,
-													MESH_OPTIMIZER_FULL);
-					if (ratio < 0.f)
-					{
-						break;
-					}
-				}
-				if (ratio < 0.f)
-				{
-					model_meshopt_mode = MESH_OPTIMIZER_AUTO;
-				}
-				else
-				{
-					out << " simplified using per face method.";
-				}
-			}
+	// Rebuild scene based on mBaseScene
+	mScene[lod].clear();
+	mScene[lod] = mBaseScene;
 
-			if (model_meshopt_mode == MESH_OPTIMIZER_AUTO)
-			{
-				// Remove progressively more data if we cannot reach the target
-				// Run meshoptimizer for each model/object, up to 8 faces in
-				// one model.
-				ratio = genMeshOptimizerPerModel(base, target_model,
-												 indices_decim, lod_err_thres,
-												 MESH_OPTIMIZER_FULL);
-				bool done = ratio * allowed_ratio_drift >= indices_decim;
-				if (done)
-				{
-					out << " simplified using per model method.";
-				}
-				else
-				{
-					ratio =
-						genMeshOptimizerPerModel(base, target_model,
-												 indices_decim, lod_err_thres,
-												 MESH_OPTIMIZER_NO_NORMALS);
-					done = ratio * allowed_ratio_drift >= indices_decim;
-					if (done)
-					{
-						out << " simplified using per model method without normals.";
-					}
-				}
-				if (!done)
-				{
-					ratio =
-						genMeshOptimizerPerModel(base, target_model,
-												 indices_decim, lod_err_thres,
-												 MESH_OPTIMIZER_NO_UVS);
-					done = ratio * allowed_ratio_drift >= indices_decim;
-					if (done)
-					{
-						out << " simplified using per model method without UVs.";
-					}
-				}
-				if (!done)
-				{
-					// Try sloppy variant if normal one failed to simplify
-					// model enough. Use per-model, sloppy optimization
-					ratio = genMeshOptimizerPerModel(base, target_model,
-													 indices_decim,
-													 lod_err_thres,
-													 MESH_OPTIMIZER_NO_TOPOLOGY);
-					// Sloppy has a tendency to error into lower side, so a
-					// request for 100 triangles turns into ~70; check for
-					// significant difference from target decimation.
-					constexpr F32 sloppy_ratio_drift = 1.4f;
-					if (lod_mode == LIMIT_TRIANGLES &&
-						(ratio < 0.f ||
-						 ratio > indices_decim * sloppy_ratio_drift))
-					{
-						// Apply a correction to compensate.
-						// (indices_decim / res_ratio) by itself is likely
-						// to overshoot to a different side due to overal lack
-						// of precision, and we do not need an ideal result,
-						// which likely does not exist, just a better one, so a
-						// partial correction is enough.
-						F32 sloppy_decimator = indices_decim * 0.5f *
-											   (indices_decim / ratio + 1.f);
-						ratio = genMeshOptimizerPerModel(base, target_model,
-														 sloppy_decimator,
-														 lod_err_thres,
-														 MESH_OPTIMIZER_NO_TOPOLOGY);
-					}
-					if (ratio < 0.f)
-					{
-						// Sloppy variant failed to generate triangles. Can
-						// happen with models that are too simple as is.
-						// Fallback to normal method.
-						if (genMeshOptimizerPerModel(base, target_model,
-													 indices_decim,
-													 lod_err_thres,
-													 MESH_OPTIMIZER_FULL) < 0.f)
-						{
-							// Failed again !  Fall back to sloppy per face
-							// method
-							model_meshopt_mode = MESH_OPTIMIZER_SLOPPY;
-						}
-						else
-						{
-							out << " simplified using per model sloppy method.";
-						}
-					}
-				}
-			}
+	for (U32 i = 0; i < mBaseModel.size(); ++i)
+	{
+		LLModel* mdl = mBaseModel[i];
 
-			if (model_meshopt_mode == MESH_OPTIMIZER_SLOPPY)
+		LLModel* target = mModel[lod][i];
+		if (!target) continue;
+
+		for (LLModelLoader::scene::iterator iter = mScene[lod].begin(),
+											end = mScene[lod].end();
+			 iter != end; ++iter)
+		{
+			for (U32 j = 0, count = iter->second.size(); j < count; ++j)
 			{
-				for (U32 face_idx = 0, count = base->getNumVolumeFaces();
-					 face_idx < count; ++face_idx)
+				if (iter->second[j].mModel == mdl)
 				{
-					if (genMeshOptimizerPerFace(base, target_model, face_idx,
-												indices_decim, lod_err_thres,
-												MESH_OPTIMIZER_NO_TOPOLOGY) < 0)
-					{
-						genMeshOptimizerPerFace(base, target_model, face_idx,
-												indices_decim, lod_err_thres,
-												MESH_OPTIMIZER_FULL);
-					}
+					iter->second[j].mModel = target;
 				}
-				out << " simplified using per face sloppy method.";
-			}
-
-			llinfos << out.str() << llendl;
-			mFMP->addLineToLog(out.str());
-
-			// Blind-copy skin weights and just take closest skin weight to
-			// point on decimated mesh for now (auto-generating LODs with skin
-			// weights is still a bit of an open problem).
-			target_model->mPosition = base->mPosition;
-			target_model->mSkinWeights = base->mSkinWeights;
-			target_model->mSkinInfo.clone(base->mSkinInfo);
-			// Copy materials list
-			target_model->mMaterialList = base->mMaterialList;
-
-			if (!target_model->validate())
-			{
-				model_error("Invalid meshoptimizer model generated when creating LODs.");
-				mFMP->close();
-				return;
 			}
 		}
+	}
 
-		// Rebuild scene based on mBaseScene
-		mScene[lod].clear();
-		mScene[lod] = mBaseScene;
+	// Let update() rebuild the upload data and refresh the status messages
+	// and preview.
+	mDirty = true;
+	refresh();
+}
 
-		for (U32 i = 0; i < mBaseModel.size(); ++i)
+void LLModelPreview::cancelLODJobs(S32 lod)
+{
+	for (S32 i = 0; i < LLModel::NUM_LODS; ++i)
+	{
+		if (lod != -1 && i != lod)
 		{
-			LLModel* mdl = mBaseModel[i];
+			continue;
+		}
+		// Jobs not yet started will skip their work, and the results of the
+		// running ones will be dropped.
+		++mLODJobsCtx->mGeneration[i];
+		if (mLODJobs[i])
+		{
+			LL_DEBUGS("MeshUpload") << "Cancelling "
+									<< mLODJobs[i]->mPending
+									<< " pending jobs for LOD " << i
+									<< LL_ENDL;
+			mLODJobs[i].reset();
+		}
+	}
+}
 
-			LLModel* target = mModel[lod][i];
-			if (!target) continue;
+void LLModelPreview::retireBaseModels()
+{
+	cancelLODJobs();
+	if (mLODJobsCtx->mInFlight.get())
+	{
+		// The running jobs may still be reading the current base models: keep
+		// the latter alive till the former are done, and use a new context
+		// for the jobs on the next base models.
+		sRetiredBaseModels.emplace_back(mLODJobsCtx, mBaseModel);
+		mLODJobsCtx = std::make_shared<LODJobsContext>();
+	}
+}
 
-			for (LLModelLoader::scene::iterator iter = mScene[lod].begin(),
-												end = mScene[lod].end();
-				 iter != end; ++iter)
-			{
-				for (U32 j = 0, count = iter->second.size(); j < count; ++j)
-				{
-					if (iter->second[j].mModel == mdl)
-					{
-						iter->second[j].mModel = target;
-					}
-				}
-			}
+bool LLModelPreview::baseModelsInUse()
+{
+	pruneRetiredBaseModels();
+	return mLODJobsCtx->mInFlight.get() || !sRetiredBaseModels.empty();
+}
+
+//static
+void LLModelPreview::pruneRetiredBaseModels()
+{
+	for (U32 i = 0; i < sRetiredBaseModels.size(); )
+	{
+		if (sRetiredBaseModels[i].first->mInFlight.get())
+		{
+			++i;
+		}
+		else
+		{
+			sRetiredBaseModels.erase(sRetiredBaseModels.begin() + i);
 		}
 	}
+}
 
-	updateDimentionsAndOffsets();
-
-	LLVertexBuffer::unbind();
-	if (shader)
+U32 LLModelPreview::getLODJobsProgress(U32& total) const
+{
+	U32 pending = 0;
+	total = 0;
+	for (S32 i = 0; i < LLModel::NUM_LODS; ++i)
 	{
-		shader->bind();
+		if (mLODJobs[i])
+		{
+			pending += mLODJobs[i]->mPending;
+			total += mLODJobs[i]->mResults.size();
+		}
 	}
+	return pending;
 }
 
 void LLModelPreview::updateStatusMessages()
@@ -5148,7 +4834,8 @@ void LLModelPreview::updateStatusMessages()
 		total_submeshes[i] = 0;
 	}
 
-	mFMP->mCalculateBtn->setEnabled(true);
+	// Do not allow to calculate the fee before all LODs got generated.
+	mFMP->mCalculateBtn->setEnabled(!hasPendingLODJobs());
 
     for (LLMeshUploadThread::instance_list_t::iterator
 			iter = mUploadData.begin(), end = mUploadData.end();
@@ -5988,6 +5675,21 @@ void LLModelPreview::genBuffers(S32 lod, bool include_skin_weights)
 
 void LLModelPreview::update()
 {
+	// Perform any normals operation delayed till no LOD job reads the base
+	// models any more.
+	if (mDeferredNormalsOp != NORMALS_NONE && !baseModelsInUse())
+	{
+		if (mDeferredNormalsOp == NORMALS_GENERATE)
+		{
+			generateNormals();
+		}
+		else
+		{
+			restoreNormals();
+		}
+		mDeferredNormalsOp = NORMALS_NONE;
+	}
+
 	if (mGenLOD)
 	{
 		bool subscribe_for_generation = mLodsQuery.empty();
@@ -33,6 +33,9 @@
 #ifndef LL_LLFLOATERMODELPREVIEW_H
 #define LL_LLFLOATERMODELPREVIEW_H
 
+#include <memory>
+
+#include "llatomic.h"
 #include "llcontrol.h"
 #include "llfloater.h"
 #include "llhandle.h"
@@ -249,6 +252,7 @@ protected:
 	static void onPhysicsParamCommit(LLUICtrl* ctrl, void* userdata);
 	static void onPhysicsStageCancel(void* userdata);
 	static void onCancel(void* userdata);
+	static void onCancelLODs(void* userdata);
 
 	static void onPhysicsBrowse(void* userdata);
 	static void onPhysicsUseLOD(LLUICtrl*, void* userdata);
@@ -314,6 +318,7 @@ private:
 	LLPanel*							mLogPanel;
 	LLButton*							mUploadBtn;
 	LLButton*							mCalculateBtn;
+	LLButton*							mCancelLODsBtn;
 	LLScrollListCtrl*					mJointsList;
 	LLScrollListCtrl*					mJointsOverrides;
 	LLTextBox*							mConflictsText;
@@ -407,10 +412,34 @@ public:
 	bool genGlodLODs(S32 which_lod = -1, U32 decimation = 3,
 					 bool enforce_tri_limit = false);
 
+	// Queues the meshoptimizer simplification of each base model for the
+	// requested LOD(s) on the "General" threads pool; the resulting LOD models
+	// are published to the preview as soon as all the models of a given LOD
+	// got simplified.
 	void genMeshOptimizerLODs(S32 which_lod, S32 meshopt_mode,
 							  U32 decimation = 3,
 							  bool enforce_tri_limit = false);
 
+	// Cancels the pending meshoptimizer jobs for 'lod' (for all LODs when
+	// 'lod' is -1): the queued jobs skip their work and the results of the
+	// running ones get discarded.
+	void cancelLODJobs(S32 lod = -1);
+	// Cancels all the meshoptimizer jobs and, when some are still running,
+	// keeps the current base models alive till these are done. This must be
+	// called before replacing or destroying the base models.
+	void retireBaseModels();
+
+	// Returns the number of models still to simplify in all the pending LOD
+	// jobs batches, and sets 'total' to the total number of models in these
+	// batches.
+	U32 getLODJobsProgress(U32& total) const;
+
+	LL_INLINE bool hasPendingLODJobs() const
+	{
+		U32 total;
+		return getLODJobsProgress(total) > 0;
+	}
+
 	void generateNormals();
 	void restoreNormals();
 	void updateDimentionsAndOffsets();
@@ -492,22 +521,81 @@ private:
 	// Count amount of original models, excluding sub-models
 	static U32 countRootModels(LLModelLoader::model_list models);
 
-	enum
+	// Meshoptimizer jobs state shared by a model preview and its jobs, which
+	// may outlive the preview; it therefore holds no reference to the preview
+	// or to its models.
+	struct LODJobsContext
+	{
+		LL_INLINE LODJobsContext()
+		:	mInFlight(0)
+		{
+			for (S32 i = 0; i < LLModel::NUM_LODS; ++i)
+			{
+				mGeneration[i] = 0;
+			}
+		}
+
+		// Number of jobs posted to the threads pool and not yet ran (whether
+		// cancelled or not).
+		LLAtomicU32					mInFlight;
+		// Incremented each time the jobs for a given LOD get cancelled.
+		LLAtomicU32					mGeneration[LLModel::NUM_LODS];
+	};
+	typedef std::shared_ptr<LODJobsContext> lod_ctx_ptr_t;
+
+	// State of a batch of meshoptimizer jobs (one job per base model) for a
+	// given LOD. Only used by the main thread.
+	struct LODJobsBatch
 	{
-		MESH_OPTIMIZER_FULL,
-		MESH_OPTIMIZER_NO_NORMALS,
-		MESH_OPTIMIZER_NO_UVS,
-		MESH_OPTIMIZER_NO_TOPOLOGY,
+		LL_INLINE LODJobsBatch(S32 lod, U32 count, U32 generation)
+		:	mLOD(lod),
+			mPending(count),
+			mGeneration(generation)
+		{
+			mResults.resize(count);
+		}
+
+		LLModelLoader::model_list	mResults;
+		S32							mLOD;
+		U32							mPending;
+		// Generation of mLOD this batch belongs to: stale when different
+		// from the current generation in the jobs context.
+		U32							mGeneration;
+	};
+	typedef std::shared_ptr<LODJobsBatch> lod_batch_ptr_t;
+
+	// Result of a meshoptimizer job, passed from the worker thread to the
+	// main thread. Since LLRefCount is not thread-safe, mModel is a raw
+	// pointer, only wrapped into a LLPointer once back on the main thread.
+	struct LODJobResult
+	{
+		LL_INLINE LODJobResult()
+		:	mModel(NULL),
+			mIndex(0),
+			mValid(true)
+		{
+		}
+
+		LLModel*					mModel;
+		std::vector<std::string>	mLog;
+		U32							mIndex;
+		bool						mValid;
 	};
 
-	// Methods using the meshoptimizer library, returning the reached
-	// simplification ratio, or -1.f on failure to simplify the model.
-	F32 genMeshOptimizerPerModel(LLModel* base_model, LLModel* target_model,
-								 F32 indices_ratio, F32 error_threshold,
-								 S32 simplification_mode);
-	F32 genMeshOptimizerPerFace(LLModel* base_model, LLModel* target_model,
-								U32 face_idx, F32 indices_ratio,
-								F32 error_threshold, S32 simplification_mode);
+	// The meshoptimizer job proper, run on the threads pool: a wrapper for
+	// LLModelSimplifier::simplify().
+	static void simplifyModel(LLModel* base, S32 lod, S32 meshopt_mode,
+							  U32 lod_mode, F32 indices_decim,
+							  F32 lod_err_thres, LODJobResult& result);
+	// Called on the main thread for each completed meshoptimizer job.
+	void onLODJobDone(const lod_batch_ptr_t& batch, LODJobResult& result);
+	// Called on the main thread once all the jobs of a batch are completed.
+	void publishLODModels(LODJobsBatch& batch);
+
+	// Returns true when meshoptimizer jobs may still be reading base models.
+	bool baseModelsInUse();
+	// Releases the retired base models no job is reading any more.
+	static void pruneRetiredBaseModels();
 
 protected:
 	LLFloaterModelPreview*  mFMP;
@@ -587,6 +675,20 @@ protected:
 	vv_LLVolumeFace_t		mBaseModelFacesCopy;
 
 	std::vector<S32>		mLodsQuery;
+
+	// Pending meshoptimizer jobs batches, per LOD
+	lod_batch_ptr_t			mLODJobs[LLModel::NUM_LODS];
+	// Jobs context for the current base models.
+	lod_ctx_ptr_t			mLODJobsCtx;
+	// Base models replaced or left behind by destroyed previews, with the
+	// context of the jobs which may still be reading them.
+	typedef std::pair<lod_ctx_ptr_t, LLModelLoader::model_list> retired_t;
+	static std::vector<retired_t> sRetiredBaseModels;
+
+	// Normals operation requested while the base models were in use by jobs
+	// and to perform as soon as they are done.
+	enum { NORMALS_NONE, NORMALS_GENERATE, NORMALS_RESTORE };
+	U32						mDeferredNormalsOp;
 	std::vector<S32>		mLodsWithParsingError;
 
 	typedef std::map<LLPointer<LLModel>, U32> model_object_map_t;
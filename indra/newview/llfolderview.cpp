@@ -206,6 +206,7 @@ LLFolderViewItem::LLFolderViewItem(const std::string& name, LLUIImagePtr icon,
 	mFiltered(false),
 	mLastFilterGeneration(-1),
 	mStringMatchOffset(std::string::npos),
+	mSearchableNameLength(std::string::npos),
 	mControlLabelRotation(0.f),
 	mRoot(root),
 	mDragAndDropTarget(false),
@@ -385,6 +386,15 @@ void LLFolderViewItem::refresh()
 	searchable_label.append(mLabelSuffix);
 	LLStringUtil::toUpper(searchable_label);
 
+	if (mListener && mLabel == mListener->getName())
+	{
+		mSearchableNameLength = mLabel.size();
+	}
+	else
+	{
+		mSearchableNameLength = std::string::npos;
+	}
+
 	if (mSearchableLabel.compare(searchable_label))
 	{
 		mSearchableLabel.assign(searchable_label);
@@ -397,6 +407,14 @@ void LLFolderViewItem::refresh()
 		}
 	}
 
+	// Note: the root folder view calls this from its base class constructor,
+	// before it is itself constructed, but it got no listener.
+	if (mListener && mRoot)
+	{
+		mRoot->noteSearchableLabel(mListener->getUUID(), mSearchableLabel,
+								   mSearchableNameLength);
+	}
+
 	U32 style;
 	const LLFontGL* fontp = getRenderFont(style);
 	S32 label_width = fontp->getWidth(mLabel);
@@ -707,17 +725,18 @@ std::string LLFolderViewItem::getSearchableData()
 {
 	std::string searchable;
 	U32 flags = mRoot->getSearchType();
-	if (flags == 0 || (flags & 1))
+	if (flags == 0 || (flags & LLFolderView::SEARCH_NAME))
 	{
 		searchable = mSearchableLabel;
 	}
-	bool want_desc = (flags & 2) != 0 && mHasDescription;
+	bool want_desc = (flags & LLFolderView::SEARCH_DESCRIPTION) != 0 &&
+					 mHasDescription;
 	if (!want_desc)
 	{
 		// Get rid of cached data to save memory.
 		mSearchableDesc.clear();
 	}
-	bool want_creator = (flags & 4) != 0;
+	bool want_creator = (flags & LLFolderView::SEARCH_CREATOR) != 0;
 	if (!want_creator)
 	{
 		// Get rid of cached data to save memory.
@@ -1135,7 +1154,8 @@ void LLFolderViewItem::draw()
 			S32 filter_string_length = mRoot->getFilterSubString().size();
 			std::string combined_string_upper = combined_string;
 			LLStringUtil::toUpper(combined_string_upper);
-			if (filter_string_length > 0 && (mRoot->getSearchType() & 1) &&
+			if (filter_string_length > 0 &&
+				(mRoot->getSearchType() & LLFolderView::SEARCH_NAME) &&
 				combined_string_upper.find(mRoot->getFilterSubString()) == mStringMatchOffset)
 			{
 				S32 left = ll_round(text_left) +
@@ -1483,6 +1503,24 @@ void LLFolderViewFolder::filter(LLInventoryFilter& filter)
 			continue;
 		}
 
+		// When the names index tells that nothing in this folder sub-tree
+		// can match the searched sub-string, flag the folder as filtered out
+		// and done, without traversing its descendants (which filter
+		// generation is left untouched, so that they get properly filtered
+		// on the next pass that would need them).
+		LLFolderViewEventListener* listenerp = (*fit)->getListener();
+		if (listenerp && !filter.mayHaveMatches(listenerp->getUUID()))
+		{
+			if ((*fit)->getVisible())
+			{
+				requestArrange();
+			}
+			(*fit)->setFiltered(false, filter_generation);
+			(*fit)->setCompletedFilterGeneration(filter_generation, false);
+			filter.decrementFilterCount();
+			continue;
+		}
+
 		// Update this folders filter status (and children)
 		(*fit)->filter(filter);
 
@@ -2882,7 +2920,7 @@ LLFolderView::LLFolderView(const std::string& name, LLUIImagePtr folder_icon,
 	mNeedsAutoRename(false),
 	// This gets overridden by a preference shortly after:
 	mSortOrder(LLInventoryFilter::SO_FOLDERS_BY_NAME),
-	mSearchType(1),
+	mSearchType(SEARCH_NAME),
 	mFilter(name),
 	mShowSelectionContext(false),
 	mShowSingleSelection(false),
@@ -3025,40 +3063,19 @@ U32 LLFolderView::toggleSearchType(std::string toggle)
 {
 	if (toggle == "name")
 	{
-		if (mSearchType & 1)
-		{
-			mSearchType &= 6;
-		}
-		else
-		{
-			mSearchType |= 1;
-		}
+		mSearchType ^= SEARCH_NAME;
 	}
 	else if (toggle == "description")
 	{
-		if (mSearchType & 2)
-		{
-			mSearchType &= 5;
-		}
-		else
-		{
-			mSearchType |= 2;
-		}
+		mSearchType ^= SEARCH_DESCRIPTION;
 	}
 	else if (toggle == "creator")
 	{
-		if (mSearchType & 4)
-		{
-			mSearchType &= 3;
-		}
-		else
-		{
-			mSearchType |= 4;
-		}
+		mSearchType ^= SEARCH_CREATOR;
 	}
 	if (mSearchType == 0)
 	{
-		mSearchType = 1;
+		mSearchType = SEARCH_NAME;
 	}
 
 	if (getFilterSubString().length())
@@ -3074,6 +3091,49 @@ U32 LLFolderView::getSearchType() const
 	return mSearchType;
 }
 
+void LLFolderView::noteSearchableLabel(const LLUUID& id,
+									   const std::string& upper_label,
+									   size_t name_length)
+{
+	if (name_length == std::string::npos)
+	{
+		mNonNameLabelIDs.emplace(id);
+		return;
+	}
+
+	mNonNameLabelIDs.erase(id);
+	if (name_length < upper_label.size())
+	{
+		mLabelSuffixes.emplace(upper_label.substr(name_length));
+	}
+}
+
+bool LLFolderView::mayMatchLabelSuffix(const std::string& upper_str) const
+{
+	size_t len = upper_str.size();
+	for (std::set<std::string>::const_iterator it = mLabelSuffixes.begin(),
+											   end = mLabelSuffixes.end();
+		 it != end; ++it)
+	{
+		const std::string& suffix = *it;
+		// Searched string contained in the suffix
+		if (suffix.find(upper_str) != std::string::npos)
+		{
+			return true;
+		}
+		// Searched string starting in the name and ending in the suffix
+		for (size_t i = 1, count = llmin(len - 1, suffix.size()); i <= count;
+			 ++i)
+		{
+			if (!upper_str.compare(len - i, i, suffix, 0, i))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 //virtual
 bool LLFolderView::addFolder(LLFolderViewFolder* folder)
 {
@@ -3253,6 +3313,7 @@ void LLFolderView::filter(LLInventoryFilter& filter)
 	{
 		mFiltered = false;
 		mMinWidth = 0;
+		filter.updateIndexFolders(this);
 		LLFolderViewFolder::filter(filter);
 	}
 }
@@ -5057,6 +5118,7 @@ void LLFolderView::addItemID(const LLUUID& id, LLFolderViewItem* itemp)
 void LLFolderView::removeItemID(const LLUUID& id)
 {
 	mItemMap.erase(id);
+	mNonNameLabelIDs.erase(id);
 }
 
 LLFolderViewItem* LLFolderView::getItemByID(const LLUUID& id)
@@ -5352,7 +5414,11 @@ LLInventoryFilter::LLInventoryFilter(const std::string& name)
 	mFilterWorn(false),
 	mFilterLastOpen(false),
 	mFilterShowLinks(false),
-	mSubStringMatchOffset(0)
+	mSubStringMatchOffset(0),
+	mIndexVersion(0),
+	mIndexUsable(false),
+	mIndexFoldersDirty(true),
+	mSkipUnmatchedFolders(false)
 {
 	mFilterOps.mFilterTypes = 0xffffffff;
 	mFilterOps.mMinDate = time_min();
@@ -5423,12 +5489,8 @@ bool LLInventoryFilter::check(LLFolderViewItem* item)
 	}
 	else
 	{
-		std::string search_string = mFilterSubString;
-		if (search_string != "(LINK)" && search_string.find("(LINK)"))
-		{
-			LLStringUtil::replaceString(search_string, "(LINK)", "");
-		}
-		mSubStringMatchOffset = item->getSearchableData().find(search_string);
+		mSubStringMatchOffset = findSubString(item, item_id,
+											  getSearchString());
 		if (mSubStringMatchOffset == std::string::npos)
 		{
 			return false;
@@ -5489,6 +5551,125 @@ bool LLInventoryFilter::check(LLFolderViewItem* item)
 	return true;
 }
 
+std::string LLInventoryFilter::getSearchString() const
+{
+	std::string search_string = mFilterSubString;
+	if (search_string != "(LINK)" && search_string.find("(LINK)"))
+	{
+		LLStringUtil::replaceString(search_string, "(LINK)", "");
+	}
+	return search_string;
+}
+
+bool LLInventoryFilter::queryNameIndex(const std::string& search_string)
+{
+	U32 version = gInventory.getNameIndexVersion();
+	if (mIndexVersion != version || mIndexedSubString != search_string)
+	{
+		mIndexedSubString = search_string;
+		mIndexUsable = gInventory.findObjectsByName(search_string,
+													mIndexMatches);
+		// The first query builds the index, so get the version again.
+		mIndexVersion = gInventory.getNameIndexVersion();
+		mIndexFoldersDirty = true;
+	}
+	return mIndexUsable;
+}
+
+void LLInventoryFilter::updateIndexFolders(LLFolderView* rootp)
+{
+	mSkipUnmatchedFolders = false;
+
+	// The names index may only be used when searching in labels alone.
+	if (mFilterSubString.empty() ||
+		(rootp->getSearchType() & (LLFolderView::SEARCH_DESCRIPTION |
+								   LLFolderView::SEARCH_CREATOR)))
+	{
+		return;
+	}
+	std::string search_string = getSearchString();
+	if (!queryNameIndex(search_string) ||
+		// Items could then match on their label suffix alone.
+		rootp->mayMatchLabelSuffix(search_string))
+	{
+		return;
+	}
+
+	// The folders hierarchy or the labels may have changed whenever the
+	// root got its completed filter generation reset by dirtyFilter().
+	if (mIndexFoldersDirty || rootp->getCompletedFilterGeneration() < 0)
+	{
+		mIndexFoldersDirty = false;
+		mIndexFolders.clear();
+
+		auto add_ancestors = [this](const uuid_list_t& ids)
+		{
+			for (uuid_list_t::const_iterator it = ids.begin(),
+											 end = ids.end();
+				 it != end; ++it)
+			{
+				// Stop at the first already recorded ancestor, since all its
+				// own ancestors got recorded with it.
+				LLInventoryObject* objp = gInventory.getObject(*it);
+				while (objp)
+				{
+					const LLUUID& parent_id = objp->getParentUUID();
+					if (parent_id.isNull() ||
+						!mIndexFolders.emplace(parent_id).second)
+					{
+						break;
+					}
+					objp = gInventory.getCategory(parent_id);
+				}
+			}
+		};
+		add_ancestors(mIndexMatches);
+		// Items which label is not their inventory name must be checked on
+		// their label, so they count as potential matches.
+		const uuid_list_t& non_name_ids = rootp->getNonNameLabelIDs();
+		add_ancestors(non_name_ids);
+		mIndexFolders.insert(mIndexMatches.begin(), mIndexMatches.end());
+		mIndexFolders.insert(non_name_ids.begin(), non_name_ids.end());
+	}
+
+	mSkipUnmatchedFolders = true;
+}
+
+size_t LLInventoryFilter::findSubString(LLFolderViewItem* item,
+										const LLUUID& item_id,
+										const std::string& search_string)
+{
+	// The names index may only be used when searching in labels alone, and
+	// when the label is actually made of the inventory object name.
+	LLFolderView* rootp = item->getRoot();
+	if (!rootp ||
+		(rootp->getSearchType() & (LLFolderView::SEARCH_DESCRIPTION |
+								   LLFolderView::SEARCH_CREATOR)) ||
+		item->getSearchableNameLength() == std::string::npos ||
+		!queryNameIndex(search_string))
+	{
+		return item->getSearchableData().find(search_string);
+	}
+
+	const std::string& label = item->getSearchableLabel();
+	if (mIndexMatches.count(item_id))
+	{
+		return label.find(search_string);
+	}
+
+	// The object name does not contain the searched string, but the label
+	// suffix (or a span overlapping the end of the name and that suffix)
+	// still could.
+	size_t name_len = item->getSearchableNameLength();
+	size_t len = search_string.size();
+	size_t start = name_len >= len ? name_len - len + 1 : 0;
+	if (start >= label.size())
+	{
+		return std::string::npos;
+	}
+	return label.find(search_string, start);
+}
+
 // Has user modified default filter params ?
 bool LLInventoryFilter::isNotDefault()
 {
@@ -38,6 +38,7 @@
 #define LL_LLFOLDERVIEW_H
 
 #include <deque>
+#include <set>
 #include <vector>
 
 #include "llcolor4.h"
@@ -370,6 +371,34 @@ public:
 	void toLLSD(LLSD& data);
 	void fromLLSD(LLSD& data);
 
+	// Called by the root folder view before each filtering pass: when the
+	// inventory names index alone can tell which objects match the searched
+	// sub-string, records the folders that hold (or are) such matches, so
+	// that the other folders sub-trees do not need to be traversed.
+	void updateIndexFolders(LLFolderView* rootp);
+
+	// Returns false when no object in the sub-tree of folder 'folder_id' can
+	// pass the sub-string filter.
+	LL_INLINE bool mayHaveMatches(const LLUUID& folder_id) const
+	{
+		return !mSkipUnmatchedFolders || mIndexFolders.count(folder_id);
+	}
+
+private:
+	// Returns the sub-string actually searched for in items labels.
+	std::string getSearchString() const;
+
+	// Refreshes, when needed, the cached results of the inventory names index
+	// query for 'search_string'. Returns false when the index cannot be used
+	// for it.
+	bool queryNameIndex(const std::string& search_string);
+
+	// Returns the offset of 'search_string' in the searchable data of 'item'
+	// (std::string::npos when not found), using the inventory names index
+	// whenever possible to avoid scanning the label.
+	size_t findSubString(LLFolderViewItem* item, const LLUUID& item_id,
+						 const std::string& search_string);
+
 private:
 	LLUUID				mLastOpenID;
 	std::string			mFilterText;
@@ -401,6 +430,16 @@ protected:
 	size_t				mSubStringMatchOffset;
 	std::string			mFilterSubString;
 
+	// Cached results of the last inventory names index query.
+	std::string			mIndexedSubString;
+	uuid_list_t			mIndexMatches;
+	U32					mIndexVersion;
+	bool				mIndexUsable;
+	// Matching objects and all their ancestor folders.
+	uuid_list_t			mIndexFolders;
+	bool				mIndexFoldersDirty;
+	bool				mSkipUnmatchedFolders;
+
 	const std::string	mName;
 
 	S32					mFilterSubType;
@@ -582,6 +621,20 @@ public:
 
 	std::string getSearchableData();
 
+	// Upper-cased label plus label suffix, as used for name searches.
+	LL_INLINE const std::string& getSearchableLabel() const
+	{
+		return mSearchableLabel;
+	}
+
+	// Length of the leading part of the searchable label that is made of the
+	// inventory object name, or std::string::npos when the displayed label
+	// differs from that name.
+	LL_INLINE size_t getSearchableNameLength() const
+	{
+		return mSearchableNameLength;
+	}
+
 	// This method returns the label displayed on the view. This
 	// method was primarily added to allow sorting on the folder
 	// contents possible before the entire view has been constructed.
@@ -670,6 +723,7 @@ protected:
 	LLTimer						mTimeSinceRequestStart;
 
 	size_t						mStringMatchOffset;
+	size_t						mSearchableNameLength;
 
 	S32							mIndentation;
 	S32							mLastFilterGeneration;
@@ -1015,6 +1069,11 @@ public:
 	typedef void (*selection_cb_t)(LLFolderView* folderp, bool user_action,
 								   void* userdata);
 
+	// Search type flags, as returned by getSearchType()
+	static constexpr U32 SEARCH_NAME = 1;
+	static constexpr U32 SEARCH_DESCRIPTION = 2;
+	static constexpr U32 SEARCH_CREATOR = 4;
+
 	LLFolderView(const std::string& name, LLUIImagePtr root_folder_icon,
 				 const LLRect& rect, const LLUUID& source_id,
 				 LLPanel* parent_panel);
@@ -1068,6 +1127,21 @@ public:
 	U32 toggleSearchType(std::string toggle);
 	U32 getSearchType() const;
 
+	// Called by the items on refresh(), to keep track of the labels that the
+	// inventory names index cannot account for when filtering.
+	void noteSearchableLabel(const LLUUID& id, const std::string& upper_label,
+							 size_t name_length);
+
+	// Ids of the items which label is not made of their inventory name.
+	LL_INLINE const uuid_list_t& getNonNameLabelIDs() const
+	{
+		return mNonNameLabelIDs;
+	}
+
+	// Returns true when 'upper_str' could be found in a span of some item
+	// searchable label that overlaps that label suffix.
+	bool mayMatchLabelSuffix(const std::string& upper_str) const;
+
 	// Closes all folders in the view
 	void closeAllFolders();
 
@@ -1275,6 +1349,11 @@ protected:
 	typedef fast_hmap<LLUUID, LLFolderViewItem*> item_map_t;
 	item_map_t				mItemMap;
 
+	// Upper-cased label suffixes seen so far (never pruned, which is harmless
+	// since they are only used to disable a filtering optimization).
+	std::set<std::string>	mLabelSuffixes;
+	uuid_list_t				mNonNameLabelIDs;
+
 	selected_items_t		mSelectedItems;
 
 	// Marketplace listings upkeeping
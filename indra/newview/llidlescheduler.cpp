@@ -0,0 +1,189 @@
+/**
+ * @file llidlescheduler.cpp
+ * @brief Frame-budgeted scheduler for the main loop idle tasks
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include <algorithm>
+
+#include "llidlescheduler.h"
+
+#include "lltimer.h"
+
+#include "llappviewer.h"
+#include "llviewercontrol.h"
+
+LLIdleScheduler gIdleScheduler;
+
+LLIdleScheduler::LLIdleScheduler()
+:	mBudget(0.0),
+	mLastUsedTime(0.0),
+	mLastDeferred(0)
+{
+}
+
+void LLIdleScheduler::addTask(const std::string& name, task_func_t func,
+							  EPriority priority, U32 max_skip)
+{
+	if (!func)
+	{
+		llwarns << "Null function passed for task: " << name << llendl;
+		llassert(false);
+		return;
+	}
+
+	Task task;
+	task.mName = name;
+	task.mFunc = func;
+	task.mAverageCost = task.mLastCost = 0.0;
+	task.mPriority = llmin((U32)priority, (U32)PRIORITY_COUNT - 1);
+	task.mMaxSkippedFrames = max_skip;
+	task.mSkippedFrames = task.mRuns = task.mDeferrals = 0;
+	task.mRanLastFrame = false;
+	mTasks.emplace_back(std::move(task));
+	LL_DEBUGS("IdleScheduler") << "Added task: " << name << " - Priority: "
+							   << getPriorityName(priority)
+							   << " - Max skipped frames: " << max_skip
+							   << LL_ENDL;
+}
+
+void LLIdleScheduler::removeTask(const std::string& name)
+{
+	for (tasks_vec_t::iterator it = mTasks.begin(), end = mTasks.end();
+		 it != end; ++it)
+	{
+		if (it->mName == name)
+		{
+			mTasks.erase(it);
+			LL_DEBUGS("IdleScheduler") << "Removed task: " << name << LL_ENDL;
+			return;
+		}
+	}
+}
+
+//static
+const char* LLIdleScheduler::getPriorityName(U32 priority)
+{
+	switch (priority)
+	{
+		case PRIORITY_HIGH:
+			return "high";
+
+		case PRIORITY_NORMAL:
+			return "normal";
+
+		default:
+			return "low";
+	}
+}
+
+void LLIdleScheduler::updateBudget()
+{
+	static LLCachedControl<U32> max_fps(gSavedSettings, "FrameRateLimit");
+	static LLCachedControl<U32> target_fps(gSavedSettings,
+										   "IdleSchedulerTargetFPS");
+	static LLCachedControl<F32> fraction(gSavedSettings,
+										 "IdleSchedulerBudgetFraction");
+	// Use the frame rate limit as the target when set (same logic as in
+	// LLAppViewer::frame()).
+	U32 fps = max_fps >= 20 ? (U32)max_fps : (U32)target_fps;
+	F64 frame_time = 1.0 / F64(llclamp(fps, 10U, 240U));
+	mBudget = frame_time * F64(llclamp((F32)fraction, 0.01f, 1.f));
+	// When the last frame already overran the target frame time, shrink the
+	// budget accordingly, so that deferrable work gets spread over more
+	// frames instead of adding up to the spike.
+	if (gFrameDT > frame_time)
+	{
+		mBudget *= llmax(frame_time / F64(gFrameDT), 0.25);
+	}
+}
+
+void LLIdleScheduler::run()
+{
+	updateBudget();
+
+	static LLCachedControl<bool> enabled(gSavedSettings,
+										 "IdleSchedulerEnabled");
+
+	// Run order: by priority first, then by decreasing number of consecutive
+	// skipped frames, so that deferred tasks get a chance to run first at
+	// the next frame.
+	U32 count = mTasks.size();
+	mOrder.resize(count);
+	for (U32 i = 0; i < count; ++i)
+	{
+		mOrder[i] = i;
+	}
+	std::stable_sort(mOrder.begin(), mOrder.end(),
+					 [this](U32 a, U32 b)
+					 {
+						const Task& ta = mTasks[a];
+						const Task& tb = mTasks[b];
+						if (ta.mPriority != tb.mPriority)
+						{
+							return ta.mPriority < tb.mPriority;
+						}
+						return ta.mSkippedFrames > tb.mSkippedFrames;
+					 });
+
+	mLastDeferred = 0;
+	LLTimer timer;
+	F64 used = 0.0;
+	for (U32 i = 0; i < count; ++i)
+	{
+		Task& task = mTasks[mOrder[i]];
+		if (enabled && task.mSkippedFrames < task.mMaxSkippedFrames &&
+			used + task.mAverageCost > mBudget)
+		{
+			// Defer this task to a next frame.
+			++task.mSkippedFrames;
+			++task.mDeferrals;
+			task.mRanLastFrame = false;
+			++mLastDeferred;
+			continue;
+		}
+
+		task.mFunc();
+
+		F64 now = timer.getElapsedTimeF64();
+		task.mLastCost = now - used;
+		used = now;
+		// Running average, seeded with the first measured cost
+		task.mAverageCost = task.mRuns ? 0.9 * task.mAverageCost +
+										 0.1 * task.mLastCost
+									   : task.mLastCost;
+		++task.mRuns;
+		task.mSkippedFrames = 0;
+		task.mRanLastFrame = true;
+	}
+	mLastUsedTime = used;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file llidlescheduler.h
+ * @brief Frame-budgeted scheduler for the main loop idle tasks
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLIDLESCHEDULER_H
+#define LL_LLIDLESCHEDULER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "llerror.h"
+
+// This class runs the deferrable main loop idle tasks within a per-frame time
+// budget derived from the target frame rate. The cost of each task is tracked
+// (running average of its execution time), and the tasks that would not fit
+// in what remains of the budget for the current frame are deferred to the
+// next frames, in priority order; a task may however not be deferred for
+// more than a configurable number of consecutive frames, so to avoid its
+// starvation. This avoids frame time spikes whenever several tasks happen to
+// have catch-up work to do during the same frame.
+
+class LLIdleScheduler
+{
+protected:
+	LOG_CLASS(LLIdleScheduler);
+
+public:
+	enum EPriority : U32
+	{
+		PRIORITY_HIGH = 0,
+		PRIORITY_NORMAL,
+		PRIORITY_LOW,
+		PRIORITY_COUNT
+	};
+
+	typedef std::function<void()> task_func_t;
+
+	struct Task
+	{
+		std::string	mName;
+		task_func_t	mFunc;
+		F64			mAverageCost;		// In seconds
+		F64			mLastCost;			// In seconds
+		U32			mPriority;
+		U32			mMaxSkippedFrames;
+		U32			mSkippedFrames;		// Consecutive deferrals
+		U32			mRuns;
+		U32			mDeferrals;			// Total deferrals
+		bool		mRanLastFrame;
+	};
+	typedef std::vector<Task> tasks_vec_t;
+
+	LLIdleScheduler();
+
+	// Registers a new task. 'max_skip' is the maximum number of consecutive
+	// frames the task may be deferred for (0 = run at every frame, but still
+	// account for its cost in the frame budget).
+	void addTask(const std::string& name, task_func_t func,
+				 EPriority priority = PRIORITY_NORMAL, U32 max_skip = 4);
+	// Note: must not be called from a running task.
+	void removeTask(const std::string& name);
+
+	// Runs the due tasks. Called once per frame from LLAppViewer::idle().
+	void run();
+
+	LL_INLINE const tasks_vec_t& getTasks() const	{ return mTasks; }
+
+	// Budget for the last frame, in seconds
+	LL_INLINE F64 getBudget() const					{ return mBudget; }
+	// Time spent running the tasks during the last frame, in seconds
+	LL_INLINE F64 getLastUsedTime() const			{ return mLastUsedTime; }
+	// Number of tasks deferred during the last frame
+	LL_INLINE U32 getLastDeferred() const			{ return mLastDeferred; }
+
+	static const char* getPriorityName(U32 priority);
+
+private:
+	void updateBudget();
+
+private:
+	tasks_vec_t			mTasks;
+	// Tasks run order, reused at each frame to avoid allocations
+	std::vector<U32>	mOrder;
+
+	F64					mBudget;
+	F64					mLastUsedTime;
+	U32					mLastDeferred;
+};
+
+extern LLIdleScheduler gIdleScheduler;
+
+#endif	// LL_LLIDLESCHEDULER_H
@@ -411,6 +411,136 @@ bool LLDispatchBulkUpdateInventory::operator()(const LLDispatcher*,
 	return true;
 }
 
+//----------------------------------------------------------------------------
+// Class LLInventoryNameIndex
+//----------------------------------------------------------------------------
+
+void LLInventoryNameIndex::clear()
+{
+	mSlots.clear();
+	mSlotIds.clear();
+	mSlotNames.clear();
+	mFreeSlots.clear();
+	mPostings.clear();
+}
+
+void LLInventoryNameIndex::addPostings(U32 slot)
+{
+	const std::string& name = mSlotNames[slot];
+	for (size_t i = 0, count = name.size(); i + 2 < count; ++i)
+	{
+		mPostings[getTrigram(name.data() + i)].emplace(slot);
+	}
+}
+
+void LLInventoryNameIndex::removePostings(U32 slot)
+{
+	const std::string& name = mSlotNames[slot];
+	for (size_t i = 0, count = name.size(); i + 2 < count; ++i)
+	{
+		auto it = mPostings.find(getTrigram(name.data() + i));
+		if (it != mPostings.end())
+		{
+			it->second.erase(slot);
+			if (it->second.empty())
+			{
+				mPostings.hmap_erase(it);
+			}
+		}
+	}
+}
+
+bool LLInventoryNameIndex::insert(const LLUUID& id,
+								  const std::string& upper_name)
+{
+	U32 slot;
+	auto it = mSlots.find(id);
+	if (it != mSlots.end())
+	{
+		slot = it->second;
+		if (mSlotNames[slot] == upper_name)
+		{
+			return false;	// Nothing changed
+		}
+		removePostings(slot);
+		mSlotNames[slot] = upper_name;
+	}
+	else if (!mFreeSlots.empty())
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+		mSlotIds[slot] = id;
+		mSlotNames[slot] = upper_name;
+		mSlots.emplace(id, slot);
+	}
+	else
+	{
+		slot = mSlotIds.size();
+		mSlotIds.emplace_back(id);
+		mSlotNames.emplace_back(upper_name);
+		mSlots.emplace(id, slot);
+	}
+	addPostings(slot);
+	return true;
+}
+
+bool LLInventoryNameIndex::remove(const LLUUID& id)
+{
+	auto it = mSlots.find(id);
+	if (it == mSlots.end())
+	{
+		return false;
+	}
+	U32 slot = it->second;
+	mSlots.hmap_erase(it);
+	removePostings(slot);
+	mSlotIds[slot].setNull();
+	mSlotNames[slot].clear();
+	mFreeSlots.push_back(slot);
+	return true;
+}
+
+bool LLInventoryNameIndex::find(const std::string& upper_str,
+								uuid_list_t& matches) const
+{
+	size_t len = upper_str.size();
+	if (len < MIN_SEARCH_LENGTH)
+	{
+		return false;
+	}
+
+	matches.clear();
+
+	// Find the shortest posting list among the trigrams of the searched
+	// string. If any trigram is absent from the index, nothing can match.
+	const slots_set_t* shortest = NULL;
+	for (size_t i = 0; i + 2 < len; ++i)
+	{
+		auto it = mPostings.find(getTrigram(upper_str.data() + i));
+		if (it == mPostings.end())
+		{
+			return true;
+		}
+		if (!shortest || it->second.size() < shortest->size())
+		{
+			shortest = &it->second;
+		}
+	}
+
+	// Confirm each candidate against its actual name: this also takes care
+	// of the trigrams order, which the posting lists do not record.
+	for (auto it = shortest->begin(), end = shortest->end(); it != end; ++it)
+	{
+		U32 slot = *it;
+		if (mSlotNames[slot].find(upper_str) != std::string::npos)
+		{
+			matches.emplace(mSlotIds[slot]);
+		}
+	}
+
+	return true;
+}
+
 //----------------------------------------------------------------------------
 // Class LLInventoryModel
 //----------------------------------------------------------------------------
@@ -425,6 +555,8 @@ LLInventoryModel::LLInventoryModel()
 	mLastItem(NULL),
 	mIsNotifyObservers(false),
 	mIsAgentInvUsable(false),
+	mNameIndexVersion(0),
+	mNameIndexEnabled(false),
 	mHttpRequestFG(NULL),
 	mHttpRequestBG(NULL),
 	mHttpPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID)
@@ -594,6 +726,90 @@ S32 LLInventoryModel::getCategoryCount() const
 	return mCategoryMap.size();
 }
 
+bool LLInventoryModel::findObjectsByName(const std::string& upper_str,
+										 uuid_list_t& matches)
+{
+	if (upper_str.size() < LLInventoryNameIndex::MIN_SEARCH_LENGTH)
+	{
+		return false;
+	}
+
+	if (!mNameIndexEnabled)
+	{
+		// First use: index everything we got so far. From now on, the index
+		// will be updated incrementally via setNameIndexDirty().
+		mNameIndexEnabled = true;
+		mNameIndexPending.clear();
+		std::string name;
+		for (cat_map_t::const_iterator it = mCategoryMap.begin(),
+									   end = mCategoryMap.end();
+			 it != end; ++it)
+		{
+			name = it->second->getName();
+			LLStringUtil::toUpper(name);
+			mNameIndex.insert(it->first, name);
+		}
+		for (item_map_t::const_iterator it = mItemMap.begin(),
+										end = mItemMap.end();
+			 it != end; ++it)
+		{
+			name = it->second->getName();
+			LLStringUtil::toUpper(name);
+			mNameIndex.insert(it->first, name);
+		}
+		LL_DEBUGS("Inventory") << "Built the names index with "
+							   << mNameIndex.size() << " entries" << LL_ENDL;
+	}
+	else
+	{
+		flushNameIndex();
+	}
+
+	return mNameIndex.find(upper_str, matches);
+}
+
+void LLInventoryModel::flushNameIndex()
+{
+	if (mNameIndexPending.empty())
+	{
+		return;
+	}
+
+	bool changed = false;
+	std::string name;
+	for (uuid_list_t::const_iterator it = mNameIndexPending.begin(),
+									 end = mNameIndexPending.end();
+		 it != end; ++it)
+	{
+		const LLUUID& id = *it;
+		LLInventoryObject* objp = getObject(id);
+		if (objp)
+		{
+			name = objp->getName();
+			LLStringUtil::toUpper(name);
+			changed |= mNameIndex.insert(id, name);
+		}
+		else
+		{
+			changed |= mNameIndex.remove(id);
+		}
+	}
+	mNameIndexPending.clear();
+
+	if (changed)
+	{
+		++mNameIndexVersion;
+	}
+}
+
+U32 LLInventoryModel::getNameIndexVersion()
+{
+	// Apply the pending changes first, so that the version only moves when
+	// an indexed name actually changed.
+	flushNameIndex();
+	return mNameIndexVersion;
+}
+
 // Return the direct descendents of the id provided. The array provided points
 // straight into the guts of this object, and should only be used for read
 // operations, since modifications may invalidate the internal state of the
@@ -1900,6 +2116,7 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links,
 	LLUUID parent_id = obj->getParentUUID();
 	mCategoryMap.erase(id);
 	mItemMap.erase(id);
+	setNameIndexDirty(id);
 #if 0
 	mInventory.erase(id);
 #endif
@@ -2122,6 +2339,15 @@ void LLInventoryModel::addChangedMask(U32 mask, const LLUUID& referent)
 		added_items = &mAddedItemIDs;
 	}
 
+	// Renames and link repairs: refresh the name of this object in the names
+	// index. Other changes (permissions, description, structure...) do not
+	// affect it.
+	if (referent.notNull() &&
+		(mask & (LLInventoryObserver::LABEL | LLInventoryObserver::REBUILD)))
+	{
+		setNameIndexDirty(referent);
+	}
+
 	if (referent.notNull() && !changed_items->count(referent))
 	{
 		changed_items->emplace(referent);
@@ -2256,6 +2482,7 @@ void LLInventoryModel::addCategory(LLViewerInventoryCategory* category)
 		// Insert category uniquely into the map
 		// LLPointer will deref and delete the old one
 		mCategoryMap[category->getUUID()] = category;
+		setNameIndexDirty(category->getUUID());
 		//mInventory[category->getUUID()] = category;
 	}
 }
@@ -2327,6 +2554,7 @@ void LLInventoryModel::addItem(LLViewerInventoryItem* itemp)
 	}
 
 	mItemMap.emplace(item_id, itemp);
+	setNameIndexDirty(item_id);
 }
 
 void LLInventoryModel::rebuildBrokenLinks()
@@ -2407,6 +2635,11 @@ void LLInventoryModel::empty()
 	mCategoryMap.clear();	// Remove all references (should delete entries)
 	mItemMap.clear();		// Remove all references (should delete entries)
 	mLastItem = NULL;
+
+	mNameIndex.clear();
+	mNameIndexPending.clear();
+	mNameIndexEnabled = false;
+	++mNameIndexVersion;
 #if 0
 	mInventory.clear();
 #endif
@@ -45,6 +45,7 @@
 #include "llcorehttpoptions.h"
 #include "llcorehttprequest.h"
 #include "hbfastmap.h"
+#include "hbfastset.h"
 #include "llfoldertype.h"
 #include "llpermissionsflags.h"
 #include "llstring.h"
@@ -91,6 +92,62 @@ public:
 	virtual void changed(U32 mask) = 0;
 };
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryNameIndex
+//
+// Trigram index of the upper-cased names of inventory objects, used to find
+// all the objects which name contains a given sub-string without having to
+// scan every single object name.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+class LLInventoryNameIndex
+{
+public:
+	// Shortest searched sub-string the index can be used for.
+	static constexpr size_t MIN_SEARCH_LENGTH = 3;
+
+	void clear();
+
+	// Adds or updates the entry for object 'id'; 'upper_name' must be
+	// upper-cased with LLStringUtil::toUpper(). Returns false when the entry
+	// already existed with that same name.
+	bool insert(const LLUUID& id, const std::string& upper_name);
+
+	// Returns false when there was no entry for 'id'.
+	bool remove(const LLUUID& id);
+
+	// Fills 'matches' with the Ids of the objects which upper-cased name
+	// contains 'upper_str'. Returns false when the latter is too short for
+	// the index to be used, in which case 'matches' is left untouched.
+	bool find(const std::string& upper_str, uuid_list_t& matches) const;
+
+	LL_INLINE size_t size() const						{ return mSlots.size(); }
+
+private:
+	typedef U32 trigram_t;
+
+	LL_INLINE static trigram_t getTrigram(const char* str)
+	{
+		return ((trigram_t)(U8)str[0] << 16) | ((trigram_t)(U8)str[1] << 8) |
+			   (trigram_t)(U8)str[2];
+	}
+
+	void addPostings(U32 slot);
+	void removePostings(U32 slot);
+
+private:
+	// Object Id to slot number map.
+	fast_hmap<LLUUID, U32>					mSlots;
+	// Slot number indexed arrays.
+	std::vector<LLUUID>						mSlotIds;
+	std::vector<std::string>				mSlotNames;
+	// Slots freed by remove(), for reuse.
+	std::vector<U32>						mFreeSlots;
+	// Trigram to slots posting lists.
+	typedef fast_hset<U32> slots_set_t;
+	fast_hmap<trigram_t, slots_set_t>		mPostings;
+};
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // LLInventoryModel
 //
@@ -282,6 +339,34 @@ protected:
 	// preferred type. Returns LLUUID::null if not found
  	LLUUID findCatUUID(LLFolderType::EType preferred_type);
 
+	//--------------------------------------------------------------------
+	// Name search
+	//--------------------------------------------------------------------
+public:
+	// Fills 'matches' with the Ids of all the inventory objects which name,
+	// once upper-cased, contains 'upper_str'. Returns false when the name
+	// index cannot be used for this sub-string (too short), in which case the
+	// caller must fall back to a per-object search. The index is built on the
+	// first call and incrementally maintained afterwards.
+	bool findObjectsByName(const std::string& upper_str,
+						   uuid_list_t& matches);
+
+	// Incremented each time the set of indexed names changed, so that
+	// callers may cache the results of findObjectsByName().
+	U32 getNameIndexVersion();
+
+protected:
+	void flushNameIndex();
+
+	LL_INLINE void setNameIndexDirty(const LLUUID& id)
+	{
+		if (mNameIndexEnabled)
+		{
+			mNameIndexPending.emplace(id);
+		}
+	}
+
+public:
 	//--------------------------------------------------------------------
 	// Count
 	//--------------------------------------------------------------------
@@ -682,6 +767,13 @@ private:
 	U32											mModifyMask;
 	U32											mModifyMaskBacklog;
 
+	// Names index used by the inventory filters, and the Ids of the objects
+	// added, removed or changed since it was last brought up to date.
+	LLInventoryNameIndex						mNameIndex;
+	uuid_list_t									mNameIndexPending;
+	U32											mNameIndexVersion;
+	bool										mNameIndexEnabled;
+
 	// Used to handle an invalid inventory state
 	bool										mIsAgentInvUsable;
 
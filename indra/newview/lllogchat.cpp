@@ -33,11 +33,17 @@
 
 #include "llviewerprecompiledheaders.h"
 
+#include <memory>
+#include <set>
+
 #include "lllogchat.h"
 
+#include "llapp.h"
 #include "llcorehttputil.h"
 #include "lldir.h"
+#include "llmutex.h"
 #include "llsdutil.h"
+#include "llthreadpool.h"
 
 #include "llagent.h"
 #include "llfloaterim.h"
@@ -45,6 +51,244 @@
 #include "llmutelist.h"
 #include "llviewercontrol.h"
 
+// Each log file gets an index file, named after it with this extension
+// appended. The index is made of a header, followed with one record per line
+// of the log. It allows to seek directly to the N-th last line of the log.
+static const std::string LOG_INDEX_EXT = ".idx";
+
+constexpr U32 LOG_INDEX_MAGIC = 0x58444c43;	// "CLDX" in little endian
+constexpr U32 LOG_INDEX_VERSION = 1;
+
+struct LogIndexHeader
+{
+	U32	mMagic;
+	U32	mVersion;
+	// Size of the log file when last indexed: the index is only valid for as
+	// long as this matches the actual size of the log file (which could have
+	// been edited by the user, or appended to by another viewer).
+	U64	mIndexedSize;
+};
+
+struct LogIndexRecord
+{
+	U64	mOffset;	// Offset of the start of the line in the log file
+	U64	mTime;		// Grid time of the logging, or 0 when unknown
+};
+
+struct PendingLogLine
+{
+	LL_INLINE PendingLogLine(const std::string& filename,
+							 const std::string& line, time_t time)
+	:	mFilename(filename),
+		mLine(line),
+		mTime(time)
+	{
+	}
+
+	std::string	mFilename;
+	std::string	mLine;
+	time_t		mTime;
+};
+
+// Lines waiting to be written by the log writer thread.
+static LLMutex sPendingLinesMutex;
+static std::vector<PendingLogLine> sPendingLines;
+// Log files for which an index rebuild is queued.
+static std::set<std::string> sIndexRebuilds;
+// true when a writePendingLines() job is queued but not yet started.
+static bool sWriteQueued = false;
+// Held while appending to the log files or replacing their index, whatever
+// the thread. The writer thread takes it before grabbing the pending lines,
+// so that once the main thread holds it, any line not yet written is still
+// in sPendingLines.
+static LLMutex sLogFilesMutex;
+
+static std::unique_ptr<LLThreadPool> sWriterPool;
+static bool sWriterStopped = false;
+
+// Returns the thread pool to post the log writes to, or NULL when the writes
+// must be done synchronously (viewer shutting down).
+static LLThreadPool* get_writer_pool()
+{
+	if (!sWriterPool && !sWriterStopped && !LLApp::isExiting())
+	{
+		sWriterPool.reset(new LLThreadPool("Chat logs writer", 1));
+		sWriterPool->start();
+	}
+	return sWriterPool.get();
+}
+
+static bool read_index_header(LLFILE* fp, LogIndexHeader& header)
+{
+	return fp && !fseek(fp, 0, SEEK_SET) &&
+		   fread(&header, sizeof(LogIndexHeader), 1, fp) == 1 &&
+		   header.mMagic == LOG_INDEX_MAGIC &&
+		   header.mVersion == LOG_INDEX_VERSION;
+}
+
+static bool read_index_record(LLFILE* fp, U64 idx, LogIndexRecord& record)
+{
+	long pos = (long)(sizeof(LogIndexHeader) + idx * sizeof(LogIndexRecord));
+	return !fseek(fp, pos, SEEK_SET) &&
+		   fread(&record, sizeof(LogIndexRecord), 1, fp) == 1;
+}
+
+// (Re)builds the index for 'log_filename' by scanning the whole log file. The
+// time stamps of the lines are then unknown.
+static void rebuild_log_index(const std::string& log_filename)
+{
+	std::string index_filename = log_filename + LOG_INDEX_EXT;
+	LLFILE* in = LLFile::open(log_filename, "rb");
+	if (!in)
+	{
+		LLFile::remove(index_filename);
+		return;
+	}
+	std::string tmp_filename = index_filename + ".tmp";
+	LLFILE* out = LLFile::open(tmp_filename, "wb");
+	if (!out)
+	{
+		llwarns << "Could not write index file: " << tmp_filename << llendl;
+		LLFile::close(in);
+		return;
+	}
+
+	LogIndexHeader header;
+	header.mMagic = LOG_INDEX_MAGIC;
+	header.mVersion = LOG_INDEX_VERSION;
+	header.mIndexedSize = 0;
+	bool success = fwrite(&header, sizeof(LogIndexHeader), 1, out) == 1;
+
+	constexpr size_t BUFFER_SIZE = 65536;
+	std::vector<char> buffer(BUFFER_SIZE);
+	std::vector<LogIndexRecord> records;
+	records.reserve(BUFFER_SIZE / 16);
+	LogIndexRecord record;
+	record.mTime = 0;
+	bool line_start = true;
+	size_t read;
+	while (success &&
+		   (read = fread(buffer.data(), 1, BUFFER_SIZE, in)) > 0)
+	{
+		for (size_t i = 0; i < read; ++i)
+		{
+			if (line_start)
+			{
+				record.mOffset = header.mIndexedSize + i;
+				records.push_back(record);
+				line_start = false;
+			}
+			if (buffer[i] == '\n')
+			{
+				line_start = true;
+			}
+		}
+		header.mIndexedSize += read;
+		if (!records.empty())
+		{
+			success = fwrite(records.data(), sizeof(LogIndexRecord),
+							 records.size(), out) == records.size();
+			records.clear();
+		}
+	}
+	LLFile::close(in);
+
+	success = success && !fseek(out, 0, SEEK_SET) &&
+			  fwrite(&header, sizeof(LogIndexHeader), 1, out) == 1;
+	LLFile::close(out);
+	if (success)
+	{
+		// The log is scanned without holding sLogFilesMutex, since this may
+		// take a while: only use the new index when no line got appended to
+		// the log meanwhile.
+		LLMutexLock lock(&sLogFilesMutex);
+		if ((U64)LLFile::getFileSize(log_filename) != header.mIndexedSize)
+		{
+			LLFile::remove(tmp_filename);
+			return;
+		}
+		LLFile::remove(index_filename);
+		success = LLFile::rename(tmp_filename, index_filename);
+	}
+	if (!success)
+	{
+		llwarns << "Failed to build index file: " << index_filename
+				<< llendl;
+		LLFile::remove(tmp_filename);
+	}
+}
+
+// Appends the lines of 'batch' with indices in 'lines' to 'log_filename' and
+// updates the corresponding index. Called with sLogFilesMutex locked.
+static void append_log_lines(const std::string& log_filename,
+							 const std::vector<PendingLogLine>& batch,
+							 const std::vector<U32>& lines)
+{
+	LLFILE* fp = LLFile::open(log_filename, "a");
+	if (!fp)
+	{
+		llwarns << "Could not write into chat/IM history log file: "
+				<< log_filename << llendl;
+		return;
+	}
+	fseek(fp, 0, SEEK_END);
+	U64 old_size = (U64)ftell(fp);
+	std::vector<LogIndexRecord> records;
+	records.reserve(lines.size());
+	LogIndexRecord record;
+	for (U32 i = 0, count = lines.size(); i < count; ++i)
+	{
+		const PendingLogLine& line = batch[lines[i]];
+		record.mOffset = (U64)ftell(fp);
+		record.mTime = (U64)line.mTime;
+		records.push_back(record);
+		fprintf(fp, "%s\n", line.mLine.c_str());
+	}
+	U64 new_size = (U64)ftell(fp);
+	LLFile::close(fp);
+
+	std::string index_filename = log_filename + LOG_INDEX_EXT;
+	LogIndexHeader header;
+	fp = LLFile::open(index_filename, "r+b");
+	if (!fp && old_size == 0)
+	{
+		// New log file: create its index.
+		fp = LLFile::open(index_filename, "w+b");
+		header.mMagic = LOG_INDEX_MAGIC;
+		header.mVersion = LOG_INDEX_VERSION;
+		header.mIndexedSize = 0;
+	}
+	else if (!read_index_header(fp, header) ||
+			 header.mIndexedSize != old_size)
+	{
+		// Missing or stale index: rebuild it, including the new lines.
+		if (fp)
+		{
+			LLFile::close(fp);
+		}
+		rebuild_log_index(log_filename);
+		return;
+	}
+	if (!fp)
+	{
+		return;
+	}
+	header.mIndexedSize = new_size;
+	if (fseek(fp, 0, SEEK_END) ||
+		fwrite(records.data(), sizeof(LogIndexRecord), records.size(),
+			   fp) != records.size() ||
+		fseek(fp, 0, SEEK_SET) ||
+		fwrite(&header, sizeof(LogIndexHeader), 1, fp) != 1)
+	{
+		llwarns << "Failed to update index file: " << index_filename
+				<< llendl;
+		LLFile::close(fp);
+		LLFile::remove(index_filename);
+		return;
+	}
+	LLFile::close(fp);
+}
+
 //static
 std::string LLLogChat::timestamp(bool no_date, time_t ts)
 {
@@ -117,16 +361,219 @@ std::string LLLogChat::makeLogFileName(std::string filename)
 void LLLogChat::saveHistory(const std::string& filename,
 							const std::string& line)
 {
-	std::string log_filename = makeLogFileName(filename);
-	LLFILE* fp = LLFile::open(log_filename, "a");
-	if (!fp)
+	bool post_write;
+	{
+		LLMutexLock lock(&sPendingLinesMutex);
+		sPendingLines.emplace_back(makeLogFileName(filename), line,
+								   time_corrected());
+		post_write = !sWriteQueued;
+		sWriteQueued = true;
+	}
+	if (!post_write)
+	{
+		return;	// The already queued write job will take care of this line.
+	}
+
+	LLThreadPool* poolp = get_writer_pool();
+	if (!poolp || !poolp->getQueue().postIfOpen([]()
+												{
+													writePendingLines();
+												}))
+	{
+		// Writer thread gone (viewer shutting down): write now.
+		writePendingLines();
+	}
+}
+
+//static
+void LLLogChat::writePendingLines()
+{
+	LLMutexLock files_lock(&sLogFilesMutex);
+
+	std::vector<PendingLogLine> batch;
+	{
+		LLMutexLock lock(&sPendingLinesMutex);
+		batch.swap(sPendingLines);
+		sWriteQueued = false;
+	}
+	if (batch.empty())
 	{
-		llwarns << "Could not write into chat/IM history log file: "
-				<< log_filename << llendl;
 		return;
 	}
-	fprintf(fp, "%s\n", line.c_str());
-	LLFile::close (fp);
+
+	// Group the lines by log file, preserving their order, so that each file
+	// (and its index) only gets opened once per batch.
+	std::map<std::string, std::vector<U32> > lines_by_file;
+	for (U32 i = 0, count = batch.size(); i < count; ++i)
+	{
+		lines_by_file[batch[i].mFilename].push_back(i);
+	}
+	for (std::map<std::string, std::vector<U32> >::const_iterator
+			it = lines_by_file.begin(), end = lines_by_file.end();
+		 it != end; ++it)
+	{
+		append_log_lines(it->first, batch, it->second);
+	}
+}
+
+//static
+void LLLogChat::flushHistory(const std::string& log_filename)
+{
+	// This only waits for the writer thread when it is actually busy writing
+	// a batch of lines or replacing an index.
+	LLMutexLock files_lock(&sLogFilesMutex);
+
+	std::vector<PendingLogLine> lines;
+	{
+		LLMutexLock lock(&sPendingLinesMutex);
+		U32 kept = 0;
+		for (U32 i = 0, count = sPendingLines.size(); i < count; ++i)
+		{
+			PendingLogLine& line = sPendingLines[i];
+			if (line.mFilename == log_filename)
+			{
+				lines.emplace_back(std::move(line));
+			}
+			else if (kept++ != i)
+			{
+				sPendingLines[kept - 1] = std::move(line);
+			}
+		}
+		sPendingLines.erase(sPendingLines.begin() + kept, sPendingLines.end());
+	}
+	if (lines.empty())
+	{
+		return;
+	}
+
+	std::vector<U32> indices(lines.size());
+	for (U32 i = 0, count = indices.size(); i < count; ++i)
+	{
+		indices[i] = i;
+	}
+	append_log_lines(log_filename, lines, indices);
+}
+
+//static
+void LLLogChat::cleanupClass()
+{
+	sWriterStopped = true;
+	if (sWriterPool)
+	{
+		// This lets the writer thread process its queue before joining it.
+		sWriterPool->close();
+		sWriterPool.reset(nullptr);
+	}
+	writePendingLines();
+}
+
+//static
+bool LLLogChat::loadIndexedHistory(const std::string& log_filename,
+								   void (*callback)(S32, const LLSD&, void*),
+								   void* userdata)
+{
+	U64 log_size = (U64)LLFile::getFileSize(log_filename);
+	LLFILE* fp = LLFile::open(log_filename + LOG_INDEX_EXT, "rb");
+	if (!fp)
+	{
+		return false;
+	}
+	LogIndexHeader header;
+	U64 count = 0;
+	if (read_index_header(fp, header) && header.mIndexedSize == log_size &&
+		!fseek(fp, 0, SEEK_END))
+	{
+		count = ((U64)ftell(fp) - sizeof(LogIndexHeader)) /
+				sizeof(LogIndexRecord);
+	}
+	if (!count)
+	{
+		LLFile::close(fp);
+		return false;
+	}
+
+	// Find the first line to recall
+	U64 first = 0;
+	LogIndexRecord record;
+	U32 max_lines = gSavedPerAccountSettings.getU32("LogShowHistoryLines");
+	if (max_lines)
+	{
+		if (count > (U64)max_lines)
+		{
+			first = count - (U64)max_lines;
+		}
+	}
+	else
+	{
+		// Binary search for the first line such that it and all the next
+		// ones fit in the backlog size.
+		U64 max_size =
+			gSavedPerAccountSettings.getU32("LogShowHistoryMaxSize");
+		max_size = llmax(max_size, (U64)2) * 1024;
+		U64 low = 0;
+		U64 high = count - 1;	// At least the last line is shown.
+		while (low < high)
+		{
+			U64 mid = (low + high) / 2;
+			if (!read_index_record(fp, mid, record))
+			{
+				LLFile::close(fp);
+				return false;
+			}
+			if (log_size - record.mOffset <= max_size)
+			{
+				high = mid;
+			}
+			else
+			{
+				low = mid + 1;
+			}
+		}
+		first = low;
+	}
+	bool success = read_index_record(fp, first, record) &&
+				   record.mOffset < log_size;
+	LLFile::close(fp);
+	if (!success)
+	{
+		return false;
+	}
+
+	fp = LLFile::open(log_filename, "rb");
+	if (!fp)
+	{
+		return false;
+	}
+	std::string buffer;
+	buffer.resize(log_size - record.mOffset);
+	success = !fseek(fp, (long)record.mOffset, SEEK_SET) &&
+			  fread(&buffer[0], 1, buffer.size(), fp) == buffer.size();
+	LLFile::close(fp);
+	if (!success)
+	{
+		return false;
+	}
+
+	size_t start = 0;
+	size_t size = buffer.size();
+	while (start < size)
+	{
+		size_t end = buffer.find('\n', start);
+		if (end == std::string::npos)
+		{
+			end = size;
+		}
+		size_t len = end - start;
+		while (len && buffer[start + len - 1] == '\r')
+		{
+			--len;
+		}
+		callback(LOG_LINE, llsd::map("line", buffer.substr(start, len)),
+				 userdata);
+		start = end + 1;
+	}
+
+	return true;
 }
 
 //static
@@ -138,11 +585,41 @@ void LLLogChat::loadHistory(const std::string& filename,
 	// Inform the floater about the log file name to use.
 	callback(LOG_FILENAME, llsd::map("filename", log_filename), userdata);
 
+	// Any line still queued for this log must be written before we read it.
+	flushHistory(log_filename);
+
 	// For server messages timestamp comparisons; returns 0 for non-existent
 	// file. HB
 	time_t last_modified = LLFile::lastModidied(log_filename);
 
-	LLFILE* fp = last_modified ? LLFile::open(log_filename, "r") : NULL;
+	LLFILE* fp = NULL;
+	if (last_modified &&
+		!loadIndexedHistory(log_filename, callback, userdata))
+	{
+		fp = LLFile::open(log_filename, "r");
+		// Missing or stale index: rebuild it in the background, so that it
+		// can be used the next time.
+		LLThreadPool* poolp = fp ? get_writer_pool() : NULL;
+		if (poolp)
+		{
+			bool rebuild;
+			{
+				LLMutexLock lock(&sPendingLinesMutex);
+				rebuild = sIndexRebuilds.emplace(log_filename).second;
+			}
+			if (rebuild &&
+				!poolp->getQueue().postIfOpen([log_filename]()
+											  {
+												rebuild_log_index(log_filename);
+												LLMutexLock lock(&sPendingLinesMutex);
+												sIndexRebuilds.erase(log_filename);
+											  }))
+			{
+				LLMutexLock lock(&sPendingLinesMutex);
+				sIndexRebuilds.erase(log_filename);
+			}
+		}
+	}
 	if (fp)
 	{
 		U32 bsize = gSavedPerAccountSettings.getU32("LogShowHistoryMaxSize");
@@ -222,12 +699,13 @@ void LLLogChat::loadHistory(const std::string& filename,
 	// Fetch the server log asynchronously.
 	gCoros.launch("fetchHistoryCoro",
 				  boost::bind(&LLLogChat::fetchHistoryCoro, url, session_id,
-							  callback, last_modified));
+							  callback, log_filename, last_modified));
 }
 
 //static
 void LLLogChat::fetchHistoryCoro(const std::string& url, LLUUID session_id,
 								 void (*callback)(S32, const LLSD&, void*),
+								 std::string log_filename,
 								 time_t last_modified)
 {
 	LLSD query;
@@ -351,5 +829,8 @@ void LLLogChat::fetchHistoryCoro(const std::string& url, LLUUID session_id,
 		callback(LOG_SERVER, cbdata, userdata);
 	}
 
+	// Make sure the server log lines saved by the floater are written, since
+	// the latter checks for the log file existence on LOG_END.
+	flushHistory(log_filename);
 	callback(LOG_END, LLSD(), userdata);
 }
@@ -68,15 +68,39 @@ public:
 
 	static std::string makeLogFileName(std::string filename);
 
+	// Queues 'line' for appending to the log. The lines are written in
+	// batches by a dedicated thread, which also maintains a line-offsets and
+	// time stamps index alongside each (plain text) log file.
 	static void saveHistory(const std::string& filename,
 							const std::string& line);
+
+	// Loads the last lines of the log. When the latter got an up to date
+	// index, exactly the last LogShowHistoryLines lines (or as many full
+	// lines as fit in LogShowHistoryMaxSize when the former is 0) are read,
+	// else we fall back to reading the tail of the file, and the index gets
+	// (re)built in the background.
 	static void loadHistory(const std::string& filename,
 		                    void (*callback)(S32, const LLSD&, void*),
 							void* userdata,
 							const LLUUID& session_id = LLUUID::null);
+
+	// Writes any line still queued for 'log_filename' (a full path, as
+	// returned by makeLogFileName()), from the calling thread.
+	static void flushHistory(const std::string& log_filename);
+
+	// Writes any pending line and stops the writer thread. Called on viewer
+	// shutdown; saveHistory() writes synchronously after this call.
+	static void cleanupClass();
+
 private:
+	static bool loadIndexedHistory(const std::string& log_filename,
+								   void (*callback)(S32, const LLSD&, void*),
+								   void* userdata);
+	static void writePendingLines();
+
 	static void fetchHistoryCoro(const std::string& url, LLUUID session_id,
 								 void (*callback)(S32, const LLSD&, void*),
+								 std::string log_filename,
 								 time_t last_modified);
 };
 
@@ -619,65 +619,25 @@ bool LLMeshCostData::init(const LLSD& header)
 {
 	LL_TRACY_TIMER(TRC_MESH_COST_INIT);
 
-	S32 bytes_lowest = 0;
-	if (header.has("lowest_lod"))
-	{
-		bytes_lowest = header["lowest_lod"]["size"].asInteger();
-	}
-
-	S32 bytes_low = 0;
-	if (header.has("low_lod"))
-	{
-		bytes_low = header["low_lod"]["size"].asInteger();
-	}
-
-	S32 bytes_med = 0;
-	if (header.has("medium_lod"))
-	{
-		bytes_med = header["medium_lod"]["size"].asInteger();
-	}
-
-	S32 bytes_high = 0;
-	if (header.has("high_lod"))
-	{
-		bytes_high = header["high_lod"]["size"].asInteger();
-	}
-
-	return init(bytes_lowest, bytes_low, bytes_med, bytes_high);
+	S32 sizes[4];
+	LLMeshCost::getLODSizes(header, sizes);
+	return init(sizes[0], sizes[1], sizes[2], sizes[3]);
 }
 
 bool LLMeshCostData::init(S32 bytes_lowest, S32 bytes_low, S32 bytes_med,
 						  S32 bytes_high)
 {
-	if (bytes_high <= 0)
-	{
-		bytes_high = llmax(0, bytes_med, bytes_low, bytes_lowest);
-	}
-	if (bytes_high == 0)
+	S32* sizes = mSizeByLOD.data();
+	sizes[0] = bytes_lowest;
+	sizes[1] = bytes_low;
+	sizes[2] = bytes_med;
+	sizes[3] = bytes_high;
+	if (!LLMeshCost::fillLODSizes(sizes))
 	{
 		return false;
 	}
-	mSizeByLOD[3] = bytes_high;
 
-	if (bytes_med <= 0)
-	{
-		bytes_med = bytes_high;
-	}
-	mSizeByLOD[2] = bytes_med;
-
-	if (bytes_low <= 0)
-	{
-		bytes_low = bytes_med;
-	}
-	mSizeByLOD[1] = bytes_low;
-
-	if (bytes_lowest <= 0)
-	{
-		bytes_lowest = bytes_low;
-	}
-	mSizeByLOD[0] = bytes_lowest;
-
-	mSizeTotal = bytes_high + bytes_med + bytes_low + bytes_lowest;
+	mSizeTotal = sizes[0] + sizes[1] + sizes[2] + sizes[3];
 
 	static LLCachedControl<U32> discount(gSavedSettings,
 										 "MeshMetaDataDiscount");
@@ -685,23 +645,9 @@ bool LLMeshCostData::init(S32 bytes_lowest, S32 bytes_low, S32 bytes_med,
 										 "MeshMinimumByteSize");
 	static LLCachedControl<U32> tri_bytes(gSavedSettings,
 										  "MeshBytesPerTriangle");
-	F32 max = 0.f;
-	F32 bytes_per_tri = (F32)tri_bytes;
-	for (S32 i = 0; i < 4; ++i)
-	{
-		S32 size = mSizeByLOD[i] - discount;
-		if (size < (S32)min_size)
-		{
-			size = min_size;
-		}
-		F32 tris = (F32)size / bytes_per_tri;
-		if (tris > max)
-		{
-			max = tris;
-		}
-		mEstTrisByLOD[i] = tris;
-	}
-	mEstTrisMax = max;
+	mEstTrisMax = LLMeshCost::estimateTrisByLOD(sizes, mEstTrisByLOD.data(),
+												(S32)discount, (S32)min_size,
+												(F32)tri_bytes);
 
 	mChargedTris = -1.f;
 
@@ -710,65 +656,14 @@ bool LLMeshCostData::init(S32 bytes_lowest, S32 bytes_low, S32 bytes_med,
 
 F32 LLMeshCostData::getRadiusWeightedTris(F32 radius)
 {
-	constexpr F32 MAX_DISTANCE = 512.f;
-	constexpr F32 K1 = 1.f / 0.03f;
-	constexpr F32 K2 = 1.f / 0.06f;
-	constexpr F32 K3 = 1.f / 0.24f;
-	F32 dlowest = llmin(radius * K1, MAX_DISTANCE);
-	F32 dlow = llmin(radius * K2, MAX_DISTANCE);
-	F32 dmid = llmin(radius * K3, MAX_DISTANCE);
-
-	// Area of a circle that encompasses region (see MAINT-6559):
-	constexpr F32 MAX_AREA = 102944.f;
-	constexpr F32 MIN_AREA = 1.f;
-
-	F32 high_area = llmin(F_PI * dmid * dmid, MAX_AREA);
-	F32 mid_area = llmin(F_PI * dlow * dlow, MAX_AREA);
-	F32 low_area = llmin(F_PI * dlowest * dlowest, MAX_AREA);
-	F32 lowest_area = MAX_AREA;
-
-	lowest_area -= low_area;
-	low_area -= mid_area;
-	mid_area -= high_area;
-
-	high_area = llclamp(high_area, MIN_AREA, MAX_AREA);
-	mid_area = llclamp(mid_area, MIN_AREA, MAX_AREA);
-	low_area = llclamp(low_area, MIN_AREA, MAX_AREA);
-	lowest_area = llclamp(lowest_area, MIN_AREA, MAX_AREA);
-
-	F32 inv_total_area = 1.f / (high_area + mid_area + low_area + lowest_area);
-	high_area *= inv_total_area;
-	mid_area *= inv_total_area;
-	low_area *= inv_total_area;
-	lowest_area *= inv_total_area;
-
-	return mEstTrisByLOD[3] * high_area + mEstTrisByLOD[2] * mid_area +
-		   mEstTrisByLOD[1] * low_area + mEstTrisByLOD[0] * lowest_area;
+	return LLMeshCost::getRadiusWeightedTris(mEstTrisByLOD.data(), radius);
 }
 
 F32 LLMeshCostData::getEstTrisForStreamingCost()
 {
 	if (mChargedTris < 0.f)
 	{
-		mChargedTris = mEstTrisByLOD[3];
-		F32 allowed_tris = mChargedTris;
-		constexpr F32 ENFORCE_FLOOR = 64.f;
-		for (S32 i = 2; i >= 0; --i)
-		{
-			// How many tris can we have in this LOD without affecting land
-			// impact ?
-			// - normally a LOD should be at most half the size of the previous
-			//   one
-			// - once we reach a floor of ENFORCE_FLOOR, do not require LODs to
-			//   get any smaller.
-			allowed_tris = llclamp(allowed_tris * 0.5f, ENFORCE_FLOOR,
-								   mEstTrisByLOD[i]);
-			F32 excess_tris = mEstTrisByLOD[i] - allowed_tris;
-			if (excess_tris > 0.f)
-			{
-				mChargedTris += excess_tris;
-			}
-		}
+		mChargedTris = LLMeshCost::getChargedTris(mEstTrisByLOD.data());
 	}
 	return mChargedTris;
 }
@@ -778,16 +673,16 @@ F32 LLMeshCostData::getRadiusBasedStreamingCost(F32 radius)
 	LL_TRACY_TIMER(TRC_MESH_COST_RADIUS);
 
 	static LLCachedControl<U32> budget(gSavedSettings, "MeshTriangleBudget");
-	F32 triangle_budget = budget > 0 ? (F32)budget : 250000.f;
-	return getRadiusWeightedTris(radius) * 15000.f / triangle_budget;
+	F32 triangle_budget = budget > 0 ? (F32)budget : MESH_COST_TRIANGLE_BUDGET;
+	return LLMeshCost::getRadiusBasedCost(mEstTrisByLOD.data(), radius,
+										  triangle_budget);
 }
 
 F32 LLMeshCostData::getTriangleBasedStreamingCost()
 {
 	LL_TRACY_TIMER(TRC_MESH_COST_TRI);
 
-	return ANIMATED_OBJECT_COST_PER_KTRI * 0.001f *
-		   getEstTrisForStreamingCost();
+	return LLMeshCost::getTriangleBasedCost(getEstTrisForStreamingCost());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
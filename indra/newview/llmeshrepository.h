@@ -52,6 +52,7 @@
 #include "hbfastmap.h"
 #include "hbfastset.h"
 #include "llhandle.h"
+#include "llmeshcost.h"
 #include "llmodel.h"
 #include "llmutex.h"
 #include "llthread.h"
@@ -871,6 +872,5 @@ namespace std
 extern void dump_llsd_to_file(const LLSD& data, const std::string& filename);
 
 constexpr F32 ANIMATED_OBJECT_BASE_COST = 15.f;
-constexpr F32 ANIMATED_OBJECT_COST_PER_KTRI = 1.5f;
 
 #endif
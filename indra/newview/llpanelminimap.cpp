@@ -57,6 +57,7 @@
 #include "llrender.h"
 #include "lltextbox.h"
 #include "lluictrlfactory.h"
+#include "llworkqueue.h"
 
 #include "llagent.h"
 #include "llagentpilot.h"
@@ -97,6 +98,15 @@ constexpr F32 DOT_SCALE = 0.75f;
 constexpr F32 MIN_PICK_SCALE = 2.f;
 // How far the mouse needs to move before we think it is a drag:
 constexpr S32 MOUSE_DRAG_SLOP = 2;
+// The object layer is split into OBJECT_TILES_PER_SIDE x OBJECT_TILES_PER_SIDE
+// tiles, so that a U64 may hold one dirty bit per tile.
+constexpr S32 OBJECT_TILES_PER_SIDE = 8;
+static_assert(OBJECT_TILES_PER_SIDE * OBJECT_TILES_PER_SIDE == 64,
+			  "One bit per object layer tile in a U64");
+constexpr U64 ALL_OBJECT_TILES = ~U64(0);
+// Minimum number of footprints to re-draw for the job to be worth posting to
+// the general threads pool.
+constexpr size_t MIN_THREADED_STAMPS = 256;
 
 bool LLPanelMiniMap::sMiniMapRotate = true;
 S32 LLPanelMiniMap::sMiniMapCenter = 1;
@@ -111,9 +121,17 @@ LLPanelMiniMap::LLPanelMiniMap(const std::string& name)
 	mNorthEastLabel(NULL),
 	mSouthWestLabel(NULL),
 	mSouthEastLabel(NULL),
+	mDirtyObjectTiles(0),
+	mObjectStampsPass(0),
+	mObjectLayerGeneration(0),
+	mObjectLayerWidth(0),
+	mObjectLayerStampsTPM(0.f),
+	mObjectTilesJobPending(false),
 	mScale(128.f),
 	mObjectMapTPM(1.f),
 	mObjectMapPixels(255.f),
+	mObjectLayerTPM(1.f),
+	mObjectLayerPixels(255.f),
 	mTargetPanX(0.f),
 	mTargetPanY(0.f),
 	mCurPanX(0.f),
@@ -247,6 +265,12 @@ void LLPanelMiniMap::setScale(F32 scale)
 		F32 num_pixels = (F32)mObjectImagep->getWidth();
 		mObjectMapTPM = num_pixels / meters;
 		mObjectMapPixels = diameter;
+		// The object layer center gets snapped to the tiles grid, i.e. by up
+		// to half a tile in each direction: add this as a margin around it.
+		constexpr F32 margin_factor = F32(OBJECT_TILES_PER_SIDE - 1) /
+									  F32(OBJECT_TILES_PER_SIDE);
+		mObjectLayerTPM = mObjectMapTPM * margin_factor;
+		mObjectLayerPixels = mObjectMapPixels / margin_factor;
 	}
 
 	mPixelsPerMeter = mScale / region_width;
@@ -447,6 +471,10 @@ void LLPanelMiniMap::draw()
 				last_redraw = gFrameTimeSeconds;
 				updateObjectImage(pos_center);
 			}
+			if (mDirtyObjectTiles && !mObjectTilesJobPending)
+			{
+				rasterizeObjectTiles();
+			}
 
 			LLVector3 map_center_agent =
 				gAgent.getPosAgentFromGlobal(mObjectImageCenterGlobal);
@@ -456,8 +484,8 @@ void LLPanelMiniMap::draw()
 
 			unit0->bind(mObjectImagep);
 
-			const F32 image_half_width = 0.5f * mObjectMapPixels;
-			const F32 image_half_height = 0.5f * mObjectMapPixels;
+			const F32 image_half_width = 0.5f * mObjectLayerPixels;
+			const F32 image_half_height = 0.5f * mObjectLayerPixels;
 			gGL.begin(LLRender::TRIANGLES);
 			gGL.texCoord2f(0.f, 1.f);
 			gGL.vertex2f(agent_x - image_half_width,
@@ -1031,9 +1059,9 @@ void LLPanelMiniMap::updateMinorDirections()
 	mSouthWestLabel->setVisible(show_minors);
 }
 
-void LLPanelMiniMap::renderScaledPointGlobal(const LLVector3d& pos,
-											 const LLColor4U& color,
-											 F32 radius_meters)
+void LLPanelMiniMap::plotObject(const LLViewerObject* objectp,
+								const LLVector3d& pos, const LLColor4U& color,
+								F32 radius_meters)
 {
 	static LLCachedControl<F32> max_radius(gSavedSettings,
 										   "MiniMapPrimMaxRadius");
@@ -1044,90 +1072,108 @@ void LLPanelMiniMap::renderScaledPointGlobal(const LLVector3d& pos,
 	{
 		radius_meters = max_radius;
 	}
-	S32 diameter_pixels = ll_roundp(2 * radius_meters * mObjectMapTPM);
-
-	LLVector3 local_pos;
-	local_pos.set(pos - mObjectImageCenterGlobal);
-
-	renderPoint(local_pos, color, diameter_pixels);
-}
-
-void LLPanelMiniMap::renderPoint(const LLVector3& pos_local,
-								 const LLColor4U& color,
-								 S32 diameter, S32 relative_height)
-{
+	S32 diameter = ll_roundp(2 * radius_meters * mObjectLayerTPM);
 	if (diameter <= 0)
 	{
 		return;
 	}
 
-	const S32 image_width = (S32)mObjectImagep->getWidth();
-	S32 x_offset = ll_round(pos_local.mV[VX] * mObjectMapTPM +
-							image_width / 2);
-	if (x_offset < 0 || x_offset >= image_width)
+	const S32 half_width = mObjectLayerWidth / 2;
+	S32 x = ll_round(F32(pos.mdV[VX] - mObjectLayerCenter.mdV[VX]) *
+					 mObjectLayerTPM) + half_width;
+	if (x < 0 || x >= mObjectLayerWidth)
 	{
+		// Not plotted during this pass: any former footprint of this object
+		// will get erased by updateObjectImage().
 		return;
 	}
-
-	const S32 image_height = (S32)mObjectImagep->getHeight();
-	S32 y_offset = ll_round(pos_local.mV[VY] * mObjectMapTPM +
-							image_height / 2);
-	if (y_offset < 0 || y_offset >= image_height)
+	S32 y = ll_round(F32(pos.mdV[VY] - mObjectLayerCenter.mdV[VY]) *
+					 mObjectLayerTPM) + half_width;
+	if (y < 0 || y >= mObjectLayerWidth)
 	{
 		return;
 	}
 
-	U8* datap = mObjectRawImagep->getData();
+	ObjectStamp& stamp = mObjectStamps[objectp];
+	stamp.mPass = mObjectStampsPass;
+
+	U32 rgba = color.asRGBA();
+	if (stamp.mX == x && stamp.mY == y && stamp.mDiameter == diameter &&
+		stamp.mColor == rgba)
+	{
+		return;	// Unchanged
+	}
+
+	// New or changed footprint: both the old and new covered tiles need to be
+	// re-drawn.
+	mDirtyObjectTiles |= stamp.mTiles;
 
+	stamp.mX = x;
+	stamp.mY = y;
+	stamp.mDiameter = diameter;
+	stamp.mColor = rgba;
+
+	const S32 tile_size = mObjectLayerWidth / OBJECT_TILES_PER_SIDE;
 	S32 neg_radius = diameter / 2;
 	S32 pos_radius = diameter - neg_radius;
-	S32 x, y;
-
-	if (relative_height > 0)
+	S32 tx0 = llmax(x - neg_radius, 0) / tile_size;
+	S32 tx1 = llmin(x + pos_radius - 1, mObjectLayerWidth - 1) / tile_size;
+	S32 ty0 = llmax(y - neg_radius, 0) / tile_size;
+	S32 ty1 = llmin(y + pos_radius - 1, mObjectLayerWidth - 1) / tile_size;
+	stamp.mTiles = 0;
+	for (S32 ty = ty0; ty <= ty1; ++ty)
 	{
-		// Point above agent
-		S32 px, py;
-
-		// Vertical line
-		px = x_offset;
-		for (y = -neg_radius; y < pos_radius; ++y)
+		for (S32 tx = tx0; tx <= tx1; ++tx)
 		{
-			py = y_offset + y;
-			if (py >= 0 && py < image_height)
-			{
-				S32 offset = px + py * image_width;
-				((U32*)datap)[offset] = color.asRGBA();
-			}
+			stamp.mTiles |= U64(1) << (ty * OBJECT_TILES_PER_SIDE + tx);
 		}
+	}
+
+	mDirtyObjectTiles |= stamp.mTiles;
+}
 
-		// Top line
-		py = y_offset + pos_radius - 1;
-		for (x = -neg_radius; x < pos_radius; ++x)
+// Clears the 'tiles' of the 'width' pixels wide RGBA 'pixels' layer and draws
+// in them the (parts of the) footprints overlapping them. Only ever touches
+// the passed data, so that it may run on a worker thread.
+//static
+void LLPanelMiniMap::rasterizeTiles(U32* pixels, S32 width, U64 tiles,
+									const stamps_vec_t& stamps)
+{
+	const S32 tile_size = width / OBJECT_TILES_PER_SIDE;
+	for (S32 ty = 0; ty < OBJECT_TILES_PER_SIDE; ++ty)
+	{
+		for (S32 tx = 0; tx < OBJECT_TILES_PER_SIDE; ++tx)
 		{
-			px = x_offset + x;
-			if (px >= 0 && px < image_width)
+			if (tiles & (U64(1) << (ty * OBJECT_TILES_PER_SIDE + tx)))
 			{
-				S32 offset = px + py * image_width;
-				((U32*)datap)[offset] = color.asRGBA();
+				U32* datap = pixels + ty * tile_size * width + tx * tile_size;
+				for (S32 y = 0; y < tile_size; ++y)
+				{
+					memset((void*)datap, 0, tile_size * sizeof(U32));
+					datap += width;
+				}
 			}
 		}
 	}
-	else
+
+	for (size_t i = 0, count = stamps.size(); i < count; ++i)
 	{
-		// Point level with agent
-		for (x = -neg_radius; x < pos_radius; ++x)
+		const ObjectStamp& stamp = stamps[i];
+		S32 neg_radius = stamp.mDiameter / 2;
+		S32 pos_radius = stamp.mDiameter - neg_radius;
+		S32 x0 = llmax(stamp.mX - neg_radius, 0);
+		S32 x1 = llmin(stamp.mX + pos_radius, width);
+		S32 y0 = llmax(stamp.mY - neg_radius, 0);
+		S32 y1 = llmin(stamp.mY + pos_radius, width);
+		for (S32 y = y0; y < y1; ++y)
 		{
-			S32 p_x = x_offset + x;
-			if (p_x > 0 && p_x < image_width)
+			U32* rowp = pixels + y * width;
+			S32 tile_row = (y / tile_size) * OBJECT_TILES_PER_SIDE;
+			for (S32 x = x0; x < x1; ++x)
 			{
-				for (y = -neg_radius; y < pos_radius; ++y)
+				if (tiles & (U64(1) << (tile_row + x / tile_size)))
 				{
-					S32 p_y = y_offset + y;
-					if (p_y >= 0 && p_y < image_height)
-					{
-						S32 offset = p_x + p_y * image_width;
-						((U32*)datap)[offset] = color.asRGBA();
-					}
+					rowp[x] = stamp.mColor;
 				}
 			}
 		}
@@ -1204,24 +1250,207 @@ void LLPanelMiniMap::createParcelImage()
 void LLPanelMiniMap::updateObjectImage(const LLVector3d& pos_center_global)
 {
 	mUpdateObjectImage = false;
-	mObjectImageCenterGlobal = pos_center_global;
 
-	// Create the base texture.
-	S32 img_width = mObjectImagep->getWidth();
-	S32 img_height = mObjectImagep->getHeight();
-	U8* default_texture = mObjectRawImagep->getData();
-	memset((void*)default_texture, 0,
-		   img_width * img_height * mObjectImagep->getComponents());
+	// Snap the layer center to the tiles grid, so that the layer only needs a
+	// full re-draw when the camera moved by a tile or more, or when the scale
+	// changed. Otherwise, only the tiles covered by footprints that changed
+	// since the last pass get re-drawn.
+	const S32 img_width = mObjectRawImagep->getWidth();
+	const F64 tile_meters = F64(img_width / OBJECT_TILES_PER_SIDE) /
+							F64(mObjectLayerTPM);
+	LLVector3d center;
+	center.mdV[VX] = floor(pos_center_global.mdV[VX] / tile_meters + 0.5) *
+					 tile_meters;
+	center.mdV[VY] = floor(pos_center_global.mdV[VY] / tile_meters + 0.5) *
+					 tile_meters;
+	center.mdV[VZ] = pos_center_global.mdV[VZ];
+	if (img_width != mObjectLayerWidth ||
+		mObjectLayerTPM != mObjectLayerStampsTPM ||
+		center.mdV[VX] != mObjectLayerCenter.mdV[VX] ||
+		center.mdV[VY] != mObjectLayerCenter.mdV[VY])
+	{
+		resetObjectLayer(center, img_width);
+	}
 
 	// Clear the cached positions for pathfinding characters and physical
 	// objects since they will be re-filled by the renderObjectsForMap()
 	// method. HB
 	mPathfindingCharsPos.clear();
 	mPhysicalObjectsPos.clear();
-	// Draw objects
+	// Plot objects
+	++mObjectStampsPass;
 	gObjectList.renderObjectsForMap(this);
 
-	mObjectImagep->setSubImage(mObjectRawImagep, 0, 0, img_width, img_height);
+	// Erase the footprints of the objects which were not plotted during this
+	// pass (killed, removed from the map objects list, gone out of the layer
+	// bounds or now plotted by the mini-map code itself).
+	std::vector<const LLViewerObject*> gone;
+	for (stamps_map_t::const_iterator it = mObjectStamps.begin(),
+									  end = mObjectStamps.end();
+		 it != end; ++it)
+	{
+		if (it->second.mPass != mObjectStampsPass)
+		{
+			mDirtyObjectTiles |= it->second.mTiles;
+			gone.push_back(it->first);
+		}
+	}
+	for (size_t i = 0, count = gone.size(); i < count; ++i)
+	{
+		mObjectStamps.erase(gone[i]);
+	}
+}
+
+void LLPanelMiniMap::resetObjectLayer(const LLVector3d& center, S32 width)
+{
+	// Unique among all mini-map instances, so that a job result cannot get
+	// applied to the wrong layer.
+	static U32 last_generation = 0;
+	mObjectLayerGeneration = ++last_generation;
+
+	mObjectLayerCenter = center;
+	mObjectLayerWidth = width;
+	mObjectLayerStampsTPM = mObjectLayerTPM;
+	mObjectStamps.clear();
+	mDirtyObjectTiles = ALL_OBJECT_TILES;
+}
+
+void LLPanelMiniMap::rasterizeObjectTiles()
+{
+	std::shared_ptr<ObjectTilesJob> job = std::make_shared<ObjectTilesJob>();
+	job->mCenter = mObjectLayerCenter;
+	job->mTiles = mDirtyObjectTiles;
+	job->mGeneration = mObjectLayerGeneration;
+	job->mWidth = mObjectLayerWidth;
+	mDirtyObjectTiles = 0;
+
+	// Collect the footprints overlapping the dirty tiles
+	for (stamps_map_t::const_iterator it = mObjectStamps.begin(),
+									  end = mObjectStamps.end();
+		 it != end; ++it)
+	{
+		if (it->second.mTiles & job->mTiles)
+		{
+			job->mStamps.push_back(it->second);
+		}
+	}
+
+	// Large jobs (typically full layer re-draws) are rasterized on the general
+	// threads pool; the result gets applied on the main thread, and until then
+	// the former layer keeps being displayed at its former position.
+	if (gMainloopWorkp && job->mStamps.size() >= MIN_THREADED_STAMPS)
+	{
+		static LLWorkQueue::weak_t general_queue =
+			LLWorkQueue::getNamedInstance("General");
+		LLHandle<LLPanel> handle = getHandle();
+		mObjectTilesJobPending = true;
+		if (gMainloopWorkp->postTo(general_queue,
+								   // Work done on general queue
+								   [job]()
+								   {
+										job->mPixels.resize(job->mWidth *
+															job->mWidth);
+										rasterizeTiles(job->mPixels.data(),
+													   job->mWidth,
+													   job->mTiles,
+													   job->mStamps);
+										return job;
+								   },
+								   // Callback to main thread
+								   [handle](std::shared_ptr<ObjectTilesJob> job)
+								   {
+										LLPanelMiniMap* self =
+											(LLPanelMiniMap*)handle.get();
+										if (self)
+										{
+											self->applyObjectTiles(*job);
+										}
+								   }))
+		{
+			return;
+		}
+		mObjectTilesJobPending = false;
+	}
+
+	rasterizeTiles((U32*)mObjectRawImagep->getData(), job->mWidth,
+				   job->mTiles, job->mStamps);
+	uploadObjectTiles(job->mTiles);
+	mObjectImageCenterGlobal = job->mCenter;
+}
+
+void LLPanelMiniMap::applyObjectTiles(const ObjectTilesJob& job)
+{
+	mObjectTilesJobPending = false;
+
+	if (job.mGeneration != mObjectLayerGeneration ||
+		mObjectRawImagep.isNull() || mObjectImagep.isNull() ||
+		mObjectRawImagep->getWidth() != job.mWidth)
+	{
+		// Stale result: the layer got reset meanwhile, and all its tiles have
+		// been flagged dirty again.
+		return;
+	}
+
+	// Copy the re-drawn tiles into the layer raw image
+	const S32 width = job.mWidth;
+	const S32 tile_size = width / OBJECT_TILES_PER_SIDE;
+	U32* datap = (U32*)mObjectRawImagep->getData();
+	for (S32 ty = 0; ty < OBJECT_TILES_PER_SIDE; ++ty)
+	{
+		for (S32 tx = 0; tx < OBJECT_TILES_PER_SIDE; ++tx)
+		{
+			if (job.mTiles & (U64(1) << (ty * OBJECT_TILES_PER_SIDE + tx)))
+			{
+				S32 offset = ty * tile_size * width + tx * tile_size;
+				for (S32 y = 0; y < tile_size; ++y)
+				{
+					memcpy((void*)(datap + offset),
+						   (const void*)(job.mPixels.data() + offset),
+						   tile_size * sizeof(U32));
+					offset += width;
+				}
+			}
+		}
+	}
+
+	uploadObjectTiles(job.mTiles);
+	mObjectImageCenterGlobal = job.mCenter;
+}
+
+void LLPanelMiniMap::uploadObjectTiles(U64 tiles)
+{
+	const S32 width = mObjectRawImagep->getWidth();
+	if (tiles == ALL_OBJECT_TILES)
+	{
+		mObjectImagep->setSubImage(mObjectRawImagep, 0, 0, width, width);
+		return;
+	}
+
+	// Upload each run of consecutive dirty tiles in a tiles row at once
+	const S32 tile_size = width / OBJECT_TILES_PER_SIDE;
+	for (S32 ty = 0; ty < OBJECT_TILES_PER_SIDE; ++ty)
+	{
+		S32 tx = 0;
+		while (tx < OBJECT_TILES_PER_SIDE)
+		{
+			S32 bit = ty * OBJECT_TILES_PER_SIDE + tx;
+			if (!(tiles & (U64(1) << bit)))
+			{
+				++tx;
+				continue;
+			}
+			S32 run = 1;
+			while (tx + run < OBJECT_TILES_PER_SIDE &&
+				   (tiles & (U64(1) << (bit + run))))
+			{
+				++run;
+			}
+			mObjectImagep->setSubImage(mObjectRawImagep, tx * tile_size,
+									   ty * tile_size, run * tile_size,
+									   tile_size);
+			tx += run;
+		}
+	}
 }
 
 void LLPanelMiniMap::updateParcelImage(const LLVector3d& pos_center_global,
@@ -50,6 +50,7 @@
 #ifndef LL_LLPANELMINIMAP_H
 #define LL_LLPANELMINIMAP_H
 
+#include "hbfastmap.h"
 #include "llimage.h"
 #include "llmemberlistener.h"
 #include "llpanel.h"
@@ -58,6 +59,7 @@
 #include "llcolor4.h"
 
 class LLTextBox;
+class LLViewerObject;
 class LLViewerTexture;
 class LLViewerRegion;
 
@@ -91,8 +93,12 @@ public:
 	bool handleScrollWheel(S32 x, S32 y, S32 clicks) override;
 	bool handleToolTip(S32 x, S32 y, std::string& msg, LLRect* rect) override;
 
-	void renderScaledPointGlobal(const LLVector3d& pos, const LLColor4U& color,
-								 F32 radius);
+	// Called by LLViewerObjectList::renderObjectsForMap() for each object to
+	// plot on the object layer. The object footprint is compared with the
+	// one it got on the previous layer update, and only the tiles covered by
+	// new, moved, resized or recoloured objects get flagged for re-drawing.
+	void plotObject(const LLViewerObject* objectp, const LLVector3d& pos,
+					const LLColor4U& color, F32 radius);
 
 	LL_INLINE void addPathFindingCharacter(const LLVector3d& global_pos)
 	{
@@ -109,8 +115,6 @@ private:
 
 	LL_INLINE void setPan(F32 x, F32 y)		{ mTargetPanX = x; mTargetPanY = y; }
 
-	void renderPoint(const LLVector3 &pos, const LLColor4U& color,
-					 S32 diameter, S32 relative_height = 0);
 	LLVector3 globalPosToView(const LLVector3d& glob_pos, bool rotated) const;
 	LLVector3d viewPosToGlobal(S32 x,S32 y, bool rotated) const;
 
@@ -130,6 +134,9 @@ private:
 	void createParcelImage();
 
 	void updateObjectImage(const LLVector3d& pos_center_global);
+	void resetObjectLayer(const LLVector3d& center, S32 width);
+	void rasterizeObjectTiles();
+	void uploadObjectTiles(U64 tiles);
 
 	void updateParcelImage(const LLVector3d& pos_center_global, LLColor4U c);
 	void renderParcelBorders(const LLViewerRegion* regionp, const LLColor4U& c,
@@ -384,6 +391,57 @@ private:
 	objs_pos_vec_t				mPathfindingCharsPos;
 	objs_pos_vec_t				mPhysicalObjectsPos;
 
+	// Footprint of an object on the object layer, in layer pixels.
+	struct ObjectStamp
+	{
+		LL_INLINE ObjectStamp()
+		:	mX(-1),
+			mY(-1),
+			mDiameter(0),
+			mColor(0),
+			mPass(0),
+			mTiles(0)
+		{
+		}
+
+		S32	mX;
+		S32	mY;
+		S32	mDiameter;
+		U32	mColor;
+		// Layer update pass during which the object was last plotted
+		U32	mPass;
+		// Bit mask of the layer tiles covered by the footprint
+		U64	mTiles;
+	};
+	typedef std::vector<ObjectStamp> stamps_vec_t;
+	typedef flat_hmap<const LLViewerObject*, ObjectStamp> stamps_map_t;
+	stamps_map_t				mObjectStamps;
+
+	// Tiles re-rasterization job, possibly done on a worker thread.
+	struct ObjectTilesJob
+	{
+		LLVector3d				mCenter;
+		stamps_vec_t			mStamps;
+		std::vector<U32>		mPixels;
+		U64						mTiles;
+		U32						mGeneration;
+		S32						mWidth;
+	};
+	static void rasterizeTiles(U32* pixels, S32 width, U64 tiles,
+							   const stamps_vec_t& stamps);
+	void applyObjectTiles(const ObjectTilesJob& job);
+
+	// Tiles-grid aligned center of the object layer the stamps are relative
+	// to; mObjectImageCenterGlobal is the center of the layer as currently
+	// uploaded to mObjectImagep.
+	LLVector3d					mObjectLayerCenter;
+	U64							mDirtyObjectTiles;
+	U32							mObjectStampsPass;
+	U32							mObjectLayerGeneration;
+	S32							mObjectLayerWidth;
+	F32							mObjectLayerStampsTPM;
+	bool						mObjectTilesJobPending;
+
 	LLUUID						mClosestAgentToCursor;
 	LLUUID						mClosestAgentAtLastRightClick;
 
@@ -402,6 +460,11 @@ private:
 	F32							mObjectMapTPM;
 	// Width of object map in pixels
 	F32							mObjectMapPixels;
+	// Same as above, for the object layer, which coverage includes a half
+	// tile margin on each side to allow snapping its center to the tiles
+	// grid.
+	F32							mObjectLayerTPM;
+	F32							mObjectLayerPixels;
 	F32							mDotRadius;			// Size of avatar markers
 	F32							mTargetPanX;
 	F32							mTargetPanY;
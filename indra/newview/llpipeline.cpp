@@ -2044,7 +2044,8 @@ void LLPipeline::createGLBuffers()
 {
 	updateRenderDeferred();
 
-	U32 res = llmax(gSavedSettings.getU32("RenderWaterRefResolution"), 512);
+	U32 res = llmax(gSavedSettings.getU32(LL_CONTROL("RenderWaterRefResolution")),
+					512U);
 	if (!gUsePBRShaders)
 	{
 		// Water reflection texture
@@ -2062,7 +2063,8 @@ void LLPipeline::createGLBuffers()
 	GLuint res_y = gViewerWindowp->getWindowDisplayHeight();
 
 	// Screen space glow buffers
-	U32 glow_pow = gSavedSettings.getU32("RenderGlowResolutionPow");
+	U32 glow_pow =
+		gSavedSettings.getU32(LL_CONTROL("RenderGlowResolutionPow"));
 	// Limited between 16 and 512
 	const U32 glow_res = 1 << llclamp(glow_pow, 4U, 9U);
 
@@ -2093,7 +2095,8 @@ void LLPipeline::createGLBuffers()
 		constexpr U32 noise_res = 128;
 		LLVector3 noise[noise_res * noise_res];
 
-		F32 scaler = gSavedSettings.getF32("RenderDeferredNoise") / 100.f;
+		F32 scaler =
+			gSavedSettings.getF32(LL_CONTROL("RenderDeferredNoise")) / 100.f;
 		for (U32 i = 0; i < noise_res * noise_res; ++i)
 		{
 			noise[i].set(ll_frand() - 0.5f, ll_frand() - 0.5f, 0.f);
@@ -61,6 +61,7 @@
 LLColor4U MAX_WATER_COLOR(0, 48, 96, 240);
 
 U32 LLSurface::sTextureSize = 256;
+U32 LLSurface::sLastPatchDataGeneration = 0;
 S32 LLSurface::sTexelsUpdated = 0;
 F32 LLSurface::sTextureUpdateTime = 0.f;
 LLStat LLSurface::sTexelsUpdatedPerSecStat;
@@ -97,6 +98,8 @@ LLSurface::LLSurface(U32 type, LLViewerRegion* regionp)
 	mNorm(NULL),
 	mPatchList(NULL),
 	mVisiblePatchCount(0),
+	mDecodeSerial(0),
+	mPatchDataGeneration(0),
 	mHasZData(false),
 	mMinZ(10000.f),
 	mMaxZ(-10000.f),
@@ -807,13 +810,28 @@ void LLSurface::idleUpdate(F32 max_update_time)
 void LLSurface::decompressDCTPatch(LLBitPack& bitpack, LLGroupHeader* gopp,
 								   bool large_patch)
 {
+	decoded_patches_t patches;
+	decodeDCTPatches(bitpack, gopp->patch_size, large_patch, mPatchesPerEdge,
+					 patches);
+	applyDecodedPatches(patches, mPatchDataGeneration, getNextDecodeSerial());
+}
+
+//static
+bool LLSurface::decodeDCTPatches(LLBitPack& bitpack, S32 patch_size,
+								 bool large_patch, S32 patches_per_edge,
+								 decoded_patches_t& patches)
+{
+	if (patch_size != NORMAL_PATCH_SIZE && patch_size != LARGE_PATCH_SIZE)
+	{
+		llwarns << "Received invalid terrain packet: patch size = "
+				<< patch_size << llendl;
+		return false;
+	}
+
+	LLPatchDecompressor decompressor(patch_size);
 	LLPatchHeader ph;
 	S32 patch[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
 
-	init_patch_decompressor(gopp->patch_size);
-	gopp->stride = mGridsPerEdge;
-	set_group_of_patch_header(gopp);
-
 	while (true)
 	{
 		// Variable region size support via large_patch
@@ -836,10 +854,10 @@ void LLSurface::decompressDCTPatch(LLBitPack& bitpack, LLGroupHeader* gopp,
 			j = ph.patchids & 0x1F;		// y
 		}
 
-		if (i >= mPatchesPerEdge || j >= mPatchesPerEdge)
+		if (i >= patches_per_edge || j >= patches_per_edge)
 		{
 			llwarns << "Received invalid terrain packet: patch header incorrect !  Patches per edge = "
-					<< mPatchesPerEdge << " - i = " << i << " - j = " << j
+					<< patches_per_edge << " - i = " << i << " - j = " << j
 					<< " - dc_offset = " << ph.dc_offset << " - range = "
 					<< (S32)ph.range << " - quant_wbits = "
 					<< (S32)ph.quant_wbits << " patchids = "
@@ -847,14 +865,65 @@ void LLSurface::decompressDCTPatch(LLBitPack& bitpack, LLGroupHeader* gopp,
 #if 0		// Do not disconnect any more: just ignore the bogus packet.
             gAppViewerp->badNetworkHandler();
 #endif
-			return;
+			return false;
+		}
+
+		decode_patch(bitpack, patch);
+
+		patches.emplace_back();
+		DecodedPatch& decoded = patches.back();
+		decoded.mX = i;
+		decoded.mY = j;
+		decoded.mSize = patch_size;
+		decoded.mHeights.resize(patch_size * patch_size);
+		decompressor.decompress(decoded.mHeights.data(), patch_size, patch,
+								&ph);
+	}
+
+	return true;
+}
+
+void LLSurface::applyDecodedPatches(const decoded_patches_t& patches,
+									U32 generation, U32 serial)
+{
+	if (generation != mPatchDataGeneration)
+	{
+		// The patches got destroyed or re-created since the decoding got
+		// queued: this data is stale.
+		return;
+	}
+
+	for (U32 k = 0, count = patches.size(); k < count; ++k)
+	{
+		const DecodedPatch& decoded = patches[k];
+		S32 i = decoded.mX;
+		S32 j = decoded.mY;
+		if (i >= mPatchesPerEdge || j >= mPatchesPerEdge)
+		{
+			// The surface got re-created with a different size meanwhile...
+			continue;
+		}
+
+		U32 index = j * mPatchesPerEdge + i;
+		if (mPatchSerials[index] > serial)
+		{
+			// We already got newer data for this patch.
+			continue;
 		}
+		mPatchSerials[index] = serial;
 
-		LLSurfacePatch* patchp = &mPatchList[j * mPatchesPerEdge + i];
+		LLSurfacePatch* patchp = &mPatchList[index];
 		if (!patchp) break;	// Paranoia
 
-		decode_patch(bitpack, patch);
-		decompress_patch(patchp->getDataZ(), patch, &ph);
+		S32 size = llmin(decoded.mSize, mGridsPerEdge);
+		F32* dataz = patchp->getDataZ();
+		const F32* heights = decoded.mHeights.data();
+		for (S32 y = 0; y < size; ++y)
+		{
+			memcpy((void*)(dataz + y * mGridsPerEdge),
+				   (const void*)(heights + y * decoded.mSize),
+				   size * sizeof(F32));
+		}
 
 		// Update edges for neighbors. We need to guarantee that this gets done
 		// before we generate vertical stats.
@@ -1115,6 +1184,9 @@ void LLSurface::createPatchData()
 
 	// Allocate memory
 	mPatchList = new LLSurfacePatch[mNumberOfPatches];
+	mPatchSerials.clear();
+	mPatchSerials.resize(mNumberOfPatches, 0);
+	mPatchDataGeneration = ++sLastPatchDataGeneration;
 
 	// One of each for each camera
 	mVisiblePatchCount = mNumberOfPatches;
@@ -1239,6 +1311,8 @@ void LLSurface::destroyPatchData()
 	// Delete all of the cached patch data for these patches.
 	delete[] mPatchList;
 	mPatchList = NULL;
+	mPatchSerials.clear();
+	mPatchDataGeneration = 0;
 	mVisiblePatchCount = 0;
 }
 
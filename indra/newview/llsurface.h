@@ -34,6 +34,7 @@
 #define LL_LLSURFACE_H
 
 #include <list>
+#include <vector>
 
 #include "llvector3.h"
 #include "llvector3d.h"
@@ -96,6 +97,36 @@ public:
 
 	void decompressDCTPatch(LLBitPack& bitpack, LLGroupHeader* gopp,
 							bool large_patch);
+
+	// Heights of a terrain patch, as decoded from a LayerData packet.
+	struct DecodedPatch
+	{
+		S32					mX;
+		S32					mY;
+		S32					mSize;		// Grids per patch edge
+		std::vector<F32>	mHeights;	// mSize * mSize heights
+	};
+	typedef std::vector<DecodedPatch> decoded_patches_t;
+
+	// Decodes all the DCT patches in 'bitpack' (positioned after the group
+	// header) into 'patches'. This does not touch any surface, thus may be
+	// called from any thread. Returns false on bogus data, in which case
+	// 'patches' only contains the patches decoded before the error.
+	static bool decodeDCTPatches(LLBitPack& bitpack, S32 patch_size,
+								 bool large_patch, S32 patches_per_edge,
+								 decoded_patches_t& patches);
+	// Copies the decoded heights into this surface patches and updates their
+	// edges and statistics. Must be called from the main thread. 'generation'
+	// and 'serial' are the values returned by getPatchDataGeneration() and
+	// getNextDecodeSerial() when the packet got queued for decoding: data
+	// decoded for patches since destroyed or re-created is dropped, and older
+	// data never overwrites newer data for a patch, even when decoded out of
+	// order.
+	void applyDecodedPatches(const decoded_patches_t& patches, U32 generation,
+							 U32 serial);
+	LL_INLINE U32 getNextDecodeSerial()					{ return ++mDecodeSerial; }
+	LL_INLINE U32 getPatchDataGeneration() const		{ return mPatchDataGeneration; }
+
 	void updatePatchVisibilities();
 
 	LL_INLINE F32 getZ(U32 k) const						{ return mSurfaceZ[k]; }
@@ -215,6 +246,9 @@ private:
 
 	// Default size of the surface texture
 	static U32					sTextureSize;
+	// Last generation given to a surface patch data, unique across all the
+	// surfaces of the session.
+	static U32					sLastPatchDataGeneration;
 
 protected:
 	LLVector3d					mOriginGlobal;	// In absolute frame
@@ -257,6 +291,13 @@ protected:
 	// Min and max Z for this region (during the session)
 	F32							mMinZ;
 	F32							mMaxZ;
+	// Serial number of the last packet queued for decoding, and serial of
+	// the last decoded data applied to each patch.
+	U32							mDecodeSerial;
+	std::vector<U32>			mPatchSerials;
+	// Changes each time the patch data is created or destroyed (0 when there
+	// is none).
+	U32							mPatchDataGeneration;
 	// Wether or not we have received any patch data for this surface:
 	bool						mHasZData;
 };
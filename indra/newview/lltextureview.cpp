@@ -477,6 +477,10 @@ void LLGLTexMemBar::draw()
 		text += llformat(" (%d)",
 						 LLViewerFetchedTexture::sImageThreadQueueSize);
 	}
+	text += llformat(" - Uploads: %dKB/frame (%dKB staged) - Stalls: %.1fms",
+					 LLImageGL::sLastFrameUploadBytes / 1024,
+					 LLImageGL::sLastFrameStagedBytes / 1024,
+					 LLImageGL::sLastFrameStallTime);
 
 	fontp->renderUTF8(text, 0, 0, line_height * 2, text_color, LLFontGL::LEFT,
 					  LLFontGL::TOP);
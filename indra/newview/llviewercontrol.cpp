@@ -272,6 +272,12 @@ static bool handleRenderGLImageSyncInThread(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleRenderGLUploadStagingChanged(const LLSD& newvalue)
+{
+	LLImageGL::setUploadStagingSize(newvalue.asInteger());
+	return true;
+}
+
 static bool handleGLBufferChanged(const LLSD& newvalue)
 {
 	LLPipeline::refreshCachedSettings();
@@ -1118,6 +1124,7 @@ void settings_setup_listeners()
 	add_listener("RenderDeferredAAQuality", handleGLBufferChanged);
 	add_listener("RenderDeferredDisplayGamma", handleSetShaderChanged);
 	add_listener("RenderGLImageSyncInThread", handleRenderGLImageSyncInThread);
+	add_listener("RenderGLUploadStagingMB", handleRenderGLUploadStagingChanged);
 	add_listener("RenderGlow", handleGLBufferChanged);
 	add_listener("RenderGlowResolutionPow", handleGLBufferChanged);
 	add_listener("RenderHideGroupTitle", handleHideGroupTitleChanged);
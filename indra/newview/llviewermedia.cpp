@@ -618,6 +618,13 @@ void LLViewerMedia::updateMedia(void*)
 	static LLCachedControl<bool> plugin_use_read_thread(gSavedSettings,
 														"PluginUseReadThread");
 	LLPluginProcessParent::setUseReadThread(plugin_use_read_thread);
+	// Message framing and frame buffering modes for the plugins
+	static LLCachedControl<bool> binary_framing(gSavedSettings,
+												"PluginBinaryFraming");
+	LLPluginProcessParent::setUseBinaryFraming(binary_framing);
+	static LLCachedControl<bool> double_buffered(gSavedSettings,
+												 "PluginDoubleBufferedFrames");
+	LLPluginClassMedia::setDoubleBufferedFrames(double_buffered);
 
 	impl_list::iterator iter = sViewerMediaImplList.begin();
 	impl_list::iterator end = sViewerMediaImplList.end();
@@ -3198,6 +3205,10 @@ void LLViewerMediaImpl::update()
 								   [=]()	// Callback to main thread
 								   {
 										mTextureUpdatePending = false;
+										if (mMediaSource)
+										{
+											mMediaSource->releaseFrame();
+										}
 										media_tex->unref();
 										unref();
 								   }))
@@ -3216,6 +3227,7 @@ void LLViewerMediaImpl::update()
 		doMediaTexUpdate(media_tex, data, data_width, data_height, x_pos,
 						 y_pos, width, height, false);
 	}
+	mMediaSource->releaseFrame();
 }
 
 bool LLViewerMediaImpl::preMediaTexUpdate(LLViewerMediaTexture*& media_tex,
@@ -3253,7 +3265,8 @@ bool LLViewerMediaImpl::preMediaTexUpdate(LLViewerMediaTexture*& media_tex,
 			if (width > 0 && height > 0)
 			{
 				LL_FAST_TIMER(FTM_MEDIA_GET_DATA);
-				data = mMediaSource->getBitsData();
+				// Keep the plugin from overwriting this frame till uploaded
+				data = mMediaSource->acquireFrame();
 				data_width = mMediaSource->getWidth();
 				data_height = mMediaSource->getHeight();
 				// This will be true when data is ready to be copied to GL
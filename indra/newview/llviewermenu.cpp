@@ -130,6 +130,7 @@
 #include "llfloatergroupinvite.h"
 #include "llfloatergroups.h"
 #include "hbfloatergrouptitles.h"
+#include "llfloateridlescheduler.h"
 #include "llfloaterimagepreview.h"
 #include "llfloaterinspect.h"
 #include "llfloaterinventory.h"
@@ -220,6 +221,7 @@
 #include "llviewerobjectlist.h"
 #include "llviewerparcelmgr.h"
 #include "llviewerparceloverlay.h"
+#include "llviewerpartsim.h"
 #include "llviewerregion.h"
 #include "llviewerstats.h"
 #include "llviewertexturelist.h"		// For gTextureList
@@ -492,6 +494,11 @@ void handle_debug_tags(void*)
 	HBFloaterDebugTags::showInstance();
 }
 
+void handle_idle_scheduler(void*)
+{
+	LLFloaterIdleScheduler::showInstance();
+}
+
 void update_upload_costs_in_menus()
 {
 	if (!gMenuHolderp) return;
@@ -746,6 +753,32 @@ bool tracy_not_connected(void*)
 }
 #endif
 
+#if LL_FAST_TIMERS_ENABLED
+void handle_dump_allocations(void*)
+{
+	std::string filename = llformat("allocations_%u.csv", gFrameCount);
+	filename = gDirUtilp->getFullPath(LL_PATH_LOGS, filename);
+	LLFastTimerView::dumpAllocations(filename);
+}
+
+bool enable_dump_allocations(void*)
+{
+	return LLMemory::allocProfiling();
+}
+#endif
+
+#if LL_TRACE_CAPTURE
+void handle_dump_trace_capture(void*)
+{
+	dump_trace_capture("manual");
+}
+
+bool enable_dump_trace_capture(void*)
+{
+	return LLTraceCapture::enabled();
+}
+#endif
+
 void handle_show_notifications_console(void*)
 {
 	LLFloaterNotificationConsole::showInstance();
@@ -946,6 +979,28 @@ void handle_viewer_toggle_message_log(void*)
 	}
 }
 
+static U32 sControlLookupsStartFrame = 0;
+
+bool check_count_control_lookups(void*)
+{
+	return LLControlGroup::sCountStringLookups;
+}
+
+void handle_toggle_count_control_lookups(void*)
+{
+	if (LLControlGroup::sCountStringLookups)
+	{
+		LLControlGroup::sCountStringLookups = false;
+		gSavedSettings.dumpStringLookups(gFrameCount -
+										 sControlLookupsStartFrame);
+	}
+	else
+	{
+		sControlLookupsStartFrame = gFrameCount;
+		LLControlGroup::sCountStringLookups = true;
+	}
+}
+
 void save_settings_to_xml_callback(HBFileSelector::ESaveFilter filter,
 								   std::string& filename,
 								   void* user_data)
@@ -1136,6 +1191,13 @@ bool http2_checked(void*)
 }
 #endif
 
+void handle_http_benchmark(void*)
+{
+	LLAppCoreHttp::runBenchmark(gSavedSettings.getString("HttpBenchmarkURL"),
+								gSavedSettings.getU32("HttpBenchmarkRequests"),
+								gSavedSettings.getU32("HttpBenchmarkRangeSize"));
+}
+
 void restart_audio_engine(void*)
 {
 	gSavedSettings.setBool("NoAudio", false);
@@ -1294,12 +1356,27 @@ void init_debug_console_menu(LLMenuGL* sub)
 									   menu_toggle_control, NULL,
 									   menu_check_control,
 									   (void*)"FastTimersAlwaysEnabled"));
+	sub->append(new LLMenuItemCheckGL("Allocation profiling",
+									  menu_toggle_control, NULL,
+									  menu_check_control,
+									  (void*)"AllocationProfiling"));
+	sub->append(new LLMenuItemCallGL("Dump allocations profile (CSV)",
+									 handle_dump_allocations,
+									 enable_dump_allocations, NULL));
 #endif
 #if TRACY_ENABLE
 	sub->append(new LLMenuItemCallGL("Launch Tracy profiler",
 									  handle_tracy_profiler,
 									  tracy_not_connected, NULL,
 									  '8', MASK_CONTROL|MASK_SHIFT));
+#endif
+#if LL_TRACE_CAPTURE
+	sub->append(new LLMenuItemCheckGL("Trace capture", menu_toggle_control,
+									  NULL, menu_check_control,
+									  (void*)"TraceCapture"));
+	sub->append(new LLMenuItemCallGL("Dump trace capture",
+									 handle_dump_trace_capture,
+									 enable_dump_trace_capture, NULL));
 #endif
 	sub->appendSeparator();
 
@@ -1314,6 +1391,8 @@ void init_debug_console_menu(LLMenuGL* sub)
 									  menu_check_control,
 									  (void*)"PreciseLogTimestamps"));
 	sub->append(new LLMenuItemCallGL("Debug tags", handle_debug_tags, NULL));
+	sub->append(new LLMenuItemCallGL("Idle tasks scheduler",
+									 handle_idle_scheduler, NULL));
 
 	LLMenuGL* sub2 = new LLMenuGL("Info to debug console");
 	sub->appendMenu(sub2);
@@ -1344,6 +1423,9 @@ void init_debug_console_menu(LLMenuGL* sub)
 	sub2->append(new LLMenuItemCheckGL("Server UDP messages (spammy)",
 				 &handle_viewer_toggle_message_log, NULL,
 				 &check_message_logging, NULL));
+	sub2->append(new LLMenuItemCheckGL("Settings lookups by name",
+				 &handle_toggle_count_control_lookups, NULL,
+				 &check_count_control_lookups, NULL));
 	sub2->append(new LLMenuItemCallGL("Stale images list", dump_stale_images));
 	sub2->createJumpKeys();
 
@@ -1503,6 +1585,16 @@ void init_network_menu(LLMenuGL* sub)
 									  menu_toggle_control, NULL,
 									  menu_check_control,
 									  (void*)"HttpRangeRequestsDisable"));
+	sub->append(new LLMenuItemCheckGL("Event-driven HTTP service loop",
+									  menu_toggle_control, NULL,
+									  menu_check_control,
+									  (void*)"HttpEventDrivenLoop"));
+	sub->append(new LLMenuItemCheckGL("HTTP/2 multiplexing for textures and meshes",
+									  menu_toggle_control, NULL,
+									  menu_check_control,
+									  (void*)"HttpHTTP2Multiplexing"));
+	sub->append(new LLMenuItemCallGL("HTTP benchmark (local server)",
+									 handle_http_benchmark));
 
 	sub->appendSeparator();
 
@@ -2803,6 +2895,12 @@ void schedule_objects_visibility_refresh(U32 type)
 					llmin((F32)delay, 10.f));
 }
 
+void handle_particles_benchmark(void*)
+{
+	gViewerPartSim.runBenchmark(gSavedSettings.getU32("ParticlesBenchmarkSources"),
+								gSavedSettings.getF32("ParticlesBenchmarkSeconds"));
+}
+
 bool vb_cache_check_control(void*)
 {
 	static LLCachedControl<bool> vbcache(gSavedSettings, "RenderGLUseVBCache");
@@ -3261,6 +3359,8 @@ void init_debug_rendering_menu(LLMenuGL* menu)
 									   menu_toggle_attached_particles, NULL,
 									   menu_check_control,
 									   (void*)"RenderAttachedParticles"));
+	menu->append(new LLMenuItemCallGL("Particles benchmark",
+									  handle_particles_benchmark));
 	menu->createJumpKeys();
 }
 
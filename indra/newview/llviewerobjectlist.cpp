@@ -1959,7 +1959,7 @@ void LLViewerObjectList::renderObjectsForMap(LLPanelMiniMap* map)
 			color = below_water_color;
 		}
 
-		map->renderScaledPointGlobal(pos, color, approx_radius);
+		map->plotObject(objectp, pos, color, approx_radius);
 	}
 }
 
@@ -50,7 +50,7 @@
 #include "llviewerobjectlist.h"
 #include "llviewerpartsource.h"
 #include "llviewerregion.h"
-#include "llvoavatar.h"
+#include "llvoavatarself.h"
 #include "llvopartgroup.h"
 #include "llvovolume.h"
 #include "llworld.h"
@@ -72,6 +72,103 @@ S32 LLViewerPartSim::sParticleCount2 = 0;
 F32 LLViewerPartSim::sParticleAdaptiveRate = 0.0625f;
 F32 LLViewerPartSim::sParticleBurstRate = 0.5f;
 
+///////////////////////////////////////////////////////////////////////////////
+// LLViewerPartPool class
+///////////////////////////////////////////////////////////////////////////////
+
+// Pool of fixed-size slots for LLViewerPart instances, allocated by chunks of
+// contiguous memory and recycled via a free list, which avoids the heap
+// allocation cost of individual particles (particle-heavy sims create and
+// destroy thousands of them per second) and keeps them close in memory. Only
+// used from the main thread.
+// Note: particles are not stored as structures of arrays, because ribbon
+// particles, particle sources and the particle callbacks all hold pointers to
+// individual particles, which must therefore stay at a fixed address for
+// their whole life.
+class LLViewerPartPool
+{
+protected:
+	LOG_CLASS(LLViewerPartPool);
+
+public:
+	LLViewerPartPool() = default;
+
+	void* allocate()
+	{
+		if (!mFreeList)
+		{
+			grow();
+		}
+		FreeSlot* slotp = mFreeList;
+		mFreeList = slotp->mNext;
+		++mUsedSlots;
+		return slotp;
+	}
+
+	LL_INLINE void free(void* ptr)
+	{
+		FreeSlot* slotp = (FreeSlot*)ptr;
+		slotp->mNext = mFreeList;
+		mFreeList = slotp;
+		--mUsedSlots;
+	}
+
+	// Releases all the chunks, provided no particle is still alive. Called
+	// from LLViewerPartSim::cleanupClass(). There is no destructor releasing
+	// the chunks, since we must not log anything on static destruction.
+	void cleanup()
+	{
+		if (mUsedSlots)
+		{
+			llwarns << mUsedSlots
+					<< " particles still allocated, cannot free the pool."
+					<< llendl;
+			return;
+		}
+		for (U32 i = 0, count = mChunks.size(); i < count; ++i)
+		{
+			ll_aligned_free_16(mChunks[i]);
+		}
+		mChunks.clear();
+		mFreeList = NULL;
+	}
+
+private:
+	void grow()
+	{
+		U8* chunkp = (U8*)ll_aligned_malloc_16(SLOT_SIZE * SLOTS_PER_CHUNK);
+		if (!chunkp)
+		{
+			LLMemory::allocationFailed(SLOT_SIZE * SLOTS_PER_CHUNK);
+			throw std::bad_alloc();
+		}
+		mChunks.push_back(chunkp);
+		// Chain the slots in address order, so that successive allocations
+		// are contiguous in memory.
+		for (S32 i = SLOTS_PER_CHUNK - 1; i >= 0; --i)
+		{
+			FreeSlot* slotp = (FreeSlot*)(chunkp + i * SLOT_SIZE);
+			slotp->mNext = mFreeList;
+			mFreeList = slotp;
+		}
+	}
+
+private:
+	struct FreeSlot
+	{
+		FreeSlot* mNext;
+	};
+
+	std::vector<void*>	mChunks;
+	FreeSlot*			mFreeList = NULL;
+	U32					mUsedSlots = 0;
+
+	static constexpr size_t SLOT_SIZE = (sizeof(LLViewerPart) + 15) & ~15;
+	static constexpr U32 SLOTS_PER_CHUNK = 256;
+};
+
+static LLViewerPartPool sViewerPartPool;
+
 F32 calc_desired_size(LLVector3 pos, LLVector2 scale)
 {
 	F32 desired_size = (pos - gViewerCamera.getOrigin()).length() * 0.25f;
@@ -122,6 +219,20 @@ LLViewerPart::~LLViewerPart()
 #endif
 }
 
+void* LLViewerPart::operator new(size_t size)
+{
+	llassert(size == sizeof(LLViewerPart));
+	return sViewerPartPool.allocate();
+}
+
+void LLViewerPart::operator delete(void* ptr) noexcept
+{
+	if (ptr)
+	{
+		sViewerPartPool.free(ptr);
+	}
+}
+
 void LLViewerPart::init(LLPointer<LLViewerPartSource> sourcep,
 						LLViewerTexture* imagep, LLVPCallback cb)
 {
@@ -294,8 +405,6 @@ void LLViewerPartGroup::updateParticles(F32 lastdt)
 {
 	F32 dt;
 
-	LLVector3 gravity(0.f, 0.f, GRAVITY);
-
 #if LL_DEBUG
 	LLViewerPartSim::checkParticleCount(mParticles.size());
 #endif
@@ -392,12 +501,14 @@ void LLViewerPartGroup::updateParticles(F32 lastdt)
 		// Do color interpolation
 		if (part->mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
 		{
-			part->mColor.set(part->mStartColor);
-			// Note: LLColor4's v%k means multiply-alpha-only,
-			//       LLColor4's v*k means multiply-rgb-only
-			part->mColor *= 1.f - frac; // rgb*k
-			part->mColor %= 1.f - frac; // alpha*k
-			part->mColor += frac % (frac * part->mEndColor); // rgb,alpha
+			// color = start * (1 - frac) + end * frac, on all 4 components
+			LLVector4a start_color, end_color;
+			start_color.loadua(part->mStartColor.mV);
+			end_color.loadua(part->mEndColor.mV);
+			start_color.mul(1.f - frac);
+			end_color.mul(frac);
+			start_color.add(end_color);
+			part->mColor.set(start_color.getF32ptr());
 		}
 
 		// Do scale interpolation
@@ -519,6 +630,8 @@ void LLViewerPartSim::cleanupClass()
 	llinfos << "Destroying all particle sources..." << llendl;
 	mViewerPartSources.clear();
 
+	sViewerPartPool.cleanup();
+
 	llinfos << "Particles destroyed." << llendl;
 }
 
@@ -1068,3 +1181,98 @@ void LLViewerPartSim::clearParticlesByRootObjectID(const LLUUID& object_id)
 		}
 	}
 }
+
+void LLViewerPartSim::runBenchmark(U32 sources, F32 seconds)
+{
+	if (!sources || seconds <= 0.f || !isAgentAvatarValid())
+	{
+		return;
+	}
+
+	llinfos << "Benchmarking " << sources << " particle sources over "
+			<< seconds << " seconds of simulated time..." << llendl;
+
+	// A fairly demanding particle system: wind, bounce, and color and scale
+	// interpolations.
+	LLPartSysData params;
+	params.mPattern = LLPartSysData::LL_PART_SRC_PATTERN_EXPLODE;
+	params.mBurstRate = 0.05f;
+	params.mBurstPartCount = 20;
+	params.mBurstRadius = 0.5f;
+	params.mBurstSpeedMin = 0.5f;
+	params.mBurstSpeedMax = 2.f;
+	params.mPartAccel.set(0.f, 0.f, -1.f);
+	params.mPartData.mFlags = LLPartData::LL_PART_INTERP_COLOR_MASK |
+							  LLPartData::LL_PART_INTERP_SCALE_MASK |
+							  LLPartData::LL_PART_WIND_MASK |
+							  LLPartData::LL_PART_BOUNCE_MASK |
+							  LLPartData::LL_PART_EMISSIVE_MASK;
+	params.mPartData.mMaxAge = 5.f;
+	params.mPartData.setStartColor(LLVector3(1.f, 0.5f, 0.f));
+	params.mPartData.setEndColor(LLVector3(0.f, 0.5f, 1.f));
+	params.mPartData.setStartAlpha(1.f);
+	params.mPartData.setEndAlpha(0.f);
+	params.mPartData.setStartScale(0.2f, 0.2f);
+	params.mPartData.setEndScale(0.5f, 0.5f);
+
+	std::vector<LLPointer<LLViewerPartSourceScript> > bench_sources;
+	bench_sources.reserve(sources);
+	for (U32 i = 0; i < sources; ++i)
+	{
+		LLPointer<LLViewerPartSourceScript> pssp =
+			LLViewerPartSourceScript::createPSS(gAgentAvatarp, params);
+		pssp->setStart();
+		bench_sources.emplace_back(pssp);
+	}
+
+	constexpr F32 STEP = 1.f / 60.f;
+	U32 steps = llmax(1U, (U32)(seconds / STEP));
+	F64 sources_time = 0.0;
+	F64 groups_time = 0.0;
+	U64 parts_total = 0;
+	S32 parts_max = 0;
+	LLTimer timer;
+	for (U32 step = 0; step < steps; ++step)
+	{
+		timer.reset();
+		for (U32 i = 0; i < sources; ++i)
+		{
+			bench_sources[i]->update(STEP);
+		}
+		sources_time += timer.getElapsedTimeF64();
+
+		timer.reset();
+		for (S32 i = 0, count = mViewerPartGroups.size(); i < count; ++i)
+		{
+			LLViewerPartGroup* pgroup = mViewerPartGroups[i];
+			pgroup->updateParticles(STEP);
+			pgroup->mSkippedTime = 0.f;
+			if (!pgroup->getCount())
+			{
+				delete pgroup;
+				mViewerPartGroups[i--] = mViewerPartGroups.back();
+				mViewerPartGroups.pop_back();
+				--count;
+			}
+		}
+		groups_time += timer.getElapsedTimeF64();
+
+		parts_total += sParticleCount;
+		parts_max = llmax(parts_max, sParticleCount);
+	}
+
+	// Kill the benchmark particles; they will be removed on next simulation
+	// update.
+	for (U32 i = 0; i < sources; ++i)
+	{
+		clearParticlesByID(bench_sources[i]->getID());
+		bench_sources[i]->setDead();
+	}
+
+	F64 per_step = 1000.0 / (F64)steps;
+	llinfos << "Steps: " << steps << " - Average particles: "
+			<< parts_total / steps << " - Max particles: " << parts_max
+			<< " - Sources update: " << sources_time * per_step
+			<< "ms/step - Particles update: " << groups_time * per_step
+			<< "ms/step" << llendl;
+}
@@ -51,12 +51,17 @@ typedef void (*LLVPCallback)(LLViewerPart& part, F32 dt);
 // An individual particle
 //
 
-class LLViewerPart : public LLPartData
+class LLViewerPart final : public LLPartData
 {
 public:
 	LLViewerPart();
 	~LLViewerPart();
 
+	// Particles are allocated from a pool of fixed-size slots held in
+	// contiguous chunks, instead of individually on the heap.
+	void* operator new(size_t size);
+	void operator delete(void* ptr) noexcept;
+
 	void init(LLPointer<LLViewerPartSource> sourcep, LLViewerTexture* imagep,
 			  LLVPCallback cb);
 
@@ -178,6 +183,13 @@ public:
 	void clearParticlesByRootObjectID(const LLUUID& object_id);
 	void removeLastCreatedSource();
 
+	// In-viewer benchmark, started from the Advanced -> Rendering menu: it
+	// needs a logged-in agent avatar to attach the particle sources to. It
+	// creates 'sources' particle sources and drives them (and their
+	// particles) synchronously for 'seconds' of simulated time at 60 steps
+	// per second, without rendering them, then logs the timings.
+	void runBenchmark(U32 sources, F32 seconds);
+
 	// Note: 'max" gets clamped between 0 and 8192
 	static void setMaxPartCount(S32 max);
 	LL_INLINE static S32  getMaxPartCount()				{ return sMaxParticleCount; }
@@ -323,6 +323,8 @@ void LLViewerShaderMgr::init()
 {
 	sVertexShaderObjects.clear();
 	sFragmentShaderObjects.clear();
+	sShaderObjectDigests.clear();
+	clearShaderSources();
 	mShaderList.clear();
 
 	std::string subdir = gUsePBRShaders ? "pbr" : "ee";
@@ -330,6 +332,14 @@ void LLViewerShaderMgr::init()
 													  "shaders", subdir,
 													  "class");
 
+	std::string binaries_cache;
+	if (gSavedSettings.getBool("ShaderProgramBinaryCache"))
+	{
+		binaries_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,
+														"shader_cache");
+	}
+	setProgramBinaryCache(binaries_cache);
+
 	if (!gGLManager.mHasRequirements)
 	{
 		llwarns << "Failed to pass minimum requirements for shaders."
@@ -852,6 +862,10 @@ void LLViewerShaderMgr::setShaders()
 
 	gPipeline.createGLBuffers();
 
+	logCacheStats();
+	// The preprocessed sources are only useful while (re)loading shaders
+	clearShaderSources();
+
 	reentrance = false;
 }
 
@@ -1199,7 +1199,8 @@ void LLViewerTextureList::updateImagesDecodePriorities()
 
 // Created GL textures for all textures that need them (images which have been
 // decoded, but have not been pushed into GL).
-F32 LLViewerTextureList::updateImagesCreateTextures(F32 max_time)
+F32 LLViewerTextureList::updateImagesCreateTextures(F32 max_time,
+													 bool use_budget)
 {
 	if (gGLManager.mIsDisabled)
 	{
@@ -1210,14 +1211,27 @@ F32 LLViewerTextureList::updateImagesCreateTextures(F32 max_time)
 
 	LLTimer create_timer;
 
+	static LLCachedControl<U32> upload_budget(gSavedSettings,
+											  "TextureUploadBudgetKB");
+	S64 max_bytes = use_budget ? (S64)upload_budget * 1024 : 0;
+	S64 bytes = 0;
+
 	image_list_t::iterator enditer = mCreateTextureList.begin();
 	for (image_list_t::iterator iter = mCreateTextureList.begin(),
 								end = mCreateTextureList.end();
 		 iter != end; )
 	{
 		image_list_t::iterator curiter = iter++;
-		enditer = iter;
 		LLViewerFetchedTexture* imagep = *curiter;
+		const LLImageRaw* rawp = imagep->getRawImage();
+		S64 raw_bytes = rawp ? rawp->getDataSize() : 0;
+		// Always create at least one texture per call
+		if (max_bytes && bytes && bytes + raw_bytes > max_bytes)
+		{
+			break;
+		}
+		bytes += raw_bytes;
+		enditer = iter;
 		imagep->createTexture();
 		imagep->postCreateTexture();
 		if (create_timer.getElapsedTimeF32() > max_time)
@@ -1432,7 +1446,7 @@ S32 LLViewerTextureList::decodeAllImages(F32 max_time)
 	}
 	max_time -= timer.getElapsedTimeF32();
 	max_time = llmax(max_time, 0.1f);
-	F32 create_time = updateImagesCreateTextures(max_time);
+	F32 create_time = updateImagesCreateTextures(max_time, false);
 
 	LL_DEBUGS("ViewerTexture") << "decodeAllImages() took "
 							   << timer.getElapsedTimeF32()
@@ -130,7 +130,10 @@ public:
 
 private:
 	void updateImagesDecodePriorities();
-	F32  updateImagesCreateTextures(F32 max_time);
+	// When 'use_budget' is true, the amount of texture data created per call
+	// is limited by the TextureUploadBudgetKB setting, so to spread the
+	// uploads over several frames.
+	F32  updateImagesCreateTextures(F32 max_time, bool use_budget = true);
 	F32  updateImagesFetchTextures(F32 max_time);
 	void updateImagesUpdateStats();
 
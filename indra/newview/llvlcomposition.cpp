@@ -34,6 +34,7 @@
 
 #include "llvlcomposition.h"
 
+#include "hbxxh.h"
 #include "imageids.h"
 #include "llnoise.h"
 #include "llregionhandle.h"			// For from_region_handle()
@@ -45,6 +46,16 @@
 
 constexpr S32 BASE_SIZE = 128;
 
+// Cache of the composited texels of surface patches, shared by all regions,
+// so that returning to a region (or re-generating a patch whose terrain did
+// not change) does not need to composite the texels again. It is keyed by a
+// hash of all the composition inputs and gets flushed whenever it grows
+// beyond MAX_CACHE_BYTES.
+constexpr size_t MAX_CACHE_BYTES = 16 * 1024 * 1024;
+typedef fast_hmap<U64, std::vector<U8> > texels_cache_t;
+static texels_cache_t sTexelsCache;
+static size_t sTexelsCacheBytes = 0;
+
 // Not sure if this is the right math... Takes the weighted average of all four
 // points (bilinear interpolation)
 static F32 bilinear(F32 v00, F32 v01, F32 v10, F32 v11, F32 x_frac, F32 y_frac)
@@ -333,6 +344,118 @@ bool LLVLComposition::detailTexturesReady()
 	return true;
 }
 
+// Composites the detail textures into the [tex_x_begin, tex_x_end[ x
+// [tex_y_begin, tex_y_end[ texels of rawp. The interpolation factors and the
+// detail textures offsets only depend on the column or on the row, so they
+// are computed once per column and once per row, with the very same floating
+// point operations as getValueScaled() and as the former per-texel code did.
+void LLVLComposition::compositeTexels(U8* rawp, S32 tex_stride,
+									  F32 tex_x_begin, F32 tex_y_begin,
+									  F32 tex_x_end, F32 tex_y_end,
+									  F32 tex_x_ratiof, F32 tex_y_ratiof,
+									  U8** st_data, S32* st_data_size)
+{
+	constexpr S32 st_comps = 3;
+	constexpr S32 st_width = BASE_SIZE;
+	constexpr S32 st_height = BASE_SIZE;
+
+	LLViewerTexture* texturep = mSurfacep->getSTexture();
+	S32 tex_width = texturep->getWidth();
+	S32 tex_height = texturep->getHeight();
+
+	F32 st_x_stride = ((F32)st_width / (F32)mTexScaleX) *
+					  ((F32)mWidth / (F32)tex_width);
+	F32 st_y_stride = ((F32)st_height / (F32)mTexScaleY) *
+					  ((F32)mWidth / (F32)tex_height);
+
+	llassert(st_x_stride > 0.f && st_y_stride > 0.f);
+
+	S32 max = mWidth - 1;
+
+	// Per-column values
+	S32 columns = (S32)tex_x_end - (S32)tex_x_begin;
+	std::vector<S32> x1s(columns), x2s(columns), st_columns(columns);
+	std::vector<F32> x_fracs(columns);
+	F32 sti = tex_x_begin * st_x_stride -
+			  st_width * ((U32)(tex_x_begin * st_x_stride) / st_width);
+	for (S32 c = 0; c < columns; ++c)
+	{
+		S32 i = (S32)tex_x_begin + c;
+		F32 x_frac = i * tex_x_ratiof * mScaleInv;
+		S32 x1 = llfloor(x_frac);
+		x_fracs[c] = x_frac - x1;
+		x1s[c] = llclamp(x1, 0, max);
+		x2s[c] = llclamp(x1 + 1, 0, max);
+
+		st_columns[c] = lltrunc(sti);
+		sti += st_x_stride;
+		if (sti >= st_width)
+		{
+			sti -= st_width;
+		}
+	}
+
+	// Iterate through the target texture, striding through the sub-textures
+	// and interpolating appropriately.
+
+	F32 stj = tex_y_begin * st_y_stride -
+			  st_height * llfloor(tex_y_begin * st_y_stride / st_height);
+	for (S32 j = tex_y_begin; j < tex_y_end; ++j)
+	{
+		F32 y_frac = j * tex_y_ratiof * mScaleInv;
+		S32 y1 = llfloor(y_frac);
+		y_frac -= y1;
+		const F32* row1 = mDatap + llclamp(y1, 0, max) * mWidth;
+		const F32* row2 = mDatap + llclamp(y1 + 1, 0, max) * mWidth;
+		S32 st_row = lltrunc(stj) * st_width;
+
+		U32 offset = j * tex_stride + (S32)tex_x_begin * st_comps;
+		for (S32 c = 0; c < columns; ++c)
+		{
+			// Bilinear interpolation, like in getValueScaled()
+			F32 x_frac = x_fracs[c];
+			F32 row1_left  = row1[x1s[c]];
+			F32 row1_right = row1[x2s[c]];
+			F32 row2_left  = row2[x1s[c]];
+			F32 row2_right = row2[x2s[c]];
+			F32 row1_interp = row1_left - x_frac * (row1_left - row1_right);
+			F32 row2_interp = row2_left - x_frac * (row2_left - row2_right);
+			F32 composition = row1_interp - y_frac * (row1_interp -
+													  row2_interp);
+
+			S32 tex0 = llfloor(composition);
+			tex0 = llclamp(tex0, 0, 3);
+			composition -= tex0;
+
+			S32 tex1 = tex0 + 1;
+			tex1 = llclamp(tex1, 0, 3);
+
+			S32 st_offset = (st_columns[c] + st_row) * st_comps;
+			const U8* data0 = st_data[tex0];
+			const U8* data1 = st_data[tex1];
+			S32 max_offset = llmin(st_data_size[tex0], st_data_size[tex1]);
+			for (S32 k = 0; k < st_comps; ++k)
+			{
+				// Linearly interpolate based on composition.
+				if (st_offset < max_offset)
+				{
+					F32 a = data0[st_offset];
+					F32 b = data1[st_offset];
+					rawp[offset] = (U8)lltrunc(a + composition * (b - a));
+				}
+				++offset;
+				++st_offset;
+			}
+		}
+
+		stj += st_y_stride;
+		if (stj >= st_height)
+		{
+			stj -= st_height;
+		}
+	}
+}
+
 bool LLVLComposition::generateTexture(F32 x, F32 y, F32 width, F32 height)
 {
 	if (!mParamsReady)
@@ -457,11 +580,7 @@ bool LLVLComposition::generateTexture(F32 x, F32 y, F32 width, F32 height)
 	S32 tex_comps = texturep->getComponents();
 	S32 tex_stride = tex_width * tex_comps;
 
-	S32 st_comps = 3;
-	S32 st_width = BASE_SIZE;
-	S32 st_height = BASE_SIZE;
-
-	if (tex_comps != st_comps)
+	if (tex_comps != 3)
 	{
 		llwarns_sparse << "Base texture comps != input texture comps"
 					   << llendl;
@@ -478,70 +597,86 @@ bool LLVLComposition::generateTexture(F32 x, F32 y, F32 width, F32 height)
 	F32 tex_x_ratiof = (F32)mWidth * mScale / (F32)tex_width;
 	F32 tex_y_ratiof = (F32)mWidth * mScale / (F32)tex_height;
 
-	LLPointer<LLImageRaw> raw = new LLImageRaw(tex_width, tex_height,
-											   tex_comps);
+	// Re-use the same full-size image for all patches: it avoids allocating
+	// and clearing a new full texture sized image for each patch, and keeps
+	// the already composited patches around for createGLTexture() below.
+	if (mCompositeRaw.isNull() ||
+		mCompositeRaw->getWidth() != tex_width ||
+		mCompositeRaw->getHeight() != tex_height ||
+		mCompositeRaw->getComponents() != tex_comps)
+	{
+		mCompositeRaw = new LLImageRaw(tex_width, tex_height, tex_comps);
+	}
+	LLPointer<LLImageRaw> raw = mCompositeRaw;
 	U8* rawp = raw->getData();
 
-	F32 st_x_stride = ((F32)st_width / (F32)mTexScaleX) *
-					  ((F32)mWidth / (F32)tex_width);
-	F32 st_y_stride = ((F32)st_height / (F32)mTexScaleY) *
-					  ((F32)mWidth / (F32)tex_height);
-
-	llassert(st_x_stride > 0.f && st_y_stride > 0.f);
-
-	// Iterate through the target texture, striding through the sub-textures
-	// and interpolating appropriately.
+	S32 tex_x_first = (S32)tex_x_begin;
+	S32 tex_y_first = (S32)tex_y_begin;
+	S32 row_bytes = ((S32)tex_x_end - tex_x_first) * tex_comps;
+	S32 rows = (S32)tex_y_end - tex_y_first;
+	if (row_bytes <= 0 || rows <= 0)
+	{
+		return false;
+	}
 
-	F32 sti = tex_x_begin * st_x_stride -
-			  st_width * llfloor(tex_x_begin * st_x_stride / st_width);
-	F32 stj = tex_y_begin * st_y_stride -
-			  st_height * llfloor(tex_y_begin * st_y_stride / st_height);
+	// Hash all the inputs of the composition for this patch.
+	HBXXH64 hasher;
+	for (S32 i = 0; i < (S32)TERRAIN_COUNT; ++i)
+	{
+		hasher.update((const void*)mDetailTextures[i]->getID().mData,
+					  UUID_BYTES);
+	}
+	hasher.update((const void*)mStartHeight, sizeof(mStartHeight));
+	hasher.update((const void*)mHeightRange, sizeof(mHeightRange));
+	F32 float_params[] = { mTexScaleX, mTexScaleY, mScale };
+	hasher.update((const void*)float_params, sizeof(float_params));
+	S32 int_params[] = { mWidth, tex_width, tex_height, tex_comps,
+						 tex_x_first, tex_y_first, row_bytes, rows };
+	hasher.update((const void*)int_params, sizeof(int_params));
+	// Window of composition values read by compositeTexels()
+	S32 max_index = mWidth - 1;
+	S32 win_x_begin = llclamp(x_begin, 0, max_index);
+	S32 win_x_end = llclamp(x_end, 0, max_index);
+	S32 win_y_end = llclamp(y_end, 0, max_index);
+	for (S32 j = llclamp(y_begin, 0, max_index); j <= win_y_end; ++j)
+	{
+		hasher.update((const void*)(mDatap + j * mWidth + win_x_begin),
+					  (win_x_end - win_x_begin + 1) * sizeof(F32));
+	}
+	U64 key = hasher.digest();
 
-	S32 st_offset = (llfloor(stj * st_width) + llfloor(sti)) * st_comps;
-	for (S32 j = tex_y_begin; j < tex_y_end; ++j)
+	texels_cache_t::const_iterator it = sTexelsCache.find(key);
+	if (it != sTexelsCache.end() &&
+		it->second.size() == (size_t)(row_bytes * rows))
 	{
-		U32 offset = j * tex_stride + tex_x_begin * tex_comps;
-		sti = tex_x_begin * st_x_stride -
-			  st_width * ((U32)(tex_x_begin * st_x_stride) / st_width);
-		for (S32 i = tex_x_begin; i < tex_x_end; ++i)
+		const U8* cachedp = it->second.data();
+		for (S32 j = 0; j < rows; ++j)
 		{
-			F32 composition = getValueScaled(i * tex_x_ratiof,
-											 j * tex_y_ratiof);
-
-			S32 tex0 = llfloor(composition);
-			tex0 = llclamp(tex0, 0, 3);
-			composition -= tex0;
-
-			S32 tex1 = tex0 + 1;
-			tex1 = llclamp(tex1, 0, 3);
-
-			st_offset = (lltrunc(sti) + lltrunc(stj) * st_width) * st_comps;
-			for (S32 k = 0; k < tex_comps; ++k)
-			{
-				// Linearly interpolate based on composition.
-				if (st_offset < st_data_size[tex0] &&
-					st_offset < st_data_size[tex1])
-				{
-					F32 a = *(st_data[tex0] + st_offset);
-					F32 b = *(st_data[tex1] + st_offset);
-					rawp[offset] = (U8)lltrunc(a + composition * (b - a));
-				}
-				++offset;
-				++st_offset;
-			}
-
-			sti += st_x_stride;
-			if (sti >= st_width)
-			{
-				sti -= st_width;
-			}
+			memcpy((void*)(rawp + (tex_y_first + j) * tex_stride +
+						   tex_x_first * tex_comps),
+				   (const void*)(cachedp + j * row_bytes), row_bytes);
 		}
+	}
+	else
+	{
+		compositeTexels(rawp, tex_stride, tex_x_begin, tex_y_begin,
+						tex_x_end, tex_y_end, tex_x_ratiof, tex_y_ratiof,
+						st_data, st_data_size);
 
-		stj += st_y_stride;
-		if (stj >= st_height)
+		if (sTexelsCacheBytes > MAX_CACHE_BYTES)
 		{
-			stj -= st_height;
+			sTexelsCache.clear();
+			sTexelsCacheBytes = 0;
+		}
+		std::vector<U8>& cached = sTexelsCache[key];
+		cached.resize(row_bytes * rows);
+		for (S32 j = 0; j < rows; ++j)
+		{
+			memcpy((void*)(cached.data() + j * row_bytes),
+				   (const void*)(rawp + (tex_y_first + j) * tex_stride +
+								 tex_x_first * tex_comps), row_bytes);
 		}
+		sTexelsCacheBytes += cached.size();
 	}
 
 	if (!texturep->hasGLTexture())
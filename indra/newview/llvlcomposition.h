@@ -115,11 +115,19 @@ public:
 	LL_INLINE void setParamsReady()				{ mParamsReady = true; }
 	LL_INLINE bool getParamsReady() const		{ return mParamsReady; }
 
+protected:
+	void compositeTexels(U8* rawp, S32 tex_stride, F32 tex_x_begin,
+						 F32 tex_y_begin, F32 tex_x_end, F32 tex_y_end,
+						 F32 tex_x_ratiof, F32 tex_y_ratiof, U8** st_data,
+						 S32* st_data_size);
+
 protected:
 	LLSurface*							mSurfacep;
 
 	LLPointer<LLViewerFetchedTexture>	mDetailTextures[TERRAIN_COUNT];
 	LLPointer<LLImageRaw>				mRawImages[TERRAIN_COUNT];
+	// Full size composited surface texture image, re-used between patches
+	LLPointer<LLImageRaw>				mCompositeRaw;
 
 	F32									mStartHeight[TERRAIN_COUNT];
 	F32									mHeightRange[TERRAIN_COUNT];
@@ -38,8 +38,11 @@
 #include "llpatch_code.h"
 
 #include "llagent.h"
+#include "llappviewer.h"		// For gMainloopWorkp
 #include "llsurface.h"
+#include "llviewercontrol.h"
 #include "llviewerregion.h"
+#include "llworld.h"
 
 LLVLManager gVLManager;
 
@@ -83,20 +86,91 @@ void LLVLManager::addLayerData(LLVLData* vl_datap, S32 mesg_size)
 	mPacketData.push_back(vl_datap);
 }
 
+// Posts the decoding of a land layer packet to the general threads pool, the
+// decoded heights being applied to the region surface on the main thread.
+// Takes ownership of 'datap'.
+static void post_land_data_decoding(LLVLData* datap)
+{
+	static LLWorkQueue::weak_t general_queue =
+		LLWorkQueue::getNamedInstance("General");
+
+	LLSurface& land = datap->mRegionp->getLand();
+	U64 handle = datap->mRegionp->getHandle();
+	U32 generation = land.getPatchDataGeneration();
+	U32 serial = land.getNextDecodeSerial();
+	S32 patches_per_edge = land.getPatchesPerEdge();
+	bool large_patch = datap->mType == AURORA_LAND_LAYER_CODE;
+	std::shared_ptr<LLVLData> data(datap);
+	if (gMainloopWorkp &&
+		gMainloopWorkp->postTo(general_queue,
+							   // Work done on general queue
+							   [data, large_patch, patches_per_edge]()
+							   {
+									LLSurface::decoded_patches_t patches;
+									LLBitPack bit_pack(data->mData,
+													   data->mSize);
+									LLGroupHeader goph;
+									decode_patch_group_header(bit_pack, &goph);
+									LLSurface::decodeDCTPatches(bit_pack,
+																goph.patch_size,
+																large_patch,
+																patches_per_edge,
+																patches);
+									return patches;
+							   },
+							   // Callback to main thread
+							   [handle, generation,
+								serial](LLSurface::decoded_patches_t patches)
+							   {
+									// The region may have been removed, or
+									// re-created for the same handle with a
+									// new surface, in which case the
+									// generation does not match any more.
+									LLViewerRegion* regionp =
+										gWorld.getRegionFromHandle(handle);
+									if (regionp)
+									{
+										regionp->getLand().applyDecodedPatches(patches,
+																			   generation,
+																			   serial);
+									}
+							   }))
+	{
+		return;
+	}
+
+	// Could not post (shutting down ?): decode synchronously.
+	LLBitPack bit_pack(data->mData, data->mSize);
+	LLGroupHeader goph;
+	decode_patch_group_header(bit_pack, &goph);
+	land.decompressDCTPatch(bit_pack, &goph, large_patch);
+}
+
 void LLVLManager::unpackData(S32 num_packets)
 {
+	static LLCachedControl<bool> threaded(gSavedSettings,
+										  "ThreadedTerrainDecoding");
 	S32 count = mPacketData.size();
 	for (S32 i = 0; i < count; ++i)
 	{
 		LLVLData* datap = mPacketData[i];
 		if (!datap) continue;	// Paranoia
 
+		S8 type = datap->mType;
+		if (threaded &&
+			(type == LAND_LAYER_CODE || type == AURORA_LAND_LAYER_CODE))
+		{
+			// The packet data is now owned by the decoding work.
+			post_land_data_decoding(datap);
+			mPacketData[i] = NULL;
+			continue;
+		}
+
 		LLBitPack bit_pack(datap->mData, datap->mSize);
 		LLGroupHeader goph;
 
 		decode_patch_group_header(bit_pack, &goph);
 
-		S8 type = datap->mType;
 		if (type == LAND_LAYER_CODE)
 		{
 			datap->mRegionp->getLand().decompressDCTPatch(bit_pack, &goph,
@@ -5914,7 +5914,14 @@ void LLVOAvatar::updateVisualParams()
 
 	setSex(getVisualParamWeight("male") > 0.5f ? SEX_MALE : SEX_FEMALE);
 
+	// Batch the morph targets so that each mesh gets all its changed morphs
+	// applied at once, or its morphed data shared from the morphs cache.
+	static LLCachedControl<U32> morphs_cache_size(gSavedSettings,
+												  "AvatarMorphsCacheSize");
+	LLPolyMesh::setMorphsCacheSize(morphs_cache_size);
+	LLPolyMesh::beginMorphsBatch();
 	LLCharacter::updateVisualParams();
+	LLPolyMesh::endMorphsBatch();
 
 	if (mLastSkeletonSerialNum != mSkeletonSerialNum)
 	{
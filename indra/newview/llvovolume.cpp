@@ -402,6 +402,9 @@ void LLVOVolume::cleanupClass()
 	sObjectMediaNavigateClient = NULL;
 	llinfos << "Number of LOD cache hits: " << LLVolume::sLODCacheHit
 			<< " - Cache misses: " << LLVolume::sLODCacheMiss << llendl;
+	llinfos << "Number of texture entry updates: " << LLPrimitive::sTEUpdates
+			<< " - Skipped as unchanged: " << LLPrimitive::sTEUpdatesSkipped
+			<< llendl;
 }
 
 U32 LLVOVolume::processUpdateMessage(LLMessageSystem* mesgsys,
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+#
+# @file http-bench-server.py
+# @brief Local stand-in HTTP server for the viewer HTTP benchmark.
+#
+# Serves synthetic "texture" and "mesh" assets (/texture/<n> and /mesh/<n>),
+# honouring single byte-range requests, with HTTP/1.1 keep-alive connections,
+# so that the viewer "HTTP benchmark (local server)" (Advanced -> Network menu)
+# can measure the HTTP service latency and throughput without depending on
+# the grid servers.
+#
+# With --h2, serves the same assets over HTTPS with HTTP/2 (negotiated via
+# ALPN, with HTTP/1.1 refused), to benchmark the HttpHTTP2Multiplexing mode:
+# set HttpBenchmarkURL to https://127.0.0.1:<port>/ in the viewer. This mode
+# needs the "h2" Python package (pip install h2) and, unless --cert and --key
+# are given, the openssl command to generate a self-signed certificate. The
+# number of connections and streams served is printed on exit.
+#
+# Usage: http-bench-server.py [--port 8765] [--size 1048576] [--delay 0]
+#                             [--h2 [--cert file.pem --key key.pem]]
+#
+# $LicenseInfo:firstyear=2026&license=mit$
+#
+# Copyright (c) 2026, Linden Research, Inc.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+# $/LicenseInfo$
+
+import argparse
+import asyncio
+import os
+import re
+import ssl
+import subprocess
+import tempfile
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+RANGE_RE = re.compile(r"bytes=(\d+)-(\d*)$")
+PATH_RE = re.compile(r"^/(texture|mesh)/(\d+)$")
+
+# One synthetic payload per asset type, sliced for each request.
+PAYLOADS = {}
+
+
+def build_response(path, range_header):
+    """Returns (status, headers list, body) for a GET request."""
+    match = PATH_RE.match(path)
+    if not match:
+        return 404, [("Content-Length", "0")], b""
+    kind = match.group(1)
+    data = PAYLOADS[kind]
+    content_type = ("image/x-j2c" if kind == "texture"
+                    else "application/vnd.ll.mesh")
+
+    start, end = 0, len(data) - 1
+    status = 200
+    if range_header:
+        rmatch = RANGE_RE.match(range_header.strip())
+        if not rmatch:
+            return 416, [("Content-Length", "0")], b""
+        start = int(rmatch.group(1))
+        if rmatch.group(2):
+            end = min(int(rmatch.group(2)), end)
+        if start > end:
+            return 416, [("Content-Range", "bytes */%d" % len(data)),
+                         ("Content-Length", "0")], b""
+        status = 206
+
+    body = data[start:end + 1]
+    headers = [("Content-Type", content_type),
+               ("Content-Length", str(len(body)))]
+    if status == 206:
+        headers.append(("Content-Range",
+                        "bytes %d-%d/%d" % (start, end, len(data))))
+    return status, headers, body
+
+
+class BenchHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    delay = 0.0
+
+    def log_message(self, format, *args):
+        pass
+
+    def do_GET(self):
+        status, headers, body = build_response(self.path,
+                                               self.headers.get("Range"))
+        if self.delay > 0.0 and status < 400:
+            time.sleep(self.delay)
+        self.send_response(status)
+        for name, value in headers:
+            self.send_header(name, value)
+        self.end_headers()
+        self.wfile.write(body)
+
+
+class H2Connection(asyncio.Protocol):
+    """One HTTP/2 connection, serving its streams concurrently."""
+
+    delay = 0.0
+    connections = 0
+    streams = 0
+
+    def __init__(self):
+        import h2.config
+        import h2.connection
+        self.conn = h2.connection.H2Connection(
+            config=h2.config.H2Configuration(client_side=False,
+                                             header_encoding="utf-8"))
+        self.transport = None
+        # Stream id -> asyncio.Event set when the flow control window opens
+        self.window_events = {}
+
+    def connection_made(self, transport):
+        H2Connection.connections += 1
+        self.transport = transport
+        self.conn.initiate_connection()
+        self.transport.write(self.conn.data_to_send())
+
+    def connection_lost(self, exc):
+        for event in self.window_events.values():
+            event.set()
+
+    def data_received(self, data):
+        import h2.events
+        import h2.exceptions
+        try:
+            events = self.conn.receive_data(data)
+        except h2.exceptions.ProtocolError:
+            self.transport.write(self.conn.data_to_send())
+            self.transport.close()
+            return
+        for event in events:
+            if isinstance(event, h2.events.RequestReceived):
+                H2Connection.streams += 1
+                headers = dict(event.headers)
+                asyncio.ensure_future(self.serve(event.stream_id, headers))
+            elif isinstance(event, h2.events.WindowUpdated):
+                if event.stream_id == 0:
+                    for waiter in self.window_events.values():
+                        waiter.set()
+                elif event.stream_id in self.window_events:
+                    self.window_events[event.stream_id].set()
+            elif isinstance(event, h2.events.StreamReset):
+                waiter = self.window_events.pop(event.stream_id, None)
+                if waiter:
+                    waiter.set()
+        self.transport.write(self.conn.data_to_send())
+
+    async def serve(self, stream_id, headers):
+        status, resp_headers, body = build_response(headers.get(":path", ""),
+                                                    headers.get("range"))
+        if self.delay > 0.0 and status < 400:
+            await asyncio.sleep(self.delay)
+        if self.transport.is_closing():
+            return
+        self.conn.send_headers(stream_id,
+                               [(":status", str(status))] +
+                               [(k.lower(), v) for k, v in resp_headers],
+                               end_stream=not body)
+        self.transport.write(self.conn.data_to_send())
+        offset = 0
+        while offset < len(body):
+            window = min(self.conn.local_flow_control_window(stream_id),
+                         self.conn.max_outbound_frame_size)
+            if window <= 0:
+                waiter = asyncio.Event()
+                self.window_events[stream_id] = waiter
+                await waiter.wait()
+                self.window_events.pop(stream_id, None)
+                if self.transport.is_closing():
+                    return
+                continue
+            chunk = body[offset:offset + window]
+            offset += len(chunk)
+            self.conn.send_data(stream_id, chunk,
+                                end_stream=offset >= len(body))
+            self.transport.write(self.conn.data_to_send())
+
+
+def make_ssl_context(cert, key):
+    if not cert or not key:
+        tmpdir = tempfile.mkdtemp(prefix="http-bench-")
+        cert = os.path.join(tmpdir, "cert.pem")
+        key = os.path.join(tmpdir, "key.pem")
+        subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048",
+                        "-nodes", "-days", "30", "-subj", "/CN=127.0.0.1",
+                        "-keyout", key, "-out", cert],
+                       check=True, stdout=subprocess.DEVNULL,
+                       stderr=subprocess.DEVNULL)
+    context = ssl.create_default_context(ssl.Purpose.CLIENT_AUTH)
+    context.load_cert_chain(cert, key)
+    context.set_alpn_protocols(["h2"])
+    return context
+
+
+def serve_h2(port, cert, key):
+    context = make_ssl_context(cert, key)
+    loop = asyncio.new_event_loop()
+    server = loop.run_until_complete(
+        loop.create_server(H2Connection, "127.0.0.1", port, ssl=context))
+    print("Serving synthetic assets on https://127.0.0.1:%d/ (HTTP/2)" % port)
+    try:
+        loop.run_forever()
+    except KeyboardInterrupt:
+        pass
+    server.close()
+    print("Served %d streams over %d connections" %
+          (H2Connection.streams, H2Connection.connections))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Stand-in HTTP server for the viewer HTTP benchmark")
+    parser.add_argument("--port", type=int, default=8765,
+                        help="listening port (default: 8765)")
+    parser.add_argument("--size", type=int, default=1048576,
+                        help="size in bytes of each synthetic asset")
+    parser.add_argument("--delay", type=float, default=0.0,
+                        help="artificial per-request server delay, in "
+                             "seconds (to simulate a remote server)")
+    parser.add_argument("--h2", action="store_true",
+                        help="serve over HTTPS with HTTP/2 (needs the h2 "
+                             "Python package)")
+    parser.add_argument("--cert", help="PEM certificate for --h2 (default: "
+                                       "generate a self-signed one)")
+    parser.add_argument("--key", help="PEM private key for --cert")
+    args = parser.parse_args()
+
+    PAYLOADS["texture"] = bytes((i * 7) & 0xff for i in range(args.size))
+    PAYLOADS["mesh"] = bytes((i * 13) & 0xff for i in range(args.size))
+    BenchHandler.delay = args.delay
+    H2Connection.delay = args.delay
+
+    if args.h2:
+        serve_h2(args.port, args.cert, args.key)
+        return
+
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), BenchHandler)
+    server.daemon_threads = True
+    print("Serving synthetic assets on http://127.0.0.1:%d/" % args.port)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()